@@ -0,0 +1,697 @@
+/**
+ * @brief Reproducible benchmark suite for the Bank, Account, queue and logger hot paths
+ *
+ * Scenario benchmarks drive a fresh Bank from T threads with a fixed number
+ * of operations each: deposit/withdraw/transfer mixes and balance-read
+ * ratios, over uniform or Zipfian (s = 0.99) account access, with audit
+ * logging off or on. Microbenchmarks time ThreadPool::submitTask (also with
+ * a ThreadMonitor attached and lock contention sampled), WorkQueue,
+ * TransactionQueue, TransactionLogger (logMessage and logDeposit) and the
+ * BankUtils validators. Bulk benchmarks time the month-end jobs (applyInterest,
+ * applyFees, sumAllBalances) and consistent report views (viewAccounts)
+ * over 100 times --accounts accounts. Pipeline benchmarks submit deposits in
+ * windows of 64 to the TransactionPipeline, with and without shard
+ * affinity (Bank::Config::shardAffinity). Server benchmarks send binary-protocol
+ * deposits to a BankServer over loopback, one frame at a time and 64
+ * pipelined frames at a time (Linux only).
+ *
+ * Every thread draws from its own generator seeded from --seed, so a run
+ * replays the same operation sequence. Each operation is timed on its own,
+ * except for the validators, which are too short for that: their samples
+ * are the mean over a batch of calls ("batch" in the output), and the
+ * pipeline and server benchmarks, whose samples are a window's round trip per operation. A bulk job
+ * counts one operation per account, and its sample is the job's time per
+ * account.
+ *
+ * The results go to stdout (or --output) as one JSON document with ops/sec
+ * and latency percentiles per benchmark; progress goes to stderr. Audit
+ * logging scenarios and the logger benchmark append to the usual
+ * transaction log in the working directory.
+ *
+ * Usage: mtbs_bench [--threads N] [--ops N] [--accounts N] [--seed N]
+ *                   [--filter TEXT] [--output FILE] [--quick]
+ */
+
+#include "../include/bank.h"
+#include "../include/bank_server.h"
+#include "../include/bank_utils.h"
+#include "../include/latency_histogram.h"
+#include "../include/thread_manager.h"
+#include "../include/transaction.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    struct Options {
+        size_t threads = std::max(2u, std::thread::hardware_concurrency());
+        uint64_t opsPerThread = 200000;
+        size_t accounts = 1000;
+        uint64_t seed = 42;
+        std::string filter;
+        std::string output;
+    };
+
+    struct Measurement {
+        std::string name;
+        size_t threads = 0;
+        uint64_t operations = 0;
+        double seconds = 0.0;
+        size_t batch = 1;                       // Operations per latency sample
+        LatencyHistogram::Snapshot latency;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t nanosSince(Clock::time_point start) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - start).count());
+    }
+
+    template <typename Op>
+    void timed(LatencyHistogram& latency, Op&& op) {
+        Clock::time_point start = Clock::now();
+        op();
+        latency.record(nanosSince(start));
+    }
+
+    /**
+     * Runs body(thread, latency) on each of `threads` threads, released
+     * together once all have started; the clock covers release to last exit.
+     */
+    template <typename Body>
+    Measurement runParallel(const std::string& name, size_t threads, uint64_t operations, Body body) {
+        LatencyHistogram latency;
+        std::atomic<size_t> ready(0);
+        std::atomic<bool> go(false);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                body(t, latency);
+            });
+        }
+        while (ready.load() < threads) {
+            std::this_thread::yield();
+        }
+        Clock::time_point start = Clock::now();
+        go.store(true, std::memory_order_release);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        Measurement result;
+        result.name = name;
+        result.threads = threads;
+        result.operations = operations;
+        result.seconds = static_cast<double>(nanosSince(start)) / 1e9;
+        result.latency = latency.snapshot();
+        return result;
+    }
+
+    // ========================================================================
+    // ACCOUNT ACCESS
+    // ========================================================================
+
+    // Zipfian ranks 0..n-1 by inverse CDF; rank 0 is the hottest account
+    class ZipfDistribution {
+    public:
+        ZipfDistribution(size_t n, double exponent) : cdf(n) {
+            double total = 0.0;
+            for (size_t rank = 0; rank < n; ++rank) {
+                total += 1.0 / std::pow(static_cast<double>(rank + 1), exponent);
+                cdf[rank] = total;
+            }
+            for (double& value : cdf) {
+                value /= total;
+            }
+        }
+
+        size_t operator()(std::mt19937_64& rng) const {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            size_t rank = static_cast<size_t>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+            return std::min(rank, cdf.size() - 1);
+        }
+
+    private:
+        std::vector<double> cdf;
+    };
+
+    enum class Access { UNIFORM, ZIPF };
+
+    class AccountPicker {
+    public:
+        AccountPicker(Access access, size_t accounts) : access(access), uniform(0, accounts - 1), zipf(accounts, 0.99) {}
+
+        size_t operator()(std::mt19937_64& rng) {
+            return access == Access::ZIPF ? zipf(rng) : uniform(rng);
+        }
+
+    private:
+        Access access;
+        std::uniform_int_distribution<size_t> uniform;
+        ZipfDistribution zipf;
+    };
+
+    // ========================================================================
+    // BANK SCENARIOS
+    // ========================================================================
+
+    struct Scenario {
+        const char* name;
+        Access access;
+        int readPercent;        // getAccountBalance
+        int depositPercent;
+        int withdrawPercent;    // The rest are transfers
+        bool audit;
+    };
+
+    const Scenario kScenarios[] = {
+        {"bank/mixed/uniform",          Access::UNIFORM,  0,  50, 30, false},
+        {"bank/mixed/zipf",             Access::ZIPF,     0,  50, 30, false},
+        {"bank/deposit/zipf",           Access::ZIPF,     0, 100,  0, false},
+        {"bank/transfer/uniform",       Access::UNIFORM,  0,   0,  0, false},
+        {"bank/transfer/zipf",          Access::ZIPF,     0,   0,  0, false},
+        {"bank/read90/uniform",         Access::UNIFORM, 90,   4,  3, false},
+        {"bank/read90/zipf",            Access::ZIPF,    90,   4,  3, false},
+        {"bank/read50/zipf",            Access::ZIPF,    50,  25, 15, false},
+        {"bank/mixed/uniform/audit",    Access::UNIFORM,  0,  50, 30, true},
+        {"bank/mixed/zipf/audit",       Access::ZIPF,     0,  50, 30, true},
+    };
+
+    Bank::Config benchConfig(bool audit) {
+        Bank::Config config("MTBS Bench", "MTBS001", SIZE_MAX, 4, audit);
+        config.enableJournal = false;   // Measures the in-memory paths, not the disk
+        config.snapshotPath.clear();
+        config.recoverOnStart = false;
+        return config;
+    }
+
+    Measurement runScenario(const Scenario& scenario, const Options& options) {
+        Bank bank(benchConfig(scenario.audit));
+        std::vector<Bank::AccountSpec> specs(options.accounts, {"Bench Holder", Money::fromDollars(1000000)});
+        std::vector<std::string> numbers = bank.createAccounts(specs);
+
+        return runParallel(scenario.name, options.threads, options.threads * options.opsPerThread,
+                           [&](size_t thread, LatencyHistogram& latency) {
+            std::mt19937_64 rng(options.seed * 1000003 + thread);
+            AccountPicker pick(scenario.access, numbers.size());
+            std::uniform_int_distribution<int> percent(0, 99);
+            std::uniform_int_distribution<int64_t> cents(1, 10000);
+            volatile int64_t sink = 0;
+
+            for (uint64_t i = 0; i < options.opsPerThread; ++i) {
+                int roll = percent(rng);
+                size_t index = pick(rng);
+                const std::string& account = numbers[index];
+                Money amount = Money::fromCents(cents(rng));
+                if (roll < scenario.readPercent) {
+                    timed(latency, [&]() { sink = bank.getAccountBalance(account).toCents(); });
+                } else if (roll < scenario.readPercent + scenario.depositPercent) {
+                    timed(latency, [&]() { bank.processDeposit(account, amount); });
+                } else if (roll < scenario.readPercent + scenario.depositPercent + scenario.withdrawPercent) {
+                    timed(latency, [&]() { bank.processWithdraw(account, amount); });
+                } else {
+                    size_t other = pick(rng);
+                    const std::string& target = numbers[other == index ? (other + 1) % numbers.size() : other];
+                    timed(latency, [&]() { bank.processTransfer(account, target, amount); });
+                }
+            }
+            (void)sink;
+        });
+    }
+
+    // ========================================================================
+    // MICROBENCHMARKS
+    // ========================================================================
+
+    // Monitored: the workers publish their state to a ThreadMonitor, with lock contention sampled
+    Measurement runThreadPoolSubmit(const Options& options, bool monitored) {
+        // Submitters are external threads: every task goes through the injection ring
+        ThreadPool pool(std::max<size_t>(options.threads / 2, 1));
+        ThreadMonitor monitor;
+        uint32_t sampling = ThreadMonitor::getContentionSampling();
+        if (monitored) {
+            pool.setMonitor(&monitor);
+            ThreadMonitor::setContentionSampling(64);
+        }
+        pool.start();
+        std::atomic<uint64_t> completed(0);
+        uint64_t total = options.threads * options.opsPerThread;
+
+        Measurement result = runParallel(monitored ? "thread_pool/submit_task/monitored" : "thread_pool/submit_task", 
+                                         options.threads, total,
+                                         [&](size_t, LatencyHistogram& latency) {
+            for (uint64_t i = 0; i < options.opsPerThread; ++i) {
+                timed(latency, [&]() {
+                    pool.submitTask([&completed]() { completed.fetch_add(1, std::memory_order_relaxed); });
+                });
+            }
+        });
+        // Throughput counts until the last task has run
+        Clock::time_point drainStart = Clock::now();
+        while (completed.load() < total) {
+            std::this_thread::yield();
+        }
+        result.seconds += static_cast<double>(nanosSince(drainStart)) / 1e9;
+        pool.stop();
+        ThreadMonitor::setContentionSampling(sampling);
+        return result;
+    }
+
+    // Half the threads produce, half consume; latency is per enqueue, throughput is items moved
+    template <typename Produce, typename Consume>
+    Measurement runProducerConsumer(const std::string& name, const Options& options, Produce produce, Consume consume) {
+        size_t pairs = std::max<size_t>(options.threads / 2, 1);
+        return runParallel(name, pairs * 2, pairs * options.opsPerThread,
+                           [&](size_t thread, LatencyHistogram& latency) {
+            if (thread % 2 == 0) {
+                for (uint64_t i = 0; i < options.opsPerThread; ++i) {
+                    timed(latency, [&]() { produce(); });
+                }
+            } else {
+                for (uint64_t i = 0; i < options.opsPerThread; ++i) {
+                    consume();
+                }
+            }
+        });
+    }
+
+    Measurement runWorkQueue(const Options& options) {
+        WorkQueue queue(1024, BackpressurePolicy::BLOCK);
+        std::function<void()> work = []() {};
+        return runProducerConsumer("work_queue/enqueue_dequeue", options,
+            [&]() { queue.enqueue(WorkQueue::WorkItem(work, "bench")); },
+            [&]() { WorkQueue::WorkItem item; queue.dequeue(item); });
+    }
+
+    Measurement runTransactionQueue(const Options& options) {
+        TransactionQueue queue(1024, BackpressurePolicy::BLOCK);
+        auto task = []() {
+            return TransactionProcessor::TransactionResult(true, "", 0, Money(), std::chrono::system_clock::time_point());
+        };
+        return runProducerConsumer("transaction_queue/enqueue_dequeue", options,
+            [&]() { queue.enqueueTransaction(TransactionQueue::TransactionTask(task, "bench")); },
+            [&]() {
+                TransactionQueue::TransactionTask item;
+                while (!queue.dequeueTransaction(item)) {   // Non-blocking by design
+                    std::this_thread::yield();
+                }
+            });
+    }
+
+    // log_message hands over a formatted message; log_deposit the raw fields of the same line
+    Measurement runLogger(const std::string& name, const Options& options, bool rawFields) {
+        TransactionLogger logger("bank_transactions.log");
+        uint64_t perThread = std::max<uint64_t>(options.opsPerThread / 4, 1);   // Keeps the log file modest
+        Measurement result = runParallel(name, options.threads, options.threads * perThread,
+                                         [&](size_t thread, LatencyHistogram& latency) {
+            std::string account = "MTBS-0000-" + std::to_string(1000 + thread);
+            std::string message = "Deposit: $12.34 to account " + account;
+            uint32_t accountId = StringTable::accountNumbers().intern(account);
+            for (uint64_t i = 0; i < perThread; ++i) {
+                if (rawFields) {
+                    timed(latency, [&]() { logger.logDeposit(accountId, Money::fromCents(1234)); });
+                } else {
+                    timed(latency, [&]() { logger.logMessage(TransactionLogger::LogLevel::INFO, message); });
+                }
+            }
+        });
+        logger.flushLogs();
+        return result;
+    }
+
+    // Single thread; each latency sample is the mean over kBatch calls
+    template <typename Check>
+    Measurement runValidator(const std::string& name, const std::vector<std::string>& inputs,
+                             const Options& options, Check check) {
+        constexpr size_t kBatch = 64;
+        uint64_t batches = std::max<uint64_t>(options.opsPerThread * 4 / kBatch, 1);
+        Measurement result = runParallel(name, 1, batches * kBatch, [&](size_t, LatencyHistogram& latency) {
+            size_t accepted = 0;
+            size_t next = 0;
+            for (uint64_t b = 0; b < batches; ++b) {
+                Clock::time_point start = Clock::now();
+                for (size_t i = 0; i < kBatch; ++i) {
+                    accepted += check(inputs[next]) ? 1 : 0;
+                    next = next + 1 == inputs.size() ? 0 : next + 1;
+                }
+                latency.record(nanosSince(start) / kBatch);
+            }
+            volatile size_t sink = accepted;
+            (void)sink;
+        });
+        result.batch = kBatch;
+        return result;
+    }
+
+    std::vector<Measurement> runValidators(const Options& options, const std::string& filter) {
+        std::mt19937_64 rng(options.seed);
+        std::uniform_int_distribution<int> digit(1000, 9999);
+        std::vector<std::string> accounts;
+        std::vector<std::string> names;
+        std::vector<std::string> emails;
+        for (int i = 0; i < 256; ++i) {
+            accounts.push_back("MTBS-" + std::to_string(digit(rng)) + "-" + std::to_string(digit(rng)));
+        }
+        accounts.push_back("mtbs-1234-5678");
+        const char* const first[] = {"John", "Mary-Ann", "O'Brien", "Jean-Luc", "Anne Marie"};
+        const char* const last[] = {"Doe", "Johnson, Jr.", "van der Berg", "St. James", "3rd"};
+        for (const char* f : first) {
+            for (const char* l : last) {
+                names.push_back(std::string(f) + " " + l);
+            }
+        }
+        const char* const users[] = {"john", "jane.doe", "x+tag", "first.last%dept"};
+        const char* const domains[] = {"example.com", "mail.example.co.uk", "localhost", "x.c0m"};
+        for (const char* u : users) {
+            for (const char* d : domains) {
+                emails.push_back(std::string(u) + "@" + d);
+            }
+        }
+
+        std::vector<Measurement> results;
+        auto add = [&](const std::string& name, const std::vector<std::string>& inputs, bool (*check)(const std::string&)) {
+            if (name.find(filter) != std::string::npos) {
+                std::cerr << "  " << name << std::endl;
+                results.push_back(runValidator(name, inputs, options, check));
+            }
+        };
+        add("validators/account_number", accounts, [](const std::string& s) { return BankUtils::isValidAccountNumber(s); });
+        add("validators/holder_name", names, [](const std::string& s) { return BankUtils::isValidHolderName(s); });
+        add("validators/email", emails, [](const std::string& s) { return BankUtils::isValidEmail(s); });
+        return results;
+    }
+
+    // ========================================================================
+    // BULK JOBS
+    // ========================================================================
+
+    // Jobs on a running (so parallel) bank; each latency sample is one job's time per account
+    template <typename Job>
+    Measurement runBulk(const std::string& name, const Options& options, Job job) {
+        Bank bank(benchConfig(false));
+        size_t accounts = options.accounts * 100;
+        std::vector<Bank::AccountSpec> specs(accounts, {"Bench Holder", Money::fromDollars(1000)});
+        bank.createAccounts(specs);
+        bank.startBankingSystem();
+
+        uint64_t jobs = std::max<uint64_t>(options.opsPerThread / 10000, 1);
+        Measurement result = runParallel(name, 1, jobs * accounts, [&](size_t, LatencyHistogram& latency) {
+            for (uint64_t j = 0; j < jobs; ++j) {
+                Clock::time_point start = Clock::now();
+                job(bank);
+                latency.record(nanosSince(start) / accounts);
+            }
+        });
+        result.batch = accounts;
+        bank.stopBankingSystem();
+        return result;
+    }
+
+    // ========================================================================
+    // PIPELINE
+    // ========================================================================
+
+    // Deposits through the pipeline, kWindow in flight per thread; each sample is one window's
+    // round trip per operation
+    Measurement runPipeline(const std::string& name, const Options& options, bool affinity) {
+        constexpr size_t kWindow = 64;
+        Bank::Config config = benchConfig(false);
+        config.shardAffinity = affinity;
+        Bank bank(config);
+        std::vector<Bank::AccountSpec> specs(options.accounts, {"Bench Holder", Money::fromDollars(1000000)});
+        std::vector<std::string> numbers = bank.createAccounts(specs);
+        bank.startBankingSystem();
+
+        uint64_t windows = std::max<uint64_t>(options.opsPerThread / kWindow, 1);
+        Measurement result = runParallel(name, options.threads, options.threads * windows * kWindow,
+                                         [&](size_t thread, LatencyHistogram& latency) {
+            std::mt19937_64 rng(options.seed * 1000003 + thread);
+            std::uniform_int_distribution<size_t> account(0, numbers.size() - 1);
+            std::vector<std::future<Bank::TransactionResult>> window;
+            window.reserve(kWindow);
+            for (uint64_t w = 0; w < windows; ++w) {
+                Clock::time_point start = Clock::now();
+                for (size_t i = 0; i < kWindow; ++i) {
+                    window.push_back(bank.submitDeposit(numbers[account(rng)], Money::fromCents(100)));
+                }
+                for (auto& future : window) {
+                    future.get();
+                }
+                window.clear();
+                latency.record(nanosSince(start) / kWindow);
+            }
+        });
+        result.batch = kWindow;
+        bank.stopBankingSystem();
+        return result;
+    }
+
+    // ========================================================================
+    // NETWORK FRONT-END
+    // ========================================================================
+
+#if defined(__linux__)
+    // Binary-protocol deposits over loopback, window frames in flight per connection (one
+    // connection per thread); each latency sample is one window's round trip per frame
+    Measurement runServer(const std::string& name, const Options& options, size_t window) {
+        Bank bank(benchConfig(false));
+        std::vector<Bank::AccountSpec> specs(options.accounts, {"Bench Holder", Money::fromDollars(1000000)});
+        std::vector<std::string> numbers = bank.createAccounts(specs);
+        bank.startBankingSystem();
+        BankServer::Options serverOptions;
+        serverOptions.port = 0;
+        serverOptions.staticRoot.clear();
+        BankServer server(bank, serverOptions);
+        server.start();
+
+        uint64_t windows = std::max<uint64_t>(options.opsPerThread / 10 / window, 1);
+        Measurement result = runParallel(name, options.threads, options.threads * windows * window,
+                                         [&](size_t thread, LatencyHistogram& latency) {
+            int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(server.getPort());
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            int enable = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                ::close(fd);
+                throw std::runtime_error("cannot connect to the bench server");
+            }
+
+            std::mt19937_64 rng(options.seed * 1000003 + thread);
+            std::uniform_int_distribution<size_t> account(0, numbers.size() - 1);
+            std::string frames(BankServer::kBinaryMagic, sizeof(BankServer::kBinaryMagic));
+            std::string received;
+            char chunk[65536];
+            for (uint64_t w = 0; w < windows; ++w) {
+                for (size_t i = 0; i < window; ++i) {
+                    BankServer::appendBinaryRequest(frames, BankServer::BinaryOp::DEPOSIT, static_cast<uint32_t>(i),
+                                                    numbers[account(rng)], "", Money::fromCents(100));
+                }
+                Clock::time_point start = Clock::now();
+                ::send(fd, frames.data(), frames.size(), MSG_NOSIGNAL);
+                frames.clear();
+                size_t answered = 0;
+                while (answered < window) {
+                    ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+                    if (got <= 0) {
+                        ::close(fd);
+                        throw std::runtime_error("bench server closed the connection");
+                    }
+                    received.append(chunk, static_cast<size_t>(got));
+                    BankServer::BinaryResponse response;
+                    size_t used, offset = 0;
+                    while ((used = BankServer::parseBinaryResponse(received.data() + offset, 
+                                                                   received.size() - offset, response)) != 0) {
+                        offset += used;
+                        ++answered;
+                    }
+                    received.erase(0, offset);
+                }
+                latency.record(nanosSince(start) / window);
+            }
+            ::close(fd);
+        });
+        result.batch = window;
+        server.stop();
+        bank.stopBankingSystem();
+        return result;
+    }
+#endif
+
+    // ========================================================================
+    // OUTPUT
+    // ========================================================================
+
+    std::string toJson(const Options& options, const std::vector<Measurement>& results) {
+        std::time_t now = std::time(nullptr);
+        std::ostringstream oss;
+        oss << "{\n  \"suite\": \"mtbs_bench\",\n  \"version\": 1,\n"
+            << "  \"timestamp\": \"" << std::put_time(std::gmtime(&now), "%Y-%m-%dT%H:%M:%SZ") << "\",\n"
+            << "  \"config\": {\"threads\": " << options.threads << ", \"ops_per_thread\": " << options.opsPerThread
+            << ", \"accounts\": " << options.accounts << ", \"seed\": " << options.seed
+            << ", \"hardware_concurrency\": " << std::thread::hardware_concurrency() << "},\n"
+            << "  \"results\": [";
+        oss << std::fixed;
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Measurement& m = results[i];
+            double opsPerSec = m.seconds > 0.0 ? static_cast<double>(m.operations) / m.seconds : 0.0;
+            oss << (i ? "," : "") << "\n    {\"name\": \"" << m.name << "\", \"threads\": " << m.threads
+                << ", \"operations\": " << m.operations
+                << ", \"seconds\": " << std::setprecision(6) << m.seconds
+                << ", \"ops_per_sec\": " << std::setprecision(1) << opsPerSec
+                << ", \"batch\": " << m.batch
+                << ", \"latency_ns\": {\"mean\": " << std::setprecision(1) << m.latency.meanNanos()
+                << ", \"p50\": " << m.latency.percentile(50.0)
+                << ", \"p90\": " << m.latency.percentile(90.0)
+                << ", \"p99\": " << m.latency.percentile(99.0)
+                << ", \"p999\": " << m.latency.percentile(99.9)
+                << ", \"max\": " << m.latency.maxNanos << "}}";
+        }
+        oss << "\n  ]\n}\n";
+        return oss.str();
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string flag = argv[i];
+            if (flag == "--quick") {
+                options.opsPerThread = 20000;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                break;
+            }
+            std::string value = argv[++i];
+            if (flag == "--threads") options.threads = std::strtoull(value.c_str(), nullptr, 10);
+            else if (flag == "--ops") options.opsPerThread = std::strtoull(value.c_str(), nullptr, 10);
+            else if (flag == "--accounts") options.accounts = std::strtoull(value.c_str(), nullptr, 10);
+            else if (flag == "--seed") options.seed = std::strtoull(value.c_str(), nullptr, 10);
+            else if (flag == "--filter") options.filter = value;
+            else if (flag == "--output") options.output = value;
+        }
+        if (options.threads == 0) options.threads = 1;
+        if (options.opsPerThread == 0) options.opsPerThread = 1;
+        if (options.accounts < 2) options.accounts = 2;     // Transfers need two accounts
+        return options;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options = parseOptions(argc, argv);
+    std::vector<Measurement> results;
+    auto selected = [&options](const std::string& name) {
+        if (name.find(options.filter) == std::string::npos) {
+            return false;
+        }
+        std::cerr << "  " << name << std::endl;
+        return true;
+    };
+
+    std::cerr << "mtbs_bench: " << options.threads << " threads, " << options.opsPerThread
+              << " operations each" << std::endl;
+    try {
+        for (const Scenario& scenario : kScenarios) {
+            if (selected(scenario.name)) {
+                results.push_back(runScenario(scenario, options));
+            }
+        }
+        if (selected("thread_pool/submit_task")) {
+            results.push_back(runThreadPoolSubmit(options, false));
+        }
+        if (selected("thread_pool/submit_task/monitored")) {
+            results.push_back(runThreadPoolSubmit(options, true));
+        }
+        if (selected("work_queue/enqueue_dequeue")) {
+            results.push_back(runWorkQueue(options));
+        }
+        if (selected("transaction_queue/enqueue_dequeue")) {
+            results.push_back(runTransactionQueue(options));
+        }
+        if (selected("logger/log_message")) {
+            results.push_back(runLogger("logger/log_message", options, false));
+        }
+        if (selected("logger/log_deposit")) {
+            results.push_back(runLogger("logger/log_deposit", options, true));
+        }
+        for (Measurement& measurement : runValidators(options, options.filter)) {
+            results.push_back(std::move(measurement));
+        }
+        if (selected("pipeline/deposit")) {
+            results.push_back(runPipeline("pipeline/deposit", options, false));
+        }
+        if (selected("pipeline/deposit/affinity")) {
+            results.push_back(runPipeline("pipeline/deposit/affinity", options, true));
+        }
+#if defined(__linux__)
+        if (selected("server/binary_deposit")) {
+            results.push_back(runServer("server/binary_deposit", options, 1));
+        }
+        if (selected("server/binary_pipelined")) {
+            results.push_back(runServer("server/binary_pipelined", options, 64));
+        }
+#endif
+        if (selected("bulk/apply_interest")) {
+            results.push_back(runBulk("bulk/apply_interest", options, [](Bank& bank) { bank.applyInterest(1.2); }));
+        }
+        if (selected("bulk/apply_fees")) {
+            Bank::FeeSchedule schedule{Money::fromCents(1), Money()};
+            results.push_back(runBulk("bulk/apply_fees", options, [&schedule](Bank& bank) { bank.applyFees(schedule); }));
+        }
+        if (selected("bulk/sum_balances")) {
+            results.push_back(runBulk("bulk/sum_balances", options, [](Bank& bank) {
+                volatile int64_t sink = bank.sumAllBalances().toCents();
+                (void)sink;
+            }));
+        }
+        if (selected("bulk/view_accounts")) {
+            results.push_back(runBulk("bulk/view_accounts", options, [](Bank& bank) {
+                volatile int64_t sink = bank.viewAccounts().totalBalance().toCents();
+                (void)sink;
+            }));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "mtbs_bench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::string json = toJson(options, results);
+    if (options.output.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(options.output);
+        out << json;
+        if (!out) {
+            std::cerr << "mtbs_bench: cannot write " << options.output << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * @brief Push/pop throughput of MpmcRing against a mutex + condvar queue
+ *
+ * Runs N producers and N consumers for N = 1, 2, 4, ... up to --max-threads
+ * and prints millions of items moved per second for each queue. The mutex
+ * queue reproduces the design WorkQueue used before it moved to MpmcRing.
+ *
+ * Usage: queue_bench [--items N] [--capacity N] [--max-threads N]
+ */
+
+#include "../include/mpmc_ring.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+
+namespace {
+    // Baseline: bounded queue behind one mutex and two condition variables
+    class MutexQueue {
+    public:
+        explicit MutexQueue(size_t capacity) : capacity(capacity) {}
+
+        void push(uint64_t value) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this]() { return items.size() < capacity; });
+            items.push(value);
+            notEmpty.notify_one();
+        }
+
+        void pop(uint64_t& value) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this]() { return !items.empty(); });
+            value = items.front();
+            items.pop();
+            notFull.notify_one();
+        }
+
+    private:
+        std::queue<uint64_t> items;
+        size_t capacity;
+        std::mutex mutex;
+        std::condition_variable notFull;
+        std::condition_variable notEmpty;
+    };
+
+    struct Options {
+        size_t items = 2000000;
+        size_t capacity = 1024;
+        size_t maxThreads = 8;
+    };
+
+    // Moves options.items values through the queue; returns items per second
+    template <typename Push, typename Pop>
+    double run(size_t threads, size_t items, Push push, Pop pop) {
+        size_t perThread = items / threads;
+        std::vector<std::thread> workers;
+        std::vector<uint64_t> checksums(threads, 0);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([=]() {
+                for (size_t i = 0; i < perThread; ++i) {
+                    push(static_cast<uint64_t>(i + 1));
+                }
+            });
+            workers.emplace_back([=, &checksums]() {
+                uint64_t value = 0;
+                uint64_t sum = 0;
+                for (size_t i = 0; i < perThread; ++i) {
+                    pop(value);
+                    sum += value;
+                }
+                checksums[t] = sum;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return static_cast<double>(perThread * threads) / elapsed;
+    }
+
+    double runRing(size_t threads, const Options& options, BackpressurePolicy policy) {
+        MpmcRing<uint64_t> ring(options.capacity);
+        return run(threads, options.items,
+                   [&ring, policy](uint64_t value) { ring.push(value, policy); },
+                   [&ring, policy](uint64_t& value) { ring.pop(value, policy); });
+    }
+
+    double runRingSpinning(size_t threads, const Options& options) {
+        // REJECT policy retried by the caller: pure lock-free path, never parks
+        MpmcRing<uint64_t> ring(options.capacity);
+        return run(threads, options.items,
+                   [&ring](uint64_t value) { while (!ring.tryPush(value)) std::this_thread::yield(); },
+                   [&ring](uint64_t& value) { while (!ring.tryPop(value)) std::this_thread::yield(); });
+    }
+
+    double runMutex(size_t threads, const Options& options) {
+        MutexQueue queue(options.capacity);
+        return run(threads, options.items,
+                   [&queue](uint64_t value) { queue.push(value); },
+                   [&queue](uint64_t& value) { queue.pop(value); });
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string flag = argv[i];
+            size_t value = std::strtoull(argv[i + 1], nullptr, 10);
+            if (flag == "--items") options.items = value;
+            else if (flag == "--capacity") options.capacity = value;
+            else if (flag == "--max-threads") options.maxThreads = value;
+        }
+        if (options.maxThreads == 0) options.maxThreads = 1;
+        return options;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options = parseOptions(argc, argv);
+
+    std::cout << "Queue throughput (" << options.items << " items, capacity " << options.capacity
+              << ", N producers + N consumers, M items/s)" << std::endl;
+    std::cout << std::setw(4) << "N"
+              << std::setw(14) << "mutex+cv"
+              << std::setw(14) << "ring BLOCK"
+              << std::setw(14) << "ring SPIN"
+              << std::setw(14) << "ring lockfree" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t threads = 1; threads <= options.maxThreads; threads *= 2) {
+        std::cout << std::setw(4) << threads
+                  << std::setw(14) << runMutex(threads, options) / 1e6
+                  << std::setw(14) << runRing(threads, options, BackpressurePolicy::BLOCK) / 1e6
+                  << std::setw(14) << runRing(threads, options, BackpressurePolicy::SPIN_THEN_PARK) / 1e6
+                  << std::setw(14) << runRingSpinning(threads, options) / 1e6 << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * @brief Cost of BankUtils validators against the std::regex versions they replaced
+ *
+ * For account numbers, holder names and emails, times the regex built on
+ * every call (the old code), a regex built once, and the table-driven
+ * validator, and prints nanoseconds per call. Before timing, the new name
+ * and email rules are checked against the regexes on the whole input set.
+ *
+ * Usage: validator_bench [--iterations N]
+ */
+
+#include "../include/bank_utils.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <regex>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+    const char* const kAccountPattern = "^[A-Z0-9]{8,12}$";
+    const char* const kNamePattern = "^[a-zA-Z\\s\\-\\'\\,\\.]+$";
+    const char* const kEmailPattern = R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})";
+
+    // Baseline: the length checks and regex of the old validators
+    bool regexName(const std::string& name, const std::regex* pattern) {
+        if (name.empty() || name.length() < 2 || name.length() > 100) {
+            return false;
+        }
+        return pattern ? std::regex_match(name, *pattern) : std::regex_match(name, std::regex(kNamePattern));
+    }
+
+    bool regexEmail(const std::string& email, const std::regex* pattern) {
+        if (email.empty() || email.length() > 254) {
+            return false;
+        }
+        return pattern ? std::regex_match(email, *pattern) : std::regex_match(email, std::regex(kEmailPattern));
+    }
+
+    bool regexAccount(const std::string& number, const std::regex* pattern) {
+        if (number.empty() || number.length() < 8) {
+            return false;
+        }
+        return pattern ? std::regex_match(number, *pattern) : std::regex_match(number, std::regex(kAccountPattern));
+    }
+
+    struct Inputs {
+        std::vector<std::string> accounts;
+        std::vector<std::string> names;
+        std::vector<std::string> emails;
+    };
+
+    Inputs makeInputs() {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> digit(1000, 9999);
+        Inputs inputs;
+
+        for (int i = 0; i < 256; ++i) {
+            std::string grouped = "MTBS-" + std::to_string(digit(gen)) + "-" + std::to_string(digit(gen));
+            inputs.accounts.push_back(grouped);
+            inputs.accounts.push_back(grouped.substr(0, 4) + grouped.substr(5, 4) + grouped.substr(10, 4));
+        }
+        inputs.accounts.push_back("mtbs-1234-5678");
+        inputs.accounts.push_back("MTBS--1234-5678");
+
+        const char* const first[] = {"John", "Jane", "Mary-Ann", "O'Brien", "Li", "Jean-Luc", "Zoe", "Anne Marie"};
+        const char* const last[] = {"Doe", "Smith", "Johnson, Jr.", "van der Berg", "Nguyen", "St. James"};
+        for (const char* f : first) {
+            for (const char* l : last) {
+                inputs.names.push_back(std::string(f) + " " + l);
+                inputs.names.push_back(std::string(f) + " " + l + " 3rd");     // Digit: rejected
+            }
+        }
+        inputs.names.push_back("Dr. Maximilian Alexander von Hohenzollern-Sigmaringen");
+        inputs.names.push_back("Jos\xc3\xa9 Garc\xc3\xad" "a");                       // Non-ASCII: rejected
+        inputs.names.push_back("X");
+
+        const char* const users[] = {"john", "jane.doe", "a_b", "x+tag", "first.last%dept"};
+        const char* const domains[] = {"example.com", "mail.example.co.uk", "bank-mtbs.io", "localhost", "a.b", "x.c0m"};
+        for (const char* u : users) {
+            for (const char* d : domains) {
+                inputs.emails.push_back(std::string(u) + "@" + d);
+            }
+        }
+        inputs.emails.push_back("@example.com");
+        inputs.emails.push_back("two@@example.com");
+        inputs.emails.push_back("no-at-sign.example.com");
+        return inputs;
+    }
+
+    volatile size_t sink;
+
+    template <typename Check>
+    double nanosPerCall(const std::vector<std::string>& inputs, size_t iterations, Check check) {
+        size_t accepted = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            accepted += check(inputs[i % inputs.size()]) ? 1 : 0;
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        sink = accepted;
+        return elapsed / static_cast<double>(iterations);
+    }
+
+    template <typename New, typename Old>
+    size_t mismatches(const std::vector<std::string>& inputs, New newer, Old older) {
+        size_t count = 0;
+        for (const std::string& input : inputs) {
+            if (newer(input) != older(input)) {
+                std::cout << "  mismatch: \"" << input << "\"" << std::endl;
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    void report(const char* label, double perCall, double precompiled, double validator) {
+        std::cout << std::left << std::setw(16) << label << std::right
+                  << std::setw(14) << perCall
+                  << std::setw(14) << precompiled
+                  << std::setw(14) << validator
+                  << std::setw(11) << perCall / validator << "x" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = 200000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::string(argv[i]) == "--iterations") {
+            iterations = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    if (iterations == 0) iterations = 1;
+
+    Inputs inputs = makeInputs();
+    const std::regex accountPattern(kAccountPattern);
+    const std::regex namePattern(kNamePattern);
+    const std::regex emailPattern(kEmailPattern);
+
+    // The name and email rules are meant to be identical to the regexes
+    size_t nameMismatches = mismatches(inputs.names,
+        [](const std::string& s) { return BankUtils::isValidHolderName(s); },
+        [&](const std::string& s) { return regexName(s, &namePattern); });
+    size_t emailMismatches = mismatches(inputs.emails,
+        [](const std::string& s) { return BankUtils::isValidEmail(s); },
+        [&](const std::string& s) { return regexEmail(s, &emailPattern); });
+    std::cout << "Rule check: " << nameMismatches << " name and " << emailMismatches
+              << " email mismatches against the regexes" << std::endl;
+    std::cout << "Generated \"MTBS-1234-5678\": old rule " << (regexAccount("MTBS-1234-5678", &accountPattern) ? "accepts" : "rejects")
+              << ", new rule " << (BankUtils::isValidAccountNumber("MTBS-1234-5678") ? "accepts" : "rejects") << std::endl;
+
+    std::cout << "\nns per call (" << iterations << " calls each)" << std::endl;
+    std::cout << std::left << std::setw(16) << "validator" << std::right
+              << std::setw(14) << "regex/call"
+              << std::setw(14) << "regex once"
+              << std::setw(14) << "BankUtils"
+              << std::setw(12) << "speedup" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    // Building a regex per call is far slower; fewer iterations keep the run short
+    size_t slowIterations = std::max<size_t>(iterations / 20, 1);
+    report("account number",
+           nanosPerCall(inputs.accounts, slowIterations, [](const std::string& s) { return regexAccount(s, nullptr); }),
+           nanosPerCall(inputs.accounts, iterations, [&](const std::string& s) { return regexAccount(s, &accountPattern); }),
+           nanosPerCall(inputs.accounts, iterations, [](const std::string& s) { return BankUtils::isValidAccountNumber(s); }));
+    report("holder name",
+           nanosPerCall(inputs.names, slowIterations, [](const std::string& s) { return regexName(s, nullptr); }),
+           nanosPerCall(inputs.names, iterations, [&](const std::string& s) { return regexName(s, &namePattern); }),
+           nanosPerCall(inputs.names, iterations, [](const std::string& s) { return BankUtils::isValidHolderName(s); }));
+    report("holder (scalar)",
+           nanosPerCall(inputs.names, slowIterations, [](const std::string& s) { return regexName(s, nullptr); }),
+           nanosPerCall(inputs.names, iterations, [&](const std::string& s) { return regexName(s, &namePattern); }),
+           nanosPerCall(inputs.names, iterations, [](const std::string& s) {
+               return s.length() >= 2 && s.length() <= 100 && BankUtils::detail::isValidHolderNameScalar(s);
+           }));
+    report("email",
+           nanosPerCall(inputs.emails, slowIterations, [](const std::string& s) { return regexEmail(s, nullptr); }),
+           nanosPerCall(inputs.emails, iterations, [&](const std::string& s) { return regexEmail(s, &emailPattern); }),
+           nanosPerCall(inputs.emails, iterations, [](const std::string& s) { return BankUtils::isValidEmail(s); }));
+
+    return nameMismatches + emailMismatches == 0 ? 0 : 1;
+}
@@ -39,6 +39,46 @@ if %errorlevel% neq 0 (
     exit /b 1
 )
 
+echo Compiling account_directory.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/account_directory.cpp -o build/account_directory.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile account_directory.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling account_columns.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/account_columns.cpp -o build/account_columns.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile account_columns.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling account_number_allocator.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/account_number_allocator.cpp -o build/account_number_allocator.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile account_number_allocator.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling admission_controller.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/admission_controller.cpp -o build/admission_controller.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile admission_controller.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling async_file_writer.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/async_file_writer.cpp -o build/async_file_writer.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile async_file_writer.cpp
+    pause
+    exit /b 1
+)
+
 echo Compiling bank.cpp...
 g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/bank.cpp -o build/bank.o
 if %errorlevel% neq 0 (
@@ -47,6 +87,14 @@ if %errorlevel% neq 0 (
     exit /b 1
 )
 
+echo Compiling bank_server.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/bank_server.cpp -o build/bank_server.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile bank_server.cpp
+    pause
+    exit /b 1
+)
+
 echo Compiling bank_utils.cpp...
 g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/bank_utils.cpp -o build/bank_utils.o
 if %errorlevel% neq 0 (
@@ -55,6 +103,102 @@ if %errorlevel% neq 0 (
     exit /b 1
 )
 
+echo Compiling deferred_log.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/deferred_log.cpp -o build/deferred_log.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile deferred_log.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling epoch_reclaimer.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/epoch_reclaimer.cpp -o build/epoch_reclaimer.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile epoch_reclaimer.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling id_generator.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/id_generator.cpp -o build/id_generator.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile id_generator.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling journal.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/journal.cpp -o build/journal.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile journal.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling latency_histogram.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/latency_histogram.cpp -o build/latency_histogram.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile latency_histogram.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling log_reader.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/log_reader.cpp -o build/log_reader.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile log_reader.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling money.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/money.cpp -o build/money.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile money.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling scratch_arena.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/scratch_arena.cpp -o build/scratch_arena.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile scratch_arena.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling sharded_counter.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/sharded_counter.cpp -o build/sharded_counter.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile sharded_counter.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling replication.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/replication.cpp -o build/replication.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile replication.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling snapshot.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/snapshot.cpp -o build/snapshot.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile snapshot.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling string_table.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/string_table.cpp -o build/string_table.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile string_table.cpp
+    pause
+    exit /b 1
+)
+
 echo Compiling transaction.cpp...
 g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/transaction.cpp -o build/transaction.o
 if %errorlevel% neq 0 (
@@ -63,6 +207,22 @@ if %errorlevel% neq 0 (
     exit /b 1
 )
 
+echo Compiling transaction_history.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/transaction_history.cpp -o build/transaction_history.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile transaction_history.cpp
+    pause
+    exit /b 1
+)
+
+echo Compiling transaction_pipeline.cpp...
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/transaction_pipeline.cpp -o build/transaction_pipeline.o
+if %errorlevel% neq 0 (
+    echo ERROR: Failed to compile transaction_pipeline.cpp
+    pause
+    exit /b 1
+)
+
 echo Compiling thread_manager.cpp...
 g++ -std=c++17 -Wall -Wextra -O2 -pthread -Iinclude -c src/thread_manager.cpp -o build/thread_manager.o
 if %errorlevel% neq 0 (
@@ -58,9 +58,29 @@ if ($BuildType -eq "Debug") {
 # Source files to compile
 $sourceFiles = @(
     @{File="src/account.cpp"; Output="build/account.o"},
+    @{File="src/account_directory.cpp"; Output="build/account_directory.o"},
+    @{File="src/account_columns.cpp"; Output="build/account_columns.o"},
+    @{File="src/account_number_allocator.cpp"; Output="build/account_number_allocator.o"},
+    @{File="src/admission_controller.cpp"; Output="build/admission_controller.o"},
+    @{File="src/async_file_writer.cpp"; Output="build/async_file_writer.o"},
     @{File="src/bank.cpp"; Output="build/bank.o"},
+    @{File="src/bank_server.cpp"; Output="build/bank_server.o"},
     @{File="src/bank_utils.cpp"; Output="build/bank_utils.o"},
+    @{File="src/deferred_log.cpp"; Output="build/deferred_log.o"},
+    @{File="src/epoch_reclaimer.cpp"; Output="build/epoch_reclaimer.o"},
+    @{File="src/id_generator.cpp"; Output="build/id_generator.o"},
+    @{File="src/journal.cpp"; Output="build/journal.o"},
+    @{File="src/latency_histogram.cpp"; Output="build/latency_histogram.o"},
+    @{File="src/log_reader.cpp"; Output="build/log_reader.o"},
+    @{File="src/money.cpp"; Output="build/money.o"},
+    @{File="src/scratch_arena.cpp"; Output="build/scratch_arena.o"},
+    @{File="src/sharded_counter.cpp"; Output="build/sharded_counter.o"},
+    @{File="src/replication.cpp"; Output="build/replication.o"},
+    @{File="src/snapshot.cpp"; Output="build/snapshot.o"},
+    @{File="src/string_table.cpp"; Output="build/string_table.o"},
     @{File="src/transaction.cpp"; Output="build/transaction.o"},
+    @{File="src/transaction_history.cpp"; Output="build/transaction_history.o"},
+    @{File="src/transaction_pipeline.cpp"; Output="build/transaction_pipeline.o"},
     @{File="src/thread_manager.cpp"; Output="build/thread_manager.o"},
     @{File="src/main.cpp"; Output="build/main.o"}
 )
@@ -1,9 +1,17 @@
 // MTBS Frontend - Core Banking System Interface
+// Talks to the bank engine through its embedded server (bank_system --serve, see BankServer);
+// opened from a file, it expects that server on the default port
+const API_BASE = window.location.protocol === 'file:' ? 'http://127.0.0.1:8080' : '';
+
 class MTBSFrontend {
     constructor() {
         this.currentTheme = localStorage.getItem('theme') || 'light';
-        this.accounts = [];
-        this.transactions = [];
+        this.accounts = [];         // As last pushed by the server
+        this.transactions = [];     // Newest first
+        this.stats = null;
+        this.status = null;
+        this.lastThroughputSample = null;
+        this.events = null;
         this.init();
     }
 
@@ -64,7 +72,7 @@ class MTBSFrontend {
         this.currentTheme = theme;
         document.documentElement.setAttribute('data-theme', theme);
         localStorage.setItem('theme', theme);
-        
+
         const icon = document.querySelector('#theme-toggle i');
         icon.className = theme === 'dark' ? 'fas fa-sun' : 'fas fa-moon';
     }
@@ -76,10 +84,10 @@ class MTBSFrontend {
     showSection(sectionId) {
         document.querySelectorAll('.content-section').forEach(s => s.classList.remove('active'));
         document.querySelectorAll('.nav-item').forEach(n => n.classList.remove('active'));
-        
+
         document.getElementById(sectionId).classList.add('active');
         document.querySelector(`[data-section="${sectionId}"]`).classList.add('active');
-        
+
         this.updateSectionContent(sectionId);
     }
 
@@ -87,16 +95,36 @@ class MTBSFrontend {
         switch(sectionId) {
             case 'dashboard': this.updateDashboard(); break;
             case 'accounts': this.updateAccountsList(); break;
-            case 'transactions': this.updateTransactionHistory(); break;
-            case 'threads': this.updateThreadMonitor(); break;
-            case 'performance': this.updatePerformanceMetrics(); break;
+            case 'transactions': this.loadTransactions(); break;
+            case 'threads': this.loadStatus().then(() => this.updateThreadMonitor()); break;
+            case 'performance': this.loadStatus().then(() => this.updatePerformanceMetrics()); break;
+        }
+    }
+
+    // Server API: resolves to the decoded JSON body, rejects with the server's error message
+    async api(method, path, body) {
+        const options = { method, headers: {} };
+        if (body !== undefined) {
+            options.headers['Content-Type'] = 'application/json';
+            options.body = JSON.stringify(body);
         }
+        let response;
+        try {
+            response = await fetch(API_BASE + path, options);
+        } catch (e) {
+            throw new Error('The bank server is not reachable');
+        }
+        const data = await response.json().catch(() => ({}));
+        if (!response.ok) {
+            throw new Error(data.error || `Request failed (${response.status})`);
+        }
+        return data;
     }
 
-    createAccount() {
+    async createAccount() {
         const form = document.getElementById('create-account-form');
         const formData = new FormData(form);
-        
+
         const holderName = formData.get('holderName');
         const initialBalance = parseFloat(formData.get('initialBalance')) || 0;
 
@@ -105,126 +133,74 @@ class MTBSFrontend {
             return;
         }
 
-        const accountNumber = 'ACC' + Date.now().toString().slice(-6);
-        const account = {
-            accountNumber,
-            holderName,
-            balance: initialBalance,
-            status: 'ACTIVE',
-            createdAt: new Date(),
-            transactions: []
-        };
-
-        this.accounts.push(account);
-
-        if (initialBalance > 0) {
-            const transaction = {
-                id: 'TXN_' + Date.now(),
-                type: 'DEPOSIT',
-                amount: initialBalance,
-                description: 'Initial deposit',
-                status: 'SUCCESS',
-                timestamp: new Date(),
-                fromAccount: '',
-                toAccount: accountNumber
-            };
-            account.transactions.push(transaction);
-            this.transactions.push(transaction);
+        try {
+            const account = await this.api('POST', '/api/accounts', { holderName, initialBalance });
+            this.mergeAccounts([account]);
+            this.updateAccountsList();
+            this.updateDashboard();
+            this.showModal('Success', `Account created! Number: ${account.accountNumber}`);
+            form.reset();
+        } catch (e) {
+            this.showModal('Error', e.message);
         }
+    }
 
-        this.updateAccountsList();
-        this.updateDashboard();
-        this.showModal('Success', `Account created! Number: ${accountNumber}`);
-        form.reset();
+    // Deposits, withdrawals and transfers go to the engine's transaction pipeline;
+    // their balances come back with the next server push
+    async submitOperation(path, request, successMessage) {
+        try {
+            const result = await this.api('POST', path, request);
+            if (!result.success) {
+                this.showModal('Error', result.message);
+                return false;
+            }
+            this.showModal('Success', successMessage);
+            if (document.getElementById('transactions').classList.contains('active')) {
+                this.loadTransactions();
+            }
+            return true;
+        } catch (e) {
+            this.showModal('Error', e.message);
+            return false;
+        }
     }
 
-    processDeposit() {
+    async processDeposit() {
         const form = document.getElementById('deposit-form');
         const formData = new FormData(form);
-        
+
         const accountNumber = formData.get('accountNumber');
         const amount = parseFloat(formData.get('amount'));
         const description = formData.get('description') || 'Deposit';
 
         if (!this.validateTransaction(accountNumber, amount)) return;
 
-        const account = this.accounts.find(acc => acc.accountNumber === accountNumber);
-        if (!account) {
-            this.showModal('Error', 'Account not found');
-            return;
+        if (await this.submitOperation('/api/deposit', { accountNumber, amount, description },
+                                       `Deposit of $${amount.toFixed(2)} processed`)) {
+            form.reset();
         }
-
-        account.balance += amount;
-        
-        const transaction = {
-            id: 'TXN_' + Date.now(),
-            type: 'DEPOSIT',
-            amount: amount,
-            description: description,
-            status: 'SUCCESS',
-            timestamp: new Date(),
-            fromAccount: '',
-            toAccount: accountNumber
-        };
-
-        account.transactions.push(transaction);
-        this.transactions.push(transaction);
-
-        this.updateAccountsList();
-        this.updateTransactionHistory();
-        this.updateDashboard();
-        this.showModal('Success', `Deposit of $${amount.toFixed(2)} processed`);
-        form.reset();
     }
 
-    processWithdraw() {
+    async processWithdraw() {
         const form = document.getElementById('withdraw-form');
         const formData = new FormData(form);
-        
+
         const accountNumber = formData.get('accountNumber');
         const amount = parseFloat(formData.get('amount'));
         const description = formData.get('description') || 'Withdrawal';
 
         if (!this.validateTransaction(accountNumber, amount)) return;
 
-        const account = this.accounts.find(acc => acc.accountNumber === accountNumber);
-        if (!account) {
-            this.showModal('Error', 'Account not found');
-            return;
+        if (await this.submitOperation('/api/withdraw', { accountNumber, amount, description },
+                                       `Withdrawal of $${amount.toFixed(2)} processed`)) {
+            form.reset();
         }
-
-        if (account.balance < amount) {
-            this.showModal('Error', 'Insufficient funds');
-            return;
-        }
-
-        account.balance -= amount;
-        
-        const transaction = {
-            id: 'TXN_' + Date.now(),
-            type: 'WITHDRAW',
-            amount: amount,
-            description: description,
-            status: 'SUCCESS',
-            timestamp: new Date(),
-            fromAccount: accountNumber,
-            toAccount: ''
-        };
-
-        account.transactions.push(transaction);
-        this.transactions.push(transaction);
-
-        this.updateAccountsList();
-        this.updateTransactionHistory();
-        this.updateDashboard();
-        this.showModal('Success', `Withdrawal of $${amount.toFixed(2)} processed`);
-        form.reset();
     }
 
-    processTransfer() {
+    async processTransfer() {
         const form = document.getElementById('transfer-form');
         const formData = new FormData(form);
-        
+
         const fromAccount = formData.get('fromAccount');
         const toAccount = formData.get('toAccount');
         const amount = parseFloat(formData.get('amount'));
@@ -237,55 +213,10 @@ class MTBSFrontend {
             return;
         }
 
-        const fromAcc = this.accounts.find(acc => acc.accountNumber === fromAccount);
-        const toAcc = this.accounts.find(acc => acc.accountNumber === toAccount);
-
-        if (!fromAcc || !toAcc) {
-            this.showModal('Error', 'One or both accounts not found');
-            return;
+        if (await this.submitOperation('/api/transfer', { fromAccount, toAccount, amount, description },
+                                       `Transfer of $${amount.toFixed(2)} completed`)) {
+            form.reset();
         }
-
-        if (fromAcc.balance < amount) {
-            this.showModal('Error', 'Insufficient funds');
-            return;
-        }
-
-        fromAcc.balance -= amount;
-        toAcc.balance += amount;
-        
-        const transactionId = 'TXN_' + Date.now();
-        
-        const outgoingTransaction = {
-            id: transactionId + '_OUT',
-            type: 'TRANSFER',
-            amount: amount,
-            description: description,
-            status: 'SUCCESS',
-            timestamp: new Date(),
-            fromAccount: fromAccount,
-            toAccount: toAccount
-        };
-
-        const incomingTransaction = {
-            id: transactionId + '_IN',
-            type: 'TRANSFER',
-            amount: amount,
-            description: description,
-            status: 'SUCCESS',
-            timestamp: new Date(),
-            fromAccount: fromAccount,
-            toAccount: toAccount
-        };
-
-        fromAcc.transactions.push(outgoingTransaction);
-        toAcc.transactions.push(incomingTransaction);
-        this.transactions.push(outgoingTransaction);
-
-        this.updateAccountsList();
-        this.updateTransactionHistory();
-        this.updateDashboard();
-        this.showModal('Success', `Transfer of $${amount.toFixed(2)} completed`);
-        form.reset();
     }
 
     validateTransaction(accountNumber, amount) {
@@ -301,31 +232,22 @@ class MTBSFrontend {
     }
 
     updateDashboard() {
-        document.getElementById('total-accounts').textContent = this.accounts.length;
-        document.getElementById('total-transactions').textContent = this.transactions.length;
-        document.getElementById('active-threads').textContent = Math.floor(Math.random() * 10) + 5;
-        document.getElementById('queue-size').textContent = Math.floor(Math.random() * 20);
-        this.updateActivityFeed();
+        const threads = this.status ? this.status.threads : null;
+        document.getElementById('total-accounts').textContent = this.stats ? this.stats.accounts : this.accounts.length;
+        document.getElementById('total-transactions').textContent = this.stats ? this.stats.transactions : 0;
+        document.getElementById('active-threads').textContent = threads ? threads.active : 0;
+        document.getElementById('queue-size').textContent = threads ? threads.queued + threads.pipeline_in_flight : 0;
     }
 
-    updateActivityFeed() {
+    addActivity(message) {
         const feedContainer = document.getElementById('activity-feed');
-        const activities = [
-            'Account created successfully',
-            'Deposit processed',
-            'Withdrawal completed',
-            'Transfer executed',
-            'System backup completed'
-        ];
-
-        const randomActivity = activities[Math.floor(Math.random() * activities.length)];
         const timestamp = new Date().toLocaleTimeString();
 
         const feedItem = document.createElement('div');
         feedItem.className = 'feed-item fade-in';
         feedItem.innerHTML = `
             <i class="fas fa-info-circle"></i>
-            <span>${randomActivity}</span>
+            <span>${this.escapeHtml(message)}</span>
             <small class="timestamp">${timestamp}</small>
         `;
 
@@ -344,6 +266,7 @@ class MTBSFrontend {
             document.getElementById('transfer-from'),
             document.getElementById('transfer-to')
         ];
+        const selected = accountSelects.map(select => select.value);
 
         accountsGrid.innerHTML = '';
         accountSelects.forEach(select => {
@@ -361,6 +284,7 @@ class MTBSFrontend {
                 select.appendChild(option);
             });
         });
+        accountSelects.forEach((select, i) => { select.value = selected[i]; });
     }
 
     createAccountCard(account) {
@@ -368,31 +292,38 @@ class MTBSFrontend {
         card.className = 'account-card fade-in';
         card.innerHTML = `
             <div class="account-header">
-                <span class="account-number">${account.accountNumber}</span>
+                <span class="account-number">${this.escapeHtml(account.accountNumber)}</span>
                 <span class="account-status ${account.status.toLowerCase()}">${account.status}</span>
             </div>
             <div class="account-details">
-                <p><strong>Holder:</strong> ${account.holderName}</p>
-                <p><strong>Created:</strong> ${account.createdAt.toLocaleDateString()}</p>
-                <p><strong>Transactions:</strong> ${account.transactions.length}</p>
+                <p><strong>Holder:</strong> ${this.escapeHtml(account.holderName)}</p>
+                <p><strong>Created:</strong> ${new Date(account.createdAt).toLocaleDateString()}</p>
+                <p><strong>Transactions:</strong> ${account.transactionCount}</p>
             </div>
             <div class="account-balance">$${account.balance.toFixed(2)}</div>
         `;
         return card;
     }
 
+    async loadTransactions() {
+        try {
+            this.transactions = await this.api('GET', '/api/transactions?limit=20');
+        } catch (e) {
+            this.transactions = [];
+        }
+        this.updateTransactionHistory();
+    }
+
     updateTransactionHistory() {
         const historyContainer = document.getElementById('transaction-history');
         historyContainer.innerHTML = '';
 
-        const recentTransactions = this.transactions.slice(-20).reverse();
-        
-        recentTransactions.forEach(transaction => {
+        this.transactions.forEach(transaction => {
             const transactionItem = this.createTransactionItem(transaction);
             historyContainer.appendChild(transactionItem);
         });
 
-        if (recentTransactions.length === 0) {
+        if (this.transactions.length === 0) {
             historyContainer.innerHTML = '<p class="text-center text-muted">No transactions yet</p>';
         }
     }
@@ -400,15 +331,16 @@ class MTBSFrontend {
     createTransactionItem(transaction) {
         const item = document.createElement('div');
         item.className = 'transaction-item fade-in';
-        
-        const iconClass = transaction.type === 'DEPOSIT' ? 'deposit' : 
+
+        const iconClass = transaction.type === 'DEPOSIT' ? 'deposit' :
                          transaction.type === 'WITHDRAW' ? 'withdraw' : 'transfer';
-        
+
         const amountClass = transaction.type === 'WITHDRAW' ? 'negative' : '';
-        
+        const status = transaction.status === 'SUCCESS' ? 'SUCCESS' : 'FAILED';
+
         item.innerHTML = `
             <div class="transaction-icon ${iconClass}">
-                <i class="fas fa-${transaction.type === 'DEPOSIT' ? 'arrow-down' : 
+                <i class="fas fa-${transaction.type === 'DEPOSIT' ? 'arrow-down' :
                                    transaction.type === 'WITHDRAW' ? 'arrow-up' : 'exchange-alt'}"></i>
             </div>
             <div class="transaction-details">
@@ -416,17 +348,26 @@ class MTBSFrontend {
                 <div class="transaction-amount ${amountClass}">$${transaction.amount.toFixed(2)}</div>
             </div>
             <div class="transaction-meta">
-                <div class="transaction-status ${transaction.status.toLowerCase()}">${transaction.status}</div>
-                <div class="transaction-time">${transaction.timestamp.toLocaleTimeString()}</div>
+                <div class="transaction-status ${status.toLowerCase()}">${transaction.status}</div>
+                <div class="transaction-time">${new Date(transaction.timestamp).toLocaleTimeString()}</div>
             </div>
         `;
-        
+
         return item;
     }
 
+    async loadStatus() {
+        try {
+            this.status = await this.api('GET', '/api/status');
+        } catch (e) {
+            // Keep the last known status
+        }
+    }
+
     updateThreadMonitor() {
-        const totalThreads = Math.floor(Math.random() * 20) + 10;
-        const runningThreads = Math.floor(Math.random() * totalThreads);
+        const threads = this.status ? this.status.threads : { workers: 0, active: 0 };
+        const totalThreads = threads.workers;
+        const runningThreads = Math.min(threads.active, totalThreads);
         const idleThreads = totalThreads - runningThreads;
 
         document.getElementById('total-threads').textContent = totalThreads;
@@ -440,10 +381,10 @@ class MTBSFrontend {
         const threadContainer = document.getElementById('thread-container');
         threadContainer.innerHTML = '';
 
+        // The pool reports how many workers are busy, not which ones
         for (let i = 0; i < totalThreads; i++) {
-            const threadId = `THREAD_${i.toString().padStart(3, '0')}`;
+            const threadId = `WORKER_${i.toString().padStart(3, '0')}`;
             const status = i < runningThreads ? 'running' : 'idle';
-            const startTime = new Date(Date.now() - Math.random() * 300000);
 
             const threadItem = document.createElement('div');
             threadItem.className = 'thread-item fade-in';
@@ -453,82 +394,57 @@ class MTBSFrontend {
                     <span class="thread-status ${status}">${status.toUpperCase()}</span>
                 </div>
                 <div class="thread-meta">
-                    <small>Started: ${startTime.toLocaleTimeString()}</small>
+                    <small>Thread pool worker</small>
                 </div>
             `;
-            
+
             threadContainer.appendChild(threadItem);
         }
     }
 
     updatePerformanceMetrics() {
-        const successfulTransactions = this.transactions.filter(t => t.status === 'SUCCESS').length;
-        const totalTransactions = this.transactions.length;
-        const successRate = totalTransactions > 0 ? (successfulTransactions / totalTransactions * 100).toFixed(1) : 0;
+        const stats = this.stats || { transactions: 0, successful: 0 };
+        const successRate = stats.transactions > 0 ? (stats.successful / stats.transactions * 100).toFixed(1) : 0;
+        const latency = this.status ? this.status.latency : null;
+        const deposit = latency && latency.deposit ? latency.deposit : null;
 
         document.getElementById('success-rate').textContent = `${successRate}%`;
-        document.getElementById('avg-response-time').textContent = `${Math.floor(Math.random() * 100) + 50}ms`;
-        document.getElementById('throughput').textContent = `${Math.floor(Math.random() * 50) + 10} txn/sec`;
+        document.getElementById('avg-response-time').textContent =
+            deposit && deposit.count > 0 ? `${(deposit.mean_ns / 1e6).toFixed(3)}ms` : '0ms';
+        document.getElementById('throughput').textContent =
+            `${this.throughput !== undefined ? this.throughput.toFixed(0) : 0} txn/sec`;
     }
 
-    generateSampleData() {
-        const sampleNames = [
-            'John Smith', 'Jane Doe', 'Bob Johnson', 'Alice Brown', 'Charlie Wilson'
-        ];
-
-        for (let i = 0; i < 5; i++) {
-            const name = sampleNames[i] + ' ' + (i + 1);
-            const balance = Math.floor(Math.random() * 10000) + 100;
-            
-            const accountNumber = 'ACC' + Date.now().toString().slice(-6) + i;
-            const account = {
-                accountNumber,
-                holderName: name,
-                balance: balance,
-                status: 'ACTIVE',
-                createdAt: new Date(),
-                transactions: []
-            };
-
-            if (balance > 0) {
-                const transaction = {
-                    id: 'TXN_' + Date.now() + i,
-                    type: 'DEPOSIT',
-                    amount: balance,
-                    description: 'Initial deposit',
-                    status: 'SUCCESS',
-                    timestamp: new Date(),
-                    fromAccount: '',
-                    toAccount: accountNumber
-                };
-                account.transactions.push(transaction);
-                this.transactions.push(transaction);
-            }
-
-            this.accounts.push(account);
+    async generateSampleData() {
+        try {
+            const result = await this.api('POST', '/api/sample-data', { count: 5 });
+            this.showModal('Success', `Generated ${result.created} sample accounts`);
+        } catch (e) {
+            this.showModal('Error', e.message);
         }
-
-        this.updateAccountsList();
-        this.updateDashboard();
-        this.showModal('Success', 'Generated 5 sample accounts');
     }
 
-    clearAllData() {
+    async clearAllData() {
         if (confirm('Are you sure you want to clear all data? This action cannot be undone.')) {
-            this.accounts = [];
-            this.transactions = [];
-            
-            this.updateAccountsList();
-            this.updateTransactionHistory();
-            this.updateDashboard();
-            
-            this.showModal('Success', 'All data has been cleared');
+            try {
+                await this.api('POST', '/api/clear');
+                this.accounts = [];
+                this.transactions = [];
+
+                this.updateAccountsList();
+                this.updateTransactionHistory();
+                this.updateDashboard();
+
+                this.showModal('Success', 'All data has been cleared');
+            } catch (e) {
+                this.showModal('Error', e.message);
+            }
         }
     }
 
     showModal(title, content) {
         document.getElementById('modal-title').textContent = title;
-        document.getElementById('modal-body').innerHTML = content;
+        document.getElementById('modal-body').textContent = content;
         document.getElementById('modal-overlay').classList.add('active');
     }
 
@@ -536,50 +452,86 @@ class MTBSFrontend {
         document.getElementById('modal-overlay').classList.remove('active');
     }
 
+    escapeHtml(text) {
+        const span = document.createElement('span');
+        span.textContent = text;
+        return span.innerHTML;
+    }
+
+    mergeAccounts(accounts) {
+        accounts.forEach(account => {
+            const index = this.accounts.findIndex(acc => acc.accountNumber === account.accountNumber);
+            if (index >= 0) {
+                this.accounts[index] = account;
+            } else {
+                this.accounts.push(account);
+            }
+        });
+    }
+
+    applyStats(stats) {
+        const now = Date.now();
+        if (this.lastThroughputSample) {
+            const seconds = (now - this.lastThroughputSample.time) / 1000;
+            if (seconds > 0) {
+                this.throughput = (stats.transactions - this.lastThroughputSample.transactions) / seconds;
+            }
+        }
+        this.lastThroughputSample = { time: now, transactions: stats.transactions };
+        this.stats = stats;
+    }
+
+    // Server push (/api/events): a snapshot on connect, then balance deltas as they happen
     startRealTimeUpdates() {
-        setInterval(() => {
+        this.events = new EventSource(API_BASE + '/api/events');
+
+        this.events.addEventListener('snapshot', (e) => {
+            const data = JSON.parse(e.data);
+            this.accounts = data.accounts;
+            this.applyStats(data.stats);
+            this.updateAccountsList();
             this.updateDashboard();
+            this.addActivity('Connected to the bank engine');
+        });
+
+        this.events.addEventListener('balances', (e) => {
+            const data = JSON.parse(e.data);
+            this.mergeAccounts(data.opened);
+            data.opened.forEach(account => this.addActivity(`Account ${account.accountNumber} opened`));
+            data.changed.forEach(change => {
+                const account = this.accounts.find(acc => acc.accountNumber === change.accountNumber);
+                if (account) {
+                    const delta = change.balance - account.balance;
+                    account.balance = change.balance;
+                    this.addActivity(`${change.accountNumber}: ${delta >= 0 ? '+' : '-'}$${Math.abs(delta).toFixed(2)}`);
+                }
+            });
+            if (data.closed.length > 0) {
+                this.accounts = this.accounts.filter(acc => !data.closed.includes(acc.accountNumber));
+                data.closed.forEach(number => this.addActivity(`Account ${number} closed`));
+            }
+            this.applyStats(data.stats);
             this.updateAccountsList();
-            this.updateTransactionHistory();
-        }, 10000);
+            this.updateDashboard();
+            if (document.getElementById('performance').classList.contains('active')) {
+                this.updatePerformanceMetrics();
+            }
+        });
+
+        this.events.onerror = () => {
+            // EventSource reconnects by itself, and the server opens each connection with a snapshot
+            this.addActivity('Connection to the bank engine lost, retrying...');
+        };
     }
 
     loadInitialData() {
-        const savedAccounts = localStorage.getItem('mtbs_accounts');
-        const savedTransactions = localStorage.getItem('mtbs_transactions');
-        
-        if (savedAccounts) {
-            this.accounts = JSON.parse(savedAccounts);
-            this.accounts.forEach(account => {
-                account.createdAt = new Date(account.createdAt);
-                account.transactions.forEach(txn => {
-                    txn.timestamp = new Date(txn.timestamp);
-                });
-            });
-        }
-        
-        if (savedTransactions) {
-            this.transactions = JSON.parse(savedTransactions);
-            this.transactions.forEach(txn => {
-                txn.timestamp = new Date(txn.timestamp);
-            });
-        }
-
         this.updateAccountsList();
         this.updateTransactionHistory();
-        this.updateDashboard();
+        this.loadStatus().then(() => this.updateDashboard());
     }
 }
 
 // Initialize when DOM is loaded
 document.addEventListener('DOMContentLoaded', () => {
     window.frontend = new MTBSFrontend();
-    
-    // Auto-save data every 30 seconds
-    setInterval(() => {
-        if (window.frontend) {
-            localStorage.setItem('mtbs_accounts', JSON.stringify(window.frontend.accounts));
-            localStorage.setItem('mtbs_transactions', JSON.stringify(window.frontend.transactions));
-        }
-    }, 30000);
 });
@@ -6,53 +6,304 @@
 #include <mutex>
 #include <chrono>
 #include <atomic>
+#include <memory>
+#include <cstdint>
+#include <type_traits>
+#include "money.h"
+#include "string_table.h"
+#include "transaction_history.h"
+#include "mpmc_ring.h"
+#include "account_columns.h"
 
-// Forward declaration
-struct Transaction;
+class Journal;
+
+// Transaction types
+enum class TransactionType : uint8_t {
+    DEPOSIT,
+    WITHDRAW,
+    TRANSFER,
+    BALANCE_CHECK
+};
+
+// Transaction statuses
+enum class TransactionStatus : uint8_t {
+    SUCCESS,
+    FAILED,
+    PENDING,
+    INSUFFICIENT_FUNDS,
+    INVALID_ACCOUNT
+};
+
+// Canonical names ("DEPOSIT", "INSUFFICIENT_FUNDS", ...) used in logs and reports
+const char* transactionTypeName(TransactionType type);
+const char* transactionStatusName(TransactionStatus status);
+
+/**
+ * @brief Transaction record structure
+ * 
+ * Compact, trivially-copyable record of a single banking transaction.
+ * Account numbers and descriptions are stored as StringTable IDs and the
+ * transaction ID as a number; the textual forms are only produced when a
+ * record is displayed or logged.
+ */
+struct Transaction {
+    static constexpr uint32_t kNoAccount = StringTable::kNoString;
+    static constexpr uint8_t FLAG_INITIAL_DEPOSIT = 0x01;
+    static constexpr uint8_t FLAG_BATCH = 0x02;         // Leg of an Account::transferBatch (legs share the ID)
+    static constexpr uint8_t FLAG_BATCH_LAST = 0x04;    // Last leg; a batch without it is incomplete
+    static constexpr size_t kMaxDescriptions = size_t(1) << 16; // Distinct caller descriptions kept
+
+    uint64_t id;                                    // Unique transaction number (IdGenerator)
+    Money amount;                                   // Transaction amount
+    std::chrono::system_clock::time_point timestamp; // When transaction occurred
+    uint32_t fromAccount;                           // Source account (StringTable::accountNumbers ID)
+    uint32_t toAccount;                             // Destination account (StringTable::accountNumbers ID)
+    uint32_t description;                           // Description (StringTable::descriptions ID)
+    TransactionType type;                           // DEPOSIT, WITHDRAW, TRANSFER, BALANCE_CHECK
+    TransactionStatus status;                       // SUCCESS, FAILED, PENDING, ...
+    uint8_t flags;                                  // FLAG_* bits
+    
+    // Constructors
+    Transaction() = default;
+    Transaction(uint64_t transactionNumber, uint32_t from, uint32_t to,
+                TransactionType t, Money amt, uint32_t desc, uint8_t flagBits = 0);
+    
+    // ID for caller-supplied description text. System descriptions intern directly; caller text
+    // stops being added once kMaxDescriptions are known and is then recorded without one
+    static uint32_t internDescription(const std::string& text);
+    
+    // Resolved views of the compact fields
+    std::string getTransactionId() const;
+    const std::string& getFromAccount() const;
+    const std::string& getToAccount() const;
+    const std::string& getDescription() const;
+    
+    // Utility methods
+    std::string toString() const;
+    std::string getFormattedTimestamp() const;
+    bool isSuccessful() const;
+};
+
+static_assert(std::is_trivially_copyable<Transaction>::value, "Transaction must stay trivially copyable");
+static_assert(sizeof(Transaction) <= 64, "Transaction must fit in one cache line");
 
 /**
  * @brief Represents a bank account with thread-safe operations
  * 
  * This class demonstrates critical section protection using mutex locks.
  * All balance modifications are protected to prevent race conditions.
+ * 
+ * Readers never take the lock. The identity fields are immutable after
+ * construction, and the balance is an atomic that writers store (with
+ * release ordering) while still holding accountMutex, so getBalance()
+ * returns the balance as of some completed operation without ever
+ * waiting for, or slowing down, a deposit in progress.
+ * 
+ * Hot accounts can opt in to a fast path (setFastPath) where deposits and
+ * withdrawals skip the lock altogether, and further split the balance into
+ * per-thread stripes (setStriped) so concurrent credits do not even share
+ * a cache line; see FastPathState below. An account whose lock is contended
+ * more than the stripe threshold allows is switched to stripes automatically.
+ * 
+ * The balance itself lives in the account's AccountColumns slot, next to
+ * its terms and flags, so bulk jobs can work through all balances as
+ * arrays; see AccountColumns for the barrier they run under.
  */
 class Account {
 private:
-    std::string accountNumber;      // Unique account identifier
-    std::string accountHolderName;  // Name of account holder
-    double balance;                 // Current account balance
-    std::vector<Transaction> transactionHistory; // Transaction log
+    const std::string accountNumber;      // Unique account identifier
+    const std::string accountHolderName;  // Name of account holder
+    const uint32_t accountIndex;          // Dense numeric ID (StringTable::accountNumbers)
+    AccountColumns::Lease slot;           // Column slot holding the balance, terms and flags
+    std::atomic<Money>& balance;          // Current account balance (in slot); written under accountMutex only
+    TransactionHistory transactionHistory; // Transaction log (lock-free, bounded)
+    Journal* journal;               // Write-ahead journal, or nullptr (not owned)
+    uint64_t lastJournalLsn;        // LSN of the last journal record for this account
     
     // Mutex for protecting shared resources (CRITICAL SECTION)
     mutable std::mutex accountMutex;
     
     // Timestamp for account creation
-    std::chrono::system_clock::time_point createdAt;
+    const std::chrono::system_clock::time_point createdAt;
+    
+    // Fast-path deposits and withdrawals: the balance is changed with a CAS
+    // (the overdraft check is inside the loop) and the finished record is
+    // queued. Whoever next holds accountMutex records and journals queued
+    // records, tracking journaledBalance, so journal balances stay consistent
+    // with LSN order. Locked writers raise the writer flag and wait for
+    // in-flight fast operations, which then have the account to themselves.
+    // 
+    // Each thread works in one stripe (its own in-flight count and queue, and
+    // when striped, its own credit balance), so fast operations from different
+    // threads touch different cache lines. Striped credits add to the stripe;
+    // debits take from the thread's stripe, then the base balance, and only
+    // when both run short fall back to the locked path, which first folds
+    // every stripe into the base balance.
+    static constexpr size_t kFastPathStripes = 8;
+    
+    struct alignas(64) Stripe {
+        Stripe() : inFlight(0), pending(0), credits(Money()), records(kStripeQueueCapacity) {}
+        
+        static constexpr size_t kStripeQueueCapacity = 1024;
+        std::atomic<uint32_t> inFlight;             // Fast operations in this stripe
+        std::atomic<uint32_t> pending;              // Queued (or being queued), not yet drained
+        std::atomic<Money> credits;                 // Striped mode: this stripe's share of the balance
+        MpmcRing<Transaction> records;
+    };
+    
+    struct FastPathState {
+        FastPathState() : enabled(false), striped(false), writer(false) {}
+        
+        std::atomic<bool> enabled;
+        std::atomic<bool> striped;
+        alignas(64) std::atomic<bool> writer;       // A locked writer holds (or is taking) the account
+        Money journaledBalance;                     // Balance after the last journalled record (under accountMutex)
+        Stripe stripes[kFastPathStripes];
+    };
+    std::atomic<FastPathState*> fastPath;           // Allocated on first setFastPath(true), owned
+    
+    // Contended lock acquisitions in the current one-second window (auto-striping)
+    std::atomic<uint32_t> contendedLocks;
+    std::atomic<uint32_t> contentionWindowMs;
 
 public:
-    // Constructor and destructor
-    Account(const std::string& number, const std::string& holderName, double initialBalance = 0.0);
-    ~Account() = default;
+    // Constructor and destructor; the balance goes in a slot of columns (AccountColumns::standalone()
+    // when null), which should be the store of the Bank the account belongs to
+    Account(const std::string& number, const std::string& holderName, Money initialBalance = Money(),
+            std::shared_ptr<AccountColumns> columns = nullptr);
+    
+    // Allocates the account from a SlabPool (and its control block from another): accounts
+    // created by one thread sit side by side, so directory-wide scans walk dense memory. The
+    // last reference retires the account through the EpochReclaimer rather than freeing it,
+    // so an AccountColumns::View taken before it was closed can still read it
+    static std::shared_ptr<Account> create(const std::string& number, const std::string& holderName, 
+                                           Money initialBalance = Money(), 
+                                           std::shared_ptr<AccountColumns> columns = nullptr);
+    ~Account();
     
     // Copy constructor and assignment operator (disabled for thread safety)
     Account(const Account&) = delete;
     Account& operator=(const Account&) = delete;
     
-    // Getters (const methods, use shared_lock for better performance)
-    std::string getAccountNumber() const;
-    std::string getAccountHolderName() const;
-    double getBalance() const;
+    // Getters (lock-free: immutable fields and an atomic balance)
+    const std::string& getAccountNumber() const;
+    const std::string& getAccountHolderName() const;
+    uint32_t getAccountIndex() const;
+    Money getBalance() const;
     std::vector<Transaction> getTransactionHistory() const;
+    std::vector<Transaction> getTransactionHistory(size_t offset, size_t limit) const;
+    const TransactionHistory& getHistory() const;
     std::chrono::system_clock::time_point getCreatedAt() const;
     
-    // Thread-safe balance operations (CRITICAL SECTIONS)
-    bool deposit(double amount, const std::string& description = "");
-    bool withdraw(double amount, const std::string& description = "");
-    bool transfer(Account& targetAccount, double amount, const std::string& description = "");
+    // Thread-safe balance operations (CRITICAL SECTIONS); recorded receives the history entry. A
+    // credit that would overflow is rejected (false, nothing recorded); transfer reports it
+    // through recorded as FAILED
+    bool deposit(Money amount, const std::string& description = "", Transaction* recorded = nullptr);
+    bool withdraw(Money amount, const std::string& description = "", Transaction* recorded = nullptr);
+    bool transfer(Account& targetAccount, Money amount, const std::string& description = "",
+                  Transaction* recorded = nullptr);
+    
+    // One deposit or withdrawal in a batch passed to applyPostings
+    struct Posting {
+        TransactionType type;   // DEPOSIT or WITHDRAW
+        Money amount;
+        uint32_t description;   // StringTable::descriptions ID
+    };
+    
+    // Outcome of one posting: the recorded transaction and the balance right after it
+    struct PostingResult {
+        Transaction record;
+        Money balanceAfter;
+    };
     
-    // Transaction history management
+    // Applies postings in order under a single lock acquisition; returns how many succeeded
+    size_t applyPostings(const Posting* postings, size_t count, PostingResult* results);
+    
+    // One leg of a multi-account transfer
+    struct TransferLeg {
+        Account* from;
+        Account* to;
+        Money amount;
+    };
+    
+    // Outcome of transferBatch; failedLeg is only meaningful when status is not SUCCESS
+    struct BatchResult {
+        TransactionStatus status;
+        size_t failedLeg;
+        uint64_t transactionId;     // Shared by every leg, 0 when nothing was recorded
+    };
+    
+    // Applies every leg, in order, as one atomic unit, or none of them. Each
+    // distinct account is locked once, in canonical order (accountIndex), so
+    // concurrent batches and transfers cannot deadlock and never retry. All
+    // legs are checked before anything changes: a leg that would overdraw its
+    // source (counting the earlier legs), overflow, or is not a positive
+    // amount between two different accounts fails the batch, and a failed
+    // batch records nothing. On success each leg is recorded and journalled
+    // as a TRANSFER flagged FLAG_BATCH, the last one also FLAG_BATCH_LAST,
+    // and each account's balance is published once, at the end.
+    static BatchResult transferBatch(const TransferLeg* legs, size_t count, uint32_t description);
+    
+    // Transaction history management (lock-free, does not take accountMutex)
     void addTransaction(const Transaction& transaction);
     void clearTransactionHistory();
+    void setHistorySpillHandler(TransactionHistory::SpillHandler handler);
+    
+    // Every recorded transaction is also appended to the journal, inside the
+    // critical section. Attach before the account is shared between threads;
+    // lastLsn is the LSN of the record that opened (or last restored) it.
+    void attachJournal(Journal* journal, uint64_t lastLsn = 0);
+    
+    // Balance and journal position read together, for snapshots (takes accountMutex)
+    struct State {
+        Money balance;
+        uint64_t lastLsn;
+    };
+    State getState() const;
+    State getState(std::vector<Transaction>& history) const;   // ...and the history they reflect (replication)
+    
+    // Recovery only: sets the balance from a snapshot or journal record without recording anything
+    void restoreState(Money balance, uint64_t lastLsn);
+    
+    // Opt-in lock-free deposits and withdrawals for hot accounts (transfers, batches and
+    // postings keep the lock). Their records reach the history and journal shortly after
+    // the call returns, so they are not yet durable when it does; flushPending (called by
+    // snapshots and before closing) and every locked operation catch up first
+    void setFastPath(bool enabled);
+    bool isFastPath() const;
+    void flushPending();
+    
+    // Striped balance on top of the fast path (enabling stripes enables the fast path;
+    // disabling the fast path disables stripes). While striped, getBalance sums the
+    // stripes, so under concurrent updates it may combine stripes read at slightly
+    // different moments; it is exact whenever the account is quiet
+    void setStriped(bool enabled);
+    bool isStriped() const;
+    
+    // Process-wide: an account switches to stripes once this many lock acquisitions
+    // within one second had to wait (0, the default, turns automatic striping off)
+    static void setStripeThreshold(uint32_t contendedPerSecond);
+    static uint32_t getStripeThreshold();
+    
+    // Terms used by bulk jobs (AccountColumns): minimum balance before low-balance fees,
+    // and whether interest and fees apply at all. Not journalled: runtime configuration
+    struct Terms {
+        Money minimumBalance;
+        bool earnsInterest = true;
+        bool chargedFees = true;
+    };
+    void setTerms(const Terms& terms);
+    Terms getTerms() const;
+    
+    // Set by AccountDirectory while it holds the account; bulk jobs and views skip unlisted accounts
+    void setListed(bool listed);
+    
+    // Bulk jobs only, while the caller holds the store's AccountColumns::Barrier. settleForBulk
+    // folds stripes and drains queued fast-path records, so the column holds the whole balance;
+    // postBulk applies a deposit or withdrawal computed from the columns without taking
+    // accountMutex, recording and journalling it as usual (false, and nothing done, on overflow)
+    void settleForBulk();
+    bool postBulk(TransactionType type, Money amount, uint32_t description);
     
     // Account status
     bool isActive() const;
@@ -61,53 +312,61 @@ public:
     // Utility methods
     std::string toString() const;
     void printDetails() const;
-};
 
-/**
- * @brief Transaction record structure
- * 
- * Immutable structure representing a single banking transaction.
- * Once created, transaction details cannot be modified.
- */
-struct Transaction {
-    const std::string transactionId;        // Unique transaction identifier
-    const std::string fromAccount;          // Source account number
-    const std::string toAccount;            // Destination account number
-    const std::string type;                 // Transaction type (DEPOSIT, WITHDRAW, TRANSFER)
-    const double amount;                    // Transaction amount
-    const std::string description;          // Transaction description
-    const std::chrono::system_clock::time_point timestamp; // When transaction occurred
-    mutable std::string status;             // Transaction status (SUCCESS, FAILED, PENDING)
-    
-    // Static counter for generating unique transaction IDs
-    static std::atomic<unsigned long long> transactionCounter;
-    
-    // Constructor
-    Transaction(const std::string& id, const std::string& from, const std::string& to,
-                const std::string& t, double amt, const std::string& desc);
+private:
+    // Canonical lock order: accountIndex, then address (only equal for duplicate numbers during recovery)
+    static bool lockOrderBefore(const Account* a, const Account* b);
     
-    // Utility methods
-    std::string toString() const;
-    std::string getFormattedTimestamp() const;
-    bool isSuccessful() const;
+    // Holds accountMutex for a writer (keeping the account's values for a pending view); on a
+    // fast-path account it also excludes fast operations and drains their records, so the
+    // balance can be written directly
+    class WriteLock {
+    public:
+        explicit WriteLock(Account& account);
+        WriteLock(WriteLock&& other) noexcept;
+        ~WriteLock();
+        WriteLock(const WriteLock&) = delete;
+        WriteLock& operator=(const WriteLock&) = delete;
+        WriteLock& operator=(WriteLock&&) = delete;
+    private:
+        AccountColumns::WriterGuard guard;  // Entered before the mutex, released after everything else
+        Account* account;
+        bool gated;
+        bool promote;       // Contention crossed the stripe threshold: switch after unlocking
+    };
+    
+    // Fast path pieces; false from tryFastPosting means "take the locked path"
+    bool tryFastPosting(TransactionType type, Money amount, uint32_t description, bool& succeeded,
+                        Transaction* recorded);
+    size_t drainPendingLocked(FastPathState& fast);
+    size_t drainStripeLocked(FastPathState& fast, Stripe& stripe);
+    void drainIfIdle(FastPathState& fast, Stripe* only = nullptr);
+    bool noteContention();  // True when this acquisition crosses the threshold
+    static size_t threadStripe();
+    
+    // Before the first change after a view's cut: keeps the whole balance for the view
+    // (AccountColumns::Lease::keepForView); the caller holds accountMutex inside a WriterGuard
+    void keepForViewLocked();
+    
+    // Writer-side balance access; the caller holds accountMutex
+    Money balanceLocked() const { return balance.load(std::memory_order_relaxed); }
+    void setBalanceLocked(Money value) { balance.store(value, std::memory_order_release); }
+    
+    // Appends to the history while the caller holds accountMutex, so the
+    // history order matches the order balance changes were applied
+    void recordTransactionLocked(const Transaction& transaction);
+    
+    // Records in this history (and the target's, for a completed transfer)
+    // and journals the change; the caller holds both account locks
+    void publishLocked(const Transaction& transaction, Account* target = nullptr);
+    
+    // Journals the change with the given balances after it and moves both journal
+    // positions; the caller holds both account locks
+    void journalLocked(const Transaction& transaction, Money balanceAfter, 
+                       Account* target, Money targetBalanceAfter);
 };
 
-// Transaction types constants
-namespace TransactionType {
-    const std::string DEPOSIT = "DEPOSIT";
-    const std::string WITHDRAW = "WITHDRAW";
-    const std::string TRANSFER = "TRANSFER";
-    const std::string BALANCE_CHECK = "BALANCE_CHECK";
-}
-
-// Transaction status constants
-namespace TransactionStatus {
-    const std::string SUCCESS = "SUCCESS";
-    const std::string FAILED = "FAILED";
-    const std::string PENDING = "PENDING";
-    const std::string INSUFFICIENT_FUNDS = "INSUFFICIENT_FUNDS";
-    const std::string INVALID_ACCOUNT = "INVALID_ACCOUNT";
-}
+static_assert(std::atomic<Money>::is_always_lock_free, "Account balance reads must not fall back to a lock");
 
 #endif // ACCOUNT_H
 
@@ -0,0 +1,211 @@
+#ifndef ACCOUNT_COLUMNS_H
+#define ACCOUNT_COLUMNS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "epoch_reclaimer.h"
+#include "money.h"
+#include "sharded_counter.h"
+
+class Account;
+
+/**
+ * @brief Column store behind every account's balance, limits and flags
+ *
+ * Each Account owns one slot (a Lease) and keeps its balance in the
+ * balance column rather than in the object itself, so month-end jobs
+ * stream through contiguous arrays of 4096 slots per chunk instead of
+ * chasing one pointer and taking one mutex per account. Chunks are never
+ * freed or moved while the store lives, so a slot's address is stable and
+ * the account keeps a plain reference to it.
+ *
+ * Bulk jobs run under an epoch barrier. Every balance writer (WriteLock,
+ * the fast path) enters a WriterGuard first: a count in the thread's own
+ * slot, so writers on different cores share no line. A Barrier raises a
+ * flag, waits for the counts to drain and then holds the store: new
+ * writers wait at the gate until it is lowered, and slots are neither
+ * leased nor released meanwhile. Readers (getBalance) never wait.
+ *
+ * Views (view()) use the same gate for an instant only: the cut waits for
+ * the writers already inside, starts a new view epoch and lowers the flag,
+ * and writers carry on while the view reads the columns. The first change
+ * to a slot after the cut keeps the slot's old balance and flags for the
+ * view (Lease::keepForView), so the view sees every account as of the cut.
+ */
+class AccountColumns {
+public:
+    static constexpr size_t kChunkSlots = 4096;
+
+    enum Flag : uint8_t {
+        LISTED = 0x01,          // In an AccountDirectory: bulk jobs only touch listed accounts
+        FAST_PATH = 0x02,       // Account::setFastPath: stripes are folded in before a bulk job
+        NO_INTEREST = 0x04,     // Terms: applyInterest skips the account
+        NO_FEES = 0x08          // Terms: applyFees skips the account
+    };
+
+    struct Chunk {
+        std::atomic<Money> balances[kChunkSlots];
+        Money minimumBalances[kChunkSlots];     // Terms; written inside a WriterGuard
+        std::atomic<uint8_t> flags[kChunkSlots];
+        Account* owners[kChunkSlots];           // nullptr for a free slot
+        
+        // Values as of the latest view's cut, for slots changed since (keptEpochs == that view's epoch)
+        std::atomic<uint64_t> keptEpochs[kChunkSlots];
+        std::atomic<Money> keptBalances[kChunkSlots];
+        std::atomic<uint8_t> keptFlags[kChunkSlots];
+    };
+
+    /**
+     * @brief One account's slot; released (and its flags cleared) on destruction
+     */
+    class Lease {
+    public:
+        Lease(std::shared_ptr<AccountColumns> columns, Account* owner);
+        ~Lease();
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        AccountColumns& store() const { return *columns; }
+        std::atomic<Money>& balance() const { return chunk->balances[slot % kChunkSlots]; }
+        Money& minimumBalance() const { return chunk->minimumBalances[slot % kChunkSlots]; }
+        void setFlag(Flag flag, bool set) const;
+        bool hasFlag(Flag flag) const;
+        
+        // True while a view is being read and this slot has not changed since its cut. The
+        // caller, inside a WriterGuard and holding the owner's lock, then keeps the owner's
+        // whole balance (stripes included) for the view before changing the balance or flags
+        bool viewPending() const;
+        void keepForView(Money balance) const;
+
+    private:
+        std::shared_ptr<AccountColumns> columns;
+        Chunk* chunk;
+        size_t slot;                // Store-wide index
+    };
+
+    /**
+     * @brief Entered by every balance writer; waits while a Barrier is up
+     *
+     * Reentrant on one thread, so an operation that locks several accounts
+     * (or a bulk job's own thread) passes straight through. Nested guards
+     * must be released before the outermost one.
+     */
+    class WriterGuard {
+    public:
+        explicit WriterGuard(AccountColumns& columns);
+        WriterGuard(WriterGuard&& other) noexcept;
+        ~WriterGuard();
+        WriterGuard(const WriterGuard&) = delete;
+        WriterGuard& operator=(const WriterGuard&) = delete;
+        WriterGuard& operator=(WriterGuard&&) = delete;
+
+    private:
+        AccountColumns* columns;    // nullptr once moved from
+        size_t slot;
+        bool counted;               // Holds a writer count (not nested)
+        bool outermost;             // Tracks this thread as inside the store
+    };
+
+    /**
+     * @brief Epoch barrier: holds off every writer for the duration of a bulk job
+     *
+     * Throws std::logic_error when the calling thread is itself inside a
+     * WriterGuard on this store (it would wait for itself).
+     */
+    class Barrier {
+    public:
+        explicit Barrier(AccountColumns& columns);
+        ~Barrier();
+        Barrier(const Barrier&) = delete;
+        Barrier& operator=(const Barrier&) = delete;
+
+        // Chunks in use; slots past the high-water mark in the last one are free
+        size_t chunkCount() const { return columns.chunks.size(); }
+        Chunk& chunk(size_t index) const { return *columns.chunks[index]; }
+        size_t slotsIn(size_t index) const;
+
+    private:
+        AccountColumns& columns;
+        std::unique_lock<std::mutex> slotLock;
+    };
+
+    /**
+     * @brief Every listed account and its balance as of one instant
+     *
+     * The accounts are plain pointers, kept alive by the view's Pin rather
+     * than by references: Account::create retires accounts through the
+     * EpochReclaimer. A view held for long therefore delays freeing the
+     * accounts closed meanwhile.
+     */
+    class View {
+    public:
+        struct Entry {
+            const Account* account;
+            Money balance;
+        };
+        
+        View(View&&) = default;
+        View& operator=(View&&) = default;
+        
+        const std::vector<Entry>& entries() const { return list; }
+        size_t size() const { return list.size(); }
+        Money totalBalance() const { return total; }
+
+    private:
+        friend class AccountColumns;
+        View() = default;
+        
+        EpochReclaimer::Pin pin;        // Taken before the cut
+        std::vector<Entry> list;        // Slot order
+        Money total;
+    };
+    
+    // Takes a view: waits for a running bulk job or view and for the writers inside
+    // at the cut, but not for the scan. Throws std::logic_error inside a WriterGuard
+    View view();
+    
+    // The store for accounts created outside a Bank
+    static std::shared_ptr<AccountColumns> standalone();
+
+    AccountColumns() : slotCount(0), barrierUp(false), viewOpen(false), viewEpoch(0) {}
+    AccountColumns(const AccountColumns&) = delete;
+    AccountColumns& operator=(const AccountColumns&) = delete;
+
+    size_t size() const;        // Leased slots
+
+private:
+    struct alignas(64) WriterCount {
+        std::atomic<uint32_t> inside{0};
+    };
+
+    mutable std::mutex slotMutex;               // Chunks, free slots and the high-water mark
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::vector<size_t> freeSlots;
+    size_t slotCount;                           // High-water mark
+
+    WriterCount writers[ShardedCounterSlots::kSlotCount];
+    alignas(64) std::atomic<bool> barrierUp;
+    std::atomic<bool> viewOpen;                 // A view is reading the columns (next to barrierUp: writers check both)
+    std::atomic<uint64_t> viewEpoch;            // The latest view's cut
+    std::mutex barrierMutex;                    // One barrier or view at a time
+    std::mutex gateMutex;                       // Writers sleep here while the barrier is up
+    std::condition_variable gateOpen;
+
+    static thread_local const AccountColumns* guardedStore;
+    static thread_local uint32_t guardDepth;
+
+    Chunk* acquire(Account* owner, size_t& slot);
+    void release(size_t slot);
+    void waitForGate();
+    void raiseBarrier();        // Caller holds barrierMutex; returns once no writer is inside
+    void lowerBarrier();
+};
+
+static_assert(sizeof(std::atomic<Money>) == sizeof(int64_t), "Balance columns must stay packed");
+
+#endif // ACCOUNT_COLUMNS_H
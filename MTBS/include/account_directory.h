@@ -0,0 +1,80 @@
+#ifndef ACCOUNT_DIRECTORY_H
+#define ACCOUNT_DIRECTORY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+#include <functional>
+#include <cstddef>
+#include "account.h"
+
+/**
+ * @brief Sharded hash directory mapping account numbers to accounts
+ *
+ * Replaces the single mutex-protected map in Bank. Account numbers are
+ * hashed onto a power-of-two number of independent shards, each guarded
+ * by its own reader-writer lock, so lookups on different shards never
+ * contend and lookups on the same shard only take a shared lock.
+ * Account counts are maintained atomically so they can be read without
+ * walking the directory. Accounts are marked listed (Account::setListed)
+ * while the directory holds them, which is what bulk jobs go by.
+ */
+class AccountDirectory {
+public:
+    explicit AccountDirectory(size_t shardCount = 64);
+    ~AccountDirectory() = default;
+
+    // Non-copyable: shards own their locks
+    AccountDirectory(const AccountDirectory&) = delete;
+    AccountDirectory& operator=(const AccountDirectory&) = delete;
+
+    // Insert only if the number is not already present
+    bool insert(const std::string& accountNumber, std::shared_ptr<Account> account);
+    
+    // Batch insert keyed by each account's number, taking every shard's lock once;
+    // inserted (optional, count entries) reports which ones were new. Returns how many were
+    size_t insertMany(const std::shared_ptr<Account>* batch, size_t count, bool* inserted = nullptr);
+
+    // Lookup takes a shared lock on one shard only
+    std::shared_ptr<Account> find(const std::string& accountNumber) const;
+
+    // Removal; eraseIf checks the predicate under the shard's exclusive lock
+    bool erase(const std::string& accountNumber);
+    bool eraseIf(const std::string& accountNumber,
+                 const std::function<bool(const Account&)>& predicate);
+
+    void clear();
+
+    // Counters (lock-free)
+    size_t size() const;
+    size_t activeCount() const;
+
+    // Iteration, one shard at a time under a shared lock
+    std::vector<std::shared_ptr<Account>> snapshot() const;
+    void forEach(const std::function<void(const std::shared_ptr<Account>&)>& visitor) const;
+
+    // Shard routing
+    size_t shardCount() const;
+    size_t shardIndex(const std::string& accountNumber) const;
+
+private:
+    // Each shard sits on its own cache line(s) to avoid false sharing
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<Account>> accounts;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    size_t shardMask;
+
+    alignas(64) std::atomic<size_t> totalCount;
+    alignas(64) std::atomic<size_t> activeAccounts;
+
+    Shard& shardFor(const std::string& accountNumber) const;
+    void accountRemoved(const Account& account);
+};
+
+#endif // ACCOUNT_DIRECTORY_H
@@ -0,0 +1,63 @@
+#ifndef ACCOUNT_NUMBER_ALLOCATOR_H
+#define ACCOUNT_NUMBER_ALLOCATOR_H
+
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief Collision-free account numbers without a shared hot spot
+ *
+ * Numbers look like "MTBS-7K2Q0ZD-X": seven base-36 digits of serial and
+ * an ISO 7064 MOD 37,36 check character computed over "MTBS" and the
+ * serial, which catches any single mistyped character and nearly every
+ * swap of two adjacent ones.
+ *
+ * Serials come from ordinals 0, 1, 2, ... passed through a fixed bijection
+ * of the 36^7 serial space, so consecutive accounts do not get
+ * consecutive-looking numbers. Each thread leases blocks of ordinals and
+ * hands them out locally; the shared counter is touched once per block.
+ * Ordinals are never reused, so numbers are unique for the lifetime of the
+ * allocator. Gaps (the unused rest of a thread's lease) are expected.
+ *
+ * Across restarts uniqueness depends on resuming after everything issued
+ * before: advanceTo() with a persisted getNextOrdinal(), and observe() for
+ * numbers read back from disk.
+ */
+class AccountNumberAllocator {
+public:
+    static constexpr size_t kSerialDigits = 7;
+    static constexpr uint64_t kSerialSpace = 78364164096ull;   // 36^7
+    static constexpr uint32_t kDefaultBlockSize = 4096;
+    static constexpr size_t kNumberLength = 14;                 // "MTBS-" + 7 + "-" + 1
+
+    explicit AccountNumberAllocator(uint32_t blockSize = kDefaultBlockSize);
+
+    AccountNumberAllocator(const AccountNumberAllocator&) = delete;
+    AccountNumberAllocator& operator=(const AccountNumberAllocator&) = delete;
+
+    // Throws std::overflow_error once the serial space is used up
+    std::string allocate();
+
+    // Recovery: never hand out this number (if it is one of ours) or any ordinal below it
+    void observe(std::string_view accountNumber);
+    void advanceTo(uint64_t ordinal);
+    uint64_t getNextOrdinal() const;                            // Persist this to resume after a restart
+
+    // Encoding
+    static std::string format(uint64_t ordinal);
+    static bool parse(std::string_view accountNumber, uint64_t& ordinal);
+    static char checkCharacter(std::string_view text);          // Over letters and digits; dashes skipped
+
+private:
+    uint64_t allocatorId;
+    std::shared_ptr<const char> lifetime;                       // Per-thread leases watch it to drop themselves
+    uint32_t blockSize;
+    alignas(64) std::atomic<uint64_t> nextOrdinal;              // Start of the next unleased block
+    std::atomic<uint64_t> floorOrdinal;                         // Leases below this are discarded
+};
+
+#endif // ACCOUNT_NUMBER_ALLOCATOR_H
@@ -0,0 +1,168 @@
+#ifndef ADMISSION_CONTROLLER_H
+#define ADMISSION_CONTROLLER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "sharded_counter.h"
+
+/**
+ * @brief Token buckets keyed by a 64-bit hash (of an account number, a client address, ...)
+ *
+ * Every key starts with a full bucket of burst tokens, which refills at
+ * ratePerSecond. Buckets live in shards of a hash map, one mutex each, and
+ * are created on first use; a shard that grows past kPruneThreshold drops
+ * the buckets that have refilled to full, which is the same as forgetting
+ * them. A rate of 0 disables the buckets: tryTake always succeeds.
+ */
+class TokenBuckets {
+public:
+    static constexpr size_t kPruneThreshold = 4096;     // Buckets per shard before idle ones are dropped
+
+    TokenBuckets(double ratePerSecond, double burst, size_t shards = 64);
+
+    TokenBuckets(const TokenBuckets&) = delete;
+    TokenBuckets& operator=(const TokenBuckets&) = delete;
+
+    static uint64_t keyOf(std::string_view name);
+
+    // Takes tokens from key's bucket: zero if it had them, otherwise how long until it will
+    // (nothing is taken then)
+    std::chrono::microseconds tryTake(uint64_t key, double tokens = 1.0);
+
+    bool isEnabled() const;
+    double getRate() const;
+    double getBurst() const;
+    size_t size() const;                // Keys holding a bucket
+
+private:
+    struct Bucket {
+        double tokens;
+        int64_t refilledNs;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, Bucket> buckets;
+    };
+
+    double rate;
+    double burst;
+    std::unique_ptr<Shard[]> shards;
+    size_t shardMask;
+};
+
+/**
+ * @brief Admission control for queued transactions: a concurrency limit that adapts to queue latency
+ *
+ * Admitted work holds a permit until it completes, so the limit bounds what
+ * is queued plus what is running; past it, tryAdmit rejects at once with a
+ * retry hint instead of letting the queue (and every caller's latency) grow.
+ * A permit costs one atomic increment on the admission line.
+ *
+ * The limit moves between minLimit and maxLimit, AIMD style, once per
+ * window: the consumers report how long work sat queued (recordQueueDelay,
+ * once per batch or task is enough), and if the worst delay of a window was
+ * above targetQueueDelay the limit shrinks by decreaseFactor; if it stayed
+ * below and the window ran close to the limit, the limit grows by a step.
+ * A limit that is never approached does not grow without bound.
+ *
+ * Accounts may also be rate limited (accountRate operations per second, with
+ * bursts of accountBurst), ahead of the concurrency test.
+ *
+ * Decision counters are sharded per thread (ShardedCounters): they are for
+ * reports, not for decisions.
+ */
+class AdmissionController {
+public:
+    struct Options {
+        size_t minLimit = 1;
+        size_t maxLimit = 1024;
+        size_t initialLimit = 0;                        // 0: maxLimit
+        std::chrono::microseconds targetQueueDelay{2000};
+        std::chrono::milliseconds window{100};
+        double decreaseFactor = 0.9;
+        double accountRate = 0;                         // Operations per second per account (0: unlimited)
+        double accountBurst = 0;                        // 0: one second's worth
+    };
+
+    enum class Verdict : uint8_t {
+        ADMITTED,
+        OVER_LIMIT,         // Concurrency limit reached
+        RATE_LIMITED        // The account's bucket is empty
+    };
+
+    struct Decision {
+        Verdict verdict = Verdict::ADMITTED;
+        std::chrono::milliseconds retryAfter{0};        // When to try again, if not admitted
+
+        bool admitted() const { return verdict == Verdict::ADMITTED; }
+        std::string message() const;                    // For rejected transaction results
+    };
+
+    struct Statistics {
+        uint64_t admitted = 0;
+        uint64_t overLimit = 0;
+        uint64_t rateLimited = 0;
+        size_t inFlight = 0;
+        size_t limit = 0;
+        size_t minLimit = 0;
+        size_t maxLimit = 0;
+        uint64_t limitIncreases = 0;
+        uint64_t limitDecreases = 0;
+        std::chrono::microseconds queueDelay{0};        // Worst of the last complete window
+        std::chrono::microseconds targetQueueDelay{0};
+        double accountRate = 0;
+        size_t rateLimitedAccounts = 0;                 // Accounts holding a bucket
+    };
+
+    AdmissionController();
+    explicit AdmissionController(const Options& options);
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // Takes a permit when admitted; each admitted transaction must give it back exactly once
+    Decision tryAdmit(std::string_view accountNumber);
+    void release(size_t permits = 1);
+
+    // Queueing delay of one batch or task, measured when it starts to run; drives the limit
+    void recordQueueDelay(std::chrono::nanoseconds delay);
+
+    size_t getLimit() const;
+    size_t getInFlight() const;
+    Statistics getStatistics() const;
+
+private:
+    enum Counter : size_t {
+        ADMITTED_COUNT, OVER_LIMIT_COUNT, RATE_LIMITED_COUNT,
+        COUNTER_COUNT
+    };
+
+    Options options;
+    TokenBuckets accountBuckets;
+    ShardedCounters<COUNTER_COUNT> counters;
+
+    alignas(64) std::atomic<size_t> inFlight;
+    std::atomic<size_t> limit;
+
+    // Current window, then the limit update that closes it (whichever thread sees it end)
+    alignas(64) std::atomic<int64_t> windowEndNs;
+    std::atomic<int64_t> windowWorstNs;
+    std::atomic<size_t> windowPeakInFlight;
+    std::atomic<int64_t> lastWindowWorstNs;
+    std::atomic<uint64_t> limitIncreases;
+    std::atomic<uint64_t> limitDecreases;
+
+    std::chrono::milliseconds retryHint() const;
+    void closeWindow();
+    static int64_t nowNs();
+};
+
+#endif // ADMISSION_CONTROLLER_H
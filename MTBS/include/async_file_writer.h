@@ -0,0 +1,120 @@
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Append-only file written by a dedicated thread with group commit
+ *
+ * Producers copy records into a buffer owned by their own thread (its lock
+ * is only ever shared with the writer thread) and get back a ticket. The
+ * writer thread drains all thread buffers into one write() and, depending
+ * on the durability mode, one fsync, so many records share each system
+ * call. commit(ticket) waits until that record is durable.
+ *
+ * Records from different threads may reach the file in any order; callers
+ * that need an order (such as the journal) put a sequence number in the
+ * record itself.
+ *
+ * A failed open, write or sync is latched (getError): nothing is reported
+ * durable from then on, commit() and flush() return false, and later
+ * records are dropped rather than buffered.
+ */
+class AsyncFileWriter {
+public:
+    enum class Durability {
+        ASYNC,          // commit() never waits; data is synced on flush() and close
+        GROUP,          // One fsync per groupRecords records or per groupWindow
+        EVERY_RECORD    // commit() waits for a write+fsync without any batching delay
+    };
+
+    struct Options {
+        Durability durability = Durability::GROUP;
+        size_t groupRecords = 256;
+        std::chrono::microseconds groupWindow{200};
+    };
+
+    explicit AsyncFileWriter(const std::string& path);
+    AsyncFileWriter(const std::string& path, const Options& options);
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    // Queues one record; returns its ticket (1, 2, 3, ...)
+    uint64_t append(const void* data, size_t size);
+    uint64_t append(const std::string& text);
+
+    // Waits until the record with this ticket is durable (no wait in ASYNC mode); false once
+    // the writer has failed
+    bool commit(uint64_t ticket);
+
+    // Writes and syncs everything appended so far, in every mode; false once the writer has failed
+    bool flush();
+
+    // Flushes, then continues in a new file (used for log rotation)
+    bool reopen(const std::string& newPath);
+
+    bool isOpen() const;
+    int getError() const;             // errno of the first failed open, write or sync; 0 if none
+    std::string getPath() const;
+    Durability getDurability() const;
+
+    // Statistics
+    uint64_t getAppendedRecords() const;
+    uint64_t getDurableRecords() const;
+    uint64_t getWriteCalls() const;
+    uint64_t getSyncCalls() const;
+
+private:
+    struct ThreadBuffer {
+        std::mutex mutex;             // Owner thread vs writer thread only
+        std::vector<char> data;
+    };
+
+    std::string path;
+    Options options;
+    int fileDescriptor;
+    uint64_t writerId;                // Distinguishes writers in thread-local caches
+
+    // Per-thread buffers, owned here so they outlive their threads
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    alignas(64) std::atomic<uint64_t> appended;
+    alignas(64) std::atomic<uint64_t> durable;
+    std::atomic<bool> writerIdle;
+    std::atomic<int> writeError;
+
+    // Writer thread coordination
+    mutable std::mutex stateMutex;
+    std::condition_variable wakeWriter;
+    std::condition_variable committed;
+    uint64_t flushRequested;
+    bool stopping;
+
+    mutable std::mutex ioMutex;       // Writer thread vs reopen()
+    std::atomic<uint64_t> writeCalls;
+    std::atomic<uint64_t> syncCalls;
+    std::thread writerThread;
+
+    ThreadBuffer& localBuffer();
+    void writerLoop();
+    bool writeAll(const char* data, size_t size);
+    bool syncFile();
+    void wakeWriterThread();
+
+    static int openFile(const std::string& path);
+    static void closeFile(int descriptor);
+};
+
+#endif // ASYNC_FILE_WRITER_H
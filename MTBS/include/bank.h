@@ -1,15 +1,28 @@
 #ifndef BANK_H
 #define BANK_H
 
-#include <map>
 #include <vector>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <atomic>
+#include <future>
+#include <functional>
+#include <thread>
+#include <shared_mutex>
+#include <condition_variable>
 #include "account.h"
 #include "transaction.h"
 #include "thread_manager.h"
+#include "account_directory.h"
+#include "account_columns.h"
+#include "transaction_pipeline.h"
+#include "admission_controller.h"
+#include "journal.h"
+#include "snapshot.h"
+#include "replication.h"
+#include "account_number_allocator.h"
+#include "sharded_counter.h"
 
 // Forward declarations
 class TransactionProcessor;
@@ -30,6 +43,52 @@ public:
         size_t maxAccounts;
         size_t maxConcurrentTransactions;
         bool enableAuditLogging;
+        size_t directoryShards = 64;    // Account directory shard count (rounded to a power of two)
+        uint32_t nodeId = 0;            // IdGenerator node bits (0..31), unique per running instance
+        size_t pipelineBatchSize = 64;  // Max operations a pipeline worker applies per lane visit
+        size_t pipelineLaneCapacity = 1024; // Queued operations per shard lane before admission rejects
+        bool enableJournal = true;      // Binary write-ahead journal of every account change
+        std::string journalPath = "bank_journal.wal";
+        AsyncFileWriter::Durability journalDurability = AsyncFileWriter::Durability::GROUP;
+        size_t journalGroupRecords = 256;                  // Group commit: one fsync per this many records...
+        std::chrono::microseconds journalGroupWindow{200}; // ...or per this interval, whichever comes first
+        bool recoverOnStart = true;     // Load the snapshot and replay the journal tail in startBankingSystem
+        std::string snapshotPath = "bank_snapshot.dat";    // Empty disables snapshots
+        std::string historyArchivePath = "bank_history.wal"; // With the journal: history records evicted
+                                                            // from memory (journal format; empty: dropped)
+        std::chrono::seconds snapshotInterval{60};         // Periodic snapshots while running (0: only on stop)
+        uint32_t stripeThreshold = 1000;    // Contended lock waits per second before an account switches to
+                                            // striped balances (0: never). Striped accounts journal their
+                                            // deposits just after returning, so this only applies with ASYNC
+                                            // durability or no journal
+        // Admission control of queued work (submit*, process*Async; the synchronous process* calls
+        // run on the caller's thread and are not queued): with AdmissionController's adaptive limit
+        // between maxConcurrentTransactions and admissionMaxInFlight, and per-account rate limits,
+        // what does not fit is rejected at once with a retry hint (TransactionResult::retryAfter)
+        bool enableAdmissionControl = true;
+        size_t admissionMaxInFlight = 0;    // 0: maxConcurrentTransactions * pipelineBatchSize
+        std::chrono::microseconds admissionTargetQueueDelay{2000};  // The limit shrinks while queueing exceeds this
+        double accountRateLimit = 0;        // Per-account token bucket: operations per second (0: unlimited)...
+        double accountRateBurst = 0;        // ...and its depth (0: one second's worth)
+        bool shardAffinity = false;         // Pin pool workers to CPUs, NUMA node by node, and give every
+                                            // directory shard one owning worker: its pipeline lane and
+                                            // process*Async calls on its accounts run there only
+                                            // (priorities are then ignored)
+        uint32_t lockContentionSampling = 0;    // Time every Nth acquisition of the profiled locks
+                                                // (ThreadMonitor, process-wide; 0: leave as is)
+        // Replication (see ReplicationServer): a PRIMARY, which needs the journal, streams it to
+        // FOLLOWERs, which apply it by account shard and serve reads; writes to a follower fail.
+        // QUORUM holds each journal commit until replicationQuorum followers have applied it, or
+        // the ack timeout passes (commits then stop waiting until the followers catch up)
+        ReplicationRole replicationRole = ReplicationRole::STANDALONE;
+        std::string replicationListen = "127.0.0.1";       // Primaries and promoted followers...
+        uint16_t replicationListenPort = 7070;              // ...(0: any free port, see getReplicationPort)
+        std::string replicationPrimary = "127.0.0.1";      // Followers
+        uint16_t replicationPrimaryPort = 7070;
+        ReplicationAckMode replicationAckMode = ReplicationAckMode::ASYNC;
+        size_t replicationQuorum = 1;
+        std::chrono::milliseconds replicationAckTimeout{500};
+        std::chrono::microseconds replicationBatchWindow{1000};    // Records gather this long before shipping
         
         Config(const std::string& name = "MTBS Bank", 
                const std::string& code = "MTBS001",
@@ -43,90 +102,269 @@ public:
     ~Bank();
     
     // Account management (THREAD-SAFE)
-    std::string createAccount(const std::string& holderName, double initialBalance = 0.0);
+    std::string createAccount(const std::string& holderName, Money initialBalance = Money());
+    
+    // Bulk onboarding: every spec is validated before any account is created (the first
+    // invalid one throws), then accounts are built in parallel and inserted with one lock
+    // per shard. Numbers come back in spec order; an entry is empty only if its number
+    // collided with an existing (imported) account. One audit line per batch
+    struct AccountSpec {
+        std::string holderName;
+        Money initialBalance;
+    };
+    std::vector<std::string> createAccounts(const AccountSpec* specs, size_t count);
+    std::vector<std::string> createAccounts(const std::vector<AccountSpec>& specs);
+    
     bool closeAccount(const std::string& accountNumber);
     std::shared_ptr<Account> getAccount(const std::string& accountNumber);
     std::vector<std::shared_ptr<Account>> getAllAccounts();
     
+    // Every account and its balance as of one instant, for reports: writers are held only
+    // while the operations in flight finish, not while the accounts are read, and the view
+    // holds no references (see AccountColumns::View). Waits for a running bulk job
+    using AccountsView = AccountColumns::View;
+    AccountsView viewAccounts() const;
+    
     // Transaction processing (THREAD-SAFE)
-    bool processDeposit(const std::string& accountNumber, double amount, 
+    bool processDeposit(const std::string& accountNumber, Money amount, 
                        const std::string& description = "");
-    bool processWithdraw(const std::string& accountNumber, double amount, 
+    bool processWithdraw(const std::string& accountNumber, Money amount, 
                         const std::string& description = "");
     bool processTransfer(const std::string& fromAccount, const std::string& toAccount, 
-                        double amount, const std::string& description = "");
+                        Money amount, const std::string& description = "");
+    
+    // N-way transfer (e.g. payroll: one source, thousands of targets) applied as one atomic
+    // unit, with each distinct account locked once; see Account::transferBatch. On failure
+    // nothing is applied and the message names the offending leg. newBalance is the first
+    // leg's source balance. Counts as one transaction, with one audit line
+    struct TransferSpec {
+        std::string fromAccount;
+        std::string toAccount;
+        Money amount;
+    };
+    TransactionProcessor::TransactionResult processBatchTransfer(const std::vector<TransferSpec>& legs, 
+                                                                 const std::string& description = "");
+    
+    // Opt-in lock-free deposits and withdrawals for a hot account (see Account::setFastPath);
+    // their records are journalled shortly after the call returns. False if not found
+    bool setAccountFastPath(const std::string& accountNumber, bool enabled);
     
-    // Banking operations
-    double getAccountBalance(const std::string& accountNumber);
+    // Asynchronous variants run on the bank's thread pool (result is false if the system is stopped
+    // or admission control turned the transaction away)
+    std::future<bool> processDepositAsync(const std::string& accountNumber, Money amount, 
+                                          const std::string& description = "", int priority = 0);
+    std::future<bool> processWithdrawAsync(const std::string& accountNumber, Money amount, 
+                                           const std::string& description = "", int priority = 0);
+    std::future<bool> processTransferAsync(const std::string& fromAccount, const std::string& toAccount, 
+                                           Money amount, const std::string& description = "", int priority = 0);
+    
+    // Pipelined transaction processing (batched per account shard on the thread pool); a transaction
+    // turned away by admission control completes at once, unsuccessful, with its retryAfter set
+    using TransactionResult = TransactionProcessor::TransactionResult;
+    using TransactionCallback = TransactionPipeline::Callback;
+    std::future<TransactionResult> submitDeposit(const std::string& accountNumber, Money amount, 
+                                                 const std::string& description = "");
+    std::future<TransactionResult> submitWithdraw(const std::string& accountNumber, Money amount, 
+                                                  const std::string& description = "");
+    std::future<TransactionResult> submitTransfer(const std::string& fromAccount, const std::string& toAccount, 
+                                                  Money amount, const std::string& description = "");
+    void submitDeposit(const std::string& accountNumber, Money amount, 
+                       const std::string& description, TransactionCallback callback);
+    void submitWithdraw(const std::string& accountNumber, Money amount, 
+                        const std::string& description, TransactionCallback callback);
+    void submitTransfer(const std::string& fromAccount, const std::string& toAccount, 
+                        Money amount, const std::string& description, TransactionCallback callback);
+    void flushPipeline();
+    
+    // Runs long administrative work (sample data, clearing) on the thread pool instead of the
+    // caller's thread; false, with task not run, if the system is stopped
+    bool submitBackground(std::function<void()> task);
+    
+    // Banking operations (getAccountBalance returns a negative amount if not found)
+    Money getAccountBalance(const std::string& accountNumber);
     std::vector<Transaction> getAccountTransactions(const std::string& accountNumber);
+    // History retention: each account keeps its newest records in memory (TransactionHistory's
+    // resident window), snapshots persist that window, and older records are appended to the
+    // history archive, which this reads back (oldest first; a full scan of the archive)
+    std::vector<Transaction> getArchivedTransactions(const std::string& accountNumber);
     std::string getAccountStatus(const std::string& accountNumber);
     
-    // System management
+    // System management (start recovers persisted state once; stop writes a final snapshot)
     void startBankingSystem();
     void stopBankingSystem();
     bool isSystemRunning() const;
     
-    // Statistics and monitoring
+    // Durability: point-in-time snapshot of every account, taken without pausing traffic
+    bool takeSnapshot();
+    
+    // Month-end jobs over the account columns (see AccountColumns), each under an epoch barrier:
+    // account writers pause for its duration, readers do not, and no account lock is taken except
+    // to settle fast-path accounts. Interest (annual percent, as in BankUtils::calculateInterest,
+    // rounded half up per account) is posted as a deposit, fees as a withdrawal capped at the
+    // balance; each posting is recorded and journalled, and the journal is flushed once at the
+    // end. Exempt accounts and non-positive balances are skipped. One audit line per job
+    using AccountTerms = Account::Terms;
+    struct FeeSchedule {
+        Money maintenanceFee;       // Charged to every account that pays fees
+        Money lowBalanceFee;        // On top, while the balance is below the account's minimum
+    };
+    struct BulkResult {
+        size_t accountsPosted = 0;
+        Money total;
+    };
+    BulkResult applyInterest(double annualRatePercent, int months = 1);
+    BulkResult applyFees(const FeeSchedule& schedule);
+    Money sumAllBalances();         // Exact total at one instant (writers paused), for reconciliation
+    bool setAccountTerms(const std::string& accountNumber, const AccountTerms& terms);
+    
+    // Statistics and monitoring (transaction counts are summed from per-thread slots on read)
+    struct TransactionStatistics {
+        size_t total = 0;
+        size_t successful = 0;
+        size_t failed = 0;
+        size_t deposits = 0;            // Attempts by operation, successful or not
+        size_t withdrawals = 0;
+        size_t transfers = 0;
+        size_t batchTransfers = 0;
+        size_t insufficientFunds = 0;   // Failures by reason (they add up to failed)
+        size_t invalidAccount = 0;      // Unknown account, or a transfer to itself
+        size_t otherFailures = 0;       // Invalid amount, overflow
+    };
+    TransactionStatistics getTransactionStatistics() const;
     size_t getTotalAccounts() const;
     size_t getActiveAccounts() const;
     size_t getTotalTransactions() const;
     size_t getSuccessfulTransactions() const;
     size_t getFailedTransactions() const;
+    Money getTotalBalance() const;      // Consistent: taken from viewAccounts
     
     // System information
     std::string getBankName() const;
     std::string getBankCode() const;
     std::string getSystemStatus() const;
-    std::string getPerformanceReport() const;
+    std::string getPerformanceReport() const;     // Ends with the latency table (LatencyStats::report)
+    std::string getPerformanceSnapshot() const;   // Counters, pool and admission state and latency percentiles as one JSON object
+    
+    // Replication: the port followers connect to (0 unless a running primary), and failover: a
+    // follower stops following and becomes a primary, journalling on from the last LSN it applied
+    ReplicationRole getReplicationRole() const;
+    uint16_t getReplicationPort() const;
+    bool promoteToPrimary();        // False unless a follower with a journal
     
-    // Utility methods
+    // Utility methods (generateSampleData doubles as a bulk-load generator)
     void generateSampleData(size_t accountCount = 5);
-    void clearAllData();
-    void exportTransactionLog(const std::string& filename);
-    void importTransactionLog(const std::string& filename);
+    void clearAllData();            // Journalled as a closing per account; throws on a replica
+    // Export writes a snapshot of every account; import merges a snapshot or a journal segment
+    bool exportTransactionLog(const std::string& filename);
+    bool importTransactionLog(const std::string& filename);
 
 private:
     // Bank configuration
     Config config;
     
-    // Account storage (SHARED RESOURCE - PROTECTED BY MUTEX)
-    std::map<std::string, std::shared_ptr<Account>> accounts;
-    mutable std::mutex accountsMutex;
+    // Write-ahead journal (declared before accounts: accounts hold a raw pointer to it)
+    std::unique_ptr<Journal> journal;
+    std::shared_ptr<AsyncFileWriter> historyArchive;    // Null without the journal (accounts share it)
+    
+    // Balances, terms and flags of this bank's accounts, as columns (accounts keep it alive)
+    std::shared_ptr<AccountColumns> columns;
+    
+    // Account storage (SHARED RESOURCE - SHARDED, PER-SHARD READER-WRITER LOCKS)
+    AccountDirectory accounts;
     
     // Transaction processing components
     std::unique_ptr<TransactionProcessor> transactionProcessor;
     std::unique_ptr<TransactionLogger> transactionLogger;
     
-    // Thread management
+    // Thread management (admission and the monitor are declared first: pool workers use them)
+    std::unique_ptr<AdmissionController> admission;     // Null when disabled
+    std::unique_ptr<ThreadMonitor> threadMonitor;
     std::unique_ptr<ThreadPool> threadPool;
     std::unique_ptr<WorkQueue> workQueue;
-    std::unique_ptr<ThreadMonitor> threadMonitor;
+    std::unique_ptr<TransactionPipeline> transactionPipeline; // Declared after threadPool: destroyed first
     
     // System state
     std::atomic<bool> systemRunning;
-    std::atomic<size_t> totalTransactions;
-    std::atomic<size_t> successfulTransactions;
-    std::atomic<size_t> failedTransactions;
     
-    // Account counter (atomic for thread safety)
-    std::atomic<unsigned long long> accountCounter;
+    // Transaction statistics (SHARED RESOURCE - PER-THREAD SLOTS, see ShardedCounters)
+    enum StatCounter : size_t {
+        STAT_SUCCESSFUL, STAT_FAILED,
+        STAT_DEPOSITS, STAT_WITHDRAWALS, STAT_TRANSFERS, STAT_BATCH_TRANSFERS,
+        STAT_INSUFFICIENT_FUNDS, STAT_INVALID_ACCOUNT, STAT_OTHER_FAILURES,
+        STAT_COUNT
+    };
+    ShardedCounters<STAT_COUNT> statistics;
+    
+    // Account numbers (per-thread leases; resumes from the snapshot)
+    AccountNumberAllocator accountNumbers;
+    
+    // Durability state
+    std::shared_mutex accountCreationGate;  // Shared: journal+insert in createAccount; exclusive: snapshot cut
+    std::mutex snapshotMutex;               // One snapshot at a time
+    std::thread snapshotThread;
+    std::mutex snapshotThreadMutex;
+    std::condition_variable snapshotWake;
+    bool snapshotThreadStop;
+    bool recoveryDone;
+    std::atomic<bool> journalFailureLogged; // The first commit that fails writes the audit line
+    
+    // Replication (declared last: their threads call into the bank)
+    std::atomic<ReplicationRole> replicationRole;
+    std::unique_ptr<ReplicationServer> replicationServer;       // PRIMARY
+    std::unique_ptr<ReplicationFollower> replicationFollower;   // FOLLOWER
     
     // Private helper methods
     std::string generateAccountNumber();
     bool validateAccountNumber(const std::string& accountNumber);
-    bool validateTransaction(const std::string& accountNumber, double amount, 
-                           const std::string& type);
+    bool validateTransaction(const std::string& accountNumber, Money amount, 
+                           TransactionType type);
     void logTransaction(const Transaction& transaction);
-    void updateStatistics(bool success);
+    void updateStatistics(StatCounter operation, TransactionStatus status);
+    static StatCounter operationCounter(TransactionType type);
+    bool commitJournal();                   // False if the journal failed: what this thread logged may be lost
+    std::string shardLoadSummary() const;   // One line of ThreadMonitor::getShardLoads
+    std::string workerStateSummary() const; // ...of ThreadMonitor::getAllThreads
+    static std::string lockContentionSummary();     // ...of ThreadMonitor::getLockContention
+    
+    // Runs body over [0, count) in chunks of at least grain, on the thread pool when it is running
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+    
+    // Bulk jobs: body runs once per column chunk, in parallel, under the columns barrier with
+    // snapshots and account creation held off and fast-path accounts settled first
+    using ColumnKernel = std::function<void(const int64_t* balances, const uint8_t* flags, 
+                                            const int64_t* minimumBalances, size_t count, int64_t* amounts)>;
+    void forEachColumnChunk(const std::function<void(AccountColumns::Chunk&, size_t)>& body);
+    BulkResult postFromColumns(TransactionType type, uint32_t description, const ColumnKernel& kernel);
+    
+    // Every account is made here: it spills evicted history to the archive
+    std::shared_ptr<Account> makeAccount(const std::string& number, const std::string& holderName, 
+                                         Money initialBalance);
+    std::shared_ptr<Account> reopenAccount(const JournalRecord& opened);    // Replay of an ACCOUNT_OPENED
+    
+    // Recovery
+    void recoverState();
+    size_t replayIntoDirectory(const std::vector<SnapshotEntry>& entries, 
+                               const std::vector<JournalRecord>& records, bool journalRestored);
+    size_t replayShard(size_t shard, std::vector<const SnapshotEntry*>& entries, 
+                       std::vector<const JournalRecord*>& records, bool journalRestored);
+    SnapshotData captureSnapshot();
+    void snapshotLoop();
     
-    // Thread safety helpers
-    std::shared_ptr<Account> findAccountUnsafe(const std::string& accountNumber);
-    void addAccountUnsafe(const std::string& accountNumber, std::shared_ptr<Account> account);
-    void removeAccountUnsafe(const std::string& accountNumber);
+    // Replication: a follower clears its accounts on every bootstrap and applies frames by shard
+    bool isReplica() const;
+    void resetReplica();
+    void applyReplicated(std::vector<JournalRecord>& records, bool bootstrap);
+    void applyReplicatedShard(size_t shard, std::vector<const JournalRecord*>& records, bool bootstrap);
+    void streamReplicaSnapshot(const std::function<uint64_t()>& cut, 
+                               const std::function<void(const JournalRecord&)>& emit);
+    ReplicationServer::Options replicationServerOptions() const;
+    std::string replicationSummary() const; // One line of the replication state
+    void recordPipelineOutcome(TransactionType type, const std::string& accountNumber, 
+                               const std::string& targetAccount, Money amount, TransactionStatus status);
     
     // Internal transaction processing
-    void processTransactionAsync(const std::function<void()>& transactionTask, 
-                               const std::string& description);
+    std::future<bool> processTransactionAsync(std::function<bool()> transactionTask, const std::string& accountNumber, 
+                                              const std::string& description, int priority);
 };
 
 /**
@@ -167,12 +405,12 @@ namespace BankUtils {
     // Validate banking data
     bool isValidBankCode(const std::string& code);
     bool isValidAccountHolderName(const std::string& name);
-    bool isValidInitialBalance(double balance);
+    bool isValidInitialBalance(Money balance);
     
     // Format banking information
     std::string formatAccountNumber(const std::string& number);
     std::string formatBankCode(const std::string& code);
-    std::string formatCurrency(double amount);
+    std::string formatCurrency(Money amount);
     
     // Generate banking identifiers
     std::string generateBankCode();
@@ -180,9 +418,9 @@ namespace BankUtils {
     std::string generateTransactionId();
     
     // Banking calculations
-    double calculateInterest(double principal, double rate, int months);
-    double calculateTransactionFee(double amount, const std::string& type);
-    double calculateMinimumBalance(const std::string& accountType);
+    Money calculateInterest(Money principal, double rate, int months);
+    Money calculateTransactionFee(Money amount, TransactionType type);
+    Money calculateMinimumBalance(const std::string& accountType);
 }
 
 #endif // BANK_H
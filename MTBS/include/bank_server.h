@@ -0,0 +1,275 @@
+#ifndef BANK_SERVER_H
+#define BANK_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "admission_controller.h"
+#include "money.h"
+
+class Bank;
+
+/**
+ * @brief Embedded network front-end for a Bank: HTTP/JSON, a binary protocol and a balance push
+ *
+ * One event-loop thread (epoll, level-triggered) owns every connection. It
+ * parses requests, answers single-account reads itself and hands deposits,
+ * withdrawals and transfers to the bank's TransactionPipeline; account
+ * opening and closing, the all-account reads, sample data and clearing run
+ * on the bank's thread pool. Completions come back from the pool workers
+ * through an eventfd. Connections are keep-alive and may
+ * pipeline: every request found in a read is dispatched at once, and replies
+ * go out in request order, as many as are ready per writev. Reply bodies are
+ * shared buffers: static files are read once, and a balance push is rendered
+ * once for all its subscribers, then queued on each connection by reference.
+ *
+ * HTTP API (JSON; amounts in dollars, timestamps in milliseconds since the epoch):
+ *   GET    /api/status                         Bank::getPerformanceSnapshot
+ *   GET    /api/accounts                       One Bank::viewAccounts, paged: ?offset=N&limit=M
+ *                                              (default 1000, at most 10000)
+ *   POST   /api/accounts                       {"holderName", "initialBalance"}
+ *   GET    /api/accounts/<number>
+ *   DELETE /api/accounts/<number>              Only a zero balance can be closed
+ *   GET    /api/accounts/<number>/transactions Newest first; ?limit=N (default 50)
+ *   GET    /api/transactions                   Newest over a page of accounts; ?limit=N (default 20,
+ *                                              at most 1000), ?offset=N&accounts=M (at most 1000)
+ *   POST   /api/deposit, /api/withdraw         {"accountNumber", "amount", "description"}
+ *   POST   /api/transfer                       {"fromAccount", "toAccount", "amount", "description"}
+ *   POST   /api/batch                          [{"type": "deposit"|"withdraw"|"transfer", ...}, ...]
+ *                                              (or {"operations": [...]}): one result per operation,
+ *                                              in order; the operations run concurrently
+ *   POST   /api/sample-data                    {"count"}
+ *   POST   /api/clear
+ *   GET    /api/events                         Server-sent events, see below
+ * Any other GET is looked up in Options::staticRoot (the web UI).
+ *
+ * An operation turned away by admission control, the bank's or this
+ * server's per-client rate limit (Options::clientRate, per peer address),
+ * fails with "retryAfterMs"; a single one is answered 429 with Retry-After.
+ *
+ * /api/events opens with a "snapshot" event (every account, as /api/accounts
+ * lists them) and then sends a "balances" event every pushInterval in which
+ * something changed: "opened" accounts in full, "changed" balances and
+ * "closed" account numbers, all taken from consecutive viewAccounts, so
+ * deltas always add up to a consistent state. Both carry "stats".
+ *
+ * Binary protocol: a connection whose first bytes are kBinaryMagic exchanges
+ * little-endian frames instead; see appendBinaryRequest and
+ * parseBinaryResponse for the layouts. Frames pipeline like HTTP requests.
+ *
+ * Linux only (epoll); start() throws a BankException elsewhere.
+ */
+class BankServer {
+public:
+    struct Options {
+        std::string bindAddress = "127.0.0.1";
+        uint16_t port = 8080;                       // 0: any free port (see getPort)
+        std::string staticRoot = "frontend";        // Empty: API only
+        size_t maxConnections = 1024;
+        size_t maxRequestBytes = 1 << 20;           // Headers plus body of one request
+        size_t maxBatchOperations = 4096;
+        std::chrono::milliseconds pushInterval{250};
+        std::chrono::seconds idleTimeout{60};       // Keep-alive connections (not event streams)
+        double clientRate = 0;                      // Operations per second per client address (0: unlimited)
+        double clientBurst = 0;                     // 0: one second's worth
+    };
+
+    static constexpr char kBinaryMagic[4] = {'M', 'T', 'B', '1'};
+    static constexpr size_t kBinaryRequestHeader = 20;
+    static constexpr size_t kBinaryResponseHeader = 28;
+
+    enum class BinaryOp : uint8_t {
+        DEPOSIT = 1,
+        WITHDRAW = 2,
+        TRANSFER = 3,
+        BALANCE = 4
+    };
+
+    struct BinaryResponse {
+        uint32_t tag = 0;
+        bool success = false;
+        Money balance;              // New balance (the source's for a transfer)
+        uint64_t transactionId = 0;
+        std::string message;
+    };
+
+    // Request frame: u32 length (bytes after this field), u32 tag (echoed), u8 op,
+    // u8 account length, u8 target length, u8 reserved, i64 amount in cents, account, target
+    static void appendBinaryRequest(std::string& out, BinaryOp op, uint32_t tag, const std::string& account,
+                                    const std::string& target, Money amount);
+
+    // Response frame: u32 length, u32 tag, u8 success, u8 reserved, u16 message length,
+    // i64 balance in cents, u64 transaction ID, message. Returns the bytes consumed,
+    // or 0 if data holds no complete frame yet
+    static size_t parseBinaryResponse(const char* data, size_t size, BinaryResponse& response);
+
+    struct Statistics {
+        uint64_t connectionsAccepted = 0;
+        size_t openConnections = 0;
+        size_t eventSubscribers = 0;
+        uint64_t httpRequests = 0;
+        uint64_t binaryFrames = 0;
+        uint64_t pushEvents = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t rateLimited = 0;       // Operations over Options::clientRate
+    };
+
+    explicit BankServer(Bank& bank);
+    BankServer(Bank& bank, const Options& options);
+    ~BankServer();      // stop()
+
+    BankServer(const BankServer&) = delete;
+    BankServer& operator=(const BankServer&) = delete;
+
+    // Binds and starts the event loop; throws BankException (SYSTEM_ERROR) if the socket cannot be set up
+    void start();
+    // Closes every connection and waits for operations still in the pipeline
+    void stop();
+    bool isRunning() const;
+    uint16_t getPort() const;           // The bound port, once started
+
+    Statistics getStatistics() const;
+
+private:
+    using Buffer = std::shared_ptr<const std::string>;
+    using Clock = std::chrono::steady_clock;
+
+    // One reply slot per request, queued in request order; filled by the loop or a pool worker
+    struct Reply {
+        bool ready = false;             // Only touched by the loop thread
+        bool close = false;             // Close the connection once this reply is written
+        bool startsStream = false;      // The connection becomes an event stream after it
+        std::vector<Buffer> parts;
+    };
+
+    struct Segment {
+        Buffer data;
+        size_t offset;
+    };
+
+    struct Connection {
+        enum class Mode : uint8_t { UNKNOWN, HTTP, BINARY, EVENTS };
+
+        int fd;
+        uint64_t id;
+        uint64_t client = 0;            // Peer address, as a TokenBuckets key
+        Mode mode = Mode::UNKNOWN;
+        std::string input;
+        size_t consumed = 0;            // Parsed prefix of input
+        std::deque<std::shared_ptr<Reply>> replies;
+        size_t pendingOperations = 0;   // Replies waiting on the pipeline; later reads wait for them
+        std::deque<Segment> output;
+        size_t outputBytes = 0;
+        uint32_t interest = 0;          // epoll events currently registered
+        bool closing = false;           // Stop reading; close once output is written
+        bool peerClosed = false;        // Read end shut: answer what was received, then close
+        bool streaming = false;         // Event stream with its headers sent
+        bool needsSnapshot = false;     // Not sent a "snapshot" event yet
+        Clock::time_point lastActive;
+    };
+
+    struct Completion {
+        uint64_t connection;
+        std::shared_ptr<Reply> reply;
+    };
+
+    struct HttpRequest;
+    struct OperationBatch;
+
+    // Page sizes of the all-account reads
+    static constexpr size_t kAccountPage = 1000;       // Default accounts per page
+    static constexpr size_t kTransactionPage = 1000;   // Most transactions per /api/transactions
+
+    // Status and JSON body of a request answered on a pool worker (see submitBackground)
+    struct BackgroundReply {
+        int status;
+        std::string body;
+    };
+
+    // Balance push: last pushed state per account index (StringTable::accountNumbers ID)
+    struct Tracked {
+        int64_t balance = 0;
+        uint64_t seenPass = 0;          // 0: not listed
+    };
+
+    Bank& bank;
+    Options options;
+    TokenBuckets clientBuckets;
+    int listenFd;
+    int epollFd;
+    int wakeFd;
+    uint16_t boundPort;
+    std::atomic<bool> running;
+    std::atomic<bool> stopping;
+    std::thread loopThread;
+
+    // Loop-thread state
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+    uint64_t nextConnectionId;
+    std::map<std::string, std::pair<Buffer, const char*>> staticFiles;      // Name -> body, content type
+    std::vector<Tracked> tracked;
+    uint64_t pushPass;
+    bool trackedValid;
+    std::string lastStats;
+    Clock::time_point lastPushWrite;
+
+    // Completions from pool workers, and operations still in the pipeline
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+    std::condition_variable drained;
+    size_t inFlight;
+
+    // Statistics
+    std::atomic<uint64_t> connectionsAccepted;
+    std::atomic<size_t> openConnections;
+    std::atomic<size_t> eventSubscribers;
+    std::atomic<uint64_t> httpRequests;
+    std::atomic<uint64_t> binaryFrames;
+    std::atomic<uint64_t> pushEvents;
+    std::atomic<uint64_t> bytesWritten;
+    std::atomic<uint64_t> rateLimited;
+
+    // Event loop
+    void eventLoop();
+    void acceptConnections();
+    void onReadable(Connection& connection);
+    void onWritable(Connection& connection);
+    void closeConnection(Connection& connection);
+    void closeIdleConnections();
+    void updateInterest(Connection& connection);
+    bool readPaused(const Connection& connection) const;
+    void drainCompletions();
+    void progress(Connection& connection);     // May close (and destroy) the connection
+    bool writeOutput(Connection& connection);
+    void queueOutput(Connection& connection, const Buffer& data);
+    void wake();
+
+    // Requests
+    void parseInput(Connection& connection);
+    size_t parseHttp(Connection& connection, const char* data, size_t size);
+    size_t parseBinary(Connection& connection, const char* data, size_t size);
+    void handleHttp(Connection& connection, const HttpRequest& request, const std::shared_ptr<Reply>& reply);
+    void handleApi(Connection& connection, const HttpRequest& request, const std::shared_ptr<Reply>& reply);
+    void handleStatic(const HttpRequest& request, Reply& reply);
+    void submitBatch(Connection& connection, const std::shared_ptr<OperationBatch>& batch);
+    void submitBackground(Connection& connection, const std::shared_ptr<Reply>& reply, bool keepAlive,
+                          std::function<BackgroundReply()> work);
+    void complete(uint64_t connection, const std::shared_ptr<Reply>& reply);
+
+    // Balance push
+    void pushBalances();
+    std::string renderStats(Money totalBalance) const;
+};
+
+#endif // BANK_SERVER_H
@@ -2,10 +2,17 @@
 #define BANK_UTILS_H
 
 #include <string>
-#include <regex>
+#include <string_view>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <cstdint>
+#include "money.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BANK_UTILS_HAVE_SSE2 1
+#endif
 
 /**
  * @brief Utility functions for banking operations
@@ -15,28 +22,126 @@
  */
 namespace BankUtils {
     
+    namespace detail {
+        // Character classes used by the validators, one table lookup per byte
+        enum CharClass : uint8_t {
+            UPPER = 0x01,
+            LOWER = 0x02,
+            DIGIT = 0x04,
+            SPACE = 0x08,              // " \t\n\v\f\r"
+            NAME_PUNCT = 0x10,         // "-',."
+            EMAIL_LOCAL_PUNCT = 0x20,  // "._%+-"
+            EMAIL_DOMAIN_PUNCT = 0x40  // ".-"
+        };
+        
+        struct CharClassTable {
+            uint8_t bits[256];
+        };
+        
+        constexpr CharClassTable makeCharClassTable() {
+            constexpr std::string_view namePunct = "-',.";
+            constexpr std::string_view localPunct = "._%+-";
+            constexpr std::string_view domainPunct = ".-";
+            CharClassTable table{};
+            for (int c = 0; c < 256; ++c) {
+                uint8_t bits = 0;
+                char ch = static_cast<char>(c);
+                if (c >= 'A' && c <= 'Z') bits |= UPPER;
+                if (c >= 'a' && c <= 'z') bits |= LOWER;
+                if (c >= '0' && c <= '9') bits |= DIGIT;
+                if (c == ' ' || (c >= '\t' && c <= '\r')) bits |= SPACE;
+                if (namePunct.find(ch) != std::string_view::npos) bits |= NAME_PUNCT;
+                if (localPunct.find(ch) != std::string_view::npos) bits |= EMAIL_LOCAL_PUNCT;
+                if (domainPunct.find(ch) != std::string_view::npos) bits |= EMAIL_DOMAIN_PUNCT;
+                table.bits[c] = bits;
+            }
+            return table;
+        }
+        
+        inline constexpr CharClassTable kCharClasses = makeCharClassTable();
+        
+        constexpr uint8_t classOf(char c) {
+            return kCharClasses.bits[static_cast<uint8_t>(c)];
+        }
+        
+        constexpr bool allInClass(std::string_view text, uint8_t classes) {
+            for (char c : text) {
+                if (!(classOf(c) & classes)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        
+        constexpr bool isValidHolderNameScalar(std::string_view name) {
+            return allInClass(name, UPPER | LOWER | SPACE | NAME_PUNCT);
+        }
+        
+#ifdef BANK_UTILS_HAVE_SSE2
+        // Same rule as isValidHolderNameScalar, 16 bytes per step
+        inline bool isValidHolderNameSse2(std::string_view name) {
+            const char* data = name.data();
+            size_t size = name.size();
+            size_t i = 0;
+            const __m128i caseBit = _mm_set1_epi8(0x20);
+            const __m128i beforeA = _mm_set1_epi8('a' - 1);
+            const __m128i afterZ = _mm_set1_epi8('z' + 1);
+            const __m128i beforeTab = _mm_set1_epi8('\t' - 1);
+            const __m128i afterReturn = _mm_set1_epi8('\r' + 1);
+            for (; i + 16 <= size; i += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                // Signed compares: bytes >= 0x80 are negative and fail every range
+                __m128i folded = _mm_or_si128(bytes, caseBit);
+                __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(folded, beforeA), _mm_cmpgt_epi8(afterZ, folded));
+                __m128i space = _mm_or_si128(
+                    _mm_and_si128(_mm_cmpgt_epi8(bytes, beforeTab), _mm_cmpgt_epi8(afterReturn, bytes)),
+                    _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')));
+                __m128i punct = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('-')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\''))),
+                    _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(',')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('.'))));
+                __m128i allowed = _mm_or_si128(letter, _mm_or_si128(space, punct));
+                if (_mm_movemask_epi8(allowed) != 0xFFFF) {
+                    return false;
+                }
+            }
+            return isValidHolderNameScalar(name.substr(i));
+        }
+#endif
+    }
+    
     /**
      * @brief Validates if an initial balance is acceptable
      * @param balance The balance amount to validate
      * @return true if valid, false otherwise
      */
-    inline bool isValidInitialBalance(double balance) {
-        return balance >= 0.0 && balance <= 1000000.0; // Max $1M initial balance
+    inline bool isValidInitialBalance(Money balance) {
+        return !balance.isNegative() && balance <= Money::fromDollars(1000000); // Max $1M initial balance
     }
     
     /**
      * @brief Validates if an account number format is correct
+     * 
+     * 8 to 12 upper-case letters and digits, optionally split into groups
+     * by single dashes, so "AB12CD34", the older "MTBS-XXXX-XXXX" and
+     * generateAccountNumber's "MTBS-XXXXXXX-C" are all accepted.
+     * 
      * @param accountNumber The account number to validate
      * @return true if valid format, false otherwise
      */
-    inline bool isValidAccountNumber(const std::string& accountNumber) {
-        if (accountNumber.empty() || accountNumber.length() < 8) {
-            return false;
+    constexpr bool isValidAccountNumber(std::string_view accountNumber) {
+        size_t characters = 0;
+        bool afterDash = true; // No leading dash
+        for (char c : accountNumber) {
+            if (detail::classOf(c) & (detail::UPPER | detail::DIGIT)) {
+                ++characters;
+                afterDash = false;
+            } else if (c == '-' && !afterDash) {
+                afterDash = true;
+            } else {
+                return false;
+            }
         }
-        
-        // Check if it contains only alphanumeric characters
-        std::regex accountPattern("^[A-Z0-9]{8,12}$");
-        return std::regex_match(accountNumber, accountPattern);
+        return !afterDash && characters >= 8 && characters <= 12;
     }
     
     /**
@@ -44,8 +149,8 @@ namespace BankUtils {
      * @param amount The amount to validate
      * @return true if valid, false otherwise
      */
-    inline bool isValidTransactionAmount(double amount) {
-        return amount > 0.0 && amount <= 100000.0; // Max $100K per transaction
+    inline bool isValidTransactionAmount(Money amount) {
+        return amount.isPositive() && amount <= Money::fromDollars(100000); // Max $100K per transaction
     }
     
     /**
@@ -53,14 +158,17 @@ namespace BankUtils {
      * @param name The name to validate
      * @return true if valid, false otherwise
      */
-    inline bool isValidHolderName(const std::string& name) {
+    inline bool isValidHolderName(std::string_view name) {
         if (name.empty() || name.length() < 2 || name.length() > 100) {
             return false;
         }
         
-        // Check if it contains only letters, spaces, and common punctuation
-        std::regex namePattern("^[a-zA-Z\\s\\-\\'\\,\\.]+$");
-        return std::regex_match(name, namePattern);
+        // Only letters, whitespace, and common punctuation
+#ifdef BANK_UTILS_HAVE_SSE2
+        return detail::isValidHolderNameSse2(name);
+#else
+        return detail::isValidHolderNameScalar(name);
+#endif
     }
     
     /**
@@ -74,7 +182,7 @@ namespace BankUtils {
      * @param amount The amount to format
      * @return Formatted currency string
      */
-    std::string formatCurrency(double amount);
+    std::string formatCurrency(Money amount);
     
     /**
      * @brief Formats timestamps
@@ -92,10 +200,32 @@ namespace BankUtils {
     
     /**
      * @brief Validates email format
+     * 
+     * local@domain.tld: local part of letters, digits and "._%+-", domain of
+     * letters, digits and ".-", ending in a dot and at least two letters.
+     * 
      * @param email The email to validate
      * @return true if valid email format, false otherwise
      */
-    bool isValidEmail(const std::string& email);
+    constexpr bool isValidEmail(std::string_view email) {
+        if (email.empty() || email.length() > 254) {
+            return false;
+        }
+        
+        size_t at = email.find('@');
+        if (at == 0 || at == std::string_view::npos) {
+            return false;
+        }
+        std::string_view local = email.substr(0, at);
+        std::string_view domain = email.substr(at + 1);
+        size_t dot = domain.rfind('.');
+        if (dot == 0 || dot == std::string_view::npos || domain.size() - dot - 1 < 2) {
+            return false;
+        }
+        return detail::allInClass(local, detail::UPPER | detail::LOWER | detail::DIGIT | detail::EMAIL_LOCAL_PUNCT) &&
+               detail::allInClass(domain.substr(0, dot), detail::UPPER | detail::LOWER | detail::DIGIT | detail::EMAIL_DOMAIN_PUNCT) &&
+               detail::allInClass(domain.substr(dot + 1), detail::UPPER | detail::LOWER);
+    }
     
     /**
      * @brief Sanitizes input strings
@@ -105,5 +235,13 @@ namespace BankUtils {
     std::string sanitizeInput(const std::string& input);
 }
 
+static_assert(BankUtils::isValidAccountNumber("MTBS-7K2Q0ZD-X"), "generated account numbers must validate");
+static_assert(BankUtils::isValidAccountNumber("MTBS-1234-5678"), "older account numbers must validate");
+static_assert(BankUtils::isValidAccountNumber("AB12CD34"), "ungrouped account numbers must validate");
+static_assert(!BankUtils::isValidAccountNumber("MTBS--1234") && !BankUtils::isValidAccountNumber("mtbs-1234-5678"),
+              "malformed account numbers must be rejected");
+static_assert(BankUtils::isValidEmail("jane.doe+bank@mail.example.com") && !BankUtils::isValidEmail("jane@example.c"),
+              "email rule mismatch");
+
 #endif // BANK_UTILS_H
 
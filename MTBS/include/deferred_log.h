@@ -0,0 +1,131 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AsyncFileWriter;
+
+/**
+ * @brief One log line before formatting: an event code and its raw arguments
+ *
+ * What format and the fields mean is up to the owner's renderer; the
+ * TransactionLogger stores account and description IDs (StringTable),
+ * amounts in cents and transaction numbers, so nothing is formatted or
+ * allocated on the caller's path. text, when set, is a message already
+ * formatted by the caller and owned by the record once pushed.
+ */
+struct LogRecord {
+    int64_t timeNs = 0;             // system_clock, set by DeferredLog::push
+    uint16_t format = 0;
+    uint8_t level = 0;
+    uint8_t flags = 0;
+    uint32_t ids[2] = {};
+    int64_t values[2] = {};
+    std::string* text = nullptr;
+};
+
+static_assert(sizeof(LogRecord) <= 48, "Log records must stay compact");
+
+/**
+ * @brief Per-thread rings of LogRecords, rendered to text by a background thread
+ *
+ * push() copies the record into a single-producer ring owned by the
+ * calling thread (the render thread is its only consumer): no lock, no
+ * formatting and no shared cache line, except for a flag that says whether
+ * the render thread is asleep. The render thread wakes when that flag is
+ * set, then works in passes kRenderWindow apart while records keep coming,
+ * turning each pass into one append to the output writer. A producer whose
+ * ring is full waits for the render thread rather than drop the record.
+ *
+ * Records of one thread are rendered in push order; lines of different
+ * threads interleave one pass at a time, as AsyncFileWriter's do.
+ *
+ * A thread's ring is retired when the thread exits. Once the render thread
+ * has drained it, the ring stops being scanned and is kept (up to
+ * kSpareRings) for the next thread that logs, or freed.
+ */
+class DeferredLog {
+public:
+    static constexpr size_t kRingRecords = 4096;    // Per thread; a power of two
+    static constexpr size_t kSpareRings = 4;        // Drained rings of exited threads kept for reuse
+    static constexpr std::chrono::microseconds kRenderWindow{1000};
+
+    // Appends the text for one record (newline included) to line
+    using Renderer = std::function<void(const LogRecord& record, std::string& line)>;
+
+    DeferredLog(AsyncFileWriter& output, Renderer renderer);
+    ~DeferredLog();     // Renders everything still queued
+
+    DeferredLog(const DeferredLog&) = delete;
+    DeferredLog& operator=(const DeferredLog&) = delete;
+
+    void push(LogRecord record);
+
+    // Returns once every record pushed before the call has been appended to the output
+    void flush();
+
+    // Statistics
+    uint64_t getRenderedRecords() const;
+    uint64_t getFullRingWaits() const;
+
+private:
+    struct alignas(64) Ring {
+        std::atomic<uint64_t> tail{0};              // Written by the producer
+        uint64_t cachedHead = 0;                    // Producer's last look at head
+        std::atomic<bool> retired{false};           // Producer exited after its last push
+        std::atomic<bool> orphaned{false};          // The log is gone; the producer may drop it
+        alignas(64) std::atomic<uint64_t> head{0};  // Written by the render thread
+        LogRecord records[kRingRecords];
+    };
+
+    // The calling thread's rings, one per log it pushed to; retired when the thread exits
+    struct LocalRings {
+        struct Lease {
+            uint64_t logId;
+            std::shared_ptr<Ring> ring;
+        };
+        std::vector<Lease> leases;
+        ~LocalRings();
+    };
+
+    AsyncFileWriter& output;
+    Renderer renderer;
+    uint64_t logId;                     // Distinguishes logs in thread-local caches
+
+    // Rings of live threads (and retired ones not yet drained), shared with their threads
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::vector<std::shared_ptr<Ring>> spareRings;
+
+    alignas(64) std::atomic<bool> rendererIdle;
+    std::atomic<uint64_t> renderedRecords;
+    std::atomic<uint64_t> fullRingWaits;
+
+    // Render thread coordination
+    std::mutex stateMutex;
+    std::condition_variable wakeRenderer;
+    std::condition_variable rendered;
+    bool wakeRequested;                 // By a producer that found the flag set or its ring full
+    uint64_t flushRequested;
+    uint64_t flushCompleted;
+    bool stopping;
+    std::thread renderThread;
+
+    Ring& localRing();
+    void wake();
+    void renderLoop();
+    bool anyQueued();
+    size_t renderPass(std::string& batch);
+};
+
+#endif // DEFERRED_LOG_H
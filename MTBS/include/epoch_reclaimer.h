@@ -0,0 +1,57 @@
+#ifndef EPOCH_RECLAIMER_H
+#define EPOCH_RECLAIMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Process-wide epoch-based reclamation
+ *
+ * Objects that readers may still reach without holding a reference (raw
+ * Account pointers in an AccountColumns::View, for instance) are retired
+ * rather than freed: retire() frees an object at once when no Pin could
+ * have seen it, and otherwise queues it until every Pin taken before it
+ * was retired has been released. Holding a Pin costs one store on a
+ * record of its own, instead of refcount traffic on every pointer copy.
+ *
+ * Pins are meant to be short-lived or few: a long-held Pin delays every
+ * reclamation behind it, and there are kPinRecords of them at most (a
+ * Pin waits for a record when all are taken). Pins are not tied to a
+ * thread and may be moved and released anywhere.
+ */
+class EpochReclaimer {
+public:
+    static constexpr size_t kPinRecords = 256;
+    static constexpr size_t kCollectEvery = 64;     // Retires per thread between collection passes
+
+    class Pin {
+    public:
+        Pin();
+        ~Pin();
+        Pin(Pin&& other) noexcept;
+        Pin& operator=(Pin&& other) noexcept;
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+
+    private:
+        std::atomic<uint64_t>* record;      // nullptr once released or moved from
+        void release() noexcept;
+    };
+
+    // Frees object with reclaim(object) once no Pin that might reach it remains
+    static void retire(void* object, void (*reclaim)(void*));
+
+    template <typename T>
+    static void retire(T* object) {
+        retire(object, [](void* pointer) { delete static_cast<T*>(pointer); });
+    }
+
+    // Frees whatever can be freed now (this thread's queue and orphaned ones)
+    static void collect();
+
+    // Retired objects still waiting, over all threads (approximate)
+    static size_t pendingCount();
+};
+
+#endif // EPOCH_RECLAIMER_H
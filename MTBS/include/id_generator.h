@@ -0,0 +1,55 @@
+#ifndef ID_GENERATOR_H
+#define ID_GENERATOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Process-wide generator of 64-bit, roughly time-ordered unique IDs
+ *
+ * Snowflake-style layout, most significant bit first:
+ *   1 bit  zero (IDs stay positive as int64)
+ *  40 bits milliseconds since kEpochMs (good until 2058)
+ *   5 bits node (set once per process, see setNode)
+ *   8 bits thread slot
+ *  10 bits sequence within the millisecond
+ *
+ * Each thread claims a slot on first use and releases it when it exits.
+ * A slot is its own cache line and is normally written by one thread only,
+ * so next() neither allocates nor contends. Threads beyond the slot count
+ * share the last slot, which stays correct but is contended.
+ *
+ * A slot never repeats a (millisecond, sequence) pair: when the sequence
+ * runs out, or the clock steps back, it borrows the following millisecond.
+ * IDs are therefore unique, but only ordered by time across threads to
+ * within a few milliseconds.
+ */
+class IdGenerator {
+public:
+    static constexpr int kSequenceBits = 10;
+    static constexpr int kSlotBits = 8;
+    static constexpr int kNodeBits = 5;
+    static constexpr int kTimeBits = 40;
+    static constexpr size_t kSlotCount = size_t(1) << kSlotBits;
+    static constexpr uint32_t kMaxNode = (1u << kNodeBits) - 1;
+    static constexpr uint64_t kEpochMs = 1704067200000ull;   // 2024-01-01T00:00:00Z
+
+    static uint64_t next();
+
+    // Node bits for IDs minted from now on (values above kMaxNode are masked)
+    static void setNode(uint32_t node);
+    static uint32_t getNode();
+
+    // Recovery: make every later ID compare greater than id (e.g. one read from disk)
+    static void observe(uint64_t id);
+
+    // An ID at least as large as any issued so far
+    static uint64_t highWatermark();
+
+    // Decoding
+    static std::chrono::system_clock::time_point timeOf(uint64_t id);
+    static uint32_t nodeOf(uint64_t id);
+};
+
+#endif // ID_GENERATOR_H
@@ -0,0 +1,166 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include "money.h"
+#include "account.h"
+#include "async_file_writer.h"
+
+class ReplicationLog;
+
+// What a journal record describes
+enum class JournalRecordKind : uint8_t {
+    ACCOUNT_OPENED = 1,
+    ACCOUNT_CLOSED = 2,
+    TRANSACTION = 3
+};
+
+/**
+ * @brief One replayable journal entry
+ *
+ * Records carry the balances after the change so that replaying a record
+ * is idempotent: recovery sets balances rather than re-applying amounts.
+ * Records are ordered by LSN; for any one account the LSN order is the
+ * order the changes were applied in.
+ */
+struct JournalRecord {
+    JournalRecordKind kind = JournalRecordKind::TRANSACTION;
+    uint64_t lsn = 0;                                   // Log sequence number, assigned by Journal::append
+    uint64_t transactionId = 0;                         // Transaction::id (ACCOUNT_OPENED: of the opening
+                                                        // deposit, 0 if none)
+    std::chrono::system_clock::time_point timestamp;
+    TransactionType type = TransactionType::DEPOSIT;
+    TransactionStatus status = TransactionStatus::SUCCESS;
+    uint8_t flags = 0;                                  // Transaction::FLAG_* bits
+    Money amount;
+    std::string account;                                // Account the record is about (transfer source)
+    Money balanceAfter;
+    std::string counterparty;                           // Transfer target, empty otherwise
+    Money counterpartyBalanceAfter;
+    std::string text;                                   // Holder name (ACCOUNT_OPENED) or description (TRANSACTION)
+};
+
+/**
+ * @brief Binary write-ahead journal of account changes
+ *
+ * Record layout (little-endian, byte offsets):
+ *    0  u32 record size in bytes, including this header
+ *    4  u32 CRC-32 of bytes [8, size)
+ *    8  u64 LSN
+ *   16  u64 transaction ID
+ *   24  i64 timestamp (nanoseconds since the epoch)
+ *   32  i64 amount (cents)
+ *   40  i64 balance after (cents)
+ *   48  i64 counterparty balance after (cents)
+ *   56  u8 kind, u8 type, u8 status, u8 flags
+ *   60  u16 account, counterparty and text lengths, u16 reserved
+ *   68  account, counterparty and text bytes
+ *
+ * append() is meant to be called while the account lock is held, so that
+ * LSNs follow the order of balance changes; it only copies bytes into a
+ * per-thread buffer. Waiting for durability (commitCurrentThread) should
+ * happen after the lock is released.
+ *
+ * The journal is a sequence of segment files "<basePath>.000001", ...;
+ * each process appends to a fresh segment. rotate() starts a new one so
+ * that segments covered by a snapshot can be deleted.
+ *
+ * A replication primary taps the journal (setReplicationLog): append()
+ * also hands each encoded record, with its LSN, to the ReplicationLog.
+ */
+class Journal {
+public:
+    static constexpr size_t kHeaderSize = 68;
+    static constexpr size_t kMaxStringLength = 4096;
+    static constexpr size_t kMaxRecordSize = kHeaderSize + 3 * kMaxStringLength;
+
+    struct Segment {
+        uint64_t number;
+        std::string path;
+    };
+
+    // Picks up numbering (segments and LSNs) after whatever basePath already holds
+    explicit Journal(const std::string& basePath,
+                     const AsyncFileWriter::Options& options = AsyncFileWriter::Options());
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Assigns the record's LSN, queues it and returns the LSN
+    uint64_t append(JournalRecord& record);
+
+    // Waits until every record this thread appended is durable (per the durability mode); false
+    // if the writer failed (AsyncFileWriter::getError) and they may not have reached the disk
+    bool commitCurrentThread();
+    uint64_t getCurrentThreadLsn() const;               // LSN of this thread's last record here, 0 if none
+
+    // Writes and syncs everything appended so far; false if the writer failed
+    bool flush();
+
+    // Recovery: continue numbering after an LSN seen elsewhere (e.g. a snapshot)
+    void advanceLsn(uint64_t lsn);
+    uint64_t getLastLsn() const;
+    uint64_t getHighestTransactionId() const;           // Highest Transaction::id in earlier segments
+
+    // Segments
+    uint64_t rotate();                                  // Returns the new segment's number, 0 on failure
+    uint64_t getCurrentSegment() const;
+    std::vector<Segment> listSegments() const;          // Oldest first, current one included
+    size_t removeSegmentsBefore(uint64_t segmentNumber);
+    static std::vector<Segment> listSegments(const std::string& basePath);
+    static std::string segmentPath(const std::string& basePath, uint64_t segmentNumber);
+
+    // Attach while nothing is appending (nullptr detaches); LSNs after getLastLsn() are passed on
+    void setReplicationLog(ReplicationLog* log);
+
+    std::string getBasePath() const;
+    std::string getPath() const;                        // Current segment
+    const AsyncFileWriter& getWriter() const;
+
+    // Serialization (exposed for the reader and for tools)
+    static void encode(const JournalRecord& record, std::string& out);
+    static bool decode(const char* data, size_t size, JournalRecord& record, size_t& consumed);
+    static uint32_t crc32(const char* data, size_t size);
+
+private:
+    std::string basePath;
+    std::atomic<uint64_t> currentSegment;
+    AsyncFileWriter writer;
+    uint64_t journalId;
+    std::mutex rotateMutex;
+    uint64_t highestTransactionId;
+    std::atomic<ReplicationLog*> replicationLog;
+    alignas(64) std::atomic<uint64_t> nextLsn;
+};
+
+/**
+ * @brief Sequential reader over a journal file, for replay
+ *
+ * Stops at the first truncated or corrupt record (a torn write at the end
+ * of the file after a crash) and reports it through hitCorruption().
+ */
+class JournalReader {
+public:
+    explicit JournalReader(const std::string& path);
+
+    bool isOpen() const;
+    bool next(JournalRecord& record);
+    bool hitCorruption() const;
+    size_t getRecordsRead() const;
+
+private:
+    std::vector<char> data;
+    size_t position;
+    size_t recordsRead;
+    bool opened;
+    bool corrupt;
+};
+
+#endif // JOURNAL_H
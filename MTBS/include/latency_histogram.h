@@ -0,0 +1,150 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Log-linear (HDR-style) latency histogram with per-thread recording
+ *
+ * Values are nanoseconds. Below 16 ns every value has its own bucket;
+ * above that each power of two is split into 16 linear sub-buckets, so a
+ * recorded value is known to within 1/16 (6.25%) of itself. Values past
+ * 2^40 ns (about 18 minutes) land in the top bucket.
+ *
+ * Each thread records into one of kShardCount shards, dealt round-robin,
+ * that sits on cache lines of its own; record() is three relaxed atomic
+ * adds on lines no other thread normally touches. Shards are allocated on
+ * first use and merged only when a snapshot is read.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr int kMaxMagnitude = 40;
+    static constexpr size_t kBucketCount = (kMaxMagnitude - kSubBucketBits + 2) * kSubBuckets;
+    static constexpr size_t kShardCount = 32;
+
+    // Merged counts, as of the moment each shard was read
+    struct Snapshot {
+        std::vector<uint64_t> counts;           // Per bucket
+        uint64_t count = 0;
+        uint64_t sumNanos = 0;
+        uint64_t maxNanos = 0;
+
+        // Upper bound of the bucket holding the given percentile (0..100); 0 when empty
+        uint64_t percentile(double percent) const;
+        double meanNanos() const;
+        void merge(const Snapshot& other);
+    };
+
+    LatencyHistogram();
+    ~LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t nanos);
+    Snapshot snapshot() const;
+    void reset();                               // Not atomic with respect to concurrent record()
+
+    static size_t bucketOf(uint64_t nanos);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> counts[kBucketCount];
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> max;
+
+        Shard();
+    };
+
+    std::atomic<Shard*> shards[kShardCount];
+
+    Shard& localShard();
+};
+
+// What a process-wide latency histogram measures
+enum class LatencyStage : size_t {
+    DEPOSIT,                    // Bank::processDeposit, end to end
+    WITHDRAW,
+    TRANSFER,
+    BATCH_TRANSFER,
+    ACCOUNT_LOCK_WAIT,          // Waiting for an accountMutex (0 when it was free)
+    DIRECTORY_LOCK_WAIT,        // Waiting for an AccountDirectory shard lock (0 when it was free)
+    WORK_QUEUE_DWELL,           // Enqueue to dequeue in WorkQueue
+    TRANSACTION_QUEUE_DWELL,    // Enqueue to dequeue in TransactionQueue
+    JOURNAL_COMMIT,             // Waiting for the journal to make this thread's records durable
+    LOG_WRITE,                  // TransactionLogger::logMessage: copying the message for the render thread
+    REPLICATION_ACK,            // QUORUM replication: waiting for followers to apply this thread's records
+    COUNT
+};
+
+/**
+ * @brief The process-wide histograms, one per LatencyStage
+ *
+ * Recording is on by default; setEnabled(false) makes ScopedLatency skip
+ * even the clock reads.
+ */
+namespace LatencyStats {
+    LatencyHistogram& histogram(LatencyStage stage);
+    const char* stageName(LatencyStage stage);          // "deposit", "account_lock_wait", ...
+
+    void record(LatencyStage stage, uint64_t nanos);
+    void record(LatencyStage stage, std::chrono::steady_clock::duration elapsed);
+    void recordSince(LatencyStage stage, std::chrono::system_clock::time_point start);  // Queue timestamps
+
+    bool isEnabled();
+    void setEnabled(bool enabled);
+    void reset();
+
+    // Stages with at least one sample: text lines with count, mean, p50/p90/p99/p99.9 and max,
+    // and a JSON object {"stage": {"count":..,"mean_ns":..,"p50_ns":..,...}, ...}
+    std::string report();
+    std::string toJson();
+}
+
+/**
+ * @brief Records the lifetime of the enclosing scope into a stage's histogram
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyStage stage)
+        : stage(stage), active(LatencyStats::isEnabled()) {
+        if (active) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedLatency() {
+        if (active) {
+            LatencyStats::record(stage, std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyStage stage;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Locks a deferred lock, timing the wait only when the lock was not free
+template <typename Lock>
+void lockRecordingWait(Lock& lock, LatencyStage stage) {
+    if (lock.try_lock()) {
+        LatencyStats::record(stage, uint64_t(0));
+        return;
+    }
+    ScopedLatency wait(stage);
+    lock.lock();
+}
+
+#endif // LATENCY_HISTOGRAM_H
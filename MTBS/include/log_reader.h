@@ -0,0 +1,139 @@
+#ifndef LOG_READER_H
+#define LOG_READER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Pages are loaded on demand by the OS, so scanning part of a multi-GB log
+ * only touches that part.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+/**
+ * @brief Sparse index over a text log, kept on disk next to it ("<log>.idx")
+ *
+ * The log is cut into blocks of about kBlockSize bytes at line boundaries.
+ * Per block the index keeps the range of timestamps and of transaction
+ * numbers ("DEP_42" -> 42) it contains, plus a posting list of the
+ * blocks each account number appears in. A lookup yields the few blocks
+ * that can contain a match; only those are scanned.
+ *
+ * The index covers complete blocks only and is extended incrementally as
+ * the log grows. It is rebuilt if the log was replaced or truncated.
+ */
+class LogIndex {
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    struct Block {
+        uint64_t begin;
+        uint64_t end;
+        uint64_t minTime;          // Timestamps as YYYYMMDDhhmmss, 0 if none
+        uint64_t maxTime;
+        uint64_t minTransaction;   // Transaction numbers, UINT64_MAX/0 if none
+        uint64_t maxTransaction;
+    };
+
+    // Loads indexPath if it matches the log, then indexes whatever is new
+    void open(const std::string& indexPath, const char* log, size_t size);
+    bool save(const std::string& indexPath) const;
+    bool wasUpdated() const { return updated; }
+
+    uint64_t indexedBytes() const { return covered; }
+    const std::vector<Block>& blocks() const { return blockList; }
+
+    // Candidate blocks (indices into blocks()); nullptr or empty when nothing can match
+    const std::vector<uint32_t>* blocksForAccount(const std::string& accountNumber) const;
+    std::vector<uint32_t> blocksForTransaction(uint64_t transactionNumber) const;
+    std::vector<uint32_t> blocksForTime(uint64_t fromTime, uint64_t toTime) const;
+
+    // Token classification shared with the reader
+    static bool isAccountToken(const char* token, size_t length);
+    static bool parseTransactionToken(const char* token, size_t length, uint64_t& number);
+    static uint64_t parseLineTime(const char* line, size_t length);
+
+private:
+    std::vector<Block> blockList;
+    std::unordered_map<std::string, std::vector<uint32_t>> accountBlocks;
+    uint64_t covered = 0;
+    uint64_t fingerprint = 0;     // Hash of the log's first bytes, detects a replaced file
+    bool updated = false;
+
+    void extend(const char* log, size_t size);
+    void indexLine(const char* line, size_t length, Block& block, uint32_t blockNumber);
+    bool load(const std::string& indexPath, const char* log, size_t size);
+    static uint64_t fingerprintOf(const char* log, size_t size);
+};
+
+/**
+ * @brief Fast queries over a (possibly multi-GB) text log without loading it
+ *
+ * readLast scans backwards from the end of the mapping. search uses the
+ * sparse index when the term is an account number or transaction ID and
+ * otherwise falls back to a vectorised substring scan. Lines are returned
+ * in file (chronological) order.
+ */
+class LogReader {
+public:
+    using LineFilter = std::function<bool(const char* line, size_t length)>;
+
+    explicit LogReader(const std::string& logPath);
+
+    bool isOpen() const;
+    size_t size() const;
+
+    // Builds or extends "<log>.idx" (and saves it) before indexed queries
+    void useIndex();
+
+    std::vector<std::string> readLast(size_t count, const LineFilter& filter = LineFilter()) const;
+    std::vector<std::string> search(const std::string& term, size_t limit = SIZE_MAX,
+                                    const LineFilter& filter = LineFilter()) const;
+
+    // Timestamps as YYYYMMDDhhmmss (the log's local time), inclusive
+    std::vector<std::string> findBetween(uint64_t fromTime, uint64_t toTime,
+                                         const LineFilter& filter = LineFilter()) const;
+
+    // First occurrence of needle in [begin, end), or nullptr (SSE2 where available)
+    static const char* findSubstring(const char* begin, const char* end, const char* needle, size_t length);
+
+private:
+    std::string path;
+    MappedFile file;
+    LogIndex index;
+    bool indexed;
+
+    // Byte ranges to scan for a term: candidate blocks plus the unindexed tail
+    std::vector<std::pair<uint64_t, uint64_t>> rangesFor(const std::string& term) const;
+    void scanRange(uint64_t begin, uint64_t end, const std::string& term, size_t limit,
+                   const LineFilter& filter, std::vector<std::string>& out) const;
+};
+
+#endif // LOG_READER_H
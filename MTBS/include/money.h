@@ -0,0 +1,80 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <ostream>
+#include <limits>
+#include <type_traits>
+
+/**
+ * @brief Fixed-point monetary amount stored as an integer number of cents
+ *
+ * All balances and transaction amounts use this type instead of double so
+ * that arithmetic is exact and comparisons such as "balance is zero" are
+ * meaningful. Every arithmetic operator checks for 64-bit overflow and
+ * throws std::overflow_error rather than silently wrapping.
+ */
+class Money {
+public:
+    constexpr Money() noexcept : cents(0) {}
+
+    // Construction
+    static constexpr Money fromCents(int64_t value) noexcept { return Money(value); }
+    static Money fromDollars(int64_t dollars, int64_t extraCents = 0);
+    static Money fromDouble(double amount);
+
+    // Conversion
+    constexpr int64_t toCents() const noexcept { return cents; }
+    double toDouble() const noexcept { return static_cast<double>(cents) / 100.0; }
+    std::string toString() const;
+
+    // Checked arithmetic (throws std::overflow_error)
+    Money operator+(Money other) const;
+    Money operator-(Money other) const;
+    Money operator-() const;
+    Money& operator+=(Money other);
+    Money& operator-=(Money other);
+    Money multipliedBy(int64_t factor) const;
+
+    // Non-throwing variants; return false on overflow and leave result untouched
+    static bool tryAdd(Money a, Money b, Money& result) noexcept;
+    static bool trySubtract(Money a, Money b, Money& result) noexcept;
+
+    // Comparison
+    constexpr bool operator==(Money other) const noexcept { return cents == other.cents; }
+    constexpr bool operator!=(Money other) const noexcept { return cents != other.cents; }
+    constexpr bool operator<(Money other) const noexcept { return cents < other.cents; }
+    constexpr bool operator<=(Money other) const noexcept { return cents <= other.cents; }
+    constexpr bool operator>(Money other) const noexcept { return cents > other.cents; }
+    constexpr bool operator>=(Money other) const noexcept { return cents >= other.cents; }
+
+    constexpr bool isZero() const noexcept { return cents == 0; }
+    constexpr bool isPositive() const noexcept { return cents > 0; }
+    constexpr bool isNegative() const noexcept { return cents < 0; }
+
+    /**
+     * @brief Exact total of many amounts (batch reconciliation kernel)
+     *
+     * Sums blocks with plain integer adds that the compiler vectorises and
+     * only falls back to per-element adds into a 128-bit total for blocks
+     * containing values large enough to overflow. Partial sums may leave the
+     * 64-bit range; throws std::overflow_error only if the exact total does
+     * not fit in 64 bits.
+     */
+    static Money sum(const Money* values, size_t count);
+    static Money sumCents(const int64_t* cents, size_t count);
+
+private:
+    explicit constexpr Money(int64_t value) noexcept : cents(value) {}
+
+    int64_t cents;
+};
+
+static_assert(std::is_trivially_copyable<Money>::value, "Money must stay trivially copyable");
+static_assert(sizeof(Money) == sizeof(int64_t), "Money must be layout-compatible with int64_t");
+
+std::ostream& operator<<(std::ostream& os, Money amount);
+
+#endif // MONEY_H
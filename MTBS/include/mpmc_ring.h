@@ -0,0 +1,223 @@
+#ifndef MPMC_RING_H
+#define MPMC_RING_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Bounded lock-free multi-producer / multi-consumer ring buffer
+ *
+ * Each cell carries a sequence number that tells producers and consumers
+ * whether it is free or filled for their lap of the ring (Vyukov's bounded
+ * MPMC queue). Push and pop are one CAS on the shared position plus one
+ * store on the cell. Capacity is rounded up to a power of two.
+ *
+ * tryPush/tryPop never block. push/pop apply a BackpressurePolicy when the
+ * ring is full (or empty): a mutex and condition variable are only touched
+ * by threads that actually have to park, and by the thread that wakes them.
+ */
+
+// What a producer (or consumer) does when the ring is full (or empty)
+enum class BackpressurePolicy {
+    BLOCK,           // Park until space (or an item) is available
+    SPIN_THEN_PARK,  // Spin briefly first; cheaper when the wait is short
+    REJECT           // Return false immediately
+};
+
+template <typename T>
+class MpmcRing {
+public:
+    explicit MpmcRing(size_t requestedCapacity)
+        : enqueuePos(0), dequeuePos(0) {
+        size_t capacity = 2;
+        while (capacity < requestedCapacity) {
+            capacity <<= 1;
+        }
+        mask = capacity - 1;
+        cells.reset(new Cell[capacity]);
+        for (size_t i = 0; i < capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    static constexpr int kSpinAttempts = 64;
+
+    // Returns false if the ring is full
+    template <typename U>
+    bool tryPush(U&& value) {
+        if (!pushSlot(std::forward<U>(value))) {
+            return false;
+        }
+        wake(waitingConsumers, notEmpty);
+        return true;
+    }
+
+    // Returns false if the ring is empty
+    bool tryPop(T& out) {
+        if (!popSlot(out)) {
+            return false;
+        }
+        wake(waitingProducers, notFull);
+        return true;
+    }
+
+    // Returns false if rejected (REJECT policy) or the ring was closed
+    template <typename U>
+    bool push(U&& value, BackpressurePolicy policy = BackpressurePolicy::BLOCK) {
+        for (int attempt = 0; ; ++attempt) {
+            if (closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+            if (tryPush(std::forward<U>(value))) { // Only consumes value on success
+                return true;
+            }
+            if (policy == BackpressurePolicy::REJECT) {
+                return false;
+            }
+            if (policy == BackpressurePolicy::SPIN_THEN_PARK && attempt < kSpinAttempts) {
+                std::this_thread::yield();
+                continue;
+            }
+            park(waitingProducers, notFull, [this]() { return queuedSeqCst() < capacity(); });
+        }
+    }
+
+    // Returns false if nothing is available (REJECT policy) or the ring is closed and drained
+    bool pop(T& out, BackpressurePolicy policy = BackpressurePolicy::BLOCK) {
+        for (int attempt = 0; ; ++attempt) {
+            if (tryPop(out)) {
+                return true;
+            }
+            if (policy == BackpressurePolicy::REJECT || closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+            if (policy == BackpressurePolicy::SPIN_THEN_PARK && attempt < kSpinAttempts) {
+                std::this_thread::yield();
+                continue;
+            }
+            park(waitingConsumers, notEmpty, [this]() { return queuedSeqCst() > 0; });
+        }
+    }
+
+    // Wakes every parked thread; later pushes fail, pops drain what is left
+    void close() {
+        closed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(parkMutex);
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return mask + 1; }
+
+    // Approximate under concurrent use
+    size_t sizeApprox() const {
+        size_t tail = enqueuePos.load(std::memory_order_relaxed);
+        size_t head = dequeuePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    template <typename U>
+    bool pushSlot(U&& value) {
+        size_t position = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::forward<U>(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool popSlot(T& out) {
+        size_t position = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0) {
+                if (dequeuePos.compare_exchange_weak(position, position + 1, std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        cell->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Position CASes, waiter counts and these loads are all seq_cst (free on
+    // x86, where the CAS is already a full barrier), so either the waker
+    // sees a parked waiter or the waiter sees the waker's update
+    size_t queuedSeqCst() const {
+        size_t tail = enqueuePos.load(std::memory_order_seq_cst);
+        size_t head = dequeuePos.load(std::memory_order_seq_cst);
+        return tail > head ? tail - head : 0;
+    }
+
+    template <typename Ready>
+    void park(std::atomic<size_t>& waiters, std::condition_variable& condition, Ready ready) {
+        std::unique_lock<std::mutex> lock(parkMutex);
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        condition.wait(lock, [this, &ready]() { return ready() || closed.load(std::memory_order_acquire); });
+        waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void wake(std::atomic<size_t>& waiters, std::condition_variable& condition) {
+        if (waiters.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            condition.notify_one();
+        }
+    }
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+
+    // Producers and consumers each get their own cache line
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+
+    // Slow path only
+    alignas(64) std::atomic<size_t> waitingProducers{0};
+    std::atomic<size_t> waitingConsumers{0};
+    std::atomic<bool> closed{false};
+    std::mutex parkMutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
+
+#endif // MPMC_RING_H
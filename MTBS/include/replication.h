@@ -0,0 +1,338 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "journal.h"
+
+// What a Bank is in a replication group
+enum class ReplicationRole : uint8_t {
+    STANDALONE,
+    PRIMARY,            // Takes writes and streams its journal to followers
+    FOLLOWER            // Read-only copy of a primary, until promoted
+};
+
+// When a primary's commit (Bank::commitJournal) returns
+enum class ReplicationAckMode : uint8_t {
+    ASYNC,              // Once durable locally; followers catch up behind it
+    QUORUM              // Once a quorum of followers has also applied it (or the ack timeout passed)
+};
+
+const char* replicationRoleName(ReplicationRole role);          // "STANDALONE", "PRIMARY", "FOLLOWER"
+const char* replicationAckModeName(ReplicationAckMode mode);    // "ASYNC", "QUORUM"
+
+/**
+ * @brief The journal's records in LSN order, on their way to the followers
+ *
+ * Journal::append publishes every encoded record into the slot its LSN
+ * maps to, so appends from any thread go in without a lock, and one drain
+ * (the shipper) takes out the records whose LSNs have all arrived. A
+ * publisher that gets a whole ring ahead of the shipper waits for room.
+ *
+ * drain() never ends inside a batch transfer: a follower applies the legs
+ * of one Account::transferBatch together, as the primary did. Only a batch
+ * larger than the ring is let out in parts.
+ */
+class ReplicationLog {
+public:
+    explicit ReplicationLog(size_t capacity = 1 << 16);    // Rounded up to a power of two
+
+    ReplicationLog(const ReplicationLog&) = delete;
+    ReplicationLog& operator=(const ReplicationLog&) = delete;
+
+    // Before the log is attached: the next record published is lastLsn + 1
+    void reset(uint64_t lastLsn);
+
+    void publish(uint64_t lsn, const char* data, size_t size);
+
+    // Appends up to maxRecords whole records (more to finish a batch transfer) to out; returns the count
+    size_t drain(std::string& out, uint64_t& firstLsn, uint64_t& lastLsn, size_t maxRecords);
+    uint64_t getDrainedLsn() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};      // Position + 1 once published, + capacity once drained
+        std::string bytes;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    size_t mask;
+    uint64_t baseLsn;                           // LSN of position 0, minus one
+    alignas(64) std::atomic<uint64_t> drainPosition;
+    std::vector<uint64_t> openBatches;          // Drain scratch: batch transfers without their last leg yet
+};
+
+/**
+ * @brief Replication primary: ships the journal to followers over TCP
+ *
+ * A shipper thread drains the ReplicationLog every batchWindow (at once
+ * when a quorum commit is waiting) into RECORDS frames, encoded once and
+ * kept in a window shared by every follower connection. Each connection
+ * has a sender, which streams the window without waiting for acks (they
+ * are read by a second thread), so several batches are in flight at once.
+ * A batch leaves the window when every follower has been sent it; one
+ * that would push it past maxWindowBytes drops the followers still short
+ * of it, which then reconnect and bootstrap again. With no followers the
+ * shipper drains and discards.
+ *
+ * A follower starts with a bootstrap: the SnapshotSource hook marks a cut
+ * in the stream (the journal's last LSN, taken while no account is being
+ * opened or closed) and then emits every account, as an ACCOUNT_OPENED
+ * record carrying its balance and journal position, followed by its
+ * history as TRANSACTION records with LSN 0 (in the same SNAPSHOT_CHUNK).
+ * Streaming resumes right after the cut; the follower skips whatever its
+ * accounts already reflect.
+ *
+ * In QUORUM mode waitForQuorum holds a commit until `quorum` followers have
+ * applied its LSN. With fewer followers streaming, or once a wait has timed
+ * out, commits stop waiting (degraded) until the followers catch up.
+ *
+ * Frames are little-endian: u32 payload length, u8 type, payload.
+ *   HELLO           follower -> primary   "MTBR"
+ *   SNAPSHOT_BEGIN  primary -> follower   u64 cut LSN
+ *   SNAPSHOT_CHUNK                        encoded records (Journal::encode)
+ *   SNAPSHOT_END                          u64 accounts sent
+ *   RECORDS                               u64 first LSN, u64 last LSN, u64 primary LSN,
+ *                                         i64 shipped at (ns since the epoch), u32 count,
+ *                                         encoded records (none: a heartbeat)
+ *   ACK             follower -> primary   u64 applied LSN
+ *
+ * Linux only (sockets); start() throws a BankException elsewhere.
+ */
+class ReplicationServer {
+public:
+    struct Options {
+        std::string bindAddress = "127.0.0.1";
+        uint16_t port = 7070;                               // 0: any free port (see getPort)
+        ReplicationAckMode ackMode = ReplicationAckMode::ASYNC;
+        size_t quorum = 1;                                  // Followers that must apply a commit (QUORUM)
+        std::chrono::milliseconds ackTimeout{500};
+        std::chrono::microseconds batchWindow{1000};        // How long records gather before shipping
+        size_t maxBatchRecords = 4096;
+        size_t maxWindowBytes = 64 << 20;
+        size_t ringCapacity = 1 << 16;
+        std::chrono::milliseconds heartbeatInterval{1000};
+    };
+
+    // Called on a follower's connection thread: cut() once, then emit() per record
+    using SnapshotSource = std::function<void(const std::function<uint64_t()>& cut,
+                                              const std::function<void(const JournalRecord&)>& emit)>;
+
+    struct FollowerStatus {
+        std::string peer;
+        bool streaming = false;                 // Bootstrapped
+        uint64_t sentLsn = 0;
+        uint64_t ackedLsn = 0;
+        uint64_t lagRecords = 0;                // Journalled on the primary, not acknowledged
+        std::chrono::milliseconds lag{0};       // Age of the oldest batch it has not acknowledged
+    };
+
+    struct Statistics {
+        uint64_t shippedLsn = 0;
+        uint64_t batches = 0;
+        uint64_t records = 0;
+        uint64_t bytes = 0;
+        uint64_t bootstraps = 0;
+        uint64_t droppedFollowers = 0;          // Fell out of the window
+        uint64_t quorumWaits = 0;
+        uint64_t quorumTimeouts = 0;
+        bool degraded = false;
+        std::vector<FollowerStatus> followers;
+    };
+
+    // Attaches the journal tap at once: every later record is shipped
+    ReplicationServer(Journal& journal, const Options& options, SnapshotSource source);
+    ~ReplicationServer();      // stop(), and detaches the tap
+
+    ReplicationServer(const ReplicationServer&) = delete;
+    ReplicationServer& operator=(const ReplicationServer&) = delete;
+
+    // Listens for followers; throws BankException (SYSTEM_ERROR) if the socket cannot be set up
+    void start();
+    void stop();                // Disconnects every follower (the shipper keeps draining)
+    bool isRunning() const;
+    uint16_t getPort() const;
+
+    // QUORUM: blocks until the quorum has applied lsn; false if it did not (degraded, timed out)
+    bool waitForQuorum(uint64_t lsn);
+
+    const Options& getOptions() const;
+    Statistics getStatistics() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Batch {
+        uint64_t firstLsn;
+        uint64_t lastLsn;
+        std::shared_ptr<const std::string> frame;
+        Clock::time_point shippedAt;
+    };
+
+    struct Session {
+        int fd = -1;
+        std::string peer;
+        std::thread sender;
+        std::thread reader;
+        std::atomic<bool> closed{false};
+        std::atomic<bool> finished{false};      // Both threads are done
+        bool registered = false;                // Past the bootstrap cut (under mutex)
+        bool streaming = false;
+        uint64_t nextLsn = 0;                   // Next LSN to send (under mutex)
+        std::atomic<uint64_t> sentLsn{0};
+        std::atomic<uint64_t> ackedLsn{0};
+        std::deque<std::pair<uint64_t, Clock::time_point>> unacked;     // Sent batches (under mutex)
+    };
+
+    Journal& journal;
+    Options options;
+    SnapshotSource source;
+    ReplicationLog log;
+    int listenFd;
+    uint16_t boundPort;
+    std::atomic<bool> running;
+    std::thread listener;
+
+    // Window, sessions and acks
+    mutable std::mutex mutex;
+    std::condition_variable windowChanged;
+    std::condition_variable acksChanged;
+    std::deque<Batch> window;
+    size_t windowBytes;
+    std::vector<std::shared_ptr<Session>> sessions;
+    std::atomic<uint64_t> quorumLsn;            // Highest LSN the quorum has applied
+    std::atomic<size_t> streamingFollowers;
+    std::atomic<bool> degraded;
+    uint64_t degradedAt;                        // Degraded until the quorum has applied this (under mutex)
+
+    // Shipper
+    std::thread shipper;
+    std::mutex shipperMutex;
+    std::condition_variable shipperWake;
+    bool shipperStop;
+    bool shipperNudged;
+
+    // Statistics
+    std::atomic<uint64_t> batchesShipped;
+    std::atomic<uint64_t> recordsShipped;
+    std::atomic<uint64_t> bytesShipped;
+    std::atomic<uint64_t> bootstraps;
+    std::atomic<uint64_t> droppedFollowers;
+    std::atomic<uint64_t> quorumWaits;
+    std::atomic<uint64_t> quorumTimeouts;
+
+    void shipLoop();
+    void acceptLoop();
+    void sendLoop(const std::shared_ptr<Session>& session);
+    void ackLoop(const std::shared_ptr<Session>& session);
+    bool bootstrap(Session& session);
+    void closeSession(Session& session);
+    void reapSessions(bool all);
+    void trimWindowLocked();
+    void updateQuorumLocked();
+};
+
+/**
+ * @brief Replication follower: receives a primary's journal and applies it
+ *
+ * A receiver thread connects, reads frames and queues them; an applier
+ * thread hands each one to the ApplyHook and acknowledges the last LSN of
+ * every batch it has applied. The receiver reads the next batches while
+ * the applier works, and the TCP connection holds the primary back only
+ * when maxQueuedFrames are waiting. On every (re)connection the primary
+ * bootstraps the follower from scratch: the ResetHook runs first.
+ */
+class ReplicationFollower {
+public:
+    struct Options {
+        std::string primaryAddress = "127.0.0.1";
+        uint16_t primaryPort = 7070;
+        std::chrono::milliseconds reconnectDelay{500};
+        size_t maxQueuedFrames = 64;
+    };
+
+    using ResetHook = std::function<void(uint64_t cutLsn)>;
+    // Records of one frame, in LSN order; bootstrap records follow SnapshotSource's layout
+    using ApplyHook = std::function<void(std::vector<JournalRecord>& records, bool bootstrap)>;
+
+    struct Statistics {
+        bool connected = false;
+        bool streaming = false;                 // Bootstrapped and following the stream
+        uint64_t appliedLsn = 0;
+        uint64_t primaryLsn = 0;                // Latest LSN the primary reported
+        uint64_t lagRecords = 0;
+        std::chrono::milliseconds applyDelay{0};   // Shipped to applied, latest batch (wall clocks)
+        uint64_t batches = 0;
+        uint64_t records = 0;
+        uint64_t bootstraps = 0;
+        uint64_t connections = 0;
+    };
+
+    ReplicationFollower(const Options& options, ResetHook reset, ApplyHook apply);
+    ~ReplicationFollower();    // stop()
+
+    ReplicationFollower(const ReplicationFollower&) = delete;
+    ReplicationFollower& operator=(const ReplicationFollower&) = delete;
+
+    void start();
+    void stop();                // Waits for the frame being applied; drops the queued ones
+    bool isRunning() const;
+
+    // Highest LSN any applied record or bootstrapped account carried (a promoted follower continues from it)
+    uint64_t getHighestLsn() const;
+    const Options& getOptions() const;
+    Statistics getStatistics() const;
+
+private:
+    // A frame as read, or (type 0) the end of its connection: the applier closes fd then
+    struct Frame {
+        uint8_t type;
+        std::string payload;
+        int fd;                                 // Connection it came on (acks go back there)
+    };
+
+    Options options;
+    ResetHook reset;
+    ApplyHook apply;
+    std::atomic<bool> running;
+    std::atomic<bool> stopping;
+    std::mutex socketMutex;
+    int socketFd;                               // Live connection, for stop() (under socketMutex)
+    std::thread receiver;
+    std::thread applier;
+
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<Frame> queue;
+    bool receiverDone;                          // No more frames (under queueMutex)
+
+    std::atomic<bool> connected;
+    std::atomic<bool> streaming;
+    std::atomic<uint64_t> appliedLsn;
+    std::atomic<uint64_t> primaryLsn;
+    std::atomic<uint64_t> highestLsn;
+    uint64_t bootstrapCut;                      // Applier only
+    std::atomic<int64_t> applyDelayNs;
+    std::atomic<uint64_t> batchesApplied;
+    std::atomic<uint64_t> recordsApplied;
+    std::atomic<uint64_t> bootstrapsApplied;
+    std::atomic<uint64_t> connections;
+
+    void receiveLoop();
+    void applyLoop();
+    bool enqueue(Frame frame);              // Waits for room; false once stopping
+    void applyFrame(Frame& frame);
+};
+
+#endif // REPLICATION_H
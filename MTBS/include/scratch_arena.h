@@ -0,0 +1,95 @@
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Per-thread bump allocator for operation-scoped temporaries
+ *
+ * Audit lines, lookup tables and result buffers that live only for the
+ * length of one operation are allocated by bumping a pointer through
+ * 64 KiB blocks that the thread keeps for its lifetime; nothing is freed
+ * individually. An ArenaScope remembers the position on entry and rewinds
+ * to it on exit, so scopes nest (a completion callback that starts another
+ * operation on the same thread just allocates after its caller).
+ *
+ * Use it through std::pmr containers and strings. Anything allocated in a
+ * scope must be gone, or copied out, before the scope ends.
+ */
+class ScratchArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    static ScratchArena& local();       // The calling thread's arena
+
+    ScratchArena() : current(0), offset(0) {}
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    Mark mark() const noexcept { return {current, offset}; }
+    void rewind(Mark position) noexcept;
+    size_t reservedBytes() const noexcept;  // Held by this thread's blocks
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current;                     // Block being bumped through
+    size_t offset;                      // Next free byte in it
+
+    void* carve(Block& block, size_t bytes, size_t alignment) noexcept;   // From offset on, or nullptr
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}   // Released by rewind
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/**
+ * @brief Rewinds the thread's ScratchArena to where it was on construction
+ */
+class ArenaScope {
+public:
+    ArenaScope() : arena(ScratchArena::local()), start(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(start); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    std::pmr::memory_resource* resource() noexcept { return &arena; }
+
+    // The parts (anything convertible to std::string_view) joined into one arena string
+    template <typename... Parts>
+    std::pmr::string concat(const Parts&... parts) {
+        const std::string_view views[] = {std::string_view(parts)...};
+        size_t length = 0;
+        for (std::string_view view : views) {
+            length += view.size();
+        }
+        std::pmr::string result(resource());
+        result.reserve(length);
+        for (std::string_view view : views) {
+            result.append(view.data(), view.size());
+        }
+        return result;
+    }
+
+private:
+    ScratchArena& arena;
+    ScratchArena::Mark start;
+};
+
+#endif // SCRATCH_ARENA_H
@@ -0,0 +1,77 @@
+#ifndef SHARDED_COUNTER_H
+#define SHARDED_COUNTER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ShardedCounterSlots {
+    constexpr size_t kSlotCount = 32;
+
+    // This thread's slot (0..kSlotCount-1), dealt round-robin on first use
+    size_t threadSlot();
+}
+
+/**
+ * @brief A fixed set of N event counters, sharded per thread
+ *
+ * Each thread adds into its own slot, which sits on cache lines no other
+ * slot shares, so counters bumped on every operation by every core do not
+ * bounce a line between them. Reads sum the slots, and so are slower and
+ * only approximately consistent across counters while writers run; they
+ * are meant for monitoring, not for decisions.
+ *
+ * Keeping all N counters in one slot means an operation that bumps several
+ * (its type, its outcome, its failure reason) touches one line, not N.
+ */
+template <size_t N>
+class ShardedCounters {
+public:
+    ShardedCounters() {
+        reset();
+    }
+
+    ShardedCounters(const ShardedCounters&) = delete;
+    ShardedCounters& operator=(const ShardedCounters&) = delete;
+
+    void add(size_t counter, uint64_t delta = 1) {
+        slots[ShardedCounterSlots::threadSlot()].values[counter].fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    uint64_t get(size_t counter) const {
+        uint64_t total = 0;
+        for (const Slot& slot : slots) {
+            total += slot.values[counter].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // Every counter, in one pass over the slots
+    std::array<uint64_t, N> snapshot() const {
+        std::array<uint64_t, N> totals{};
+        for (const Slot& slot : slots) {
+            for (size_t counter = 0; counter < N; ++counter) {
+                totals[counter] += slot.values[counter].load(std::memory_order_relaxed);
+            }
+        }
+        return totals;
+    }
+
+    void reset() {                              // Not atomic with respect to concurrent add()
+        for (Slot& slot : slots) {
+            for (std::atomic<uint64_t>& value : slot.values) {
+                value.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> values[N];
+    };
+
+    Slot slots[ShardedCounterSlots::kSlotCount];
+};
+
+#endif // SHARDED_COUNTER_H
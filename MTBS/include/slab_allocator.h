@@ -0,0 +1,172 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Fixed-size slot allocator carving objects out of 64 KiB slabs
+ *
+ * Each thread carves slots from a slab of its own, so objects it creates
+ * one after another sit next to each other in memory, and keeps freed slots
+ * in a private cache that it reuses first. Only when that cache overflows
+ * or runs dry does a thread take the pool lock, to hand over or pick up a
+ * batch of kBatch free slots at once.
+ *
+ * Slabs are never returned to the system: the pool's footprint is its
+ * high-water mark. There is one pool per (size, alignment), created on
+ * first use and never destroyed, so slots may still be freed during static
+ * destruction.
+ */
+template <size_t SlotSize, size_t SlotAlign>
+class SlabPool {
+public:
+    static constexpr size_t kSlabBytes = 64 * 1024;
+    static constexpr size_t kBatch = 64;
+
+    static SlabPool& instance() {
+        static SlabPool* pool = new SlabPool();
+        return *pool;
+    }
+
+    void* allocate() {
+        ThreadCache& cache = localCache();
+        if (!cache.free && cache.bump == cache.bumpEnd) {
+            refill(cache);
+        }
+        if (cache.free) {
+            FreeSlot* slot = cache.free;
+            cache.free = slot->next;
+            --cache.count;
+            return slot;
+        }
+        void* slot = cache.bump;
+        cache.bump += kSlot;
+        return slot;
+    }
+
+    void deallocate(void* pointer) noexcept {
+        ThreadCache& cache = localCache();
+        FreeSlot* slot = static_cast<FreeSlot*>(pointer);
+        slot->next = cache.free;
+        cache.free = slot;
+        if (++cache.count >= 2 * kBatch) {
+            // Hand the oldest kBatch slots over, keeping the recently freed (cache-warm) ones
+            FreeSlot* last = cache.free;
+            for (size_t i = 1; i < kBatch; ++i) {
+                last = last->next;
+            }
+            FreeSlot* batch = last->next;
+            last->next = nullptr;
+            cache.count = kBatch;
+            returnBatch(batch, kBatch);
+        }
+    }
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    static constexpr size_t kAlign = SlotAlign < alignof(FreeSlot) ? alignof(FreeSlot) : SlotAlign;
+    static constexpr size_t kSlot = ((SlotSize < sizeof(FreeSlot) ? sizeof(FreeSlot) : SlotSize) + kAlign - 1)
+                                    / kAlign * kAlign;
+    static constexpr size_t kSlotsPerSlab = kSlabBytes / kSlot ? kSlabBytes / kSlot : 1;
+
+    struct Batch {
+        FreeSlot* head;
+        size_t count;
+    };
+
+    struct ThreadCache {
+        FreeSlot* free = nullptr;
+        size_t count = 0;
+        char* bump = nullptr;       // Unused part of this thread's slab
+        char* bumpEnd = nullptr;
+
+        ~ThreadCache() {
+            // On thread exit: the cached slots and the rest of the slab go back to the pool
+            for (; bump != bumpEnd; bump += kSlot) {
+                FreeSlot* slot = reinterpret_cast<FreeSlot*>(bump);
+                slot->next = free;
+                free = slot;
+                ++count;
+            }
+            if (free) {
+                instance().returnBatch(free, count);
+            }
+        }
+    };
+
+    SlabPool() = default;
+
+    static ThreadCache& localCache() {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+
+    void returnBatch(FreeSlot* head, size_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        batches.push_back({head, count});
+    }
+
+    // The cache is empty: take a freed batch if there is one, else a new slab
+    void refill(ThreadCache& cache) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!batches.empty()) {
+            cache.free = batches.back().head;
+            cache.count = batches.back().count;
+            batches.pop_back();
+            return;
+        }
+        char* slab = static_cast<char*>(::operator new(kSlotsPerSlab * kSlot, std::align_val_t(kAlign)));
+        slabs.push_back(slab);
+        cache.bump = slab;
+        cache.bumpEnd = slab + kSlotsPerSlab * kSlot;
+    }
+
+    std::mutex mutex;
+    std::vector<Batch> batches;
+    std::vector<char*> slabs;       // Owned, never freed
+};
+
+/**
+ * @brief Standard allocator over SlabPool for single objects
+ *
+ * Meant for std::allocate_shared, which allocates the object and its
+ * control block as one slot. Array allocations fall back to std::allocator.
+ */
+template <typename T>
+struct SlabAllocator {
+    using value_type = T;
+
+    SlabAllocator() noexcept = default;
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count) {
+        if (count == 1) {
+            return static_cast<T*>(SlabPool<sizeof(T), alignof(T)>::instance().allocate());
+        }
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept {
+        if (count == 1) {
+            SlabPool<sizeof(T), alignof(T)>::instance().deallocate(pointer);
+        } else {
+            std::allocator<T>().deallocate(pointer, count);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const SlabAllocator<U>&) const noexcept { return false; }
+};
+
+#endif // SLAB_ALLOCATOR_H
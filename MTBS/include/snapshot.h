@@ -0,0 +1,62 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include "money.h"
+#include "journal.h"
+
+/**
+ * @brief Point-in-time image of every account, used to bound journal replay
+ *
+ * Snapshots are fuzzy: accounts are read one at a time while traffic
+ * continues, and each entry records the LSN of the last journal record
+ * reflected in it. Replay applies only journal records newer than an
+ * account's lastLsn, so journal records at or below snapshotLsn are never
+ * needed again.
+ *
+ * File layout (little-endian):
+ *   header  "MTBSSNP1", u32 version, u32 reserved, u64 snapshot LSN,
+ *           u64 last transaction ID, u64 entry count, i64 creation time (ns),
+ *           u64 next account ordinal (version 2 and later)
+ *   entries u64 last LSN, i64 balance (cents), u16 account length,
+ *           u16 holder name length, u32 history record count (version 3
+ *           and later), account and holder name bytes, then the account's
+ *           resident history as journal-encoded TRANSACTION records
+ *   trailer u32 CRC-32 of everything before it
+ *
+ * The history is what the account had in memory at the cut (its resident
+ * window, see TransactionHistory); the journal segments that held those
+ * records are deleted once the snapshot is written.
+ *
+ * Files are written to "<path>.tmp", synced and renamed over the old
+ * snapshot, so a crash leaves either the old or the new snapshot intact.
+ */
+struct SnapshotEntry {
+    std::string accountNumber;
+    std::string holderName;
+    Money balance;
+    uint64_t lastLsn = 0;
+    std::vector<JournalRecord> history;    // Resident history, oldest first (none in older files)
+};
+
+struct SnapshotData {
+    uint64_t snapshotLsn = 0;          // Every journal record up to here is reflected
+    uint64_t lastTransactionId = 0;    // Transaction numbering resumes after this
+    uint64_t nextAccountOrdinal = 0;   // AccountNumberAllocator resumes here (0 in version 1 files)
+    std::chrono::system_clock::time_point createdAt;
+    std::vector<SnapshotEntry> entries;
+};
+
+namespace Snapshot {
+    bool write(const std::string& path, const SnapshotData& snapshot);
+    bool read(const std::string& path, SnapshotData& snapshot);
+
+    // Header only (no entries); cheap enough to call at startup
+    bool readHeader(const std::string& path, SnapshotData& snapshot);
+}
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,65 @@
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Append-only, thread-safe string interning table
+ *
+ * Maps strings to dense 32-bit IDs so that records such as Transaction can
+ * refer to account numbers and descriptions by ID instead of holding their
+ * own std::string copies. Interning takes a shared lock in the common
+ * "already known" case; resolving an ID back to its string is lock-free.
+ * Strings are never removed, so returned references stay valid for the
+ * lifetime of the table.
+ */
+class StringTable {
+public:
+    static constexpr uint32_t kNoString = 0xFFFFFFFFu;
+
+    StringTable();
+    ~StringTable();
+
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    // Returns the ID for value, adding it if needed (empty strings map to kNoString)
+    uint32_t intern(const std::string& value);
+
+    // As intern, but only adds value while the table holds fewer than limit strings; past
+    // that, unknown strings map to kNoString. For text supplied by callers
+    uint32_t internBounded(const std::string& value, size_t limit);
+
+    // Returns an empty string for kNoString
+    const std::string& lookup(uint32_t id) const;
+
+    size_t size() const;
+
+    // Process-wide tables shared by accounts and transactions
+    static StringTable& accountNumbers();
+    static StringTable& descriptions();
+
+private:
+    static constexpr size_t kChunkBits = 16;
+    static constexpr size_t kChunkSize = size_t(1) << kChunkBits;
+    static constexpr size_t kMaxChunks = size_t(1) << 16;
+
+    uint32_t internUpTo(const std::string& value, size_t limit);
+
+    // Storage: fixed directory of lazily allocated chunks, so entries never move
+    std::unique_ptr<std::atomic<std::string*>[]> chunks;
+    std::atomic<uint32_t> count;
+
+    // Reverse index from string to ID (keys point into chunk storage)
+    mutable std::shared_mutex indexMutex;
+    std::unordered_map<std::string_view, uint32_t> index;
+};
+
+#endif // STRING_TABLE_H
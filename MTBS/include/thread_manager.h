@@ -12,94 +12,374 @@
 #include <chrono>
 #include <string>
 #include <map>
+#include <future>
+#include <type_traits>
+#include <cstdint>
+#include "unique_function.h"
+#include "mpmc_ring.h"
+#include "work_stealing_deque.h"
+#include "latency_histogram.h"
+
+class ThreadMonitor;
 
 /**
- * @brief Thread pool manager for handling concurrent banking operations
+ * @brief Work-stealing thread pool for concurrent banking operations
+ *
+ * Every worker owns one lock-free deque per priority band. Tasks submitted
+ * from a worker go to its own deque; tasks from other threads go through a
+ * bounded lock-free injection ring per band. Idle workers steal from the
+ * other workers' deques before parking. Higher bands are always drained
+ * first: priority > 0 is HIGH, 0 is NORMAL and < 0 is LOW.
+ *
+ * submitToWorker places a task in one worker's inbox instead: it runs on
+ * that worker only, before the worker's banded work, and is never stolen.
+ * With pinWorkers, each worker is bound to one CPU of the process's
+ * affinity mask, taken NUMA node by node (Linux; elsewhere nothing is
+ * pinned and nodes are reported as -1), so that work sent to a worker
+ * stays in one core's caches.
+ *
+ * With a ThreadMonitor (setMonitor), every worker registers on start and
+ * publishes what it is doing: the task it runs, idle or parked, and which
+ * profiled lock it is waiting on, poolMutex included.
  */
 class ThreadPool {
 public:
+    enum class PriorityBand : size_t {
+        HIGH = 0,
+        NORMAL = 1,
+        LOW = 2
+    };
+    static constexpr size_t kPriorityBands = 3;
+    
     struct Task {
-        std::function<void()> function;
+        UniqueFunction function;
         std::string description;
         int priority;
         
-        Task() : function(nullptr), description(""), priority(0) {}
-        Task(const std::function<void()>& func, const std::string& desc = "", int prio = 0);
-        bool operator<(const Task& other) const { return priority < other.priority; }
+        Task() : priority(0) {}
+        Task(UniqueFunction func, const std::string& desc = "", int prio = 0);
+        Task(Task&&) = default;
+        Task& operator=(Task&&) = default;
     };
     
-    explicit ThreadPool(size_t threadCount = 4);
+    explicit ThreadPool(size_t threadCount = 4, size_t injectionCapacity = 4096, bool pinWorkers = false);
     ~ThreadPool();
     
     void start();
-    void stop();
+    void stop();   // Runs any tasks still queued before returning
+    
+    // Task nodes come from a SlabPool and callables of up to UniqueFunction::kInlineSize
+    // bytes are held inline, so a warmed-up pool submits without touching the heap
     bool submitTask(const std::function<void()>& task, const std::string& description = "");
+    bool submitTask(UniqueFunction task, const std::string& description, int priority);
+    bool submitToWorker(size_t worker, UniqueFunction task, const std::string& description);  // worker % thread count
+    
+    // Before start(): workers register with monitor as "Worker <n>" and publish their state to it
+    void setMonitor(ThreadMonitor* monitor);
+    
+    /**
+     * @brief Submits a callable and returns a future for its result
+     *
+     * If the pool is not running the task is dropped and the future
+     * reports std::future_errc::broken_promise.
+     */
+    template <typename F>
+    auto submit(F&& function, int priority = 0, const std::string& description = "")
+        -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        std::packaged_task<Result()> task(std::forward<F>(function));
+        std::future<Result> future = task.get_future();
+        submitTask(UniqueFunction(std::move(task)), description, priority);
+        return future;
+    }
     
     size_t getActiveThreadCount() const;
     size_t getQueueSize() const;
+    size_t getThreadCount() const;
     bool isRunning() const;
+    bool isPinned() const;
+    int getWorkerCpu(size_t worker) const;      // -1 if not pinned
+    int getWorkerNode(size_t worker) const;     // NUMA node of that CPU, -1 if unknown
+    
+    static PriorityBand bandForPriority(int priority);
+    static size_t currentWorkerIndex();         // Of the calling worker thread (any pool), or SIZE_MAX
 
 private:
-    std::vector<std::unique_ptr<std::thread>> workers;
-    std::priority_queue<Task> taskQueue;
+    struct Worker {
+        std::thread thread;
+        WorkStealingDeque<Task*> deques[kPriorityBands];
+        uint64_t stealSeed;
+    };
+    
+    // Per worker slot, kept across stop() and start() so that submitters never race a restart
+    struct alignas(64) Inbox {
+        std::unique_ptr<MpmcRing<Task*>> tasks;
+        std::atomic<size_t> pending{0};
+        std::atomic<bool> sleeping{false};      // The slot's worker is parked
+    };
+    
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unique_ptr<Inbox[]> inboxes;
+    std::unique_ptr<MpmcRing<Task*>> injection[kPriorityBands];
+    size_t threadCount;
+    bool pinned;
+    std::vector<int> workerCpus;                // Per worker slot, when pinned
+    std::vector<int> workerNodes;
+    ThreadMonitor* monitor;
     
+    // Parking for idle workers
     mutable std::mutex poolMutex;
     std::condition_variable condition;
+    alignas(64) std::atomic<size_t> pendingTasks;   // Queued, not yet taken
+    alignas(64) std::atomic<size_t> sleepingWorkers;
     
     std::atomic<bool> running;
     std::atomic<size_t> activeThreads;
     
     void createWorker();
-    void workerFunction();
+    void workerFunction(size_t index);
+    bool findTask(size_t index, Task*& task);   // Takes the task off its pending count
+    void runTask(Task* task);
+    Task* makeTask(UniqueFunction task, const std::string& description, int priority);
+    void placeWorkers();
+    void wakeWorker();
+    void drainRemainingTasks();
 };
 
 /**
  * @brief Work queue for transaction processing
+ *
+ * Bounded lock-free queue (MpmcRing). Producers follow the backpressure
+ * policy when the queue is full; consumers block until an item arrives or
+ * the queue is closed.
  */
 class WorkQueue {
 public:
     struct WorkItem {
-        std::function<void()> work;
+        UniqueFunction work;        // Move-only; small callables are held inline
         std::string description;
         std::chrono::system_clock::time_point timestamp;
         
-        WorkItem(const std::function<void()>& w, const std::string& desc);
+        WorkItem() = default;
+        WorkItem(UniqueFunction w, const std::string& desc);
     };
     
-    explicit WorkQueue(size_t maxSize = 1000);
+    explicit WorkQueue(size_t maxSize = 1000, BackpressurePolicy policy = BackpressurePolicy::BLOCK);
     
-    bool enqueue(const WorkItem& item);
-    bool dequeue(WorkItem& item);
+    bool enqueue(WorkItem&& item);
+    bool dequeue(WorkItem& item);   // False once closed and drained
+    void close();
     size_t size() const;
     bool empty() const;
 
 private:
-    std::queue<WorkItem> queue;
-    mutable std::mutex queueMutex;
-    std::condition_variable notEmpty;
-    std::condition_variable notFull;
-    size_t maxSize;
+    MpmcRing<WorkItem> queue;
+    BackpressurePolicy policy;
 };
 
 /**
- * @brief Thread monitoring utilities
+ * @brief Thread monitoring utilities: per-thread state, shard loads and lock contention
+ *
+ * Every registered thread owns one cache-line slot and publishes its own
+ * state there with relaxed atomic stores (setState, beginTask, endTask and
+ * LockWait). Readers load the slots without locking, so getAllThreads never
+ * holds up a worker. It may see one thread's fields from either side of an
+ * update; the task name is read under a seqlock and is always whole. Only
+ * registration takes monitorMutex. Registering the calling thread binds it
+ * to the monitor; the static publishers do nothing on unbound threads.
+ * ThreadPool workers register with their pool's monitor (setMonitor) and
+ * get their slot back, by name, after a stop() and start().
+ *
+ * Shard loads are kept in one cache line per shard, written with relaxed
+ * atomics by whichever worker ran the batch, so recording takes no lock.
+ *
+ * Lock contention sampling is process-wide, like LatencyStats, and off by
+ * default. With a period of N, every Nth acquisition a thread makes at a
+ * profiled site is timed and attributed to that site, along with the most
+ * threads seen waiting there at once. A thread that blocks on a profiled
+ * lock shows WAITING_LOCK and the site whether sampling is on or not; that
+ * costs two stores on a path that is about to sleep anyway.
  */
 class ThreadMonitor {
 public:
+    static constexpr size_t kMaxThreads = 256;          // Registered at once; more are not tracked
+    static constexpr size_t kTaskNameBytes = 48;        // Longer task descriptions are cut short
+
+    enum class ThreadState : uint8_t {
+        IDLE,               // Looking for work
+        RUNNING,            // In a task
+        WAITING_LOCK,       // Blocked on a profiled lock (ThreadInfo::lock)
+        PARKED,             // Asleep until work arrives
+        EXITED
+    };
+
+    // Profiled locks
+    enum class LockSite : uint8_t {
+        NONE,
+        ACCOUNTS,           // The accounts map: AccountDirectory shard locks
+        ACCOUNT,            // Account::accountMutex
+        POOL,               // ThreadPool::poolMutex (parking and wake-ups)
+        LOGGER,             // TransactionLogger::loggerMutex and its render thread's wake-up lock
+        COUNT
+    };
+
     struct ThreadInfo {
         std::thread::id id;
         std::string name;
-        std::string status;
+        std::string status;                     // "running Pipeline lane 3", "waiting on accountMutex", ...
         std::chrono::system_clock::time_point startTime;
+        ThreadState state = ThreadState::IDLE;
+        LockSite lock = LockSite::NONE;         // While WAITING_LOCK
+        std::string task;                       // While RUNNING or WAITING_LOCK
+        uint64_t tasksRun = 0;
+        std::chrono::nanoseconds busy{0};       // In tasks, the current one included
+        std::chrono::nanoseconds idle{0};       // Between tasks
     };
-    
+
+    // Sampled acquisitions of one lock site
+    struct LockContention {
+        LockSite site = LockSite::NONE;
+        uint64_t sampled = 0;
+        uint64_t contended = 0;                 // Sampled acquisitions that had to wait
+        std::chrono::nanoseconds wait{0};       // Their total wait
+        std::chrono::nanoseconds maxWait{0};
+        size_t peakWaiters = 0;                 // Most threads waiting there at once while sampling
+    };
+
+    // Work executed per account shard (pipeline batches)
+    struct ShardLoad {
+        size_t shard = 0;
+        size_t worker = SIZE_MAX;               // Pool worker that ran its latest batch (SIZE_MAX: none yet)
+        uint64_t operations = 0;
+        uint64_t batches = 0;
+        std::chrono::nanoseconds busy{0};
+    };
+
+    ThreadMonitor();
+    ~ThreadMonitor();
+
+    ThreadMonitor(const ThreadMonitor&) = delete;
+    ThreadMonitor& operator=(const ThreadMonitor&) = delete;
+
+    // A name whose thread has exited gets its slot back; registering the calling thread binds it
     void registerThread(const std::thread::id& id, const std::string& name);
-    void updateThreadStatus(const std::thread::id& id, const std::string& status);
-    std::vector<ThreadInfo> getAllThreads() const;
+    void unregisterThread(const std::thread::id& id);                       // EXITED, and unbound
+    void updateThreadStatus(const std::thread::id& id, ThreadState state);  // Lock-free
+    std::vector<ThreadInfo> getAllThreads() const;                          // Lock-free
+
+    // Published by the calling thread into its own slot, if it is bound
+    static void setState(ThreadState state);
+    static void beginTask(const std::string& description);
+    static void endTask();
+
+    static const char* stateName(ThreadState state);        // "idle", "running", ...
+    static const char* lockSiteName(LockSite site);         // "accountsMutex", "accountMutex", ...
+
+    // Contention sampling: every period-th acquisition per thread (0: off, 1: all of them)
+    static void setContentionSampling(uint32_t period);
+    static uint32_t getContentionSampling();
+    static std::vector<LockContention> getLockContention(); // One per site, NONE excluded
+    static void resetLockContention();
+
+    // A lock() at a profiled site that did not get the lock at once: publishes WAITING_LOCK
+    // for its lifetime and, when sampled, times it
+    class LockWait {
+    public:
+        explicit LockWait(LockSite site);
+        ~LockWait();
+
+        LockWait(const LockWait&) = delete;
+        LockWait& operator=(const LockWait&) = delete;
+
+    private:
+        LockSite site;
+        uint8_t previousState;
+        bool counted;               // Included in the site's waiter count
+        bool sampled;
+        int64_t startNs;
+    };
+
+    // A profiled acquisition that got the lock at once
+    static void noteAcquired(LockSite site);
+
+    // Locks lockable (a mutex, std::unique_lock, ...) at a profiled site
+    template <typename Lock>
+    static void lockProfiled(Lock& lockable, LockSite site) {
+        if (lockable.try_lock()) {
+            noteAcquired(site);
+            return;
+        }
+        LockWait wait(site);
+        lockable.lock();
+    }
+
+    // lockRecordingWait (latency_histogram.h) with the wait also attributed to a site
+    template <typename Lock>
+    static void lockProfiled(Lock& lockable, LockSite site, LatencyStage stage) {
+        if (lockable.try_lock()) {
+            LatencyStats::record(stage, uint64_t(0));
+            noteAcquired(site);
+            return;
+        }
+        LockWait wait(site);
+        ScopedLatency latency(stage);
+        lockable.lock();
+    }
+
+    void trackShards(size_t count);             // Before the first recordShardBatch; resets the loads
+    void recordShardBatch(size_t shard, size_t worker, size_t operations, std::chrono::nanoseconds busy);
+    std::vector<ShardLoad> getShardLoads() const;
 
 private:
-    mutable std::mutex monitorMutex;
-    std::map<std::thread::id, ThreadInfo> threads;
+    static constexpr size_t kTaskWords = kTaskNameBytes / sizeof(uint64_t);
+
+    // Written by its thread only, except state (updateThreadStatus); id, name and
+    // startTime are set at registration, before the slot is counted in threadCount
+    struct alignas(64) ThreadSlot {
+        std::atomic<uint8_t> state{static_cast<uint8_t>(ThreadState::EXITED)};
+        std::atomic<uint8_t> lock{0};
+        std::atomic<bool> inTask{false};
+        std::atomic<uint32_t> taskVersion{0};       // Seqlock over task: odd while it is written
+        std::atomic<uint64_t> tasksRun{0};
+        std::atomic<int64_t> busyNs{0};
+        std::atomic<int64_t> idleNs{0};
+        std::atomic<int64_t> sinceNs{0};            // Start of the current task or idle spell
+        std::atomic<uint64_t> task[kTaskWords];     // NUL-terminated unless full
+        std::atomic<std::thread::id> id{std::thread::id()};
+        std::atomic<int64_t> startTimeNs{0};        // system_clock
+        std::string name;
+    };
+
+    struct alignas(64) ShardSlot {
+        std::atomic<uint64_t> operations{0};
+        std::atomic<uint64_t> batches{0};
+        std::atomic<int64_t> busyNs{0};
+        std::atomic<size_t> worker{SIZE_MAX};
+    };
+
+    struct alignas(64) SiteSlot {
+        std::atomic<uint64_t> sampled{0};
+        std::atomic<uint64_t> contended{0};
+        std::atomic<int64_t> waitNs{0};
+        std::atomic<int64_t> maxWaitNs{0};
+        std::atomic<size_t> waiters{0};
+        std::atomic<size_t> peakWaiters{0};
+    };
+
+    static thread_local ThreadSlot* currentSlot;
+    static std::atomic<uint32_t> samplePeriod;
+    static SiteSlot sites[static_cast<size_t>(LockSite::COUNT)];
+
+    mutable std::mutex monitorMutex;            // Registration only
+    std::unique_ptr<ThreadSlot[]> threadSlots;
+    std::atomic<size_t> threadCount;            // Slots in use, published with release
+    std::unique_ptr<ShardSlot[]> shardSlots;
+    size_t shardCount = 0;
+
+    ThreadSlot* findSlot(const std::thread::id& id) const;
+    static bool sampleAcquisition(LockSite site);
+    static std::string readTask(const ThreadSlot& slot);
+    static int64_t steadyNs();
 };
 
 #endif // THREAD_MANAGER_H
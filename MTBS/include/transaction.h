@@ -2,6 +2,7 @@
 #define TRANSACTION_H
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <functional>
 #include <chrono>
@@ -9,6 +10,10 @@
 #include <condition_variable>
 #include <fstream>
 #include "account.h"
+#include "mpmc_ring.h"
+#include "async_file_writer.h"
+#include "deferred_log.h"
+#include "sharded_counter.h"
 
 // Forward declarations
 class Bank;
@@ -26,12 +31,16 @@ public:
     struct TransactionResult {
         bool success;
         std::string message;
-        std::string transactionId;
-        double newBalance;
+        uint64_t transactionId;     // IdGenerator ID, 0 when nothing was recorded
+        Money newBalance;
         std::chrono::system_clock::time_point timestamp;
+        std::chrono::milliseconds retryAfter{0};    // Set when admission control turned it away
         
-        TransactionResult(bool s, const std::string& msg, const std::string& id, 
-                         double balance, std::chrono::system_clock::time_point time);
+        TransactionResult(bool s, const std::string& msg, uint64_t id, 
+                         Money balance, std::chrono::system_clock::time_point time);
+        
+        // "TXN_<id>", or empty; formatted only when displayed
+        std::string getTransactionId() const;
     };
     
     // Constructor and destructor
@@ -39,30 +48,27 @@ public:
     ~TransactionProcessor();
     
     // Main transaction processing methods
-    TransactionResult processDeposit(Account& account, double amount, 
+    TransactionResult processDeposit(Account& account, Money amount, 
                                    const std::string& description = "");
-    TransactionResult processWithdraw(Account& account, double amount, 
+    TransactionResult processWithdraw(Account& account, Money amount, 
                                     const std::string& description = "");
     TransactionResult processTransfer(Account& fromAccount, Account& toAccount, 
-                                    double amount, const std::string& description = "");
+                                    Money amount, const std::string& description = "");
     TransactionResult processBalanceCheck(const Account& account);
     
     // Transaction validation
-    bool validateTransaction(const Account& account, double amount, 
-                           const std::string& type);
+    bool validateTransaction(const Account& account, Money amount, 
+                           TransactionType type);
     
     // Utility methods
-    std::string generateTransactionId();
+    uint64_t generateTransactionId();
     std::string getCurrentTimestamp();
     void logTransaction(const Transaction& transaction);
 
 private:
-    // Transaction ID counter (atomic for thread safety)
-    static std::atomic<unsigned long long> transactionCounter;
-    
     // Validation helpers
-    bool isValidAmount(double amount);
-    bool hasSufficientFunds(const Account& account, double amount);
+    bool isValidAmount(Money amount);
+    bool hasSufficientFunds(const Account& account, Money amount);
     bool isAccountActive(const Account& account);
 };
 
@@ -71,6 +77,8 @@ private:
  * 
  * Manages a queue of pending transactions and distributes them
  * to available worker threads. Demonstrates producer-consumer pattern.
+ * Backed by a lock-free MpmcRing; what enqueue does when the queue is full
+ * is set by the backpressure policy.
  */
 class TransactionQueue {
 public:
@@ -80,17 +88,20 @@ public:
         std::string description;
         std::chrono::system_clock::time_point queuedAt;
         
+        TransactionTask() = default;
         TransactionTask(const std::function<TransactionProcessor::TransactionResult()>& t,
                        const std::string& desc);
     };
     
-    // Constructor and destructor
-    TransactionQueue(size_t maxQueueSize = 1000);
+    // Constructor and destructor (capacity is rounded up to a power of two)
+    TransactionQueue(size_t maxQueueSize = 1000, 
+                     BackpressurePolicy policy = BackpressurePolicy::REJECT);
     ~TransactionQueue();
     
     // Queue management
     bool enqueueTransaction(const TransactionTask& task);
-    bool dequeueTransaction(TransactionTask& task);
+    bool enqueueTransaction(TransactionTask&& task);
+    bool dequeueTransaction(TransactionTask& task);   // Non-blocking
     
     // Queue status
     size_t getQueueSize() const;
@@ -102,9 +113,8 @@ public:
     std::vector<std::string> getQueueStatus() const;
 
 private:
-    std::vector<TransactionTask> taskQueue;
-    mutable std::mutex queueMutex;
-    std::condition_variable queueCondition;
+    MpmcRing<TransactionTask> taskQueue;
+    BackpressurePolicy policy;
     size_t maxSize;
     
     // Queue statistics
@@ -117,6 +127,12 @@ private:
  * 
  * Thread-safe logging system that maintains a complete audit trail
  * of all transactions for compliance and debugging purposes.
+ * 
+ * Lines are formatted off the caller's path: a call that passes the level
+ * filter queues a LogRecord (IDs, cents, a timestamp) in the thread's own
+ * DeferredLog ring, and the render thread writes the text. logMessage
+ * copies its message into the record; the audit calls (logTransaction,
+ * logDeposit, ...) format nothing at all.
  */
 class TransactionLogger {
 public:
@@ -135,17 +151,28 @@ public:
     
     // Logging methods
     void logTransaction(const Transaction& transaction);
-    void logMessage(LogLevel level, const std::string& message);
+    void logMessage(LogLevel level, std::string_view message);
     void logError(const std::string& error, const std::string& context = "");
     
+    // Audit trail lines at INFO ("Deposit: $12.34 to account ..."); accounts are
+    // StringTable::accountNumbers IDs
+    void logDeposit(uint32_t account, Money amount);
+    void logWithdrawal(uint32_t account, Money amount);
+    void logTransfer(uint32_t fromAccount, uint32_t toAccount, Money amount);
+    
+    // For callers that would rather not build a message that is filtered out
+    bool isEnabled(LogLevel level) const;
+    
     // Log management
     void setLogLevel(LogLevel level);
-    void flushLogs();
+    void flushLogs();                            // Renders what is queued, then syncs the file
     void rotateLogFile();
     
-    // Log retrieval
+    // Log retrieval (memory-mapped; searches use the "<log>.idx" sparse index)
     std::vector<std::string> getRecentTransactions(size_t count = 100);
     std::vector<std::string> searchTransactions(const std::string& searchTerm);
+    std::vector<std::string> getTransactionsBetween(std::chrono::system_clock::time_point from,
+                                                    std::chrono::system_clock::time_point to);
     
     // Statistics
     size_t getTotalTransactions() const;
@@ -154,19 +181,24 @@ public:
 
 private:
     std::string logFile;
-    std::ofstream logStream;
-    LogLevel currentLevel;
-    mutable std::mutex loggerMutex;
+    std::unique_ptr<AsyncFileWriter> logWriter;  // Dedicated writer thread, off the caller's path
+    std::unique_ptr<DeferredLog> deferredLog;    // Renders into logWriter (declared after it: drains first)
+    std::atomic<LogLevel> currentLevel;
+    mutable std::mutex loggerMutex;              // Guards logFile during rotation
+    std::mutex indexMutex;                       // One index update at a time
+    
+    // Log statistics (per-thread slots; the total is their sum)
+    enum LogCounter : size_t { LOGGED_SUCCESSFUL, LOGGED_FAILED, LOGGED_COUNT };
+    ShardedCounters<LOGGED_COUNT> logged;
     
-    // Log statistics
-    std::atomic<size_t> totalLogged;
-    std::atomic<size_t> successfulLogged;
-    std::atomic<size_t> failedLogged;
+    // LogRecord::format values
+    enum LogFormat : uint16_t { FORMAT_TEXT, FORMAT_TRANSACTION, FORMAT_DEPOSIT, FORMAT_WITHDRAWAL, FORMAT_TRANSFER };
     
     // Helper methods
-    std::string levelToString(LogLevel level);
-    std::string formatLogEntry(LogLevel level, const std::string& message);
-    void writeToFile(const std::string& entry);
+    static const char* levelToString(LogLevel level);
+    void queueRecord(LogLevel level, LogFormat format, LogRecord& record);
+    static void renderRecord(const LogRecord& record, std::string& line);  // Newline included
+    std::string currentLogFile();                // Flushes first, so reads see every line
 };
 
 // Utility functions for transaction processing
@@ -175,13 +207,13 @@ namespace TransactionUtils {
     std::string generateUniqueId();
     
     // Format currency amounts
-    std::string formatCurrency(double amount);
+    std::string formatCurrency(Money amount);
     
     // Validate account numbers
     bool isValidAccountNumber(const std::string& accountNumber);
     
     // Calculate transaction fees
-    double calculateTransactionFee(double amount, const std::string& type);
+    Money calculateTransactionFee(Money amount, TransactionType type);
     
     // Generate transaction summaries
     std::string generateTransactionSummary(const std::vector<Transaction>& transactions);
@@ -0,0 +1,119 @@
+#ifndef TRANSACTION_HISTORY_H
+#define TRANSACTION_HISTORY_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+struct Transaction;
+
+/**
+ * @brief Bounded, chunked, lock-free transaction history for one account
+ *
+ * Records are appended into fixed-size chunks (small chunks first, so idle
+ * accounts stay cheap). Appends never take a lock: a writer reserves a slot
+ * with one atomic increment, fills it and marks it ready. Only the most
+ * recent chunks stay resident; when a new chunk displaces the oldest one
+ * the displaced records are handed to the spill handler (Bank appends them
+ * to its history archive) and dropped from memory. Without a handler they
+ * are simply gone.
+ *
+ * Readers never block writers. They see a consistent prefix of the
+ * history (up to the first slot that is still being written), and chunks
+ * that are evicted while a reader is active are only freed once no reader
+ * can still be looking at them.
+ */
+class TransactionHistory {
+public:
+    static constexpr size_t kFirstChunkSize = 8;
+    static constexpr size_t kMaxChunkSize = 256;
+
+    using SpillHandler = std::function<void(const Transaction* records, size_t count)>;
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    explicit TransactionHistory(size_t maxResidentChunks = 16);
+    ~TransactionHistory();
+
+    TransactionHistory(const TransactionHistory&) = delete;
+    TransactionHistory& operator=(const TransactionHistory&) = delete;
+
+    // Writers (lock-free)
+    void append(const Transaction& transaction);
+    void clear();
+
+    // Must be set before concurrent appends start
+    void setSpillHandler(SpillHandler handler);
+
+    // Counters
+    size_t size() const;            // Records currently readable
+    uint64_t totalAppended() const; // Records ever appended (including spilled and cleared)
+
+    // Readers (never block writers)
+    std::vector<Transaction> snapshot() const;
+    std::vector<Transaction> page(size_t offset, size_t limit) const;
+    std::vector<Transaction> findByIdRange(uint64_t firstId, uint64_t lastId) const;
+    std::vector<Transaction> findByTimeRange(TimePoint from, TimePoint to) const;
+
+    /**
+     * @brief Forward iterator over resident records, oldest first
+     *
+     * Holds a reader registration for its lifetime, so chunks it may visit
+     * are not freed underneath it.
+     */
+    class Cursor {
+    public:
+        Cursor(Cursor&& other) noexcept;
+        Cursor& operator=(Cursor&&) = delete;
+        Cursor(const Cursor&) = delete;
+        ~Cursor();
+
+        bool next(Transaction& out);
+
+    private:
+        friend class TransactionHistory;
+        Cursor(const TransactionHistory& history, uint64_t startSlot);
+
+        const TransactionHistory* history;
+        uint64_t slot;
+    };
+
+    Cursor cursor(size_t offset = 0) const;
+
+private:
+    struct Chunk;
+
+    std::unique_ptr<std::atomic<Chunk*>[]> ring;
+    size_t ringMask;
+
+    std::atomic<uint64_t> reserved;       // Next slot to hand out
+    std::atomic<uint64_t> residentStart;  // First slot still in memory
+    std::atomic<uint64_t> clearedUpTo;    // Slots below this were cleared
+
+    SpillHandler spillHandler;
+
+    // Deferred reclamation of evicted chunks (counts cursors and in-flight appends)
+    mutable std::atomic<size_t> activeReaders;
+    std::mutex retiredMutex;
+    std::vector<Chunk*> retired;
+
+    static uint64_t chunkNumberForSlot(uint64_t slot);
+    static uint64_t chunkStartSlot(uint64_t chunkNumber);
+    static size_t chunkCapacity(uint64_t chunkNumber);
+
+    Chunk* chunkForAppend(uint64_t chunkNumber);
+    void evict(Chunk* chunk);
+    void reclaimRetired();
+
+    uint64_t firstReadableSlot() const;
+    bool readSlot(uint64_t& slot, Transaction& out) const;
+
+    template <typename Predicate>
+    std::vector<Transaction> collect(uint64_t startSlot, size_t limit, Predicate predicate) const;
+};
+
+#endif // TRANSACTION_HISTORY_H
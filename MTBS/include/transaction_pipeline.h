@@ -0,0 +1,163 @@
+#ifndef TRANSACTION_PIPELINE_H
+#define TRANSACTION_PIPELINE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <cstddef>
+#include <chrono>
+#include "account.h"
+#include "transaction.h"
+#include "mpmc_ring.h"
+
+class AccountDirectory;
+class AdmissionController;
+class ThreadPool;
+
+/**
+ * @brief Asynchronous, batched front-end for deposits, withdrawals and transfers
+ *
+ * Stages: admission (submit) -> validation -> per-shard execution ->
+ * journal -> durability -> completion. Operations are queued on a lane per
+ * account directory shard; at most one pool task drains a lane at a time,
+ * taking up to batchSize operations and applying all operations for the
+ * same account with a single Account::applyPostings call (one lock
+ * acquisition). Operations on one account complete in submission order.
+ *
+ * With an AdmissionController, every operation holds one of its permits
+ * from admission to completion, and each batch reports how long its oldest
+ * operation was queued.
+ *
+ * With lane affinity, every lane is drained by one pool worker only
+ * (ThreadPool::submitToWorker, lane modulo worker count): a shard's
+ * accounts are then only written by the pipeline from one core, so their
+ * locks stay uncontended and their cache lines stay put. A transfer runs
+ * on its source account's lane and locks both accounts, as without it.
+ */
+class TransactionPipeline {
+public:
+    using Result = TransactionProcessor::TransactionResult;
+    using Callback = std::function<void(const Result&)>;
+
+    // Outcome stage: called once per executed operation, once the batch's
+    // commit is known and before completion (status is SUCCESS, or why the
+    // operation failed; FAILED for one applied but not committed)
+    using JournalHook = std::function<void(TransactionType type, const std::string& accountNumber,
+                                           const std::string& targetAccount, Money amount,
+                                           TransactionStatus status)>;
+
+    TransactionPipeline(AccountDirectory& directory, ThreadPool& pool,
+                        size_t batchSize = 64, size_t laneCapacity = 1024);
+    ~TransactionPipeline();
+
+    TransactionPipeline(const TransactionPipeline&) = delete;
+    TransactionPipeline& operator=(const TransactionPipeline&) = delete;
+
+    // Durability stage: called once per executed batch, after every operation
+    // in it was applied and before any of them completes (group commit). If it
+    // returns false the batch's successful operations complete as failed: they
+    // may not be durable
+    using CommitHook = std::function<bool()>;
+    
+    // Load stage: called once per executed batch, on the worker that ran it
+    using BatchHook = std::function<void(size_t lane, size_t operations, std::chrono::nanoseconds busy)>;
+    
+    // Must be set before the first submission
+    void setJournalHook(JournalHook hook);
+    void setCommitHook(CommitHook hook);
+    void setAdmissionController(AdmissionController* controller);   // Rejected operations complete inline
+    void setBatchHook(BatchHook hook);
+    void setLaneAffinity(bool enabled);
+
+    // Future-returning submission
+    std::future<Result> submitDeposit(const std::string& accountNumber, Money amount,
+                                      const std::string& description = "");
+    std::future<Result> submitWithdraw(const std::string& accountNumber, Money amount,
+                                       const std::string& description = "");
+    std::future<Result> submitTransfer(const std::string& fromAccount, const std::string& toAccount,
+                                       Money amount, const std::string& description = "");
+
+    // Callback submission (callback runs on a pool worker, or inline if rejected)
+    void submitDeposit(const std::string& accountNumber, Money amount,
+                       const std::string& description, Callback callback);
+    void submitWithdraw(const std::string& accountNumber, Money amount,
+                        const std::string& description, Callback callback);
+    void submitTransfer(const std::string& fromAccount, const std::string& toAccount,
+                        Money amount, const std::string& description, Callback callback);
+
+    // Blocks until every admitted operation has completed
+    void flush();
+
+    size_t getLaneCount() const;            // One per account directory shard
+    size_t laneOwner(size_t lane) const;    // The worker a lane runs on with lane affinity
+    bool hasLaneAffinity() const;
+    size_t getBatchSize() const;
+    size_t getInFlight() const;
+    size_t getBatchesExecuted() const;
+
+private:
+    struct Operation {
+        TransactionType type;
+        std::string accountNumber;
+        std::string targetAccount;
+        Money amount;
+        std::string description;
+        std::promise<Result> promise;
+        Callback callback;   // Used instead of promise when set
+        std::chrono::steady_clock::time_point admittedAt;
+        bool completed = false;   // Outcome delivered
+    };
+
+    struct Completion {
+        Operation* operation;
+        Result result;
+        TransactionStatus status;   // For the journal hook
+    };
+    
+    struct alignas(64) Lane {
+        std::unique_ptr<MpmcRing<Operation*>> queue;
+        std::atomic<size_t> pending{0};
+        std::atomic<bool> scheduled{false};
+    };
+
+    AccountDirectory& directory;
+    ThreadPool& pool;
+    size_t batchSize;
+    std::unique_ptr<Lane[]> lanes;
+    size_t laneCount;
+    JournalHook journalHook;
+    CommitHook commitHook;
+    BatchHook batchHook;
+    AdmissionController* admission;
+    bool laneAffinity;
+
+    alignas(64) std::atomic<size_t> inFlight;
+    std::atomic<size_t> batchesExecuted;
+
+    // Stages
+    void admit(std::unique_ptr<Operation> operation);
+    void scheduleLane(size_t laneIndex);
+    void drainLane(size_t laneIndex);
+    void executeBatch(std::vector<Operation*>& batch);
+    void executeTransfer(Operation& operation, std::pmr::vector<Completion>& finished);
+    void complete(Operation& operation, const Result& result);
+    void settleBatch(std::vector<Operation*>& batch) noexcept;
+
+    // Settles a batch however executeBatch exits, including by exception
+    struct BatchGuard {
+        TransactionPipeline& pipeline;
+        std::vector<Operation*>& batch;
+        ~BatchGuard() { pipeline.settleBatch(batch); }
+    };
+
+    static std::unique_ptr<Operation> makeOperation(TransactionType type, const std::string& accountNumber,
+                                                    const std::string& targetAccount, Money amount,
+                                                    const std::string& description);
+    static Result makeResult(bool success, const std::string& message, uint64_t id, Money balance);
+};
+
+#endif // TRANSACTION_PIPELINE_H
@@ -0,0 +1,108 @@
+#ifndef UNIQUE_FUNCTION_H
+#define UNIQUE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Move-only, type-erased `void()` callable
+ *
+ * Like std::function<void()>, but it can hold move-only callables such as
+ * std::packaged_task and it is never copied, so queued tasks are moved
+ * from submitter to worker exactly once.
+ *
+ * Callables of up to kInlineSize bytes that are nothrow-movable (lambdas
+ * capturing a few pointers, a std::function, a std::packaged_task) are
+ * stored inline, so wrapping one never allocates; larger ones go to the heap.
+ */
+class UniqueFunction {
+public:
+    static constexpr size_t kInlineSize = 48;
+
+    // Whether a callable of type F is stored without a heap allocation
+    template <typename F>
+    static constexpr bool storedInline = sizeof(F) <= kInlineSize &&
+                                         alignof(F) <= alignof(std::max_align_t) &&
+                                         std::is_nothrow_move_constructible<F>::value;
+
+    UniqueFunction() noexcept : operations(nullptr) {}
+
+    template <typename F,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, UniqueFunction>::value>::type>
+    UniqueFunction(F&& function) : operations(nullptr) {
+        using Callable = typename std::decay<F>::type;
+        if constexpr (storedInline<Callable>) {
+            new (storage) Callable(std::forward<F>(function));
+            operations = &inlineOperations<Callable>;
+        } else {
+            *reinterpret_cast<Callable**>(storage) = new Callable(std::forward<F>(function));
+            operations = &heapOperations<Callable>;
+        }
+    }
+
+    UniqueFunction(UniqueFunction&& other) noexcept : operations(other.operations) {
+        if (operations) {
+            operations->relocate(other.storage, storage);
+            other.operations = nullptr;
+        }
+    }
+
+    UniqueFunction& operator=(UniqueFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            operations = other.operations;
+            if (operations) {
+                operations->relocate(other.storage, storage);
+                other.operations = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    UniqueFunction(const UniqueFunction&) = delete;
+    UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+    ~UniqueFunction() { reset(); }
+
+    void operator()() { operations->invoke(storage); }
+    explicit operator bool() const { return operations != nullptr; }
+
+private:
+    // Hand-rolled vtable; relocate moves the callable and destroys the source
+    struct Operations {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename F>
+    static constexpr Operations inlineOperations = {
+        [](void* storage) { (*static_cast<F*>(storage))(); },
+        [](void* from, void* to) noexcept {
+            new (to) F(std::move(*static_cast<F*>(from)));
+            static_cast<F*>(from)->~F();
+        },
+        [](void* storage) noexcept { static_cast<F*>(storage)->~F(); }
+    };
+
+    template <typename F>
+    static constexpr Operations heapOperations = {
+        [](void* storage) { (**static_cast<F**>(storage))(); },
+        [](void* from, void* to) noexcept { *static_cast<F**>(to) = *static_cast<F**>(from); },
+        [](void* storage) noexcept { delete *static_cast<F**>(storage); }
+    };
+
+    void reset() noexcept {
+        if (operations) {
+            operations->destroy(storage);
+            operations = nullptr;
+        }
+    }
+
+    const Operations* operations;
+    alignas(std::max_align_t) unsigned char storage[kInlineSize];
+};
+
+#endif // UNIQUE_FUNCTION_H
@@ -1,32 +1,117 @@
 #include "../include/account.h"
+#include "../include/journal.h"
+#include "../include/epoch_reclaimer.h"
+#include "../include/id_generator.h"
+#include "../include/latency_histogram.h"
+#include "../include/slab_allocator.h"
+#include "../include/thread_manager.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <functional>
+#include <thread>
 
-// Static member initialization
-std::atomic<unsigned long long> Transaction::transactionCounter(0);
+namespace {
+    std::atomic<uint32_t> stripeThreshold(0);   // Account::setStripeThreshold
+    std::atomic<uint32_t> nextStripe(0);
+    
+    uint32_t steadyMs() {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    
+    // Account::create: accounts come from a SlabPool and are freed through the EpochReclaimer
+    using AccountPool = SlabPool<sizeof(Account), alignof(Account)>;
+    
+    void reclaimAccount(void* pointer) {
+        Account* account = static_cast<Account*>(pointer);
+        account->~Account();
+        AccountPool::instance().deallocate(account);
+    }
+    
+    struct RetireAccount {
+        void operator()(Account* account) const {
+            EpochReclaimer::retire(account, reclaimAccount);
+        }
+    };
+}
 
 // ============================================================================
 // TRANSACTION IMPLEMENTATION
 // ============================================================================
 
-Transaction::Transaction(const std::string& id, const std::string& from, const std::string& to,
-                       const std::string& t, double amt, const std::string& desc)
-    : transactionId(id), fromAccount(from), toAccount(to), type(t), 
-      amount(amt), description(desc), timestamp(std::chrono::system_clock::now()),
-      status(TransactionStatus::PENDING) {
+const char* transactionTypeName(TransactionType type) {
+    switch (type) {
+        case TransactionType::DEPOSIT: return "DEPOSIT";
+        case TransactionType::WITHDRAW: return "WITHDRAW";
+        case TransactionType::TRANSFER: return "TRANSFER";
+        case TransactionType::BALANCE_CHECK: return "BALANCE_CHECK";
+        default: return "UNKNOWN";
+    }
+}
+
+const char* transactionStatusName(TransactionStatus status) {
+    switch (status) {
+        case TransactionStatus::SUCCESS: return "SUCCESS";
+        case TransactionStatus::FAILED: return "FAILED";
+        case TransactionStatus::PENDING: return "PENDING";
+        case TransactionStatus::INSUFFICIENT_FUNDS: return "INSUFFICIENT_FUNDS";
+        case TransactionStatus::INVALID_ACCOUNT: return "INVALID_ACCOUNT";
+        default: return "UNKNOWN";
+    }
+}
+
+Transaction::Transaction(uint64_t transactionNumber, uint32_t from, uint32_t to,
+                         TransactionType t, Money amt, uint32_t desc, uint8_t flagBits)
+    : id(transactionNumber), amount(amt), timestamp(std::chrono::system_clock::now()),
+      fromAccount(from), toAccount(to), description(desc), type(t),
+      status(TransactionStatus::PENDING), flags(flagBits) {
+}
+
+std::string Transaction::getTransactionId() const {
+    const char* prefix = "TXN_";
+    if (flags & FLAG_INITIAL_DEPOSIT) {
+        prefix = "INIT_";
+    } else {
+        switch (type) {
+            case TransactionType::DEPOSIT: prefix = "DEP_"; break;
+            case TransactionType::WITHDRAW: prefix = "WTH_"; break;
+            case TransactionType::TRANSFER: prefix = "TRF_"; break;
+            case TransactionType::BALANCE_CHECK: prefix = "BAL_"; break;
+        }
+    }
+    return prefix + std::to_string(id);
+}
+
+const std::string& Transaction::getFromAccount() const {
+    return StringTable::accountNumbers().lookup(fromAccount);
+}
+
+const std::string& Transaction::getToAccount() const {
+    return StringTable::accountNumbers().lookup(toAccount);
+}
+
+uint32_t Transaction::internDescription(const std::string& text) {
+    return StringTable::descriptions().internBounded(text, kMaxDescriptions);
+}
+
+const std::string& Transaction::getDescription() const {
+    return StringTable::descriptions().lookup(description);
 }
 
 std::string Transaction::toString() const {
+    const std::string& from = getFromAccount();
+    const std::string& to = getToAccount();
+    
     std::ostringstream oss;
-    oss << "Transaction ID: " << transactionId << "\n"
-        << "Type: " << type << "\n"
-        << "Amount: $" << std::fixed << std::setprecision(2) << amount << "\n"
-        << "From: " << (fromAccount.empty() ? "N/A" : fromAccount) << "\n"
-        << "To: " << (toAccount.empty() ? "N/A" : toAccount) << "\n"
-        << "Description: " << description << "\n"
-        << "Status: " << status << "\n"
+    oss << "Transaction ID: " << getTransactionId() << "\n"
+        << "Type: " << transactionTypeName(type) << "\n"
+        << "Amount: $" << amount << "\n"
+        << "From: " << (from.empty() ? "N/A" : from) << "\n"
+        << "To: " << (to.empty() ? "N/A" : to) << "\n"
+        << "Description: " << getDescription() << "\n"
+        << "Status: " << transactionStatusName(status) << "\n"
         << "Timestamp: " << getFormattedTimestamp();
     return oss.str();
 }
@@ -46,191 +131,812 @@ bool Transaction::isSuccessful() const {
 // ACCOUNT IMPLEMENTATION
 // ============================================================================
 
-Account::Account(const std::string& number, const std::string& holderName, double initialBalance)
-    : accountNumber(number), accountHolderName(holderName), balance(initialBalance),
-      createdAt(std::chrono::system_clock::now()) {
+Account::Account(const std::string& number, const std::string& holderName, Money initialBalance,
+                 std::shared_ptr<AccountColumns> columns)
+    : accountNumber(number), accountHolderName(holderName),
+      accountIndex(StringTable::accountNumbers().intern(number)), 
+      slot(columns ? std::move(columns) : AccountColumns::standalone(), this), balance(slot.balance()),
+      journal(nullptr), lastJournalLsn(0), createdAt(std::chrono::system_clock::now()), fastPath(nullptr), 
+      contendedLocks(0), contentionWindowMs(0) {
     
     // Validate initial balance
-    if (initialBalance < 0) {
+    if (initialBalance.isNegative()) {
         throw std::invalid_argument("Initial balance cannot be negative");
     }
+    balance.store(initialBalance, std::memory_order_release);  // Unlisted: no bulk job reads it yet
     
     // Add initial deposit transaction if balance > 0
-    if (initialBalance > 0) {
-        std::string transactionId = "INIT_" + std::to_string(++Transaction::transactionCounter);
-        Transaction initTransaction(transactionId, "", number, TransactionType::DEPOSIT, 
-                                  initialBalance, "Initial deposit");
-        addTransaction(initTransaction);
+    if (initialBalance.isPositive()) {
+        static const uint32_t initialDescription = StringTable::descriptions().intern("Initial deposit");
+        Transaction initTransaction(IdGenerator::next(), Transaction::kNoAccount, accountIndex,
+                                    TransactionType::DEPOSIT, initialBalance, initialDescription,
+                                    Transaction::FLAG_INITIAL_DEPOSIT);
+        initTransaction.status = TransactionStatus::SUCCESS;
+        recordTransactionLocked(initTransaction);
     }
 }
 
-std::string Account::getAccountNumber() const {
-    std::lock_guard<std::mutex> lock(accountMutex);
-    return accountNumber;
+std::shared_ptr<Account> Account::create(const std::string& number, const std::string& holderName, 
+                                         Money initialBalance, std::shared_ptr<AccountColumns> columns) {
+    void* memory = AccountPool::instance().allocate();
+    Account* account;
+    try {
+        account = new (memory) Account(number, holderName, initialBalance, std::move(columns));
+    } catch (...) {
+        AccountPool::instance().deallocate(memory);
+        throw;
+    }
+    return std::shared_ptr<Account>(account, RetireAccount(), SlabAllocator<Account>());
 }
 
-std::string Account::getAccountHolderName() const {
-    std::lock_guard<std::mutex> lock(accountMutex);
-    return accountHolderName;
+Account::~Account() {
+    delete fastPath.load(std::memory_order_relaxed);
 }
 
-double Account::getBalance() const {
-    std::lock_guard<std::mutex> lock(accountMutex);
-    return balance;
+const std::string& Account::getAccountNumber() const {
+    return accountNumber; // Immutable after construction
+}
+
+const std::string& Account::getAccountHolderName() const {
+    return accountHolderName; // Immutable after construction
+}
+
+uint32_t Account::getAccountIndex() const {
+    return accountIndex; // Immutable after construction
+}
+
+Money Account::getBalance() const {
+    Money total = balance.load(std::memory_order_acquire); // No lock: readers never block deposits
+    FastPathState* fast = fastPath.load(std::memory_order_acquire);
+    if (fast && fast->striped.load(std::memory_order_acquire)) {
+        for (const Stripe& stripe : fast->stripes) {
+            total += stripe.credits.load(std::memory_order_acquire);
+        }
+    }
+    return total;
 }
 
 std::vector<Transaction> Account::getTransactionHistory() const {
-    std::lock_guard<std::mutex> lock(accountMutex);
+    return transactionHistory.snapshot(); // No lock: readers never block deposits
+}
+
+std::vector<Transaction> Account::getTransactionHistory(size_t offset, size_t limit) const {
+    return transactionHistory.page(offset, limit);
+}
+
+const TransactionHistory& Account::getHistory() const {
     return transactionHistory;
 }
 
 std::chrono::system_clock::time_point Account::getCreatedAt() const {
-    std::lock_guard<std::mutex> lock(accountMutex);
     return createdAt;
 }
 
-bool Account::deposit(double amount, const std::string& description) {
-    // CRITICAL SECTION - Protect balance modification
-    std::lock_guard<std::mutex> lock(accountMutex);
-    
+bool Account::deposit(Money amount, const std::string& description, Transaction* recorded) {
     // Validate deposit amount
-    if (amount <= 0) {
+    if (!amount.isPositive()) {
         return false;
     }
+    uint32_t descriptionId = Transaction::internDescription(description);
     
-    // Update balance
-    balance += amount;
+    bool succeeded = false;
+    if (tryFastPosting(TransactionType::DEPOSIT, amount, descriptionId, succeeded, recorded)) {
+        return succeeded;
+    }
+    
+    // CRITICAL SECTION - Protect balance modification
+    WriteLock lock(*this);
+    
+    // Update balance (an overflow is rejected, not recorded, as in applyPostings)
+    Money updated;
+    if (!Money::tryAdd(balanceLocked(), amount, updated)) {
+        return false;
+    }
+    setBalanceLocked(updated);
     
     // Create and add transaction record
-    std::string transactionId = "DEP_" + std::to_string(++Transaction::transactionCounter);
-    Transaction depositTransaction(transactionId, "", accountNumber, 
-                                  TransactionType::DEPOSIT, amount, description);
+    Transaction depositTransaction(IdGenerator::next(), Transaction::kNoAccount, accountIndex,
+                                   TransactionType::DEPOSIT, amount, descriptionId);
     depositTransaction.status = TransactionStatus::SUCCESS;
-    addTransaction(depositTransaction);
+    publishLocked(depositTransaction);
+    if (recorded) {
+        *recorded = depositTransaction;
+    }
     
     return true;
 }
 
-bool Account::withdraw(double amount, const std::string& description) {
-    // CRITICAL SECTION - Protect balance modification
-    std::lock_guard<std::mutex> lock(accountMutex);
-    
+bool Account::withdraw(Money amount, const std::string& description, Transaction* recorded) {
     // Validate withdrawal amount
-    if (amount <= 0) {
+    if (!amount.isPositive()) {
         return false;
     }
+    uint32_t descriptionId = Transaction::internDescription(description);
+    
+    bool succeeded = false;
+    if (tryFastPosting(TransactionType::WITHDRAW, amount, descriptionId, succeeded, recorded)) {
+        return succeeded;
+    }
+    
+    // CRITICAL SECTION - Protect balance modification
+    WriteLock lock(*this);
     
     // Check sufficient funds
-    if (balance < amount) {
+    if (balanceLocked() < amount) {
         // Create failed transaction record
-        std::string transactionId = "WTH_" + std::to_string(++Transaction::transactionCounter);
-        Transaction withdrawTransaction(transactionId, accountNumber, "", 
-                                      TransactionType::WITHDRAW, amount, description);
+        Transaction withdrawTransaction(IdGenerator::next(), accountIndex, Transaction::kNoAccount,
+                                        TransactionType::WITHDRAW, amount, descriptionId);
         withdrawTransaction.status = TransactionStatus::INSUFFICIENT_FUNDS;
-        addTransaction(withdrawTransaction);
+        publishLocked(withdrawTransaction);
+        if (recorded) {
+            *recorded = withdrawTransaction;
+        }
         return false;
     }
     
     // Update balance
-    balance -= amount;
+    setBalanceLocked(balanceLocked() - amount);
     
     // Create successful transaction record
-    std::string transactionId = "WTH_" + std::to_string(++Transaction::transactionCounter);
-    Transaction withdrawTransaction(transactionId, accountNumber, "", 
-                                  TransactionType::WITHDRAW, amount, description);
+    Transaction withdrawTransaction(IdGenerator::next(), accountIndex, Transaction::kNoAccount,
+                                    TransactionType::WITHDRAW, amount, descriptionId);
     withdrawTransaction.status = TransactionStatus::SUCCESS;
-    addTransaction(withdrawTransaction);
+    publishLocked(withdrawTransaction);
+    if (recorded) {
+        *recorded = withdrawTransaction;
+    }
     
     return true;
 }
 
-bool Account::transfer(Account& targetAccount, double amount, const std::string& description) {
-    // CRITICAL SECTION - Protect both accounts during transfer
-    // Use ordered locking to prevent deadlock
-    std::unique_lock<std::mutex> lock1(accountMutex, std::defer_lock);
-    std::unique_lock<std::mutex> lock2(targetAccount.accountMutex, std::defer_lock);
-    
-    // Lock in order to prevent deadlock
-    if (accountNumber < targetAccount.accountNumber) {
-        lock1.lock();
-        lock2.lock();
-    } else {
-        lock2.lock();
-        lock1.lock();
+bool Account::transfer(Account& targetAccount, Money amount, const std::string& description,
+                       Transaction* recorded) {
+    // A transfer to itself would lock the same mutex twice
+    if (&targetAccount == this) {
+        return false;
     }
     
     // Validate transfer amount
-    if (amount <= 0) {
+    if (!amount.isPositive()) {
         return false;
     }
+    uint32_t descriptionId = Transaction::internDescription(description);
+    
+    // CRITICAL SECTION - Protect both accounts during transfer
+    // Lock in canonical order to prevent deadlock
+    bool sourceFirst = lockOrderBefore(this, &targetAccount);
+    WriteLock lock1(sourceFirst ? *this : targetAccount);
+    WriteLock lock2(sourceFirst ? targetAccount : *this);
     
     // Check sufficient funds
-    if (balance < amount) {
+    if (balanceLocked() < amount) {
         // Create failed transaction record
-        std::string transactionId = "TRF_" + std::to_string(++Transaction::transactionCounter);
-        Transaction transferTransaction(transactionId, accountNumber, targetAccount.accountNumber,
-                                      TransactionType::TRANSFER, amount, description);
+        Transaction transferTransaction(IdGenerator::next(), accountIndex, targetAccount.accountIndex,
+                                        TransactionType::TRANSFER, amount, descriptionId);
         transferTransaction.status = TransactionStatus::INSUFFICIENT_FUNDS;
-        addTransaction(transferTransaction);
+        publishLocked(transferTransaction);
+        if (recorded) {
+            *recorded = transferTransaction;
+        }
         return false;
     }
     
-    // Perform transfer
-    balance -= amount;
-    targetAccount.balance += amount;
+    // Perform transfer (compute the credit first so an overflow leaves both untouched; it is
+    // rejected, not recorded, and reported through recorded as FAILED)
+    Money newTargetBalance;
+    if (!Money::tryAdd(targetAccount.balanceLocked(), amount, newTargetBalance)) {
+        if (recorded) {
+            *recorded = Transaction(0, accountIndex, targetAccount.accountIndex,
+                                    TransactionType::TRANSFER, amount, descriptionId);
+            recorded->status = TransactionStatus::FAILED;
+        }
+        return false;
+    }
+    setBalanceLocked(balanceLocked() - amount);
+    targetAccount.setBalanceLocked(newTargetBalance);
     
     // Create successful transaction records for both accounts
-    std::string transactionId = "TRF_" + std::to_string(++Transaction::transactionCounter);
+    uint64_t transactionNumber = IdGenerator::next();
     
     // Outgoing transfer record
-    Transaction outgoingTransfer(transactionId, accountNumber, targetAccount.accountNumber,
-                                TransactionType::TRANSFER, amount, description);
+    Transaction outgoingTransfer(transactionNumber, accountIndex, targetAccount.accountIndex,
+                                 TransactionType::TRANSFER, amount, descriptionId);
     outgoingTransfer.status = TransactionStatus::SUCCESS;
-    addTransaction(outgoingTransfer);
     
-    // Incoming transfer record for target account
-    Transaction incomingTransfer(transactionId, accountNumber, targetAccount.accountNumber,
-                                TransactionType::TRANSFER, amount, description);
-    incomingTransfer.status = TransactionStatus::SUCCESS;
-    targetAccount.addTransaction(incomingTransfer);
+    // Same record in both histories, one journal entry with both balances
+    publishLocked(outgoingTransfer, &targetAccount);
+    if (recorded) {
+        *recorded = outgoingTransfer;
+    }
     
     return true;
 }
 
+size_t Account::applyPostings(const Posting* postings, size_t count, PostingResult* results) {
+    size_t succeeded = 0;
+    
+    // CRITICAL SECTION - One lock acquisition for the whole batch
+    WriteLock lock(*this);
+    
+    for (size_t i = 0; i < count; ++i) {
+        const Posting& posting = postings[i];
+        bool isDeposit = posting.type == TransactionType::DEPOSIT;
+        
+        Transaction record(IdGenerator::next(),
+                           isDeposit ? Transaction::kNoAccount : accountIndex,
+                           isDeposit ? accountIndex : Transaction::kNoAccount,
+                           posting.type, posting.amount, posting.description);
+        
+        Money updated;
+        if (!posting.amount.isPositive() ||
+            (posting.type != TransactionType::DEPOSIT && posting.type != TransactionType::WITHDRAW)) {
+            record.status = TransactionStatus::FAILED;      // Rejected, not recorded (as in deposit())
+        } else if (!isDeposit && balanceLocked() < posting.amount) {
+            record.status = TransactionStatus::INSUFFICIENT_FUNDS;
+            publishLocked(record);
+        } else if (isDeposit ? !Money::tryAdd(balanceLocked(), posting.amount, updated)
+                             : !Money::trySubtract(balanceLocked(), posting.amount, updated)) {
+            record.status = TransactionStatus::FAILED;      // Overflow; balance untouched
+        } else {
+            setBalanceLocked(updated);
+            record.status = TransactionStatus::SUCCESS;
+            publishLocked(record);
+            ++succeeded;
+        }
+        
+        results[i].record = record;
+        results[i].balanceAfter = balanceLocked();
+    }
+    
+    return succeeded;
+}
+
+Account::BatchResult Account::transferBatch(const TransferLeg* legs, size_t count, uint32_t description) {
+    BatchResult result{TransactionStatus::FAILED, 0, 0};
+    if (count == 0) {
+        return result;
+    }
+    
+    // Reject malformed legs before locking anything
+    for (size_t i = 0; i < count; ++i) {
+        const TransferLeg& leg = legs[i];
+        if (!leg.from || !leg.to || leg.from == leg.to || !leg.amount.isPositive()) {
+            result.failedLeg = i;
+            return result;
+        }
+    }
+    
+    // Every distinct account, in lock order
+    std::vector<Account*> involved;
+    involved.reserve(2 * count);
+    for (size_t i = 0; i < count; ++i) {
+        involved.push_back(legs[i].from);
+        involved.push_back(legs[i].to);
+    }
+    std::sort(involved.begin(), involved.end(), lockOrderBefore);
+    involved.erase(std::unique(involved.begin(), involved.end()), involved.end());
+    
+    auto slotOf = [&involved](const Account* account) {
+        return static_cast<size_t>(std::lower_bound(involved.begin(), involved.end(), account, 
+                                                    lockOrderBefore) - involved.begin());
+    };
+    std::vector<std::pair<uint32_t, uint32_t>> slots(count);
+    for (size_t i = 0; i < count; ++i) {
+        slots[i] = {static_cast<uint32_t>(slotOf(legs[i].from)), static_cast<uint32_t>(slotOf(legs[i].to))};
+    }
+    
+    // CRITICAL SECTION - One acquisition per account, held for the whole batch (the
+    // locks nest inside one writer guard, so a bulk barrier cannot slip in between them)
+    AccountColumns::WriterGuard guard(involved.front()->slot.store());
+    std::vector<WriteLock> locks;
+    locks.reserve(involved.size());
+    for (Account* account : involved) {
+        locks.emplace_back(*account);
+    }
+    
+    // Dry run on working balances; nothing is visible until every leg has passed
+    std::vector<Money> working(involved.size());
+    for (size_t slot = 0; slot < involved.size(); ++slot) {
+        working[slot] = involved[slot]->balanceLocked();
+    }
+    for (size_t i = 0; i < count; ++i) {
+        Money& source = working[slots[i].first];
+        Money& target = working[slots[i].second];
+        Money debited, credited;
+        if (source < legs[i].amount) {
+            result.status = TransactionStatus::INSUFFICIENT_FUNDS;
+            result.failedLeg = i;
+            return result;
+        }
+        if (!Money::trySubtract(source, legs[i].amount, debited) || 
+            !Money::tryAdd(target, legs[i].amount, credited)) {
+            result.failedLeg = i;
+            return result;      // Overflow
+        }
+        source = debited;
+        target = credited;
+    }
+    
+    // Commit: replay the legs to record (and journal) the running balances, then publish
+    uint64_t transactionNumber = IdGenerator::next();
+    for (size_t slot = 0; slot < involved.size(); ++slot) {
+        working[slot] = involved[slot]->balanceLocked();
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const TransferLeg& leg = legs[i];
+        Money& source = working[slots[i].first];
+        Money& target = working[slots[i].second];
+        source -= leg.amount;
+        target += leg.amount;
+        
+        Transaction legTransaction(transactionNumber, leg.from->accountIndex, leg.to->accountIndex, 
+                                   TransactionType::TRANSFER, leg.amount, description, 
+                                   Transaction::FLAG_BATCH | (i + 1 == count ? Transaction::FLAG_BATCH_LAST : 0));
+        legTransaction.status = TransactionStatus::SUCCESS;
+        leg.from->transactionHistory.append(legTransaction);
+        leg.to->transactionHistory.append(legTransaction);
+        leg.from->journalLocked(legTransaction, source, leg.to, target);
+    }
+    for (size_t slot = 0; slot < involved.size(); ++slot) {
+        involved[slot]->setBalanceLocked(working[slot]);
+    }
+    
+    result.status = TransactionStatus::SUCCESS;
+    result.transactionId = transactionNumber;
+    return result;
+}
+
+bool Account::lockOrderBefore(const Account* a, const Account* b) {
+    if (a->accountIndex != b->accountIndex) {
+        return a->accountIndex < b->accountIndex;
+    }
+    return std::less<const Account*>()(a, b);
+}
+
 void Account::addTransaction(const Transaction& transaction) {
-    // CRITICAL SECTION - Protect transaction history
-    std::lock_guard<std::mutex> lock(accountMutex);
-    transactionHistory.push_back(transaction);
+    transactionHistory.append(transaction);
+}
+
+void Account::recordTransactionLocked(const Transaction& transaction) {
+    transactionHistory.append(transaction);
+}
+
+void Account::publishLocked(const Transaction& transaction, Account* target) {
+    transactionHistory.append(transaction);
+    if (target) {
+        target->transactionHistory.append(transaction);
+    }
+    journalLocked(transaction, balanceLocked(), target, target ? target->balanceLocked() : Money());
+}
+
+void Account::journalLocked(const Transaction& transaction, Money balanceAfter, 
+                            Account* target, Money targetBalanceAfter) {
+    if (journal) {
+        JournalRecord entry;
+        entry.kind = JournalRecordKind::TRANSACTION;
+        entry.transactionId = transaction.id;
+        entry.timestamp = transaction.timestamp;
+        entry.type = transaction.type;
+        entry.status = transaction.status;
+        entry.flags = transaction.flags;
+        entry.amount = transaction.amount;
+        entry.account = accountNumber;
+        entry.text = transaction.getDescription();
+        entry.balanceAfter = balanceAfter;
+        if (target) {
+            entry.counterparty = target->accountNumber;
+            entry.counterpartyBalanceAfter = targetBalanceAfter;
+        }
+        lastJournalLsn = journal->append(entry);
+        if (target) {
+            target->lastJournalLsn = lastJournalLsn;
+        }
+    }
 }
 
 void Account::clearTransactionHistory() {
-    // CRITICAL SECTION - Protect transaction history
-    std::lock_guard<std::mutex> lock(accountMutex);
     transactionHistory.clear();
 }
 
-bool Account::isActive() const {
+void Account::setHistorySpillHandler(TransactionHistory::SpillHandler handler) {
+    transactionHistory.setSpillHandler(std::move(handler));
+}
+
+void Account::attachJournal(Journal* target, uint64_t lastLsn) {
+    journal = target;
+    lastJournalLsn = lastLsn;
+}
+
+Account::State Account::getState() const {
+    AccountColumns::WriterGuard guard(slot.store());   // A bulk job moves both together
     std::lock_guard<std::mutex> lock(accountMutex);
+    FastPathState* fast = fastPath.load(std::memory_order_acquire);
+    if (fast && fast->enabled.load(std::memory_order_relaxed)) {
+        return {fast->journaledBalance, lastJournalLsn}; // Queued records are not in the journal yet
+    }
+    return {balanceLocked(), lastJournalLsn};
+}
+
+Account::State Account::getState(std::vector<Transaction>& history) const {
+    // Records are added to the history under the same lock that moves the journal position
+    AccountColumns::WriterGuard guard(slot.store());
+    std::lock_guard<std::mutex> lock(accountMutex);
+    history = transactionHistory.snapshot();
+    FastPathState* fast = fastPath.load(std::memory_order_acquire);
+    if (fast && fast->enabled.load(std::memory_order_relaxed)) {
+        return {fast->journaledBalance, lastJournalLsn};
+    }
+    return {balanceLocked(), lastJournalLsn};
+}
+
+void Account::restoreState(Money restoredBalance, uint64_t lastLsn) {
+    WriteLock lock(*this);
+    setBalanceLocked(restoredBalance);
+    lastJournalLsn = lastLsn;
+}
+
+void Account::setFastPath(bool enabled) {
+    WriteLock lock(*this);
+    FastPathState* fast = fastPath.load(std::memory_order_relaxed);
+    if (!fast) {
+        if (!enabled) {
+            return;
+        }
+        fast = new FastPathState();
+        fastPath.store(fast, std::memory_order_release);
+    }
+    fast->journaledBalance = balanceLocked();   // Stripes were folded in by the lock
+    if (!enabled) {
+        fast->striped.store(false, std::memory_order_release);
+    }
+    fast->enabled.store(enabled, std::memory_order_release);
+    slot.setFlag(AccountColumns::FAST_PATH, enabled);
+}
+
+bool Account::isFastPath() const {
+    FastPathState* fast = fastPath.load(std::memory_order_acquire);
+    return fast && fast->enabled.load(std::memory_order_acquire);
+}
+
+void Account::setStriped(bool enabled) {
+    if (enabled) {
+        setFastPath(true);
+    }
+    WriteLock lock(*this);
+    FastPathState* fast = fastPath.load(std::memory_order_relaxed);
+    if (fast) {
+        fast->striped.store(enabled && fast->enabled.load(std::memory_order_relaxed), std::memory_order_release);
+    }
+}
+
+bool Account::isStriped() const {
+    FastPathState* fast = fastPath.load(std::memory_order_acquire);
+    return fast && fast->striped.load(std::memory_order_acquire);
+}
+
+size_t Account::threadStripe() {
+    // Threads are dealt stripes round-robin, so a handful of threads never collide
+    thread_local size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % kFastPathStripes;
+    return stripe;
+}
+
+void Account::setStripeThreshold(uint32_t contendedPerSecond) {
+    stripeThreshold.store(contendedPerSecond, std::memory_order_relaxed);
+}
+
+uint32_t Account::getStripeThreshold() {
+    return stripeThreshold.load(std::memory_order_relaxed);
+}
+
+void Account::flushPending() {
+    FastPathState* fast = fastPath.load(std::memory_order_acquire);
+    if (fast) {
+        AccountColumns::WriterGuard guard(slot.store());
+        std::lock_guard<std::mutex> lock(accountMutex);
+        drainPendingLocked(*fast);
+    }
+}
+
+void Account::setTerms(const Terms& terms) {
+    WriteLock lock(*this);
+    slot.minimumBalance() = terms.minimumBalance;
+    slot.setFlag(AccountColumns::NO_INTEREST, !terms.earnsInterest);
+    slot.setFlag(AccountColumns::NO_FEES, !terms.chargedFees);
+}
+
+Account::Terms Account::getTerms() const {
+    std::lock_guard<std::mutex> lock(accountMutex);
+    Terms terms;
+    terms.minimumBalance = slot.minimumBalance();
+    terms.earnsInterest = !slot.hasFlag(AccountColumns::NO_INTEREST);
+    terms.chargedFees = !slot.hasFlag(AccountColumns::NO_FEES);
+    return terms;
+}
+
+void Account::setListed(bool listed) {
+    AccountColumns::WriterGuard guard(slot.store());
+    std::lock_guard<std::mutex> lock(accountMutex);
+    keepForViewLocked();
+    slot.setFlag(AccountColumns::LISTED, listed);
+}
+
+void Account::keepForViewLocked() {
+    // While the view is pending no fast operation gets past its check, so the stripes hold still
+    if (!slot.viewPending()) {
+        return;
+    }
+    Money whole = balanceLocked();
+    FastPathState* fast = fastPath.load(std::memory_order_acquire);
+    if (fast) {
+        for (const Stripe& stripe : fast->stripes) {
+            whole += stripe.credits.load(std::memory_order_relaxed);
+        }
+    }
+    slot.keepForView(whole);
+}
+
+void Account::settleForBulk() {
+    WriteLock lock(*this);  // Folds and drains; the barrier's thread passes the writer gate
+}
+
+bool Account::postBulk(TransactionType type, Money amount, uint32_t description) {
+    // Under the barrier no writer is inside, so nothing else touches the balance or the journal position
+    bool isDeposit = type == TransactionType::DEPOSIT;
+    Money updated;
+    if (isDeposit ? !Money::tryAdd(balanceLocked(), amount, updated) 
+                  : !Money::trySubtract(balanceLocked(), amount, updated)) {
+        return false;
+    }
+    setBalanceLocked(updated);
+    
+    Transaction record(IdGenerator::next(),
+                       isDeposit ? Transaction::kNoAccount : accountIndex,
+                       isDeposit ? accountIndex : Transaction::kNoAccount,
+                       type, amount, description);
+    record.status = TransactionStatus::SUCCESS;
+    publishLocked(record);
+    
+    FastPathState* fast = fastPath.load(std::memory_order_relaxed);
+    if (fast && fast->enabled.load(std::memory_order_relaxed)) {
+        fast->journaledBalance = updated;   // Settled: nothing was queued ahead of this record
+    }
+    return true;
+}
+
+bool Account::tryFastPosting(TransactionType type, Money amount, uint32_t description, bool& succeeded,
+                             Transaction* recorded) {
+    FastPathState* fast = fastPath.load(std::memory_order_acquire);
+    if (!fast || !fast->enabled.load(std::memory_order_acquire)) {
+        return false;
+    }
+    
+    // Enter the writer gate (a bulk barrier holds us here), then our stripe; a locked
+    // writer (or disabling) sends us to the locked path, as does a view still waiting
+    // for this account's values (the locked path keeps them first)
+    AccountColumns::WriterGuard guard(slot.store());
+    if (slot.viewPending()) {
+        return false;
+    }
+    Stripe& stripe = fast->stripes[threadStripe()];
+    stripe.inFlight.fetch_add(1, std::memory_order_seq_cst);
+    if (fast->writer.load(std::memory_order_seq_cst) || !fast->enabled.load(std::memory_order_acquire)) {
+        stripe.inFlight.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+    
+    bool isDeposit = type == TransactionType::DEPOSIT;
+    Transaction record(IdGenerator::next(), 
+                       isDeposit ? Transaction::kNoAccount : accountIndex, 
+                       isDeposit ? accountIndex : Transaction::kNoAccount, 
+                       type, amount, description);
+    record.status = TransactionStatus::SUCCESS;
+    
+    // Credits go to the stripe when striped, otherwise to the balance itself
+    bool striped = fast->striped.load(std::memory_order_relaxed);
+    std::atomic<Money>& target = striped && isDeposit ? stripe.credits : balance;
+    Money current = target.load(std::memory_order_relaxed);
+    Money updated;
+    for (;;) {
+        if (isDeposit) {
+            if (!Money::tryAdd(current, amount, updated)) {
+                stripe.inFlight.fetch_sub(1, std::memory_order_release);
+                return false;   // Overflow: the locked path reports it
+            }
+        } else if (current < amount) {
+            break;
+        } else {
+            updated = current - amount;
+        }
+        if (target.compare_exchange_weak(current, updated, std::memory_order_release, 
+                                         std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    
+    if (!isDeposit && current < amount) {
+        // Striped debits try the thread's stripe as well; short in both, only the
+        // locked path (which folds every stripe in) can tell whether funds suffice
+        bool covered = false;
+        if (striped) {
+            Money credits = stripe.credits.load(std::memory_order_relaxed);
+            while (credits >= amount && 
+                   !stripe.credits.compare_exchange_weak(credits, credits - amount, std::memory_order_release, 
+                                                         std::memory_order_relaxed)) {
+            }
+            covered = credits >= amount;
+        }
+        if (!covered && striped) {
+            stripe.inFlight.fetch_sub(1, std::memory_order_release);
+            return false;
+        }
+        if (!covered) {
+            record.status = TransactionStatus::INSUFFICIENT_FUNDS;
+        }
+    }
+    
+    // Queue the record before leaving the stripe, so a locked writer finds it when it drains
+    stripe.pending.fetch_add(1, std::memory_order_seq_cst);
+    while (!stripe.records.tryPush(record)) {
+        // Full: drain it ourselves, or give the lock holder (who drains while it waits) a moment
+        if (accountMutex.try_lock()) {
+            drainStripeLocked(*fast, stripe);
+            accountMutex.unlock();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    stripe.inFlight.fetch_sub(1, std::memory_order_release);
+    drainIfIdle(*fast, &stripe);
+    
+    if (recorded) {
+        *recorded = record;
+    }
+    succeeded = record.status == TransactionStatus::SUCCESS;
+    return true;
+}
+
+size_t Account::drainPendingLocked(FastPathState& fast) {
+    size_t drained = 0;
+    for (Stripe& stripe : fast.stripes) {
+        drained += drainStripeLocked(fast, stripe);
+    }
+    return drained;
+}
+
+size_t Account::drainStripeLocked(FastPathState& fast, Stripe& stripe) {
+    size_t drained = 0;
+    Transaction record;
+    while (stripe.records.tryPop(record)) {
+        if (record.status == TransactionStatus::SUCCESS) {
+            fast.journaledBalance = record.type == TransactionType::DEPOSIT ? fast.journaledBalance + record.amount 
+                                                                            : fast.journaledBalance - record.amount;
+        }
+        transactionHistory.append(record);
+        journalLocked(record, fast.journaledBalance, nullptr, Money());
+        stripe.pending.fetch_sub(1, std::memory_order_relaxed);
+        ++drained;
+    }
+    return drained;
+}
+
+void Account::drainIfIdle(FastPathState& fast, Stripe* only) {
+    // Records queued while someone else held the lock are drained by whoever sees them
+    // after it is released; a pass that finds nothing leaves the rest to their producer.
+    // A producer only looks at its own stripe, whoever releases the lock at all of them
+    auto anyPending = [&fast, only]() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (only) {
+            return only->pending.load(std::memory_order_relaxed) != 0;
+        }
+        for (const Stripe& stripe : fast.stripes) {
+            if (stripe.pending.load(std::memory_order_relaxed) != 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+    while (anyPending() && accountMutex.try_lock()) {
+        size_t drained = drainPendingLocked(fast);
+        accountMutex.unlock();
+        if (drained == 0) {
+            break;
+        }
+    }
+}
+
+bool Account::noteContention() {
+    uint32_t threshold = stripeThreshold.load(std::memory_order_relaxed);
+    if (threshold == 0) {
+        return false;
+    }
+    
+    // Counts restart every second; only the acquisition that reaches the threshold reports it
+    uint32_t now = steadyMs();
+    uint32_t windowStart = contentionWindowMs.load(std::memory_order_relaxed);
+    if (now - windowStart >= 1000 && 
+        contentionWindowMs.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+        contendedLocks.store(0, std::memory_order_relaxed);
+    }
+    return contendedLocks.fetch_add(1, std::memory_order_relaxed) + 1 == threshold && !isStriped();
+}
+
+Account::WriteLock::WriteLock(Account& target) 
+    : guard(target.slot.store()), account(&target), gated(false), promote(false) {
+    if (account->accountMutex.try_lock()) {
+        LatencyStats::record(LatencyStage::ACCOUNT_LOCK_WAIT, uint64_t(0));
+        ThreadMonitor::noteAcquired(ThreadMonitor::LockSite::ACCOUNT);
+    } else {
+        promote = account->noteContention();
+        ThreadMonitor::LockWait profile(ThreadMonitor::LockSite::ACCOUNT);
+        ScopedLatency wait(LatencyStage::ACCOUNT_LOCK_WAIT);
+        account->accountMutex.lock();
+    }
+    account->keepForViewLocked();
+    FastPathState* fast = account->fastPath.load(std::memory_order_acquire);
+    if (!fast || !fast->enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    // Wait out in-flight fast operations; draining meanwhile unblocks one stuck on a full queue
+    gated = true;
+    fast->writer.store(true, std::memory_order_seq_cst);
+    for (Stripe& stripe : fast->stripes) {
+        while (stripe.inFlight.load(std::memory_order_seq_cst) != 0) {
+            account->drainStripeLocked(*fast, stripe);
+            std::this_thread::yield();
+        }
+    }
+    account->drainPendingLocked(*fast);
+    
+    // Fold the stripes in: the locked code sees the whole balance in one place
+    Money folded = account->balanceLocked();
+    for (Stripe& stripe : fast->stripes) {
+        folded += stripe.credits.exchange(Money(), std::memory_order_relaxed);
+    }
+    account->setBalanceLocked(folded);
+}
+
+Account::WriteLock::WriteLock(WriteLock&& other) noexcept 
+    : guard(std::move(other.guard)), account(other.account), gated(other.gated), promote(other.promote) {
+    other.account = nullptr;
+}
+
+Account::WriteLock::~WriteLock() {
+    if (!account) {
+        return;
+    }
+    FastPathState* fast = account->fastPath.load(std::memory_order_relaxed);
+    if (gated) {
+        fast->journaledBalance = account->balanceLocked();
+        fast->writer.store(false, std::memory_order_release);
+    }
+    account->accountMutex.unlock();
+    if (fast) {
+        account->drainIfIdle(*fast);
+    }
+    if (promote) {
+        account->setStriped(true);
+    }
+}
+
+bool Account::isActive() const {
     return !accountNumber.empty() && !accountHolderName.empty();
 }
 
 std::string Account::getStatus() const {
-    std::lock_guard<std::mutex> lock(accountMutex);
     if (accountNumber.empty()) return "INVALID";
     if (accountHolderName.empty()) return "UNNAMED";
     return "ACTIVE";
 }
 
 std::string Account::toString() const {
-    std::lock_guard<std::mutex> lock(accountMutex);
-    
+    auto createdTime = std::chrono::system_clock::to_time_t(createdAt);
     std::ostringstream oss;
     oss << "Account Number: " << accountNumber << "\n"
         << "Holder Name: " << accountHolderName << "\n"
-        << "Balance: $" << std::fixed << std::setprecision(2) << balance << "\n"
+        << "Balance: $" << getBalance() << "\n"
         << "Status: " << getStatus() << "\n"
-        << "Created: " << std::put_time(std::localtime(&std::chrono::system_clock::to_time_t(createdAt)), 
-                                       "%Y-%m-%d %H:%M:%S") << "\n"
+        << "Created: " << std::put_time(std::localtime(&createdTime), "%Y-%m-%d %H:%M:%S") << "\n"
         << "Transactions: " << transactionHistory.size();
     
     return oss.str();
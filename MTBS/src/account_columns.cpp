@@ -0,0 +1,244 @@
+#include "../include/account_columns.h"
+#include "../include/account.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+// ============================================================================
+// ACCOUNT COLUMNS IMPLEMENTATION
+// ============================================================================
+
+thread_local const AccountColumns* AccountColumns::guardedStore = nullptr;
+thread_local uint32_t AccountColumns::guardDepth = 0;
+
+std::shared_ptr<AccountColumns> AccountColumns::standalone() {
+    static std::shared_ptr<AccountColumns> store = std::make_shared<AccountColumns>();
+    return store;
+}
+
+size_t AccountColumns::size() const {
+    std::lock_guard<std::mutex> lock(slotMutex);
+    return slotCount - freeSlots.size();
+}
+
+AccountColumns::Chunk* AccountColumns::acquire(Account* owner, size_t& slot) {
+    std::lock_guard<std::mutex> lock(slotMutex);
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        if (slotCount == chunks.size() * kChunkSlots) {
+            chunks.push_back(std::unique_ptr<Chunk>(new Chunk()));
+        }
+        slot = slotCount++;
+    }
+    
+    Chunk* chunk = chunks[slot / kChunkSlots].get();
+    size_t index = slot % kChunkSlots;
+    chunk->balances[index].store(Money(), std::memory_order_relaxed);
+    chunk->minimumBalances[index] = Money();
+    chunk->flags[index].store(0, std::memory_order_relaxed);
+    chunk->owners[index] = owner;
+    chunk->keptEpochs[index].store(0, std::memory_order_relaxed);
+    return chunk;
+}
+
+void AccountColumns::release(size_t slot) {
+    std::lock_guard<std::mutex> lock(slotMutex);
+    Chunk& chunk = *chunks[slot / kChunkSlots];
+    chunk.flags[slot % kChunkSlots].store(0, std::memory_order_relaxed);
+    chunk.owners[slot % kChunkSlots] = nullptr;
+    freeSlots.push_back(slot);
+}
+
+void AccountColumns::waitForGate() {
+    std::unique_lock<std::mutex> lock(gateMutex);
+    gateOpen.wait(lock, [this]() { return !barrierUp.load(std::memory_order_acquire); });
+}
+
+void AccountColumns::raiseBarrier() {
+    // Raise the flag, then wait out the writers that got in before it
+    barrierUp.store(true, std::memory_order_seq_cst);
+    for (WriterCount& count : writers) {
+        while (count.inside.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void AccountColumns::lowerBarrier() {
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        barrierUp.store(false, std::memory_order_release);
+    }
+    gateOpen.notify_all();
+}
+
+AccountColumns::View AccountColumns::view() {
+    if (guardDepth != 0) {
+        throw std::logic_error("Account view taken inside an account operation");
+    }
+    View result;    // Pinned first: accounts unlisted after the cut stay allocated
+    std::lock_guard<std::mutex> exclusive(barrierMutex);
+    
+    // Cut: with no writer inside, open a new epoch; writers let in afterwards keep values for it
+    std::vector<std::pair<Chunk*, size_t>> cut;
+    raiseBarrier();
+    uint64_t epoch = viewEpoch.load(std::memory_order_relaxed) + 1;
+    viewEpoch.store(epoch, std::memory_order_relaxed);
+    viewOpen.store(true, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(slotMutex);
+        cut.reserve(chunks.size());
+        for (size_t index = 0; index < chunks.size(); ++index) {
+            size_t begin = index * kChunkSlots;
+            cut.emplace_back(chunks[index].get(), std::min(slotCount - begin, kChunkSlots));
+        }
+        result.list.reserve(slotCount - freeSlots.size());
+    }
+    lowerBarrier();
+    
+    // A slot's kept values win; otherwise read the live ones and check nobody kept them meanwhile
+    // (a writer keeps before it changes anything, so a changed value means a kept one)
+    for (const auto& range : cut) {
+        Chunk& chunk = *range.first;
+        for (size_t i = 0; i < range.second; ++i) {
+            uint8_t flags = 0;
+            Money balance;
+            bool kept = chunk.keptEpochs[i].load(std::memory_order_acquire) == epoch;
+            if (!kept) {
+                flags = chunk.flags[i].load(std::memory_order_acquire);
+                if (flags & LISTED) {
+                    balance = (flags & FAST_PATH) ? chunk.owners[i]->getBalance() 
+                                                  : chunk.balances[i].load(std::memory_order_acquire);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                kept = chunk.keptEpochs[i].load(std::memory_order_relaxed) == epoch;
+            }
+            if (kept) {
+                flags = chunk.keptFlags[i].load(std::memory_order_relaxed);
+                balance = chunk.keptBalances[i].load(std::memory_order_relaxed);
+            }
+            if (flags & LISTED) {
+                result.list.push_back({chunk.owners[i], balance});
+                result.total += balance;
+            }
+        }
+    }
+    viewOpen.store(false, std::memory_order_release);
+    return result;
+}
+
+// Lease
+
+AccountColumns::Lease::Lease(std::shared_ptr<AccountColumns> store, Account* owner)
+    : columns(std::move(store)), chunk(nullptr), slot(0) {
+    chunk = columns->acquire(owner, slot);
+}
+
+AccountColumns::Lease::~Lease() {
+    columns->release(slot);
+}
+
+void AccountColumns::Lease::setFlag(Flag flag, bool set) const {
+    if (set) {
+        chunk->flags[slot % kChunkSlots].fetch_or(flag, std::memory_order_release);
+    } else {
+        chunk->flags[slot % kChunkSlots].fetch_and(static_cast<uint8_t>(~flag), std::memory_order_release);
+    }
+}
+
+bool AccountColumns::Lease::hasFlag(Flag flag) const {
+    return (chunk->flags[slot % kChunkSlots].load(std::memory_order_relaxed) & flag) != 0;
+}
+
+bool AccountColumns::Lease::viewPending() const {
+    // Both only change at a cut, which no WriterGuard holder can be inside of
+    return columns->viewOpen.load(std::memory_order_acquire) && 
+           chunk->keptEpochs[slot % kChunkSlots].load(std::memory_order_acquire) != 
+               columns->viewEpoch.load(std::memory_order_relaxed);
+}
+
+void AccountColumns::Lease::keepForView(Money balance) const {
+    size_t index = slot % kChunkSlots;
+    chunk->keptBalances[index].store(balance, std::memory_order_relaxed);
+    chunk->keptFlags[index].store(chunk->flags[index].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    chunk->keptEpochs[index].store(columns->viewEpoch.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+// WriterGuard
+
+AccountColumns::WriterGuard::WriterGuard(AccountColumns& store)
+    : columns(&store), slot(0), counted(false), outermost(false) {
+    if (guardedStore == columns) {
+        ++guardDepth;   // Already inside: the barrier is waiting for us, or not up at all
+        return;
+    }
+    
+    // Announce ourselves, then check the flag; a barrier raised in between sees our count
+    slot = ShardedCounterSlots::threadSlot();
+    std::atomic<uint32_t>& inside = columns->writers[slot].inside;
+    for (;;) {
+        inside.fetch_add(1, std::memory_order_seq_cst);
+        if (!columns->barrierUp.load(std::memory_order_seq_cst)) {
+            break;
+        }
+        inside.fetch_sub(1, std::memory_order_release);
+        columns->waitForGate();
+    }
+    counted = true;
+    if (guardDepth == 0) {
+        guardedStore = columns;
+        guardDepth = 1;
+        outermost = true;
+    }
+}
+
+AccountColumns::WriterGuard::WriterGuard(WriterGuard&& other) noexcept
+    : columns(other.columns), slot(other.slot), counted(other.counted), outermost(other.outermost) {
+    other.columns = nullptr;
+}
+
+AccountColumns::WriterGuard::~WriterGuard() {
+    if (!columns) {
+        return;
+    }
+    if (outermost) {
+        guardedStore = nullptr;
+        guardDepth = 0;
+    } else if (!counted) {
+        --guardDepth;
+    }
+    if (counted) {
+        columns->writers[slot].inside.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+// Barrier
+
+AccountColumns::Barrier::Barrier(AccountColumns& store) : columns(store) {
+    if (guardDepth != 0) {
+        throw std::logic_error("Bulk account job started inside an account operation");
+    }
+    std::unique_lock<std::mutex> exclusive(columns.barrierMutex);
+    columns.raiseBarrier();
+    slotLock = std::unique_lock<std::mutex>(columns.slotMutex);
+    exclusive.release();
+    
+    // This thread may still write (folding stripes, posting) without counting itself
+    guardedStore = &columns;
+    guardDepth = 1;
+}
+
+AccountColumns::Barrier::~Barrier() {
+    guardedStore = nullptr;
+    guardDepth = 0;
+    slotLock.unlock();
+    columns.lowerBarrier();
+    columns.barrierMutex.unlock();
+}
+
+size_t AccountColumns::Barrier::slotsIn(size_t index) const {
+    size_t begin = index * kChunkSlots;
+    return columns.slotCount - begin < kChunkSlots ? columns.slotCount - begin : kChunkSlots;
+}
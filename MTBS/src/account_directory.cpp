@@ -0,0 +1,179 @@
+#include "../include/account_directory.h"
+#include "../include/thread_manager.h"
+#include <mutex>
+
+// ============================================================================
+// ACCOUNT DIRECTORY IMPLEMENTATION
+// ============================================================================
+
+namespace {
+    size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+AccountDirectory::AccountDirectory(size_t shardCount)
+    : totalCount(0), activeAccounts(0) {
+    size_t count = roundUpToPowerOfTwo(shardCount == 0 ? 1 : shardCount);
+    shards.reset(new Shard[count]);
+    shardMask = count - 1;
+}
+
+bool AccountDirectory::insert(const std::string& accountNumber, std::shared_ptr<Account> account) {
+    if (!account) {
+        return false;
+    }
+
+    bool active = account->isActive();
+    Shard& shard = shardFor(accountNumber);
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex, std::defer_lock);
+        ThreadMonitor::lockProfiled(lock, ThreadMonitor::LockSite::ACCOUNTS, LatencyStage::DIRECTORY_LOCK_WAIT);
+        auto placed = shard.accounts.emplace(accountNumber, std::move(account));
+        if (!placed.second) {
+            return false; // Number already taken
+        }
+        placed.first->second->setListed(true);
+    }
+
+    totalCount.fetch_add(1, std::memory_order_relaxed);
+    if (active) {
+        activeAccounts.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+size_t AccountDirectory::insertMany(const std::shared_ptr<Account>* batch, size_t count, bool* inserted) {
+    // Bucket by shard so each shard is locked, and its table grown, once
+    std::vector<std::vector<size_t>> byShard(shardMask + 1);
+    std::vector<std::string> numbers(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (inserted) {
+            inserted[i] = false;
+        }
+        if (batch[i]) {
+            numbers[i] = batch[i]->getAccountNumber();
+            byShard[shardIndex(numbers[i])].push_back(i);
+        }
+    }
+
+    size_t added = 0;
+    size_t active = 0;
+    for (size_t s = 0; s < byShard.size(); ++s) {
+        const std::vector<size_t>& indices = byShard[s];
+        if (indices.empty()) {
+            continue;
+        }
+        Shard& shard = shards[s];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.accounts.reserve(shard.accounts.size() + indices.size());
+        for (size_t i : indices) {
+            if (shard.accounts.emplace(std::move(numbers[i]), batch[i]).second) {
+                batch[i]->setListed(true);
+                ++added;
+                active += batch[i]->isActive() ? 1 : 0;
+                if (inserted) {
+                    inserted[i] = true;
+                }
+            }
+        }
+    }
+
+    totalCount.fetch_add(added, std::memory_order_relaxed);
+    activeAccounts.fetch_add(active, std::memory_order_relaxed);
+    return added;
+}
+
+std::shared_ptr<Account> AccountDirectory::find(const std::string& accountNumber) const {
+    const Shard& shard = shardFor(accountNumber);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex, std::defer_lock);
+    ThreadMonitor::lockProfiled(lock, ThreadMonitor::LockSite::ACCOUNTS, LatencyStage::DIRECTORY_LOCK_WAIT);
+    auto it = shard.accounts.find(accountNumber);
+    return (it != shard.accounts.end()) ? it->second : nullptr;
+}
+
+bool AccountDirectory::erase(const std::string& accountNumber) {
+    return eraseIf(accountNumber, [](const Account&) { return true; });
+}
+
+bool AccountDirectory::eraseIf(const std::string& accountNumber,
+                               const std::function<bool(const Account&)>& predicate) {
+    std::shared_ptr<Account> removed;
+    Shard& shard = shardFor(accountNumber);
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.accounts.find(accountNumber);
+        if (it == shard.accounts.end() || !predicate(*it->second)) {
+            return false;
+        }
+        removed = std::move(it->second);
+        shard.accounts.erase(it);
+        removed->setListed(false);
+    }
+
+    accountRemoved(*removed);
+    return true;
+}
+
+void AccountDirectory::clear() {
+    for (size_t i = 0; i <= shardMask; ++i) {
+        std::unordered_map<std::string, std::shared_ptr<Account>> removed;
+        {
+            std::unique_lock<std::shared_mutex> lock(shards[i].mutex);
+            removed.swap(shards[i].accounts);
+        }
+        for (const auto& pair : removed) {
+            pair.second->setListed(false);
+            accountRemoved(*pair.second);
+        }
+    }
+}
+
+size_t AccountDirectory::size() const {
+    return totalCount.load(std::memory_order_relaxed);
+}
+
+size_t AccountDirectory::activeCount() const {
+    return activeAccounts.load(std::memory_order_relaxed);
+}
+
+std::vector<std::shared_ptr<Account>> AccountDirectory::snapshot() const {
+    std::vector<std::shared_ptr<Account>> result;
+    result.reserve(size());
+    forEach([&result](const std::shared_ptr<Account>& account) {
+        result.push_back(account);
+    });
+    return result;
+}
+
+void AccountDirectory::forEach(const std::function<void(const std::shared_ptr<Account>&)>& visitor) const {
+    for (size_t i = 0; i <= shardMask; ++i) {
+        std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+        for (const auto& pair : shards[i].accounts) {
+            visitor(pair.second);
+        }
+    }
+}
+
+size_t AccountDirectory::shardCount() const {
+    return shardMask + 1;
+}
+
+size_t AccountDirectory::shardIndex(const std::string& accountNumber) const {
+    return std::hash<std::string>{}(accountNumber) & shardMask;
+}
+
+AccountDirectory::Shard& AccountDirectory::shardFor(const std::string& accountNumber) const {
+    return shards[shardIndex(accountNumber)];
+}
+
+void AccountDirectory::accountRemoved(const Account& account) {
+    totalCount.fetch_sub(1, std::memory_order_relaxed);
+    if (account.isActive()) {
+        activeAccounts.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,169 @@
+#include "../include/account_number_allocator.h"
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    constexpr char kPrefix[] = "MTBS";
+    constexpr size_t kPrefixLength = sizeof(kPrefix) - 1;
+    constexpr char kDigits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    constexpr uint64_t kSpace = AccountNumberAllocator::kSerialSpace;
+
+    // serial = (ordinal * kMultiplier + kOffset) mod 36^7; kMultiplier is coprime to 36
+    constexpr uint64_t kMultiplier = 47055833459ull;
+    constexpr uint64_t kOffset = 12345678901ull;
+
+    // a * b mod 36^7 without 128-bit arithmetic (both operands are below 2^37)
+    constexpr uint64_t mulMod(uint64_t a, uint64_t b) {
+        uint64_t high = (a * (b >> 20)) % kSpace;
+        high = (high << 20) % kSpace;
+        return (high + (a * (b & 0xFFFFF)) % kSpace) % kSpace;
+    }
+
+    constexpr uint64_t inverseMod(uint64_t value) {
+        int64_t t = 0, newT = 1;
+        int64_t r = static_cast<int64_t>(kSpace), newR = static_cast<int64_t>(value);
+        while (newR != 0) {
+            int64_t quotient = r / newR;
+            int64_t nextT = t - quotient * newT;
+            t = newT;
+            newT = nextT;
+            int64_t nextR = r - quotient * newR;
+            r = newR;
+            newR = nextR;
+        }
+        return static_cast<uint64_t>(t < 0 ? t + static_cast<int64_t>(kSpace) : t);
+    }
+
+    constexpr uint64_t kInverseMultiplier = inverseMod(kMultiplier);
+    static_assert(mulMod(kMultiplier, kInverseMultiplier) == 1, "serial scramble must be a bijection");
+
+    int digitValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+        if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+        return -1;
+    }
+
+    // One per live allocator this thread has allocated from
+    struct Lease {
+        uint64_t allocatorId;
+        std::weak_ptr<const char> allocator;
+        uint64_t next;
+        uint64_t end;
+    };
+    thread_local std::vector<Lease> localLeases;
+
+    std::atomic<uint64_t> nextAllocatorId(1);
+}
+
+// ============================================================================
+// ACCOUNT NUMBER ALLOCATOR IMPLEMENTATION
+// ============================================================================
+
+AccountNumberAllocator::AccountNumberAllocator(uint32_t blockSize)
+    : allocatorId(nextAllocatorId.fetch_add(1, std::memory_order_relaxed)),
+      lifetime(std::make_shared<const char>(0)),
+      blockSize(blockSize == 0 ? 1 : blockSize), nextOrdinal(0), floorOrdinal(0) {
+}
+
+std::string AccountNumberAllocator::allocate() {
+    Lease* lease = nullptr;
+    for (Lease& candidate : localLeases) {
+        if (candidate.allocatorId == allocatorId) {
+            lease = &candidate;
+            break;
+        }
+    }
+    if (!lease) {
+        // First allocation from this allocator on this thread: forget allocators since destroyed
+        localLeases.erase(std::remove_if(localLeases.begin(), localLeases.end(), [](const Lease& stale) {
+            return stale.allocator.expired();
+        }), localLeases.end());
+        localLeases.push_back({allocatorId, lifetime, 0, 0});
+        lease = &localLeases.back();
+    }
+
+    uint64_t floor = floorOrdinal.load(std::memory_order_acquire);
+    while (lease->next == lease->end || lease->next < floor) {
+        uint64_t start = nextOrdinal.fetch_add(blockSize, std::memory_order_relaxed);
+        if (start >= kSerialSpace) {
+            throw std::overflow_error("Account number space exhausted");
+        }
+        lease->next = start;
+        lease->end = std::min<uint64_t>(start + blockSize, kSerialSpace);
+        floor = floorOrdinal.load(std::memory_order_acquire);
+    }
+    return format(lease->next++);
+}
+
+void AccountNumberAllocator::observe(std::string_view accountNumber) {
+    uint64_t ordinal = 0;
+    if (parse(accountNumber, ordinal)) {
+        advanceTo(ordinal + 1);
+    }
+}
+
+void AccountNumberAllocator::advanceTo(uint64_t ordinal) {
+    // Raise the counter first, so no lease taken after the floor moves can start below it
+    uint64_t current = nextOrdinal.load(std::memory_order_relaxed);
+    while (current < ordinal && !nextOrdinal.compare_exchange_weak(current, ordinal, std::memory_order_relaxed)) {
+    }
+    current = floorOrdinal.load(std::memory_order_relaxed);
+    while (current < ordinal && !floorOrdinal.compare_exchange_weak(current, ordinal, std::memory_order_release)) {
+    }
+}
+
+uint64_t AccountNumberAllocator::getNextOrdinal() const {
+    return nextOrdinal.load(std::memory_order_relaxed);
+}
+
+std::string AccountNumberAllocator::format(uint64_t ordinal) {
+    uint64_t serial = (mulMod(ordinal % kSerialSpace, kMultiplier) + kOffset) % kSerialSpace;
+
+    std::string number(kNumberLength, '-');
+    number.replace(0, kPrefixLength, kPrefix);
+    for (size_t i = 0; i < kSerialDigits; ++i) {
+        number[kPrefixLength + kSerialDigits - i] = kDigits[serial % 36];   // Positions 5..11
+        serial /= 36;
+    }
+    number[kNumberLength - 1] = checkCharacter(std::string_view(number.data(), kNumberLength - 2));
+    return number;
+}
+
+bool AccountNumberAllocator::parse(std::string_view accountNumber, uint64_t& ordinal) {
+    if (accountNumber.size() != kNumberLength || accountNumber.compare(0, kPrefixLength, kPrefix) != 0 ||
+        accountNumber[kPrefixLength] != '-' || accountNumber[kNumberLength - 2] != '-') {
+        return false;
+    }
+
+    uint64_t serial = 0;
+    for (size_t i = kPrefixLength + 1; i < kNumberLength - 2; ++i) {
+        char c = accountNumber[i];
+        int value = digitValue(c);
+        if (value < 0 || (c >= 'a' && c <= 'z')) {
+            return false;
+        }
+        serial = serial * 36 + static_cast<uint64_t>(value);
+    }
+    if (accountNumber[kNumberLength - 1] != checkCharacter(accountNumber.substr(0, kNumberLength - 2))) {
+        return false;
+    }
+
+    ordinal = mulMod((serial + kSerialSpace - kOffset) % kSerialSpace, kInverseMultiplier);
+    return true;
+}
+
+char AccountNumberAllocator::checkCharacter(std::string_view text) {
+    // ISO 7064 MOD 37,36 (hybrid system)
+    unsigned product = 36;
+    for (char c : text) {
+        int value = digitValue(c);
+        if (value < 0) {
+            continue;
+        }
+        unsigned sum = (product + static_cast<unsigned>(value)) % 36;
+        product = ((sum == 0 ? 36 : sum) * 2) % 37;
+    }
+    return kDigits[(37 - product) % 36];
+}
@@ -0,0 +1,223 @@
+#include "../include/admission_controller.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace {
+    size_t roundUpToPowerOfTwo(size_t value) {
+        size_t power = 1;
+        while (power < value) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    std::chrono::milliseconds ceilMillis(int64_t nanoseconds) {
+        return std::chrono::milliseconds((std::max<int64_t>(nanoseconds, 1) + 999999) / 1000000);
+    }
+}
+
+// ============================================================================
+// TOKEN BUCKETS IMPLEMENTATION
+// ============================================================================
+
+TokenBuckets::TokenBuckets(double ratePerSecond, double burst, size_t shardCount)
+    : rate(ratePerSecond > 0 ? ratePerSecond : 0),
+      burst(burst > 0 ? burst : std::max(ratePerSecond, 1.0)) {
+    size_t count = roundUpToPowerOfTwo(shardCount == 0 ? 1 : shardCount);
+    shards = std::make_unique<Shard[]>(count);
+    shardMask = count - 1;
+}
+
+uint64_t TokenBuckets::keyOf(std::string_view name) {
+    return std::hash<std::string_view>()(name);
+}
+
+std::chrono::microseconds TokenBuckets::tryTake(uint64_t key, double tokens) {
+    if (rate <= 0) {
+        return std::chrono::microseconds(0);
+    }
+
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    // The low bits pick the bucket within a shard's map; mix them before picking the shard
+    Shard& shard = shards[(key ^ (key >> 29)) & shardMask];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (shard.buckets.size() >= kPruneThreshold) {
+        // A bucket that has refilled is indistinguishable from one never created
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+            double refilled = it->second.tokens + (now - it->second.refilledNs) * 1e-9 * rate;
+            it = refilled >= burst ? shard.buckets.erase(it) : std::next(it);
+        }
+    }
+
+    auto inserted = shard.buckets.emplace(key, Bucket{burst, now});
+    Bucket& bucket = inserted.first->second;
+    bucket.tokens = std::min(burst, bucket.tokens + (now - bucket.refilledNs) * 1e-9 * rate);
+    bucket.refilledNs = now;
+    if (bucket.tokens >= tokens) {
+        bucket.tokens -= tokens;
+        return std::chrono::microseconds(0);
+    }
+    double wait = (tokens - bucket.tokens) / rate;
+    return std::chrono::microseconds(static_cast<int64_t>(std::ceil(wait * 1e6)));
+}
+
+bool TokenBuckets::isEnabled() const {
+    return rate > 0;
+}
+
+double TokenBuckets::getRate() const {
+    return rate;
+}
+
+double TokenBuckets::getBurst() const {
+    return burst;
+}
+
+size_t TokenBuckets::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i <= shardMask; ++i) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        total += shards[i].buckets.size();
+    }
+    return total;
+}
+
+// ============================================================================
+// ADMISSION CONTROLLER IMPLEMENTATION
+// ============================================================================
+
+std::string AdmissionController::Decision::message() const {
+    switch (verdict) {
+        case Verdict::ADMITTED:
+            return "Admitted";
+        case Verdict::OVER_LIMIT:
+            return "Too many transactions in flight, retry in " + std::to_string(retryAfter.count()) + " ms";
+        case Verdict::RATE_LIMITED:
+            return "Account rate limit exceeded, retry in " + std::to_string(retryAfter.count()) + " ms";
+    }
+    return "Rejected";
+}
+
+AdmissionController::AdmissionController() : AdmissionController(Options()) {
+}
+
+AdmissionController::AdmissionController(const Options& options)
+    : options(options), accountBuckets(options.accountRate, options.accountBurst),
+      inFlight(0), limit(0), windowEndNs(0), windowWorstNs(0), windowPeakInFlight(0),
+      lastWindowWorstNs(0), limitIncreases(0), limitDecreases(0) {
+    this->options.minLimit = std::max<size_t>(this->options.minLimit, 1);
+    this->options.maxLimit = std::max(this->options.maxLimit, this->options.minLimit);
+    size_t initial = this->options.initialLimit ? this->options.initialLimit : this->options.maxLimit;
+    limit.store(std::clamp(initial, this->options.minLimit, this->options.maxLimit));
+    windowEndNs.store(nowNs() + std::chrono::duration_cast<std::chrono::nanoseconds>(options.window).count());
+}
+
+AdmissionController::Decision AdmissionController::tryAdmit(std::string_view accountNumber) {
+    Decision decision;
+    if (accountBuckets.isEnabled()) {
+        std::chrono::microseconds wait = accountBuckets.tryTake(TokenBuckets::keyOf(accountNumber));
+        if (wait.count() > 0) {
+            counters.add(RATE_LIMITED_COUNT);
+            decision.verdict = Verdict::RATE_LIMITED;
+            decision.retryAfter = ceilMillis(std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count());
+            return decision;
+        }
+    }
+
+    size_t current = inFlight.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (current > limit.load(std::memory_order_relaxed)) {
+        inFlight.fetch_sub(1, std::memory_order_acq_rel);
+        counters.add(OVER_LIMIT_COUNT);
+        decision.verdict = Verdict::OVER_LIMIT;
+        decision.retryAfter = retryHint();
+        return decision;
+    }
+
+    // Written only when a new peak is reached, which is rare once the window has warmed up
+    size_t peak = windowPeakInFlight.load(std::memory_order_relaxed);
+    while (current > peak && !windowPeakInFlight.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+    }
+    counters.add(ADMITTED_COUNT);
+    return decision;
+}
+
+void AdmissionController::release(size_t permits) {
+    inFlight.fetch_sub(permits, std::memory_order_acq_rel);
+}
+
+void AdmissionController::recordQueueDelay(std::chrono::nanoseconds delay) {
+    int64_t sample = delay.count();
+    int64_t worst = windowWorstNs.load(std::memory_order_relaxed);
+    while (sample > worst && !windowWorstNs.compare_exchange_weak(worst, sample, std::memory_order_relaxed)) {
+    }
+
+    int64_t now = nowNs();
+    int64_t end = windowEndNs.load(std::memory_order_relaxed);
+    int64_t window = std::chrono::duration_cast<std::chrono::nanoseconds>(options.window).count();
+    if (now >= end && windowEndNs.compare_exchange_strong(end, now + window, std::memory_order_relaxed)) {
+        closeWindow();
+    }
+}
+
+size_t AdmissionController::getLimit() const {
+    return limit.load(std::memory_order_relaxed);
+}
+
+size_t AdmissionController::getInFlight() const {
+    return inFlight.load(std::memory_order_relaxed);
+}
+
+AdmissionController::Statistics AdmissionController::getStatistics() const {
+    std::array<uint64_t, COUNTER_COUNT> counts = counters.snapshot();
+    Statistics stats;
+    stats.admitted = counts[ADMITTED_COUNT];
+    stats.overLimit = counts[OVER_LIMIT_COUNT];
+    stats.rateLimited = counts[RATE_LIMITED_COUNT];
+    stats.inFlight = getInFlight();
+    stats.limit = getLimit();
+    stats.minLimit = options.minLimit;
+    stats.maxLimit = options.maxLimit;
+    stats.limitIncreases = limitIncreases.load(std::memory_order_relaxed);
+    stats.limitDecreases = limitDecreases.load(std::memory_order_relaxed);
+    stats.queueDelay = std::chrono::microseconds(lastWindowWorstNs.load(std::memory_order_relaxed) / 1000);
+    stats.targetQueueDelay = options.targetQueueDelay;
+    stats.accountRate = accountBuckets.getRate();
+    stats.rateLimitedAccounts = accountBuckets.isEnabled() ? accountBuckets.size() : 0;
+    return stats;
+}
+
+// Roughly when the queue ahead will have drained: the last window's queueing delay
+std::chrono::milliseconds AdmissionController::retryHint() const {
+    return ceilMillis(lastWindowWorstNs.load(std::memory_order_relaxed));
+}
+
+void AdmissionController::closeWindow() {
+    int64_t worst = windowWorstNs.exchange(0, std::memory_order_relaxed);
+    size_t peak = windowPeakInFlight.exchange(inFlight.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    lastWindowWorstNs.store(worst, std::memory_order_relaxed);
+
+    size_t current = limit.load(std::memory_order_relaxed);
+    size_t next = current;
+    int64_t target = std::chrono::duration_cast<std::chrono::nanoseconds>(options.targetQueueDelay).count();
+    if (worst > target) {
+        // Multiplicative decrease, by at least one
+        next = std::min(current - 1, static_cast<size_t>(current * options.decreaseFactor));
+        next = std::max(next, options.minLimit);
+    } else if (peak * 5 >= current * 4) {
+        // Additive increase, and only while the limit is what holds the load back
+        next = std::min(current + std::max<size_t>(1, current / 16), options.maxLimit);
+    }
+
+    if (next != current) {
+        limit.store(next, std::memory_order_relaxed);
+        (next > current ? limitIncreases : limitDecreases).fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+int64_t AdmissionController::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
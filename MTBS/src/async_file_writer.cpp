@@ -0,0 +1,330 @@
+#include "../include/async_file_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    std::atomic<uint64_t> nextWriterId(1);
+
+    // Buffers of the writers this thread has appended to
+    struct LocalBufferSlot {
+        uint64_t writerId;
+        void* buffer;
+    };
+    thread_local std::vector<LocalBufferSlot> localBufferSlots;
+}
+
+// ============================================================================
+// ASYNC FILE WRITER IMPLEMENTATION
+// ============================================================================
+
+AsyncFileWriter::AsyncFileWriter(const std::string& path)
+    : AsyncFileWriter(path, Options()) {
+}
+
+AsyncFileWriter::AsyncFileWriter(const std::string& path, const Options& options)
+    : path(path), options(options), fileDescriptor(openFile(path)),
+      writerId(nextWriterId.fetch_add(1, std::memory_order_relaxed)),
+      appended(0), durable(0), writerIdle(false), writeError(fileDescriptor < 0 ? errno : 0),
+      flushRequested(0), stopping(false), writeCalls(0), syncCalls(0) {
+    if (this->options.groupRecords == 0) {
+        this->options.groupRecords = 1;
+    }
+    writerThread = std::thread(&AsyncFileWriter::writerLoop, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeWriter.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    closeFile(fileDescriptor);
+}
+
+uint64_t AsyncFileWriter::append(const void* data, size_t size) {
+    ThreadBuffer& buffer = localBuffer();
+    const char* bytes = static_cast<const char*>(data);
+
+    uint64_t ticket;
+    {
+        // Ticket and bytes go in together, so the writer thread never sees
+        // a ticket whose record is not in a buffer yet
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        ticket = appended.fetch_add(1, std::memory_order_seq_cst) + 1;
+        if (writeError.load(std::memory_order_relaxed) == 0) {
+            buffer.data.insert(buffer.data.end(), bytes, bytes + size);   // A failed writer drops it
+        }
+    }
+
+    // Wake an idle writer, or one that is waiting for its group to fill up
+    if (writerIdle.load(std::memory_order_seq_cst) || ticket % options.groupRecords == 0) {
+        wakeWriterThread();
+    }
+    return ticket;
+}
+
+uint64_t AsyncFileWriter::append(const std::string& text) {
+    return append(text.data(), text.size());
+}
+
+bool AsyncFileWriter::commit(uint64_t ticket) {
+    if (durable.load(std::memory_order_acquire) >= ticket) {
+        return true;
+    }
+    if (options.durability == Durability::ASYNC) {
+        return writeError.load(std::memory_order_acquire) == 0;     // Only a failure already seen is reported
+    }
+
+    std::unique_lock<std::mutex> lock(stateMutex);
+    wakeWriter.notify_one();
+    committed.wait(lock, [this, ticket]() {
+        return durable.load(std::memory_order_acquire) >= ticket || stopping || 
+               writeError.load(std::memory_order_acquire) != 0;
+    });
+    return durable.load(std::memory_order_acquire) >= ticket;
+}
+
+bool AsyncFileWriter::flush() {
+    uint64_t target = appended.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(stateMutex);
+    flushRequested = std::max(flushRequested, target);
+    wakeWriter.notify_one();
+    committed.wait(lock, [this, target]() {
+        return durable.load(std::memory_order_acquire) >= target || stopping || 
+               writeError.load(std::memory_order_acquire) != 0;
+    });
+    return durable.load(std::memory_order_acquire) >= target;
+}
+
+bool AsyncFileWriter::reopen(const std::string& newPath) {
+    if (!flush()) {
+        return false;
+    }
+
+    int descriptor = openFile(newPath);
+    if (descriptor < 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(ioMutex);
+    closeFile(fileDescriptor);
+    fileDescriptor = descriptor;
+    path = newPath;
+    return true;
+}
+
+bool AsyncFileWriter::isOpen() const {
+    std::lock_guard<std::mutex> lock(ioMutex);
+    return fileDescriptor >= 0;
+}
+
+int AsyncFileWriter::getError() const {
+    return writeError.load(std::memory_order_acquire);
+}
+
+std::string AsyncFileWriter::getPath() const {
+    std::lock_guard<std::mutex> lock(ioMutex);
+    return path;
+}
+
+AsyncFileWriter::Durability AsyncFileWriter::getDurability() const {
+    return options.durability;
+}
+
+uint64_t AsyncFileWriter::getAppendedRecords() const {
+    return appended.load();
+}
+
+uint64_t AsyncFileWriter::getDurableRecords() const {
+    return durable.load();
+}
+
+uint64_t AsyncFileWriter::getWriteCalls() const {
+    return writeCalls.load();
+}
+
+uint64_t AsyncFileWriter::getSyncCalls() const {
+    return syncCalls.load();
+}
+
+// ----------------------------------------------------------------------------
+// Thread buffers
+// ----------------------------------------------------------------------------
+
+AsyncFileWriter::ThreadBuffer& AsyncFileWriter::localBuffer() {
+    for (const LocalBufferSlot& slot : localBufferSlots) {
+        if (slot.writerId == writerId) {
+            return *static_cast<ThreadBuffer*>(slot.buffer);
+        }
+    }
+
+    // First append from this thread: register a buffer with the writer
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffers.push_back(std::make_unique<ThreadBuffer>());
+    ThreadBuffer* buffer = buffers.back().get();
+    localBufferSlots.push_back({writerId, buffer});
+    return *buffer;
+}
+
+// ----------------------------------------------------------------------------
+// Writer thread
+// ----------------------------------------------------------------------------
+
+void AsyncFileWriter::writerLoop() {
+    std::vector<char> batch;
+
+    while (true) {
+        bool syncRequested = false;
+        bool exiting = false;
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            if (writeError.load(std::memory_order_relaxed) != 0) {
+                // Failed: durable stays where it is, and waiters have been released
+                wakeWriter.wait(lock, [this]() { return stopping; });
+                break;
+            }
+            auto pending = [this]() {
+                return appended.load(std::memory_order_seq_cst) - durable.load(std::memory_order_relaxed);
+            };
+            auto flushPending = [this]() {
+                return flushRequested > durable.load(std::memory_order_relaxed);
+            };
+
+            if (pending() == 0 && !stopping) {
+                // Appenders check writerIdle after bumping appended, so either
+                // they see the flag or this predicate sees their record
+                writerIdle.store(true, std::memory_order_seq_cst);
+                wakeWriter.wait(lock, [&]() { return pending() > 0 || stopping || flushPending(); });
+                writerIdle.store(false, std::memory_order_relaxed);
+            }
+
+            // Group commit: gather records until the group is full or the window closes
+            if (options.durability == Durability::GROUP && pending() > 0 && !stopping && !flushPending()) {
+                wakeWriter.wait_for(lock, options.groupWindow, [&]() {
+                    return pending() >= options.groupRecords || stopping || flushPending();
+                });
+            }
+
+            syncRequested = flushPending() || stopping;
+            exiting = stopping;
+        }
+
+        // Read the target before draining: every ticket up to it is already in a buffer
+        uint64_t target = appended.load(std::memory_order_acquire);
+        bool written = true;
+        if (target != durable.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                for (auto& buffer : buffers) {
+                    std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                    batch.insert(batch.end(), buffer->data.begin(), buffer->data.end());
+                    buffer->data.clear();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(ioMutex);
+            written = writeAll(batch.data(), batch.size());
+            if (written && (options.durability != Durability::ASYNC || syncRequested)) {
+                written = syncFile();
+            }
+            batch.clear();
+        } else if (syncRequested) {
+            std::lock_guard<std::mutex> lock(ioMutex);
+            written = syncFile();
+        }
+
+        int error = written ? 0 : (errno ? errno : EIO);
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (written) {
+                durable.store(target, std::memory_order_release);
+            } else {
+                writeError.store(error, std::memory_order_release);
+            }
+        }
+        committed.notify_all();
+
+        if (exiting && appended.load(std::memory_order_acquire) == target) {
+            break;
+        }
+    }
+}
+
+void AsyncFileWriter::wakeWriterThread() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    wakeWriter.notify_one();
+}
+
+// ----------------------------------------------------------------------------
+// File access
+// ----------------------------------------------------------------------------
+
+bool AsyncFileWriter::writeAll(const char* data, size_t size) {
+    if (fileDescriptor < 0) {
+        errno = EBADF;
+        return false;
+    }
+
+    writeCalls.fetch_add(1, std::memory_order_relaxed);
+    while (size > 0) {
+#ifdef _WIN32
+        int written = ::_write(fileDescriptor, data, static_cast<unsigned int>(size));
+#else
+        ssize_t written = ::write(fileDescriptor, data, size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool AsyncFileWriter::syncFile() {
+    if (fileDescriptor < 0) {
+        errno = EBADF;
+        return false;
+    }
+
+    syncCalls.fetch_add(1, std::memory_order_relaxed);
+#ifdef _WIN32
+    return ::_commit(fileDescriptor) == 0;
+#elif defined(__APPLE__)
+    return ::fsync(fileDescriptor) == 0;
+#else
+    return ::fdatasync(fileDescriptor) == 0;
+#endif
+}
+
+int AsyncFileWriter::openFile(const std::string& path) {
+#ifdef _WIN32
+    return ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0644);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+}
+
+void AsyncFileWriter::closeFile(int descriptor) {
+    if (descriptor < 0) {
+        return;
+    }
+#ifdef _WIN32
+    ::_close(descriptor);
+#else
+    ::close(descriptor);
+#endif
+}
@@ -1,5 +1,8 @@
 #include "../include/bank.h"
 #include "../include/bank_utils.h"
+#include "../include/id_generator.h"
+#include "../include/latency_histogram.h"
+#include "../include/scratch_arena.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -7,6 +10,172 @@
 #include <algorithm>
 #include <fstream>
 #include <random>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <tuple>
+
+namespace {
+    std::unique_ptr<Journal> makeJournal(const Bank::Config& config) {
+        if (!config.enableJournal) {
+            return nullptr;
+        }
+        AsyncFileWriter::Options options;
+        options.durability = config.journalDurability;
+        options.groupRecords = config.journalGroupRecords;
+        options.groupWindow = config.journalGroupWindow;
+        return std::make_unique<Journal>(config.journalPath, options);
+    }
+    
+    // Evicted history is only read back on request, so it is never waited for
+    std::shared_ptr<AsyncFileWriter> makeHistoryArchive(const Bank::Config& config) {
+        if (!config.enableJournal || config.historyArchivePath.empty()) {
+            return nullptr;
+        }
+        AsyncFileWriter::Options options;
+        options.durability = AsyncFileWriter::Durability::ASYNC;
+        return std::make_shared<AsyncFileWriter>(config.historyArchivePath, options);
+    }
+    
+    // Admission limit ceiling: a full pipeline batch queued per worker
+    size_t admissionCeiling(const Bank::Config& config) {
+        size_t floor = std::max<size_t>(config.maxConcurrentTransactions, 1);
+        size_t ceiling = config.admissionMaxInFlight ? config.admissionMaxInFlight 
+                                                     : floor * std::max<size_t>(config.pipelineBatchSize, 1);
+        return std::max(ceiling, floor);
+    }
+    
+    std::unique_ptr<AdmissionController> makeAdmissionController(const Bank::Config& config) {
+        if (!config.enableAdmissionControl) {
+            return nullptr;
+        }
+        AdmissionController::Options options;
+        options.minLimit = std::max<size_t>(config.maxConcurrentTransactions, 1);
+        options.maxLimit = admissionCeiling(config);
+        options.targetQueueDelay = config.admissionTargetQueueDelay;
+        options.accountRate = config.accountRateLimit;
+        options.accountBurst = config.accountRateBurst;
+        return std::make_unique<AdmissionController>(options);
+    }
+    
+    const char* durabilityName(AsyncFileWriter::Durability durability) {
+        switch (durability) {
+            case AsyncFileWriter::Durability::ASYNC: return "ASYNC";
+            case AsyncFileWriter::Durability::GROUP: return "GROUP";
+            case AsyncFileWriter::Durability::EVERY_RECORD: return "EVERY_RECORD";
+        }
+        return "UNKNOWN";
+    }
+    
+    // Quoted and escaped, for names that reach the JSON snapshot from callers (task descriptions)
+    std::string jsonString(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+                quoted += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                quoted += ' ';
+            } else {
+                quoted += c;
+            }
+        }
+        return quoted + "\"";
+    }
+    
+    // Why Account rejected a withdrawal or transfer: it only rejects bad amounts and short balances
+    TransactionStatus debitFailure(Money amount) {
+        return amount.isPositive() ? TransactionStatus::INSUFFICIENT_FUNDS : TransactionStatus::FAILED;
+    }
+    
+    // History entry rebuilt from a replayed journal record
+    Transaction transactionFromRecord(const JournalRecord& record) {
+        uint32_t account = StringTable::accountNumbers().intern(record.account);
+        uint32_t counterparty = record.counterparty.empty() ? Transaction::kNoAccount 
+                                                            : StringTable::accountNumbers().intern(record.counterparty);
+        bool isDeposit = record.type == TransactionType::DEPOSIT;
+        Transaction transaction(record.transactionId, 
+                                isDeposit ? Transaction::kNoAccount : account, 
+                                isDeposit ? account : counterparty, 
+                                record.type, record.amount, 
+                                Transaction::internDescription(record.text), record.flags);
+        transaction.status = record.status;
+        transaction.timestamp = record.timestamp;
+        return transaction;
+    }
+    
+    // ID of a new account's opening deposit (0 if it opened empty), journalled with the opening
+    uint64_t openingDepositId(const Account& account) {
+        std::vector<Transaction> first = account.getTransactionHistory(0, 1);
+        return !first.empty() && (first.front().flags & Transaction::FLAG_INITIAL_DEPOSIT) ? first.front().id : 0;
+    }
+    
+    // The inverse, for a replication bootstrap: a history entry as a TRANSACTION record (LSN 0)
+    JournalRecord recordFromTransaction(const Transaction& transaction) {
+        bool isDeposit = transaction.type == TransactionType::DEPOSIT;
+        JournalRecord record;
+        record.kind = JournalRecordKind::TRANSACTION;
+        record.transactionId = transaction.id;
+        record.timestamp = transaction.timestamp;
+        record.type = transaction.type;
+        record.status = transaction.status;
+        record.flags = transaction.flags;
+        record.amount = transaction.amount;
+        record.account = isDeposit ? transaction.getToAccount() : transaction.getFromAccount();
+        record.counterparty = isDeposit ? std::string() : transaction.getToAccount();
+        record.text = transaction.getDescription();
+        return record;
+    }
+    
+    // One side of a journalled transaction, replayed or replicated: its history entry and balance
+    void applyJournalledTransaction(Account& account, const JournalRecord& record, Money balanceAfter) {
+        account.addTransaction(transactionFromRecord(record));
+        account.restoreState(record.status == TransactionStatus::SUCCESS ? balanceAfter : account.getBalance(), 
+                             record.lsn);
+    }
+    
+    // Writes to a follower fail with this; it is read-only until promoted
+    const char* const kReplicaWrites = "Read-only replica: writes go to the primary";
+    constexpr size_t kParallelApplyRecords = 256;   // Smaller replicated frames are applied inline
+    
+    Bank::TransactionResult replicaRejection() {
+        return Bank::TransactionResult(false, kReplicaWrites, 0, Money(), std::chrono::system_clock::now());
+    }
+    
+    std::future<Bank::TransactionResult> rejectedOnReplica() {
+        std::promise<Bank::TransactionResult> rejected;
+        rejected.set_value(replicaRejection());
+        return rejected.get_future();
+    }
+    
+    // Bulk-job kernels over one chunk of the account columns: straight loops over plain
+    // arrays, with every per-account condition a select rather than a branch, so that the
+    // compiler can turn them into packed operations
+    constexpr uint8_t kInterestMask = AccountColumns::LISTED | AccountColumns::NO_INTEREST;
+    constexpr uint8_t kFeeMask = AccountColumns::LISTED | AccountColumns::NO_FEES;
+    constexpr double kMaxInterestCents = 9.2e18;   // Below 2^63: the conversion stays defined
+    
+    void interestKernel(const int64_t* balances, const uint8_t* flags, size_t count, 
+                        double factor, int64_t* amounts) {
+        for (size_t i = 0; i < count; ++i) {
+            bool eligible = (flags[i] & kInterestMask) == AccountColumns::LISTED;
+            int64_t principal = eligible && balances[i] > 0 ? balances[i] : 0;
+            double interest = static_cast<double>(principal) * factor + 0.5;   // Half up
+            amounts[i] = interest < kMaxInterestCents ? static_cast<int64_t>(interest) : 0;
+        }
+    }
+    
+    void feeKernel(const int64_t* balances, const uint8_t* flags, const int64_t* minimumBalances, 
+                   size_t count, int64_t maintenanceFee, int64_t lowBalanceFee, int64_t* amounts) {
+        for (size_t i = 0; i < count; ++i) {
+            bool eligible = (flags[i] & kFeeMask) == AccountColumns::LISTED;
+            int64_t due = maintenanceFee + (balances[i] < minimumBalances[i] ? lowBalanceFee : 0);
+            int64_t available = balances[i] > 0 ? balances[i] : 0;
+            amounts[i] = eligible ? (due < available ? due : available) : 0;
+        }
+    }
+}
 
 // ============================================================================
 // BANK CONFIG IMPLEMENTATION
@@ -55,24 +224,92 @@ std::string BankException::getErrorMessage() const {
 // ============================================================================
 
 Bank::Bank(const Config& config)
-    : config(config), systemRunning(false), totalTransactions(0), 
-      successfulTransactions(0), failedTransactions(0), accountCounter(0) {
+    : config(config), journal(makeJournal(config)), historyArchive(makeHistoryArchive(config)), columns(std::make_shared<AccountColumns>()), 
+      accounts(config.directoryShards), systemRunning(false), 
+      snapshotThreadStop(false), recoveryDone(false), journalFailureLogged(false), 
+      replicationRole(config.replicationRole) {
+    
+    // New LSNs and transaction IDs continue after anything already on disk,
+    // even before recovery runs or when it is disabled
+    IdGenerator::setNode(config.nodeId);
+    bool durableOnReturn = journal && config.journalDurability != AsyncFileWriter::Durability::ASYNC;
+    Account::setStripeThreshold(durableOnReturn ? 0 : config.stripeThreshold);
+    SnapshotData persisted;
+    bool havePersisted = !config.snapshotPath.empty() && Snapshot::readHeader(config.snapshotPath, persisted);
+    if (journal) {
+        journal->advanceLsn(havePersisted ? persisted.snapshotLsn : 0);
+        IdGenerator::observe(journal->getHighestTransactionId());
+    }
+    if (havePersisted) {
+        IdGenerator::observe(persisted.lastTransactionId);
+        accountNumbers.advanceTo(persisted.nextAccountOrdinal);
+    }
     
     // Initialize transaction processing components
     transactionProcessor = std::make_unique<TransactionProcessor>();
     transactionLogger = std::make_unique<TransactionLogger>("bank_transactions.log");
     
-    // Initialize thread management components
-    threadPool = std::make_unique<ThreadPool>(config.maxConcurrentTransactions);
-    workQueue = std::make_unique<WorkQueue>(config.maxConcurrentTransactions);
+    // Initialize thread management components. Admitted work never waits for room in the pool's
+    // injection ring (at most one task per admitted transaction plus one per pipeline lane), and
+    // the work queue rejects rather than blocks when full
+    admission = makeAdmissionController(config);
     threadMonitor = std::make_unique<ThreadMonitor>();
+    threadMonitor->trackShards(accounts.shardCount());
+    if (config.lockContentionSampling) {
+        ThreadMonitor::setContentionSampling(config.lockContentionSampling);
+    }
+    size_t injectionCapacity = std::max<size_t>(4096, admissionCeiling(config) + accounts.shardCount());
+    threadPool = std::make_unique<ThreadPool>(config.maxConcurrentTransactions, injectionCapacity, config.shardAffinity);
+    threadPool->setMonitor(threadMonitor.get());
+    workQueue = std::make_unique<WorkQueue>(config.maxConcurrentTransactions, BackpressurePolicy::REJECT);
+    
+    // Pipeline front-end; its journal stage feeds statistics and the audit log
+    transactionPipeline = std::make_unique<TransactionPipeline>(accounts, *threadPool, 
+                                                                config.pipelineBatchSize, 
+                                                                config.pipelineLaneCapacity);
+    transactionPipeline->setJournalHook([this](TransactionType type, const std::string& accountNumber, 
+                                               const std::string& targetAccount, Money amount, 
+                                               TransactionStatus status) {
+        recordPipelineOutcome(type, accountNumber, targetAccount, amount, status);
+    });
+    transactionPipeline->setCommitHook([this]() {
+        return commitJournal();
+    });
+    transactionPipeline->setAdmissionController(admission.get());
+    transactionPipeline->setBatchHook([this](size_t lane, size_t operations, std::chrono::nanoseconds busy) {
+        threadMonitor->recordShardBatch(lane, ThreadPool::currentWorkerIndex(), operations, busy);
+    });
+    transactionPipeline->setLaneAffinity(config.shardAffinity);
+    
+    // Replication: a primary taps the journal from here on; a follower connects when started
+    if (config.replicationRole == ReplicationRole::PRIMARY) {
+        if (!journal) {
+            throw BankException(BankException::ErrorType::SYSTEM_ERROR, 
+                               "A replication primary needs the journal (enableJournal)");
+        }
+        replicationServer = std::make_unique<ReplicationServer>(*journal, replicationServerOptions(), 
+            [this](const std::function<uint64_t()>& cut, const std::function<void(const JournalRecord&)>& emit) {
+                streamReplicaSnapshot(cut, emit);
+            });
+    } else if (config.replicationRole == ReplicationRole::FOLLOWER) {
+        ReplicationFollower::Options options;
+        options.primaryAddress = config.replicationPrimary;
+        options.primaryPort = config.replicationPrimaryPort;
+        replicationFollower = std::make_unique<ReplicationFollower>(options, 
+            [this](uint64_t) { resetReplica(); }, 
+            [this](std::vector<JournalRecord>& records, bool bootstrap) { applyReplicated(records, bootstrap); });
+    }
 }
 
 Bank::~Bank() {
     stopBankingSystem();
 }
 
-std::string Bank::createAccount(const std::string& holderName, double initialBalance) {
+std::string Bank::createAccount(const std::string& holderName, Money initialBalance) {
+    if (isReplica()) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, kReplicaWrites);
+    }
+    
     // Validate input
     if (holderName.empty()) {
         throw BankException(BankException::ErrorType::INVALID_ACCOUNT_NUMBER, 
@@ -91,45 +328,192 @@ std::string Bank::createAccount(const std::string& holderName, double initialBal
     }
     
     // Generate unique account number
-    std::string accountNumber = BankUtils::generateAccountNumber();
+    std::string accountNumber = generateAccountNumber();
     
     // Create account
-    auto account = std::make_shared<Account>(accountNumber, holderName, initialBalance);
+    auto account = makeAccount(accountNumber, holderName, initialBalance);
     
-    // Add to accounts map (THREAD-SAFE)
     {
-        std::lock_guard<std::mutex> lock(accountsMutex);
-        accounts[accountNumber] = account;
+        // A snapshot cut never falls between journaling the opening and the insert
+        std::shared_lock<std::shared_mutex> gate(accountCreationGate);
+        
+        // Journal the opening before the account is visible, so its LSN precedes
+        // every transaction on it
+        if (journal) {
+            JournalRecord opened;
+            opened.kind = JournalRecordKind::ACCOUNT_OPENED;
+            opened.timestamp = account->getCreatedAt();
+            opened.amount = initialBalance;
+            opened.account = accountNumber;
+            opened.balanceAfter = initialBalance;
+            opened.text = holderName;
+            opened.transactionId = openingDepositId(*account);
+            account->attachJournal(journal.get(), journal->append(opened));
+        }
+        
+        // Add to account directory (THREAD-SAFE, locks one shard only)
+        if (!accounts.insert(accountNumber, account)) {
+            throw BankException(BankException::ErrorType::DUPLICATE_ACCOUNT, 
+                               "Generated account number already exists", accountNumber);
+        }
+    }
+    if (!commitJournal()) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, "Journal write failed", accountNumber);
     }
     
     // Log account creation
     if (config.enableAuditLogging) {
+        ArenaScope scratch;
         transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
-                                    "Account created: " + accountNumber + " for " + holderName);
+                                    scratch.concat("Account created: ", accountNumber, " for ", holderName));
     }
     
     return accountNumber;
 }
 
-bool Bank::closeAccount(const std::string& accountNumber) {
-    if (!validateAccountNumber(accountNumber)) {
-        return false;
+std::vector<std::string> Bank::createAccounts(const AccountSpec* specs, size_t count) {
+    if (isReplica()) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, kReplicaWrites);
+    }
+    std::vector<std::string> numbers(count);
+    if (count == 0) {
+        return numbers;
+    }
+    
+    // Validate the whole batch before anything is created
+    std::atomic<size_t> firstInvalid(count);
+    parallelFor(count, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (specs[i].holderName.empty() || !BankUtils::isValidInitialBalance(specs[i].initialBalance)) {
+                size_t current = firstInvalid.load();
+                while (i < current && !firstInvalid.compare_exchange_weak(current, i)) {
+                }
+                return;
+            }
+        }
+    });
+    if (firstInvalid < count) {
+        const AccountSpec& invalid = specs[firstInvalid];
+        std::string where = " (batch entry " + std::to_string(firstInvalid.load()) + ")";
+        if (invalid.holderName.empty()) {
+            throw BankException(BankException::ErrorType::INVALID_ACCOUNT_NUMBER, 
+                               "Account holder name cannot be empty" + where);
+        }
+        throw BankException(BankException::ErrorType::INVALID_AMOUNT, "Invalid initial balance" + where);
+    }
+    
+    if (getTotalAccounts() + count > config.maxAccounts) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, 
+                           "Maximum number of accounts reached");
+    }
+    
+    // Numbers come from per-thread leases, so building accounts scales with threads
+    std::vector<std::shared_ptr<Account>> created(count);
+    parallelFor(count, 1024, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            numbers[i] = generateAccountNumber();
+            created[i] = makeAccount(numbers[i], specs[i].holderName, specs[i].initialBalance);
+        }
+    });
+    
+    std::vector<std::vector<size_t>> byShard(accounts.shardCount());
+    for (size_t i = 0; i < count; ++i) {
+        byShard[accounts.shardIndex(numbers[i])].push_back(i);
     }
     
-    std::lock_guard<std::mutex> lock(accountsMutex);
+    // Per shard: journal the openings, then one insert; shards proceed in parallel
+    std::atomic<size_t> inserted(0);
+    std::atomic<bool> durable(true);
+    parallelFor(byShard.size(), 1, [&](size_t begin, size_t end) {
+        std::vector<std::shared_ptr<Account>> group;
+        for (size_t shard = begin; shard < end; ++shard) {
+            const std::vector<size_t>& indices = byShard[shard];
+            if (indices.empty()) {
+                continue;
+            }
+            group.clear();
+            for (size_t i : indices) {
+                group.push_back(created[i]);
+            }
+            std::unique_ptr<bool[]> added(new bool[group.size()]);
+            {
+                std::shared_lock<std::shared_mutex> gate(accountCreationGate);
+                if (journal) {
+                    for (const std::shared_ptr<Account>& account : group) {
+                        JournalRecord opened;
+                        opened.kind = JournalRecordKind::ACCOUNT_OPENED;
+                        opened.timestamp = account->getCreatedAt();
+                        opened.amount = account->getBalance();
+                        opened.account = account->getAccountNumber();
+                        opened.balanceAfter = opened.amount;
+                        opened.text = account->getAccountHolderName();
+                        opened.transactionId = openingDepositId(*account);
+                        account->attachJournal(journal.get(), journal->append(opened));
+                    }
+                }
+                inserted += accounts.insertMany(group.data(), group.size(), added.get());
+            }
+            for (size_t j = 0; j < indices.size(); ++j) {
+                if (!added[j]) {
+                    numbers[indices[j]].clear();
+                }
+            }
+            if (!commitJournal()) { // This worker's records
+                durable = false;
+            }
+        }
+    });
+    if (!durable) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, "Journal write failed");
+    }
     
-    auto it = accounts.find(accountNumber);
-    if (it == accounts.end()) {
-        return false; // Account not found
+    if (config.enableAuditLogging) {
+        std::string message = "Accounts created in batch: " + std::to_string(inserted.load()) + 
+                              " of " + std::to_string(count);
+        if (inserted < count) {
+            message += " (" + std::to_string(count - inserted.load()) + " number collisions)";
+        }
+        transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, message);
+    }
+    return numbers;
+}
+
+std::vector<std::string> Bank::createAccounts(const std::vector<AccountSpec>& specs) {
+    return createAccounts(specs.data(), specs.size());
+}
+
+bool Bank::closeAccount(const std::string& accountNumber) {
+    if (isReplica() || !validateAccountNumber(accountNumber)) {
+        return false;
     }
     
-    // Check if account has zero balance
-    if (it->second->getBalance() != 0.0) {
-        return false; // Cannot close account with non-zero balance
+    if (auto account = accounts.find(accountNumber)) {
+        account->flushPending();
     }
     
-    // Remove account
-    accounts.erase(it);
+    {
+        // Like an opening, a closing never falls inside a snapshot cut or a bulk job
+        std::shared_lock<std::shared_mutex> gate(accountCreationGate);
+        
+        // Remove account only if it has zero balance (checked under the shard lock)
+        bool removed = accounts.eraseIf(accountNumber, [](const Account& account) {
+            return account.getBalance().isZero();
+        });
+        if (!removed) {
+            return false; // Account not found or non-zero balance
+        }
+        
+        if (journal) {
+            JournalRecord closed;
+            closed.kind = JournalRecordKind::ACCOUNT_CLOSED;
+            closed.timestamp = std::chrono::system_clock::now();
+            closed.account = accountNumber;
+            journal->append(closed);
+        }
+    }
+    if (!commitJournal()) {
+        return false;
+    }
     
     // Log account closure
     if (config.enableAuditLogging) {
@@ -140,93 +524,305 @@ bool Bank::closeAccount(const std::string& accountNumber) {
     return true;
 }
 
+std::shared_ptr<Account> Bank::makeAccount(const std::string& number, const std::string& holderName, 
+                                           Money initialBalance) {
+    auto account = Account::create(number, holderName, initialBalance, columns);
+    if (historyArchive) {
+        // Holds the archive, not the bank: an account may outlive it. One append per chunk
+        std::shared_ptr<AsyncFileWriter> archive = historyArchive;
+        account->setHistorySpillHandler([archive](const Transaction* records, size_t count) {
+            std::string spilled;
+            std::string encoded;
+            for (size_t i = 0; i < count; ++i) {
+                Journal::encode(recordFromTransaction(records[i]), encoded);
+                spilled += encoded;
+            }
+            archive->append(spilled);
+        });
+    }
+    return account;
+}
+
+std::shared_ptr<Account> Bank::reopenAccount(const JournalRecord& opened) {
+    // Older journals did not record the opening deposit's ID: it is booked again under a new one
+    if (opened.transactionId == 0 || !opened.amount.isPositive()) {
+        return makeAccount(opened.account, opened.text, opened.amount);
+    }
+    
+    auto account = makeAccount(opened.account, opened.text, Money());
+    JournalRecord deposit = opened;
+    deposit.kind = JournalRecordKind::TRANSACTION;
+    deposit.type = TransactionType::DEPOSIT;
+    deposit.status = TransactionStatus::SUCCESS;
+    deposit.flags = Transaction::FLAG_INITIAL_DEPOSIT;
+    deposit.counterparty.clear();
+    deposit.text = "Initial deposit";
+    account->addTransaction(transactionFromRecord(deposit));
+    return account;
+}
+
 std::shared_ptr<Account> Bank::getAccount(const std::string& accountNumber) {
     if (!validateAccountNumber(accountNumber)) {
         return nullptr;
     }
     
-    std::lock_guard<std::mutex> lock(accountsMutex);
-    auto it = accounts.find(accountNumber);
-    return (it != accounts.end()) ? it->second : nullptr;
+    return accounts.find(accountNumber);
 }
 
 std::vector<std::shared_ptr<Account>> Bank::getAllAccounts() {
-    std::lock_guard<std::mutex> lock(accountsMutex);
-    std::vector<std::shared_ptr<Account>> result;
-    result.reserve(accounts.size());
-    
-    for (const auto& pair : accounts) {
-        result.push_back(pair.second);
-    }
-    
-    return result;
+    return accounts.snapshot();
+}
+
+Bank::AccountsView Bank::viewAccounts() const {
+    return columns->view();
 }
 
-bool Bank::processDeposit(const std::string& accountNumber, double amount, 
+bool Bank::processDeposit(const std::string& accountNumber, Money amount, 
                           const std::string& description) {
+    if (isReplica()) {
+        return false;
+    }
+    ScopedLatency timer(LatencyStage::DEPOSIT);
     auto account = getAccount(accountNumber);
     if (!account) {
-        updateStatistics(false);
+        updateStatistics(STAT_DEPOSITS, TransactionStatus::INVALID_ACCOUNT);
         return false;
     }
     
-    bool success = account->deposit(amount, description);
-    updateStatistics(success);
+    bool success = account->deposit(amount, description) && commitJournal();
+    updateStatistics(STAT_DEPOSITS, success ? TransactionStatus::SUCCESS : TransactionStatus::FAILED);
     
     if (success && config.enableAuditLogging) {
-        transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
-                                    "Deposit: $" + std::to_string(amount) + 
-                                    " to account " + accountNumber);
+        transactionLogger->logDeposit(account->getAccountIndex(), amount);
     }
     
     return success;
 }
 
-bool Bank::processWithdraw(const std::string& accountNumber, double amount, 
+bool Bank::processWithdraw(const std::string& accountNumber, Money amount, 
                            const std::string& description) {
+    if (isReplica()) {
+        return false;
+    }
+    ScopedLatency timer(LatencyStage::WITHDRAW);
     auto account = getAccount(accountNumber);
     if (!account) {
-        updateStatistics(false);
+        updateStatistics(STAT_WITHDRAWALS, TransactionStatus::INVALID_ACCOUNT);
         return false;
     }
     
-    bool success = account->withdraw(amount, description);
-    updateStatistics(success);
+    bool applied = account->withdraw(amount, description);
+    bool success = applied && commitJournal();
+    updateStatistics(STAT_WITHDRAWALS, success ? TransactionStatus::SUCCESS 
+                                               : applied ? TransactionStatus::FAILED : debitFailure(amount));
     
     if (success && config.enableAuditLogging) {
-        transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
-                                    "Withdrawal: $" + std::to_string(amount) + 
-                                    " from account " + accountNumber);
+        transactionLogger->logWithdrawal(account->getAccountIndex(), amount);
     }
     
     return success;
 }
 
 bool Bank::processTransfer(const std::string& fromAccount, const std::string& toAccount, 
-                           double amount, const std::string& description) {
+                           Money amount, const std::string& description) {
+    if (isReplica()) {
+        return false;
+    }
+    ScopedLatency timer(LatencyStage::TRANSFER);
     auto fromAcc = getAccount(fromAccount);
     auto toAcc = getAccount(toAccount);
     
     if (!fromAcc || !toAcc) {
-        updateStatistics(false);
+        updateStatistics(STAT_TRANSFERS, TransactionStatus::INVALID_ACCOUNT);
         return false;
     }
     
-    bool success = fromAcc->transfer(*toAcc, amount, description);
-    updateStatistics(success);
+    // A credit that would overflow the target comes back FAILED in recorded
+    Transaction recorded;
+    recorded.status = TransactionStatus::INSUFFICIENT_FUNDS;
+    bool applied = fromAcc->transfer(*toAcc, amount, description, &recorded);
+    bool success = applied && commitJournal();
+    updateStatistics(STAT_TRANSFERS, success ? TransactionStatus::SUCCESS 
+                                             : applied ? TransactionStatus::FAILED 
+                                             : fromAcc == toAcc ? TransactionStatus::INVALID_ACCOUNT 
+                                             : recorded.status == TransactionStatus::FAILED ? TransactionStatus::FAILED
+                                                                : debitFailure(amount));
     
     if (success && config.enableAuditLogging) {
-        transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
-                                    "Transfer: $" + std::to_string(amount) + 
-                                    " from " + fromAccount + " to " + toAccount);
+        transactionLogger->logTransfer(fromAcc->getAccountIndex(), toAcc->getAccountIndex(), amount);
     }
     
     return success;
 }
 
-double Bank::getAccountBalance(const std::string& accountNumber) {
+Bank::TransactionResult Bank::processBatchTransfer(const std::vector<TransferSpec>& legs, 
+                                                   const std::string& description) {
+    if (isReplica()) {
+        return replicaRejection();
+    }
+    ScopedLatency timer(LatencyStage::BATCH_TRANSFER);
+    auto now = std::chrono::system_clock::now();
+    if (legs.empty()) {
+        updateStatistics(STAT_BATCH_TRANSFERS, TransactionStatus::FAILED);
+        return TransactionResult(false, "Batch transfer has no legs", 0, Money(), now);
+    }
+    
+    // Resolve every account first; a leg's accounts are looked up once per batch. The lookup
+    // table and resolved legs live in this thread's scratch arena (keys point into legs)
+    ArenaScope scratch;
+    std::pmr::unordered_map<std::string_view, std::shared_ptr<Account>> resolved(scratch.resource());
+    resolved.reserve(legs.size() + 1);
+    std::pmr::vector<Account::TransferLeg> resolvedLegs(legs.size(), scratch.resource());
+    Money total;
+    for (size_t i = 0; i < legs.size(); ++i) {
+        Account* sides[2] = {nullptr, nullptr};
+        const std::string* numbers[2] = {&legs[i].fromAccount, &legs[i].toAccount};
+        for (int side = 0; side < 2; ++side) {
+            auto found = resolved.find(*numbers[side]);
+            if (found == resolved.end()) {
+                found = resolved.emplace(*numbers[side], getAccount(*numbers[side])).first;
+            }
+            sides[side] = found->second.get();
+        }
+        if (!sides[0] || !sides[1]) {
+            updateStatistics(STAT_BATCH_TRANSFERS, TransactionStatus::INVALID_ACCOUNT);
+            return TransactionResult(false, "Batch transfer failed - unknown account in leg " + std::to_string(i), 
+                                     0, Money(), now);
+        }
+        resolvedLegs[i] = {sides[0], sides[1], legs[i].amount};
+        Money::tryAdd(total, legs[i].amount, total);     // Audit figure only
+    }
+    
+    Account::BatchResult outcome = Account::transferBatch(resolvedLegs.data(), resolvedLegs.size(), 
+                                                          Transaction::internDescription(description));
+    if (outcome.status == TransactionStatus::SUCCESS && !commitJournal()) {
+        outcome.status = TransactionStatus::FAILED;
+        updateStatistics(STAT_BATCH_TRANSFERS, outcome.status);
+        return TransactionResult(false, "Batch transfer failed - journal write failed", 0, 
+                                 resolvedLegs.front().from->getBalance(), std::chrono::system_clock::now());
+    }
+    bool success = outcome.status == TransactionStatus::SUCCESS;
+    updateStatistics(STAT_BATCH_TRANSFERS, outcome.status);
+    Money newBalance = resolvedLegs.front().from->getBalance();
+    
+    if (!success) {
+        return TransactionResult(false, "Batch transfer failed - " + 
+                                 std::string(outcome.status == TransactionStatus::INSUFFICIENT_FUNDS 
+                                             ? "insufficient funds" : "invalid amount or accounts") + 
+                                 " in leg " + std::to_string(outcome.failedLeg), 
+                                 0, newBalance, std::chrono::system_clock::now());
+    }
+    
+    if (config.enableAuditLogging) {
+        transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
+                                    scratch.concat("Batch transfer: $", total.toString(), " in ", 
+                                                   std::to_string(legs.size()), " legs across ", 
+                                                   std::to_string(resolved.size()), " accounts (TRF_", 
+                                                   std::to_string(outcome.transactionId), ")"));
+    }
+    
+    return TransactionResult(true, "Batch transfer successful", outcome.transactionId, newBalance, 
+                             std::chrono::system_clock::now());
+}
+
+bool Bank::setAccountFastPath(const std::string& accountNumber, bool enabled) {
+    auto account = isReplica() ? nullptr : getAccount(accountNumber);
+    if (!account) {
+        return false;
+    }
+    
+    account->setFastPath(enabled);
+    if (config.enableAuditLogging) {
+        transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
+                                    std::string("Fast path ") + (enabled ? "enabled" : "disabled") + 
+                                    " for account " + accountNumber);
+    }
+    return true;
+}
+
+std::future<Bank::TransactionResult> Bank::submitDeposit(const std::string& accountNumber, Money amount, 
+                                                        const std::string& description) {
+    if (isReplica()) {
+        return rejectedOnReplica();
+    }
+    return transactionPipeline->submitDeposit(accountNumber, amount, description);
+}
+
+std::future<Bank::TransactionResult> Bank::submitWithdraw(const std::string& accountNumber, Money amount, 
+                                                         const std::string& description) {
+    if (isReplica()) {
+        return rejectedOnReplica();
+    }
+    return transactionPipeline->submitWithdraw(accountNumber, amount, description);
+}
+
+std::future<Bank::TransactionResult> Bank::submitTransfer(const std::string& fromAccount, const std::string& toAccount, 
+                                                         Money amount, const std::string& description) {
+    if (isReplica()) {
+        return rejectedOnReplica();
+    }
+    return transactionPipeline->submitTransfer(fromAccount, toAccount, amount, description);
+}
+
+void Bank::submitDeposit(const std::string& accountNumber, Money amount, 
+                         const std::string& description, TransactionCallback callback) {
+    if (isReplica()) {
+        callback(replicaRejection());
+        return;
+    }
+    transactionPipeline->submitDeposit(accountNumber, amount, description, std::move(callback));
+}
+
+void Bank::submitWithdraw(const std::string& accountNumber, Money amount, 
+                          const std::string& description, TransactionCallback callback) {
+    if (isReplica()) {
+        callback(replicaRejection());
+        return;
+    }
+    transactionPipeline->submitWithdraw(accountNumber, amount, description, std::move(callback));
+}
+
+void Bank::submitTransfer(const std::string& fromAccount, const std::string& toAccount, 
+                          Money amount, const std::string& description, TransactionCallback callback) {
+    if (isReplica()) {
+        callback(replicaRejection());
+        return;
+    }
+    transactionPipeline->submitTransfer(fromAccount, toAccount, amount, description, std::move(callback));
+}
+
+void Bank::flushPipeline() {
+    transactionPipeline->flush();
+}
+
+bool Bank::submitBackground(std::function<void()> task) {
+    return threadPool->submitTask(UniqueFunction(std::move(task)), "Background work", 0);
+}
+
+std::future<bool> Bank::processDepositAsync(const std::string& accountNumber, Money amount, 
+                                            const std::string& description, int priority) {
+    return processTransactionAsync([this, accountNumber, amount, description]() {
+        return processDeposit(accountNumber, amount, description);
+    }, accountNumber, "Deposit to " + accountNumber, priority);
+}
+
+std::future<bool> Bank::processWithdrawAsync(const std::string& accountNumber, Money amount, 
+                                             const std::string& description, int priority) {
+    return processTransactionAsync([this, accountNumber, amount, description]() {
+        return processWithdraw(accountNumber, amount, description);
+    }, accountNumber, "Withdrawal from " + accountNumber, priority);
+}
+
+std::future<bool> Bank::processTransferAsync(const std::string& fromAccount, const std::string& toAccount, 
+                                             Money amount, const std::string& description, int priority) {
+    return processTransactionAsync([this, fromAccount, toAccount, amount, description]() {
+        return processTransfer(fromAccount, toAccount, amount, description);
+    }, fromAccount, "Transfer " + fromAccount + " -> " + toAccount, priority);
+}
+
+Money Bank::getAccountBalance(const std::string& accountNumber) {
     auto account = getAccount(accountNumber);
-    return account ? account->getBalance() : -1.0;
+    return account ? account->getBalance() : Money::fromDollars(-1);
 }
 
 std::vector<Transaction> Bank::getAccountTransactions(const std::string& accountNumber) {
@@ -234,6 +830,39 @@ std::vector<Transaction> Bank::getAccountTransactions(const std::string& account
     return account ? account->getTransactionHistory() : std::vector<Transaction>();
 }
 
+std::vector<Transaction> Bank::getArchivedTransactions(const std::string& accountNumber) {
+    std::vector<JournalRecord> found;
+    if (!historyArchive || !historyArchive->flush()) {
+        return {};
+    }
+    JournalReader reader(historyArchive->getPath());
+    JournalRecord record;
+    while (reader.next(record)) {
+        if (record.account == accountNumber || record.counterparty == accountNumber) {
+            found.push_back(std::move(record));
+        }
+    }
+    
+    // A transfer is spilled by both of its accounts, and a record restored after a restart
+    // may be spilled again
+    auto key = [](const JournalRecord& r) {
+        return std::tie(r.timestamp, r.transactionId, r.type, r.account, r.counterparty);
+    };
+    std::sort(found.begin(), found.end(), [&key](const JournalRecord& a, const JournalRecord& b) {
+        return key(a) < key(b);
+    });
+    found.erase(std::unique(found.begin(), found.end(), [&key](const JournalRecord& a, const JournalRecord& b) {
+        return key(a) == key(b);
+    }), found.end());
+    
+    std::vector<Transaction> archived;
+    archived.reserve(found.size());
+    for (const JournalRecord& entry : found) {
+        archived.push_back(transactionFromRecord(entry));
+    }
+    return archived;
+}
+
 std::string Bank::getAccountStatus(const std::string& accountNumber) {
     auto account = getAccount(accountNumber);
     return account ? account->getStatus() : "NOT_FOUND";
@@ -249,6 +878,31 @@ void Bank::startBankingSystem() {
     // Start thread pool
     threadPool->start();
     
+    // Restore persisted state once, in parallel on the pool, before new traffic is expected;
+    // a follower takes its state from the primary instead, and writes no snapshots
+    if (config.recoverOnStart && !recoveryDone && !isReplica()) {
+        recoverState();
+    }
+    recoveryDone = true;
+    
+    if (!config.snapshotPath.empty() && config.snapshotInterval.count() > 0 && !isReplica()) {
+        snapshotThreadStop = false;
+        snapshotThread = std::thread(&Bank::snapshotLoop, this);
+    }
+    
+    // Followers are bootstrapped from the recovered state, so they connect only now
+    try {
+        if (replicationServer) {
+            replicationServer->start();
+        }
+        if (isReplica()) {
+            replicationFollower->start();
+        }
+    } catch (const BankException&) {
+        stopBankingSystem();
+        throw;
+    }
+    
     // Thread monitor is automatically ready
     
     if (config.enableAuditLogging) {
@@ -264,8 +918,34 @@ void Bank::stopBankingSystem() {
     
     systemRunning = false;
     
-    // Stop thread pool
+    // A follower stops applying before the pool its shards are applied on goes away
+    if (replicationFollower) {
+        replicationFollower->stop();
+    }
+    
+    if (snapshotThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(snapshotThreadMutex);
+            snapshotThreadStop = true;
+        }
+        snapshotWake.notify_all();
+        snapshotThread.join();
+    }
+    
+    // Let admitted pipeline operations finish, then stop thread pool
+    transactionPipeline->flush();
     threadPool->stop();
+    if (journal) {
+        journal->flush();
+    }
+    if (replicationServer) {
+        replicationServer->stop();
+    }
+    
+    // Final snapshot: the next start replays (almost) nothing
+    if (!config.snapshotPath.empty()) {
+        takeSnapshot();
+    }
     
     // Thread monitor cleanup is automatic
     
@@ -280,31 +960,45 @@ bool Bank::isSystemRunning() const {
 }
 
 size_t Bank::getTotalAccounts() const {
-    std::lock_guard<std::mutex> lock(accountsMutex);
     return accounts.size();
 }
 
 size_t Bank::getActiveAccounts() const {
-    std::lock_guard<std::mutex> lock(accountsMutex);
-    size_t count = 0;
-    for (const auto& pair : accounts) {
-        if (pair.second->isActive()) {
-            count++;
-        }
-    }
-    return count;
+    return accounts.activeCount();
+}
+
+Bank::TransactionStatistics Bank::getTransactionStatistics() const {
+    std::array<uint64_t, STAT_COUNT> counts = statistics.snapshot();
+    TransactionStatistics result;
+    result.successful = counts[STAT_SUCCESSFUL];
+    result.failed = counts[STAT_FAILED];
+    result.total = result.successful + result.failed;
+    result.deposits = counts[STAT_DEPOSITS];
+    result.withdrawals = counts[STAT_WITHDRAWALS];
+    result.transfers = counts[STAT_TRANSFERS];
+    result.batchTransfers = counts[STAT_BATCH_TRANSFERS];
+    result.insufficientFunds = counts[STAT_INSUFFICIENT_FUNDS];
+    result.invalidAccount = counts[STAT_INVALID_ACCOUNT];
+    result.otherFailures = counts[STAT_OTHER_FAILURES];
+    return result;
 }
 
 size_t Bank::getTotalTransactions() const {
-    return totalTransactions;
+    std::array<uint64_t, STAT_COUNT> counts = statistics.snapshot();
+    return counts[STAT_SUCCESSFUL] + counts[STAT_FAILED];
 }
 
 size_t Bank::getSuccessfulTransactions() const {
-    return successfulTransactions;
+    return statistics.get(STAT_SUCCESSFUL);
 }
 
 size_t Bank::getFailedTransactions() const {
-    return failedTransactions;
+    return statistics.get(STAT_FAILED);
+}
+
+Money Bank::getTotalBalance() const {
+    // One instant for every account: money in flight between two of them is never counted twice
+    return viewAccounts().totalBalance();
 }
 
 std::string Bank::getBankName() const {
@@ -316,17 +1010,26 @@ std::string Bank::getBankCode() const {
 }
 
 std::string Bank::getSystemStatus() const {
+    TransactionStatistics stats = getTransactionStatistics();
     std::ostringstream oss;
     oss << "System: " << (systemRunning ? "RUNNING" : "STOPPED") << "\n"
         << "Accounts: " << getTotalAccounts() << "/" << config.maxAccounts << "\n"
-        << "Transactions: " << totalTransactions << "\n"
-        << "Success Rate: " << (totalTransactions > 0 ? 
-            (successfulTransactions * 100.0 / totalTransactions) : 0.0) << "%";
+        << "Transactions: " << stats.total << "\n"
+        << "Success Rate: " << (stats.total > 0 ? 
+            (stats.successful * 100.0 / stats.total) : 0.0) << "%";
     
     return oss.str();
 }
 
 std::string Bank::getPerformanceReport() const {
+    size_t fastPathAccounts = 0;
+    size_t stripedAccounts = 0;
+    accounts.forEach([&](const std::shared_ptr<Account>& account) {
+        fastPathAccounts += account->isFastPath() ? 1 : 0;
+        stripedAccounts += account->isStriped() ? 1 : 0;
+    });
+    TransactionStatistics stats = getTransactionStatistics();
+    
     std::ostringstream oss;
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
@@ -335,57 +1038,260 @@ std::string Bank::getPerformanceReport() const {
         << "System Status: " << (systemRunning ? "RUNNING" : "STOPPED") << "\n"
         << "Total Accounts: " << getTotalAccounts() << "\n"
         << "Active Accounts: " << getActiveAccounts() << "\n"
-        << "Total Transactions: " << totalTransactions << "\n"
-        << "Successful: " << successfulTransactions << "\n"
-        << "Failed: " << failedTransactions << "\n"
-        << "Success Rate: " << (totalTransactions > 0 ? 
-            (successfulTransactions * 100.0 / totalTransactions) : 0.0) << "%\n"
-        << "Max Concurrent Transactions: " << config.maxConcurrentTransactions << "\n"
-        << "Audit Logging: " << (config.enableAuditLogging ? "ENABLED" : "DISABLED") << "\n"
-        << "Generated: " << std::put_time(std::gmtime(&time_t), "%Y-%m-%d %H:%M:%S");
+        << "Total Transactions: " << stats.total << "\n"
+        << "Successful: " << stats.successful << "\n"
+        << "Failed: " << stats.failed << " (" << stats.insufficientFunds << " insufficient funds, " 
+        << stats.invalidAccount << " invalid account, " << stats.otherFailures << " other)\n"
+        << "By Operation: " << stats.deposits << " deposits, " << stats.withdrawals << " withdrawals, " 
+        << stats.transfers << " transfers, " << stats.batchTransfers << " batch transfers\n"
+        << "Total Balance: $" << getTotalBalance() << "\n"
+        << "Success Rate: " << (stats.total > 0 ? 
+            (stats.successful * 100.0 / stats.total) : 0.0) << "%\n"
+        << "Max Concurrent Transactions: " << config.maxConcurrentTransactions << "\n";
+    if (admission) {
+        AdmissionController::Statistics admitted = admission->getStatistics();
+        oss << "Admission Control: limit " << admitted.limit << " (" << admitted.minLimit << ".." << admitted.maxLimit 
+            << ", " << admitted.limitIncreases << " raised, " << admitted.limitDecreases << " lowered), " 
+            << admitted.inFlight << " in flight, queue delay " << admitted.queueDelay.count() << " us (target " 
+            << admitted.targetQueueDelay.count() << " us)\n"
+            << "Admission Decisions: " << admitted.admitted << " admitted, " << admitted.overLimit << " over limit, " 
+            << admitted.rateLimited << " rate limited";
+        if (admitted.accountRate > 0) {
+            oss << " (" << admitted.accountRate << " ops/s per account, " << admitted.rateLimitedAccounts << " tracked)";
+        }
+        oss << "\n";
+    } else {
+        oss << "Admission Control: DISABLED\n";
+    }
+    oss << "Shard Affinity: ";
+    if (config.shardAffinity) {
+        oss << threadPool->getThreadCount() << " workers " << (threadPool->isPinned() ? "pinned" : "(not pinned)") 
+            << ", one per " << (accounts.shardCount() + threadPool->getThreadCount() - 1) / threadPool->getThreadCount() 
+            << " shards\n";
+    } else {
+        oss << "OFF\n";
+    }
+    oss << "Shard Load: " << shardLoadSummary() << "\n"
+        << "Worker States: " << workerStateSummary() << "\n"
+        << "Lock Contention: " << lockContentionSummary() << "\n"
+        << "Replication: " << replicationSummary() << "\n";
+    oss << "Audit Logging: " << (config.enableAuditLogging ? "ENABLED" : "DISABLED") << "\n"
+        << "Journal: " << (journal ? journal->getPath() + " (" + durabilityName(config.journalDurability) + 
+                                         (journal->getWriter().getError() 
+                                              ? std::string(", FAILED: ") + std::strerror(journal->getWriter().getError()) 
+                                              : std::string()) + ")" 
+                                   : std::string("DISABLED")) << "\n"
+        << "Hot Accounts: " << fastPathAccounts << " fast path, " << stripedAccounts << " striped (auto-stripe at " 
+        << (Account::getStripeThreshold() ? std::to_string(Account::getStripeThreshold()) + " contended locks/s" 
+                                          : std::string("OFF")) << ")\n"
+        << "Generated: " << std::put_time(std::gmtime(&time_t), "%Y-%m-%d %H:%M:%S") << "\n"
+        << "Latency (process-wide):\n" << LatencyStats::report();
     
     return oss.str();
 }
 
+std::string Bank::getPerformanceSnapshot() const {
+    TransactionStatistics stats = getTransactionStatistics();
+    std::ostringstream oss;
+    oss << "{\"bank_code\":\"" << config.bankCode << "\""
+        << ",\"running\":" << (systemRunning ? "true" : "false")
+        << ",\"accounts\":" << getTotalAccounts()
+        << ",\"active_accounts\":" << getActiveAccounts()
+        << ",\"transactions\":{\"total\":" << stats.total 
+        << ",\"successful\":" << stats.successful 
+        << ",\"failed\":" << stats.failed 
+        << ",\"deposits\":" << stats.deposits 
+        << ",\"withdrawals\":" << stats.withdrawals 
+        << ",\"transfers\":" << stats.transfers 
+        << ",\"batch_transfers\":" << stats.batchTransfers 
+        << ",\"insufficient_funds\":" << stats.insufficientFunds 
+        << ",\"invalid_account\":" << stats.invalidAccount 
+        << ",\"other_failures\":" << stats.otherFailures << "}"
+        << ",\"threads\":{\"workers\":" << threadPool->getThreadCount() 
+        << ",\"active\":" << threadPool->getActiveThreadCount() 
+        << ",\"queued\":" << threadPool->getQueueSize() 
+        << ",\"pipeline_in_flight\":" << transactionPipeline->getInFlight() 
+        << ",\"shard_affinity\":" << (config.shardAffinity ? "true" : "false") 
+        << ",\"pinned\":" << (threadPool->isPinned() ? "true" : "false") << "}";
+    oss << ",\"worker_states\":[";
+    bool firstThread = true;
+    for (const ThreadMonitor::ThreadInfo& thread : threadMonitor->getAllThreads()) {
+        oss << (firstThread ? "" : ",") << "{\"name\":" << jsonString(thread.name) 
+            << ",\"state\":\"" << ThreadMonitor::stateName(thread.state) << "\"" 
+            << ",\"lock\":" << (thread.lock == ThreadMonitor::LockSite::NONE 
+                                  ? std::string("null") 
+                                  : jsonString(ThreadMonitor::lockSiteName(thread.lock))) 
+            << ",\"task\":" << jsonString(thread.task) 
+            << ",\"tasks\":" << thread.tasksRun 
+            << ",\"busy_us\":" << thread.busy.count() / 1000 
+            << ",\"idle_us\":" << thread.idle.count() / 1000 << "}";
+        firstThread = false;
+    }
+    oss << "],\"lock_contention\":{\"sampling\":" << ThreadMonitor::getContentionSampling();
+    for (const ThreadMonitor::LockContention& site : ThreadMonitor::getLockContention()) {
+        oss << ",\"" << ThreadMonitor::lockSiteName(site.site) << "\":{\"sampled\":" << site.sampled 
+            << ",\"contended\":" << site.contended 
+            << ",\"wait_us\":" << site.wait.count() / 1000 
+            << ",\"max_wait_us\":" << site.maxWait.count() / 1000 
+            << ",\"peak_waiters\":" << site.peakWaiters << "}";
+    }
+    oss << "}";
+    oss << ",\"shards\":[";
+    bool firstShard = true;
+    for (const ThreadMonitor::ShardLoad& load : threadMonitor->getShardLoads()) {
+        if (load.batches == 0) {
+            continue;
+        }
+        bool known = load.worker != SIZE_MAX;
+        oss << (firstShard ? "" : ",") << "{\"shard\":" << load.shard 
+            << ",\"worker\":" << (known ? static_cast<long long>(load.worker) : -1LL) 
+            << ",\"cpu\":" << (known ? threadPool->getWorkerCpu(load.worker) : -1) 
+            << ",\"node\":" << (known ? threadPool->getWorkerNode(load.worker) : -1) 
+            << ",\"operations\":" << load.operations 
+            << ",\"batches\":" << load.batches 
+            << ",\"busy_us\":" << load.busy.count() / 1000 << "}";
+        firstShard = false;
+    }
+    oss << "]";
+    if (admission) {
+        AdmissionController::Statistics admitted = admission->getStatistics();
+        oss << ",\"admission\":{\"enabled\":true"
+            << ",\"limit\":" << admitted.limit 
+            << ",\"min_limit\":" << admitted.minLimit 
+            << ",\"max_limit\":" << admitted.maxLimit 
+            << ",\"in_flight\":" << admitted.inFlight 
+            << ",\"admitted\":" << admitted.admitted 
+            << ",\"rejected_over_limit\":" << admitted.overLimit 
+            << ",\"rejected_rate_limited\":" << admitted.rateLimited 
+            << ",\"limit_increases\":" << admitted.limitIncreases 
+            << ",\"limit_decreases\":" << admitted.limitDecreases 
+            << ",\"queue_delay_us\":" << admitted.queueDelay.count() 
+            << ",\"target_queue_delay_us\":" << admitted.targetQueueDelay.count() 
+            << ",\"account_rate\":" << admitted.accountRate << "}";
+    } else {
+        oss << ",\"admission\":{\"enabled\":false}";
+    }
+    oss << ",\"replication\":{\"role\":\"" << replicationRoleName(getReplicationRole()) << "\"";
+    if (getReplicationRole() == ReplicationRole::PRIMARY) {
+        ReplicationServer::Statistics replicated = replicationServer->getStatistics();
+        oss << ",\"port\":" << replicationServer->getPort() 
+            << ",\"ack_mode\":\"" << replicationAckModeName(replicationServer->getOptions().ackMode) << "\"" 
+            << ",\"quorum\":" << replicationServer->getOptions().quorum 
+            << ",\"shipped_lsn\":" << replicated.shippedLsn 
+            << ",\"batches\":" << replicated.batches 
+            << ",\"records\":" << replicated.records 
+            << ",\"bytes\":" << replicated.bytes 
+            << ",\"bootstraps\":" << replicated.bootstraps 
+            << ",\"dropped_followers\":" << replicated.droppedFollowers 
+            << ",\"quorum_waits\":" << replicated.quorumWaits 
+            << ",\"quorum_timeouts\":" << replicated.quorumTimeouts 
+            << ",\"degraded\":" << (replicated.degraded ? "true" : "false") 
+            << ",\"followers\":[";
+        bool firstFollower = true;
+        for (const ReplicationServer::FollowerStatus& follower : replicated.followers) {
+            oss << (firstFollower ? "" : ",") << "{\"peer\":" << jsonString(follower.peer) 
+                << ",\"streaming\":" << (follower.streaming ? "true" : "false") 
+                << ",\"sent_lsn\":" << follower.sentLsn 
+                << ",\"acked_lsn\":" << follower.ackedLsn 
+                << ",\"lag_records\":" << follower.lagRecords 
+                << ",\"lag_ms\":" << follower.lag.count() << "}";
+            firstFollower = false;
+        }
+        oss << "]";
+    } else if (getReplicationRole() == ReplicationRole::FOLLOWER) {
+        ReplicationFollower::Statistics replicated = replicationFollower->getStatistics();
+        oss << ",\"connected\":" << (replicated.connected ? "true" : "false") 
+            << ",\"streaming\":" << (replicated.streaming ? "true" : "false") 
+            << ",\"applied_lsn\":" << replicated.appliedLsn 
+            << ",\"primary_lsn\":" << replicated.primaryLsn 
+            << ",\"lag_records\":" << replicated.lagRecords 
+            << ",\"apply_delay_ms\":" << replicated.applyDelay.count() 
+            << ",\"batches\":" << replicated.batches 
+            << ",\"records\":" << replicated.records 
+            << ",\"bootstraps\":" << replicated.bootstraps 
+            << ",\"connections\":" << replicated.connections;
+    }
+    oss << "}";
+    oss << ",\"latency\":" << LatencyStats::toJson()
+        << "}";
+    return oss.str();
+}
+
 void Bank::generateSampleData(size_t accountCount) {
-    if (accountCount > config.maxAccounts) {
-        accountCount = config.maxAccounts;
+    size_t existing = getTotalAccounts();
+    size_t room = existing < config.maxAccounts ? config.maxAccounts - existing : 0;
+    if (accountCount > room) {
+        accountCount = room;
     }
     
-    std::vector<std::string> names = {
+    static const char* const names[] = {
         "John Smith", "Jane Doe", "Bob Johnson", "Alice Brown", "Charlie Wilson",
         "Diana Davis", "Edward Miller", "Fiona Garcia", "George Martinez", "Helen Taylor"
     };
+    const size_t nameCount = sizeof(names) / sizeof(names[0]);
     
     std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> balanceDist(100.0, 10000.0);
+    std::mt19937_64 gen(rd());
+    std::uniform_int_distribution<int64_t> balanceDist(10000, 1000000); // $100.00 - $10,000.00 in cents
     
-    for (size_t i = 0; i < accountCount; ++i) {
-        std::string name = names[i % names.size()] + " " + std::to_string(i + 1);
-        double balance = balanceDist(gen);
+    // Batches bound the memory held in specs when loading millions of accounts
+    const size_t batchSize = 65536;
+    std::vector<AccountSpec> specs;
+    specs.reserve(std::min(accountCount, batchSize));
+    size_t generated = 0;
+    for (size_t start = 0; start < accountCount; start += batchSize) {
+        size_t end = std::min(accountCount, start + batchSize);
+        specs.clear();
+        for (size_t i = start; i < end; ++i) {
+            specs.push_back({std::string(names[i % nameCount]) + " " + std::to_string(i + 1), 
+                             Money::fromCents(balanceDist(gen))});
+        }
         
         try {
-            createAccount(name, balance);
+            std::vector<std::string> numbers = createAccounts(specs);
+            generated += static_cast<size_t>(std::count_if(numbers.begin(), numbers.end(), 
+                                                           [](const std::string& n) { return !n.empty(); }));
         } catch (const BankException& e) {
-            // Log error but continue
             if (config.enableAuditLogging) {
-                transactionLogger->logError("Failed to create sample account: " + 
+                transactionLogger->logError("Failed to create sample accounts: " + 
                                           std::string(e.what()));
             }
+            break;
         }
     }
     
     if (config.enableAuditLogging) {
         transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
-                                    "Generated " + std::to_string(accountCount) + " sample accounts");
+                                    "Generated " + std::to_string(generated) + " sample accounts");
     }
 }
 
 void Bank::clearAllData() {
-    std::lock_guard<std::mutex> lock(accountsMutex);
-    accounts.clear();
-    accountCounter = 0;
+    if (isReplica()) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, kReplicaWrites);
+    }
+    
+    // Every removal is journalled as a closing, so recovery and followers drop the accounts too
+    std::vector<std::shared_ptr<Account>> cleared = accounts.snapshot();
+    for (const auto& account : cleared) {
+        account->flushPending();
+    }
+    {
+        std::shared_lock<std::shared_mutex> gate(accountCreationGate);
+        for (const auto& account : cleared) {
+            const std::string& accountNumber = account->getAccountNumber();
+            if (accounts.erase(accountNumber) && journal) { // Account numbers are not reused
+                JournalRecord closed;
+                closed.kind = JournalRecordKind::ACCOUNT_CLOSED;
+                closed.timestamp = std::chrono::system_clock::now();
+                closed.account = accountNumber;
+                journal->append(closed);
+            }
+        }
+    }
+    if (!commitJournal()) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, "Journal write failed");
+    }
     
     if (config.enableAuditLogging) {
         transactionLogger->logMessage(TransactionLogger::LogLevel::WARNING, 
@@ -393,45 +1299,68 @@ void Bank::clearAllData() {
     }
 }
 
-void Bank::exportTransactionLog(const std::string& filename) {
-    if (!config.enableAuditLogging) {
-        return; // No logging enabled
-    }
+bool Bank::exportTransactionLog(const std::string& filename) {
+    bool exported = Snapshot::write(filename, captureSnapshot());
     
-    std::ofstream exportFile(filename);
-    if (exportFile.is_open()) {
-        exportFile << getPerformanceReport() << std::endl;
-        exportFile.close();
-        
-        if (config.enableAuditLogging) {
+    if (config.enableAuditLogging) {
+        if (exported) {
             transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
                                         "Transaction log exported to: " + filename);
+        } else {
+            transactionLogger->logError("Failed to export transaction log", filename);
         }
     }
+    return exported;
 }
 
-void Bank::importTransactionLog(const std::string& filename) {
-    // This is a simplified implementation
-    // In a real system, you'd parse and import transaction data
+bool Bank::importTransactionLog(const std::string& filename) {
+    if (isReplica()) {
+        return false;
+    }
+    
+    // A snapshot file (as written by exportTransactionLog), or else a journal segment
+    SnapshotData snapshot;
+    std::vector<JournalRecord> records;
+    if (!Snapshot::read(filename, snapshot)) {
+        JournalReader reader(filename);
+        if (!reader.isOpen()) {
+            if (config.enableAuditLogging) {
+                transactionLogger->logError("Cannot open transaction log for import", filename);
+            }
+            return false;
+        }
+        JournalRecord record;
+        while (reader.next(record)) {
+            records.push_back(std::move(record));
+        }
+    }
+    
+    // Imported accounts are journaled as new openings so they survive a restart
+    size_t imported = replayIntoDirectory(snapshot.entries, records, true);
+    
     if (config.enableAuditLogging) {
         transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
-                                    "Transaction log import requested from: " + filename);
+                                    "Imported " + std::to_string(imported) + 
+                                    " accounts from: " + filename);
     }
+    return true;
 }
 
-// generateAccountNumber is now implemented in bank_utils.cpp
+std::string Bank::generateAccountNumber() {
+    return accountNumbers.allocate();
+}
 
 bool Bank::validateAccountNumber(const std::string& accountNumber) {
-    return TransactionUtils::isValidAccountNumber(accountNumber);
+    return BankUtils::isValidAccountNumber(accountNumber);
 }
 
-bool Bank::validateTransaction(const std::string& accountNumber, double amount, 
-                              const std::string& type) {
+bool Bank::validateTransaction(const std::string& accountNumber, Money amount, 
+                              TransactionType type) {
     if (!validateAccountNumber(accountNumber)) {
         return false;
     }
     
-    if (amount <= 0) {
+    if (!amount.isPositive()) {
         return false;
     }
     
@@ -440,7 +1369,7 @@ bool Bank::validateTransaction(const std::string& accountNumber, double amount,
         return false;
     }
     
-    if ((type == "WITHDRAW" || type == "TRANSFER") && 
+    if ((type == TransactionType::WITHDRAW || type == TransactionType::TRANSFER) && 
         account->getBalance() < amount) {
         return false;
     }
@@ -454,42 +1383,962 @@ void Bank::logTransaction(const Transaction& transaction) {
     }
 }
 
-void Bank::updateStatistics(bool success) {
-    totalTransactions++;
-    if (success) {
-        successfulTransactions++;
+void Bank::updateStatistics(StatCounter operation, TransactionStatus status) {
+    // All in this thread's slot: one cache line, shared with no other core
+    statistics.add(operation);
+    switch (status) {
+        case TransactionStatus::SUCCESS:
+            statistics.add(STAT_SUCCESSFUL);
+            return;
+        case TransactionStatus::INSUFFICIENT_FUNDS:
+            statistics.add(STAT_INSUFFICIENT_FUNDS);
+            break;
+        case TransactionStatus::INVALID_ACCOUNT:
+            statistics.add(STAT_INVALID_ACCOUNT);
+            break;
+        default:
+            statistics.add(STAT_OTHER_FAILURES);
+            break;
+    }
+    statistics.add(STAT_FAILED);
+}
+
+Bank::StatCounter Bank::operationCounter(TransactionType type) {
+    switch (type) {
+        case TransactionType::DEPOSIT: return STAT_DEPOSITS;
+        case TransactionType::WITHDRAW: return STAT_WITHDRAWALS;
+        default: return STAT_TRANSFERS;
+    }
+}
+
+void Bank::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    size_t workers = threadPool->isRunning() ? threadPool->getThreadCount() + 1 : 1;
+    size_t chunks = std::min(workers, (count + grain - 1) / std::max<size_t>(grain, 1));
+    if (chunks <= 1) {
+        body(0, count);
+        return;
+    }
+    
+    // Chunks are claimed from a shared cursor, the caller included, so the call finishes even if
+    // no worker gets to a helper (workers can be parked at a bulk job's barrier). A helper that
+    // starts late finds nothing left and only touches the state it keeps alive
+    struct Shared {
+        const std::function<void(size_t, size_t)>* body;
+        size_t count;
+        size_t chunkSize;
+        size_t chunks;
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t done = 0;
+        std::exception_ptr failure;
+        
+        void run() {
+            for (size_t chunk; (chunk = next.fetch_add(1)) < chunks;) {
+                std::exception_ptr error;
+                try {
+                    size_t begin = chunk * chunkSize;
+                    (*body)(begin, std::min(count, begin + chunkSize));
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                if (error && !failure) {
+                    failure = error;
+                }
+                if (++done == chunks) {
+                    finished.notify_all();
+                }
+            }
+        }
+    };
+    auto shared = std::make_shared<Shared>();
+    shared->body = &body;
+    shared->count = count;
+    shared->chunkSize = (count + chunks - 1) / chunks;
+    shared->chunks = (count + shared->chunkSize - 1) / shared->chunkSize;
+    for (size_t helper = 1; helper < shared->chunks; ++helper) {
+        threadPool->submitTask(UniqueFunction([shared]() { shared->run(); }), "Bulk work", 1);
+    }
+    shared->run();
+    
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->finished.wait(lock, [&shared]() { return shared->done == shared->chunks; });
+    if (shared->failure) {
+        std::rethrow_exception(shared->failure);
+    }
+}
+
+std::string Bank::shardLoadSummary() const {
+    std::vector<ThreadMonitor::ShardLoad> loads = threadMonitor->getShardLoads();
+    std::vector<uint64_t> perWorker(threadPool->getThreadCount(), 0);
+    uint64_t operations = 0;
+    uint64_t batches = 0;
+    size_t busyShards = 0;
+    const ThreadMonitor::ShardLoad* busiest = nullptr;
+    for (const ThreadMonitor::ShardLoad& load : loads) {
+        operations += load.operations;
+        batches += load.batches;
+        busyShards += load.operations > 0 ? 1 : 0;
+        if (load.worker < perWorker.size()) {
+            perWorker[load.worker] += load.operations;
+        }
+        if (!busiest || load.operations > busiest->operations) {
+            busiest = &load;
+        }
+    }
+    if (operations == 0) {
+        return "no pipeline batches yet";
+    }
+    
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1)
+        << operations << " operations in " << batches << " batches over " << busyShards << " of " 
+        << loads.size() << " shards; busiest shard " << busiest->shard << " has " 
+        << busiest->operations * 100.0 / operations << "% (" 
+        << std::setprecision(2) << busiest->operations * static_cast<double>(loads.size()) / operations 
+        << "x the mean";
+    if (busiest->worker < perWorker.size()) {
+        oss << ", worker " << busiest->worker;
+        int node = threadPool->getWorkerNode(busiest->worker);
+        if (node >= 0) {
+            oss << " on node " << node;
+        }
+    }
+    oss << ")";
+    if (config.shardAffinity) {
+        // Shards never change workers then, so the latest worker is the only one
+        oss << "; by worker:" << std::setprecision(1);
+        for (size_t worker = 0; worker < perWorker.size(); ++worker) {
+            oss << " " << perWorker[worker] * 100.0 / operations << "%";
+        }
+    }
+    return oss.str();
+}
+
+std::string Bank::workerStateSummary() const {
+    std::vector<ThreadMonitor::ThreadInfo> threads = threadMonitor->getAllThreads();
+    if (threads.empty()) {
+        return "no workers running";
+    }
+    
+    size_t counts[static_cast<size_t>(ThreadMonitor::ThreadState::EXITED) + 1] = {};
+    uint64_t tasks = 0;
+    std::chrono::nanoseconds busy(0);
+    std::chrono::nanoseconds total(0);
+    std::vector<const ThreadMonitor::ThreadInfo*> waiting;
+    for (const ThreadMonitor::ThreadInfo& thread : threads) {
+        counts[static_cast<size_t>(thread.state)]++;
+        tasks += thread.tasksRun;
+        busy += thread.busy;
+        total += thread.busy + thread.idle;
+        if (thread.state == ThreadMonitor::ThreadState::WAITING_LOCK) {
+            waiting.push_back(&thread);
+        }
+    }
+    
+    using State = ThreadMonitor::ThreadState;
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1)
+        << threads.size() << " workers: " << counts[static_cast<size_t>(State::RUNNING)] << " running, " 
+        << counts[static_cast<size_t>(State::WAITING_LOCK)] << " waiting on locks, " 
+        << counts[static_cast<size_t>(State::IDLE)] << " idle, " 
+        << counts[static_cast<size_t>(State::PARKED)] << " parked; " << tasks << " tasks, " 
+        << (total.count() > 0 ? busy.count() * 100.0 / total.count() : 0.0) << "% busy";
+    // Who is waiting on what: a convoy shows as many workers on one lock
+    for (size_t i = 0; i < waiting.size() && i < 8; ++i) {
+        oss << (i == 0 ? " (" : ", ") << waiting[i]->status;
+    }
+    if (!waiting.empty()) {
+        oss << (waiting.size() > 8 ? ", ...)" : ")");
+    }
+    return oss.str();
+}
+
+std::string Bank::lockContentionSummary() {
+    uint32_t period = ThreadMonitor::getContentionSampling();
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    if (period == 0) {
+        oss << "sampling OFF";
     } else {
-        failedTransactions++;
+        oss << "1 in " << period << " acquisitions sampled";
+    }
+    for (const ThreadMonitor::LockContention& site : ThreadMonitor::getLockContention()) {
+        if (site.sampled == 0) {
+            continue;
+        }
+        oss << "; " << ThreadMonitor::lockSiteName(site.site) << " " << site.sampled << " sampled, " 
+            << site.contended * 100.0 / site.sampled << "% contended";
+        if (site.contended > 0) {
+            oss << ", mean wait " << site.wait.count() / 1000.0 / site.contended << " us, max " 
+                << site.maxWait.count() / 1000.0 << " us, peak " << site.peakWaiters << " waiters";
+        }
     }
+    return oss.str();
 }
 
-std::shared_ptr<Account> Bank::findAccountUnsafe(const std::string& accountNumber) {
-    auto it = accounts.find(accountNumber);
-    return (it != accounts.end()) ? it->second : nullptr;
+bool Bank::commitJournal() {
+    // Outside every account lock: waits (per the durability mode) for what this thread journaled
+    if (!journal) {
+        return true;
+    }
+    bool durable;
+    {
+        ScopedLatency timer(LatencyStage::JOURNAL_COMMIT);
+        durable = journal->commitCurrentThread();
+    }
+    if (!durable) {
+        if (config.enableAuditLogging && !journalFailureLogged.exchange(true)) {
+            transactionLogger->logError("Journal write failed: " + 
+                                        std::string(std::strerror(journal->getWriter().getError())) + 
+                                        "; operations are reported as failed from here on", journal->getPath());
+        }
+        return false;
+    }
+    
+    // QUORUM: and until enough followers have applied it too (the server gives up after its timeout)
+    if (config.replicationAckMode == ReplicationAckMode::QUORUM && 
+        replicationRole.load(std::memory_order_acquire) == ReplicationRole::PRIMARY) {
+        ScopedLatency timer(LatencyStage::REPLICATION_ACK);
+        replicationServer->waitForQuorum(journal->getCurrentThreadLsn());
+    }
+    return true;
 }
 
-void Bank::addAccountUnsafe(const std::string& accountNumber, std::shared_ptr<Account> account) {
-    accounts[accountNumber] = account;
+void Bank::recordPipelineOutcome(TransactionType type, const std::string& accountNumber, 
+                                 const std::string& targetAccount, Money amount, TransactionStatus status) {
+    updateStatistics(operationCounter(type), status);
+    
+    if (status != TransactionStatus::SUCCESS || !config.enableAuditLogging) {
+        return;
+    }
+    
+    // Same audit lines as the synchronous process* calls (the numbers are interned already)
+    StringTable& numbers = StringTable::accountNumbers();
+    switch (type) {
+        case TransactionType::DEPOSIT:
+            transactionLogger->logDeposit(numbers.intern(accountNumber), amount);
+            break;
+        case TransactionType::WITHDRAW:
+            transactionLogger->logWithdrawal(numbers.intern(accountNumber), amount);
+            break;
+        case TransactionType::TRANSFER:
+            transactionLogger->logTransfer(numbers.intern(accountNumber), numbers.intern(targetAccount), amount);
+            break;
+        default:
+            break;
+    }
 }
 
-void Bank::removeAccountUnsafe(const std::string& accountNumber) {
-    accounts.erase(accountNumber);
+// ----------------------------------------------------------------------------
+// Bulk jobs
+// ----------------------------------------------------------------------------
+
+Bank::BulkResult Bank::applyInterest(double annualRatePercent, int months) {
+    if (isReplica()) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, kReplicaWrites);
+    }
+    double factor = annualRatePercent * months / 1200.0;
+    if (months <= 0 || !std::isfinite(factor) || factor < 0 || factor > 1) {
+        throw BankException(BankException::ErrorType::INVALID_AMOUNT, "Invalid interest rate or period");
+    }
+    
+    static const uint32_t description = StringTable::descriptions().intern("Interest");
+    BulkResult result = postFromColumns(TransactionType::DEPOSIT, description, 
+        [factor](const int64_t* balances, const uint8_t* flags, const int64_t*, size_t count, int64_t* amounts) {
+            interestKernel(balances, flags, count, factor, amounts);
+        });
+    
+    if (config.enableAuditLogging) {
+        std::ostringstream message;
+        message << "Interest applied: $" << result.total << " to " << result.accountsPosted 
+                << " accounts (" << annualRatePercent << "% for " << months << " months)";
+        transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, message.str());
+    }
+    return result;
 }
 
-void Bank::processTransactionAsync(const std::function<void()>& transactionTask, 
-                                  const std::string& description) {
-    if (!systemRunning) {
+Bank::BulkResult Bank::applyFees(const FeeSchedule& schedule) {
+    if (isReplica()) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, kReplicaWrites);
+    }
+    Money highestFee;
+    if (schedule.maintenanceFee.isNegative() || schedule.lowBalanceFee.isNegative() ||
+        !Money::tryAdd(schedule.maintenanceFee, schedule.lowBalanceFee, highestFee)) {
+        throw BankException(BankException::ErrorType::INVALID_AMOUNT, "Invalid fee schedule");
+    }
+    
+    static const uint32_t description = StringTable::descriptions().intern("Account fee");
+    int64_t maintenanceFee = schedule.maintenanceFee.toCents();
+    int64_t lowBalanceFee = schedule.lowBalanceFee.toCents();
+    BulkResult result = postFromColumns(TransactionType::WITHDRAW, description, 
+        [maintenanceFee, lowBalanceFee](const int64_t* balances, const uint8_t* flags, 
+                                        const int64_t* minimumBalances, size_t count, int64_t* amounts) {
+            feeKernel(balances, flags, minimumBalances, count, maintenanceFee, lowBalanceFee, amounts);
+        });
+    
+    if (config.enableAuditLogging) {
+        transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
+                                    "Fees charged: $" + result.total.toString() + " to " + 
+                                    std::to_string(result.accountsPosted) + " accounts");
+    }
+    return result;
+}
+
+Money Bank::sumAllBalances() {
+    Money total;
+    std::mutex totalMutex;
+    forEachColumnChunk([&](AccountColumns::Chunk& chunk, size_t slots) {
+        ArenaScope scratch;
+        std::pmr::vector<int64_t> listed(slots, scratch.resource());
+        for (size_t i = 0; i < slots; ++i) {
+            bool isListed = (chunk.flags[i].load(std::memory_order_relaxed) & AccountColumns::LISTED) != 0;
+            listed[i] = isListed ? chunk.balances[i].load(std::memory_order_relaxed).toCents() : 0;
+        }
+        Money part = Money::sumCents(listed.data(), listed.size());
+        std::lock_guard<std::mutex> lock(totalMutex);
+        total += part;
+    });
+    return total;
+}
+
+bool Bank::setAccountTerms(const std::string& accountNumber, const AccountTerms& terms) {
+    if (terms.minimumBalance.isNegative()) {
+        throw BankException(BankException::ErrorType::INVALID_AMOUNT, 
+                           "Minimum balance cannot be negative", accountNumber);
+    }
+    auto account = getAccount(accountNumber);
+    if (!account) {
+        return false;
+    }
+    account->setTerms(terms);
+    return true;
+}
+
+void Bank::forEachColumnChunk(const std::function<void(AccountColumns::Chunk&, size_t)>& body) {
+    // A snapshot sees a job entirely or not at all, and no account is listed or unlisted meanwhile
+    std::lock_guard<std::mutex> snapshotLock(snapshotMutex);
+    std::unique_lock<std::shared_mutex> gate(accountCreationGate);
+    AccountColumns::Barrier barrier(*columns);
+    
+    // Hot accounts hold part of their balance in stripes: fold it into the column first. This
+    // thread passes the writer gate; pool threads would wait at it, so they only run the body
+    for (size_t c = 0; c < barrier.chunkCount(); ++c) {
+        AccountColumns::Chunk& chunk = barrier.chunk(c);
+        for (size_t i = 0, slots = barrier.slotsIn(c); i < slots; ++i) {
+            uint8_t flags = chunk.flags[i].load(std::memory_order_relaxed);
+            if ((flags & AccountColumns::LISTED) && (flags & AccountColumns::FAST_PATH)) {
+                chunk.owners[i]->settleForBulk();
+            }
+        }
+    }
+    
+    parallelFor(barrier.chunkCount(), 1, [&barrier, &body](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            body(barrier.chunk(c), barrier.slotsIn(c));
+        }
+    });
+}
+
+Bank::BulkResult Bank::postFromColumns(TransactionType type, uint32_t description, const ColumnKernel& kernel) {
+    BulkResult result;
+    std::mutex resultMutex;
+    forEachColumnChunk([&](AccountColumns::Chunk& chunk, size_t slots) {
+        // Copy the atomics out once; the kernel then works on plain arrays. Terms only
+        // change inside a writer guard, so that column is read where it is
+        ArenaScope scratch;
+        std::pmr::vector<int64_t> balances(slots, scratch.resource());
+        std::pmr::vector<uint8_t> flags(slots, scratch.resource());
+        std::pmr::vector<int64_t> amounts(slots, scratch.resource());
+        for (size_t i = 0; i < slots; ++i) {
+            balances[i] = chunk.balances[i].load(std::memory_order_relaxed).toCents();
+            flags[i] = chunk.flags[i].load(std::memory_order_relaxed);
+        }
+        kernel(balances.data(), flags.data(), reinterpret_cast<const int64_t*>(chunk.minimumBalances), 
+               slots, amounts.data());
+        
+        size_t posted = 0;
+        Money total;
+        for (size_t i = 0; i < slots; ++i) {
+            if (amounts[i] != 0 && chunk.owners[i]->postBulk(type, Money::fromCents(amounts[i]), description)) {
+                ++posted;
+                total += Money::fromCents(amounts[i]);
+            }
+        }
+        std::lock_guard<std::mutex> lock(resultMutex);
+        result.accountsPosted += posted;
+        result.total += total;
+    });
+    
+    // Writers are back; durability for the whole job is one flush
+    if (journal && !journal->flush()) {
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, "Journal write failed");
+    }
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// Snapshots and recovery
+// ----------------------------------------------------------------------------
+
+bool Bank::takeSnapshot() {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    if (config.snapshotPath.empty() || isReplica()) {
+        return false;   // A follower's state is the primary's: it has no journal position of its own
+    }
+    
+    // Cut: a fresh segment, and the LSN every later read reflects at least
+    uint64_t firstLiveSegment = 0;
+    uint64_t cutLsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> gate(accountCreationGate);
+        if (journal) {
+            firstLiveSegment = journal->rotate();
+            cutLsn = journal->getLastLsn();
+        }
+    }
+    
+    SnapshotData snapshot = captureSnapshot();
+    snapshot.snapshotLsn = cutLsn;
+    if (!Snapshot::write(config.snapshotPath, snapshot)) {
+        if (config.enableAuditLogging) {
+            transactionLogger->logError("Failed to write snapshot", config.snapshotPath);
+        }
+        return false;
+    }
+    
+    // Older segments only hold records at or below the cut: those still resident are in the
+    // snapshot, and the archive must have the ones evicted before it was taken
+    bool archived = !historyArchive || historyArchive->flush();
+    if (journal && firstLiveSegment != 0 && archived) {
+        journal->removeSegmentsBefore(firstLiveSegment);
+    }
+    
+    if (config.enableAuditLogging) {
+        transactionLogger->logMessage(TransactionLogger::LogLevel::INFO, 
+                                    "Snapshot written: " + std::to_string(snapshot.entries.size()) + 
+                                    " accounts at LSN " + std::to_string(cutLsn));
+    }
+    return true;
+}
+
+SnapshotData Bank::captureSnapshot() {
+    SnapshotData snapshot;
+    snapshot.createdAt = std::chrono::system_clock::now();
+    snapshot.entries.reserve(accounts.size());
+    
+    // One account at a time; traffic keeps flowing on every other account. The resident history
+    // goes with the balance (taken under the same lock), since the segments that held it are
+    // deleted once the snapshot is written
+    std::vector<Transaction> history;
+    accounts.forEach([&snapshot, &history](const std::shared_ptr<Account>& account) {
+        account->flushPending();    // Fast-path records still queued reach the journal first
+        Account::State state = account->getState(history);
+        SnapshotEntry entry{account->getAccountNumber(), account->getAccountHolderName(), 
+                            state.balance, state.lastLsn, {}};
+        entry.history.reserve(history.size());
+        for (const Transaction& transaction : history) {
+            entry.history.push_back(recordFromTransaction(transaction));
+        }
+        snapshot.entries.push_back(std::move(entry));
+    });
+    snapshot.lastTransactionId = IdGenerator::highWatermark();
+    snapshot.nextAccountOrdinal = accountNumbers.getNextOrdinal();
+    return snapshot;
+}
+
+void Bank::snapshotLoop() {
+    std::unique_lock<std::mutex> lock(snapshotThreadMutex);
+    while (!snapshotWake.wait_for(lock, config.snapshotInterval, [this]() { return snapshotThreadStop; })) {
+        lock.unlock();
+        takeSnapshot();
+        lock.lock();
+    }
+}
+
+void Bank::recoverState() {
+    auto started = std::chrono::steady_clock::now();
+    
+    SnapshotData snapshot;
+    bool haveSnapshot = !config.snapshotPath.empty() && Snapshot::read(config.snapshotPath, snapshot);
+    
+    // Journal tail: every record past the snapshot cut, from segments written before this run
+    std::vector<JournalRecord> records;
+    size_t segmentsRead = 0;
+    bool tornTail = false;
+    if (journal) {
+        for (const Journal::Segment& segment : journal->listSegments()) {
+            if (segment.number >= journal->getCurrentSegment()) {
+                continue;
+            }
+            JournalReader reader(segment.path);
+            JournalRecord record;
+            while (reader.next(record)) {
+                if (record.lsn > snapshot.snapshotLsn) {
+                    records.push_back(std::move(record));
+                }
+            }
+            tornTail = tornTail || reader.hitCorruption();
+            ++segmentsRead;
+        }
+    }
+    
+    if (!haveSnapshot && records.empty()) {
+        return; // Nothing persisted
+    }
+    
+    size_t restored = replayIntoDirectory(snapshot.entries, records, false);
+    
+    if (config.enableAuditLogging) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started);
+        transactionLogger->logMessage(tornTail ? TransactionLogger::LogLevel::WARNING 
+                                               : TransactionLogger::LogLevel::INFO, 
+                                    "Recovered " + std::to_string(restored) + " accounts (snapshot: " + 
+                                    (haveSnapshot ? std::to_string(snapshot.entries.size()) + " accounts at LSN " + 
+                                                    std::to_string(snapshot.snapshotLsn) 
+                                                  : std::string("none")) + 
+                                    ", replayed " + std::to_string(records.size()) + " journal records from " + 
+                                    std::to_string(segmentsRead) + " segments" + 
+                                    (tornTail ? ", torn tail ignored" : "") + ") in " + 
+                                    std::to_string(elapsed.count()) + " ms");
+    }
+}
+
+size_t Bank::replayIntoDirectory(const std::vector<SnapshotEntry>& entries, 
+                                 const std::vector<JournalRecord>& records, bool journalRestored) {
+    // Partition by directory shard; a transfer between shards goes to both
+    size_t shardCount = accounts.shardCount();
+    std::vector<std::vector<const SnapshotEntry*>> shardEntries(shardCount);
+    std::vector<std::vector<const JournalRecord*>> shardRecords(shardCount);
+    uint64_t highestTransactionId = 0;
+    
+    // A batch transfer is all or nothing: without its last leg (a torn tail) it is dropped
+    std::unordered_set<uint64_t> completeBatches;
+    for (const JournalRecord& record : records) {
+        if (record.flags & Transaction::FLAG_BATCH_LAST) {
+            completeBatches.insert(record.transactionId);
+        }
+    }
+    
+    for (const SnapshotEntry& entry : entries) {
+        shardEntries[accounts.shardIndex(entry.accountNumber)].push_back(&entry);
+    }
+    for (const JournalRecord& record : records) {
+        highestTransactionId = std::max(highestTransactionId, record.transactionId);
+        if ((record.flags & Transaction::FLAG_BATCH) && !completeBatches.count(record.transactionId)) {
+            continue;
+        }
+        size_t shard = accounts.shardIndex(record.account);
+        shardRecords[shard].push_back(&record);
+        if (!record.counterparty.empty()) {
+            size_t counterpartyShard = accounts.shardIndex(record.counterparty);
+            if (counterpartyShard != shard) {
+                shardRecords[counterpartyShard].push_back(&record);
+            }
+        }
+    }
+    IdGenerator::observe(highestTransactionId);
+    
+    // Shards share no accounts, so they replay independently
+    std::vector<std::future<size_t>> replays;
+    size_t restored = 0;
+    for (size_t shard = 0; shard < shardCount; ++shard) {
+        if (shardEntries[shard].empty() && shardRecords[shard].empty()) {
+            continue;
+        }
+        auto replay = [this, shard, &shardEntries, &shardRecords, journalRestored]() {
+            return replayShard(shard, shardEntries[shard], shardRecords[shard], journalRestored);
+        };
+        if (threadPool->isRunning()) {
+            replays.push_back(threadPool->submit(replay, 1, "Replay shard " + std::to_string(shard)));
+        } else {
+            restored += replay();
+        }
+    }
+    for (auto& replay : replays) {
+        try {
+            restored += replay.get();
+        } catch (const std::exception& e) {
+            if (config.enableAuditLogging) {
+                transactionLogger->logError("Shard replay failed: " + std::string(e.what()));
+            }
+        }
+    }
+    return restored;
+}
+
+size_t Bank::replayShard(size_t shard, std::vector<const SnapshotEntry*>& entries, 
+                         std::vector<const JournalRecord*>& records, bool journalRestored) {
+    std::unordered_map<std::string, std::shared_ptr<Account>> restored;
+    
+    for (const SnapshotEntry* entry : entries) {
+        accountNumbers.observe(entry->accountNumber);
+        auto account = makeAccount(entry->accountNumber, entry->holderName, Money());
+        account->restoreState(entry->balance, entry->lastLsn);
+        for (const JournalRecord& record : entry->history) {
+            account->addTransaction(transactionFromRecord(record));
+        }
+        restored[entry->accountNumber] = std::move(account);
+    }
+    
+    // Per account, LSN order is the order changes were applied
+    std::sort(records.begin(), records.end(), [](const JournalRecord* a, const JournalRecord* b) {
+        return a->lsn < b->lsn;
+    });
+    
+    auto apply = [&](const JournalRecord& record, const std::string& number, Money balanceAfter) {
+        if (number.empty() || accounts.shardIndex(number) != shard) {
+            return; // The other side of a cross-shard transfer
+        }
+        auto found = restored.find(number);
+        if (found == restored.end() || found->second->getState().lastLsn >= record.lsn) {
+            return; // Unknown account, or already reflected in the snapshot
+        }
+        applyJournalledTransaction(*found->second, record, balanceAfter);
+    };
+    
+    for (const JournalRecord* record : records) {
+        switch (record->kind) {
+            case JournalRecordKind::ACCOUNT_OPENED:
+                accountNumbers.observe(record->account); // Closed accounts keep their number too
+                if (accounts.shardIndex(record->account) == shard && !restored.count(record->account)) {
+                    auto account = reopenAccount(*record);
+                    account->restoreState(record->balanceAfter, record->lsn);
+                    restored[record->account] = std::move(account);
+                }
+                break;
+            case JournalRecordKind::ACCOUNT_CLOSED: {
+                auto found = restored.find(record->account);
+                if (found != restored.end() && found->second->getState().lastLsn < record->lsn) {
+                    restored.erase(found);
+                }
+                break;
+            }
+            case JournalRecordKind::TRANSACTION:
+                apply(*record, record->account, record->balanceAfter);
+                apply(*record, record->counterparty, record->counterpartyBalanceAfter);
+                break;
+        }
+    }
+    
+    // Publish; accounts that already exist in the directory win
+    size_t inserted = 0;
+    for (auto& item : restored) {
+        std::shared_ptr<Account>& account = item.second;
+        Account::State state = account->getState();
+        if (journal) {
+            account->attachJournal(journal.get(), state.lastLsn);
+        }
+        
+        std::shared_lock<std::shared_mutex> gate(accountCreationGate);
+        if (accounts.find(item.first)) {
+            continue;
+        }
+        if (journalRestored && journal) {
+            JournalRecord opened;
+            opened.kind = JournalRecordKind::ACCOUNT_OPENED;
+            opened.timestamp = account->getCreatedAt();
+            opened.amount = state.balance;
+            opened.account = item.first;
+            opened.balanceAfter = state.balance;
+            opened.text = account->getAccountHolderName();
+            account->attachJournal(journal.get(), journal->append(opened));
+        }
+        if (accounts.insert(item.first, account)) {
+            ++inserted;
+        }
+    }
+    commitJournal();
+    return inserted;
+}
+
+// ----------------------------------------------------------------------------
+// Replication
+// ----------------------------------------------------------------------------
+
+ReplicationRole Bank::getReplicationRole() const {
+    return replicationRole.load(std::memory_order_acquire);
+}
+
+uint16_t Bank::getReplicationPort() const {
+    bool serving = getReplicationRole() == ReplicationRole::PRIMARY && replicationServer->isRunning();
+    return serving ? replicationServer->getPort() : 0;
+}
+
+bool Bank::isReplica() const {
+    return replicationRole.load(std::memory_order_acquire) == ReplicationRole::FOLLOWER;
+}
+
+ReplicationServer::Options Bank::replicationServerOptions() const {
+    ReplicationServer::Options options;
+    options.bindAddress = config.replicationListen;
+    options.port = config.replicationListenPort;
+    options.ackMode = config.replicationAckMode;
+    options.quorum = config.replicationQuorum;
+    options.ackTimeout = config.replicationAckTimeout;
+    options.batchWindow = config.replicationBatchWindow;
+    return options;
+}
+
+void Bank::streamReplicaSnapshot(const std::function<uint64_t()>& cut, 
+                                 const std::function<void(const JournalRecord&)>& emit) {
+    // As for a snapshot: no account is opened or closed across the cut
+    {
+        std::unique_lock<std::shared_mutex> gate(accountCreationGate);
+        cut();
+    }
+    
+    // One account at a time, so writers keep going; an account changed after the cut carries
+    // a later journal position, and the follower skips the records it already reflects
+    std::vector<Transaction> history;
+    for (const std::shared_ptr<Account>& account : accounts.snapshot()) {
+        account->flushPending();
+        Account::State state = account->getState(history);
+        JournalRecord opened;
+        opened.kind = JournalRecordKind::ACCOUNT_OPENED;
+        opened.lsn = state.lastLsn;
+        opened.timestamp = account->getCreatedAt();
+        opened.amount = state.balance;
+        opened.account = account->getAccountNumber();
+        opened.balanceAfter = state.balance;
+        opened.text = account->getAccountHolderName();
+        emit(opened);
+        for (const Transaction& transaction : history) {
+            emit(recordFromTransaction(transaction));
+        }
+    }
+}
+
+void Bank::resetReplica() {
+    std::unique_lock<std::shared_mutex> gate(accountCreationGate);
+    accounts.clear();
+}
+
+void Bank::applyReplicated(std::vector<JournalRecord>& records, bool bootstrap) {
+    // Partitioned by shard as in replay; bootstrap history follows the account it was emitted under
+    size_t shardCount = accounts.shardCount();
+    std::vector<std::vector<const JournalRecord*>> shardRecords(shardCount);
+    uint64_t highestTransactionId = 0;
+    size_t owner = 0;
+    for (const JournalRecord& record : records) {
+        highestTransactionId = std::max(highestTransactionId, record.transactionId);
+        if (record.kind == JournalRecordKind::ACCOUNT_OPENED) {
+            accountNumbers.observe(record.account);     // A promoted follower numbers on from them
+            owner = accounts.shardIndex(record.account);
+        }
+        if (bootstrap) {
+            shardRecords[owner].push_back(&record);
+            continue;
+        }
+        size_t shard = accounts.shardIndex(record.account);
+        shardRecords[shard].push_back(&record);
+        if (!record.counterparty.empty()) {
+            size_t counterpartyShard = accounts.shardIndex(record.counterparty);
+            if (counterpartyShard != shard) {
+                shardRecords[counterpartyShard].push_back(&record);
+            }
+        }
+    }
+    IdGenerator::observe(highestTransactionId);
+    
+    std::vector<size_t> busyShards;
+    for (size_t shard = 0; shard < shardCount; ++shard) {
+        if (!shardRecords[shard].empty()) {
+            busyShards.push_back(shard);
+        }
+    }
+    size_t grain = records.size() >= kParallelApplyRecords ? 1 : busyShards.size();
+    parallelFor(busyShards.size(), grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            applyReplicatedShard(busyShards[i], shardRecords[busyShards[i]], bootstrap);
+        }
+    });
+}
+
+void Bank::applyReplicatedShard(size_t shard, std::vector<const JournalRecord*>& records, bool bootstrap) {
+    std::shared_lock<std::shared_mutex> gate(accountCreationGate);
+    
+    if (bootstrap) {
+        // Each account is listed once its history is in
+        std::shared_ptr<Account> account;
+        auto publish = [&]() {
+            if (account) {
+                accounts.insert(account->getAccountNumber(), account);
+            }
+        };
+        for (const JournalRecord* record : records) {
+            if (record->kind == JournalRecordKind::ACCOUNT_OPENED) {
+                publish();
+                account = makeAccount(record->account, record->text, Money());
+                account->restoreState(record->balanceAfter, record->lsn);
+            } else if (account) {
+                account->addTransaction(transactionFromRecord(*record));
+            }
+        }
+        publish();
         return;
     }
     
-    // Add task to work queue
-    WorkQueue::WorkItem workItem(transactionTask, description);
-    if (workQueue->enqueue(workItem)) {
-        // Process task in thread pool
-        threadPool->submitTask(transactionTask);
+    auto apply = [&](const JournalRecord& record, const std::string& number, Money balanceAfter) {
+        if (number.empty() || accounts.shardIndex(number) != shard) {
+            return; // The other side of a cross-shard transfer
+        }
+        auto account = accounts.find(number);
+        if (account && account->getState().lastLsn < record.lsn) {
+            applyJournalledTransaction(*account, record, balanceAfter);
+        }
+    };
+    
+    for (const JournalRecord* record : records) {
+        switch (record->kind) {
+            case JournalRecordKind::ACCOUNT_OPENED:
+                if (accounts.shardIndex(record->account) == shard && !accounts.find(record->account)) {
+                    auto account = reopenAccount(*record);
+                    account->restoreState(record->balanceAfter, record->lsn);
+                    accounts.insert(record->account, account);
+                }
+                break;
+            case JournalRecordKind::ACCOUNT_CLOSED: {
+                uint64_t lsn = record->lsn;
+                accounts.eraseIf(record->account, [lsn](const Account& account) {
+                    return account.getState().lastLsn < lsn;
+                });
+                break;
+            }
+            case JournalRecordKind::TRANSACTION:
+                apply(*record, record->account, record->balanceAfter);
+                apply(*record, record->counterparty, record->counterpartyBalanceAfter);
+                break;
+        }
     }
 }
 
+bool Bank::promoteToPrimary() {
+    if (!isReplica() || !journal) {
+        return false;
+    }
+    
+    // Stop applying: the accounts then hold exactly what the follower had received
+    replicationFollower->stop();
+    uint64_t lastLsn = replicationFollower->getHighestLsn();
+    journal->advanceLsn(lastLsn);
+    {
+        std::unique_lock<std::shared_mutex> gate(accountCreationGate);
+        for (const std::shared_ptr<Account>& account : accounts.snapshot()) {
+            account->attachJournal(journal.get(), account->getState().lastLsn);
+        }
+    }
+    
+    replicationServer = std::make_unique<ReplicationServer>(*journal, replicationServerOptions(), 
+        [this](const std::function<uint64_t()>& cut, const std::function<void(const JournalRecord&)>& emit) {
+            streamReplicaSnapshot(cut, emit);
+        });
+    if (systemRunning) {
+        try {
+            replicationServer->start();
+        } catch (const BankException& e) {
+            // Promoted all the same: taking writes matters more than having followers
+            transactionLogger->logError("Replication server failed to start: " + std::string(e.what()));
+        }
+    }
+    replicationRole.store(ReplicationRole::PRIMARY, std::memory_order_release);
+    
+    // Durable from here on: a snapshot of the promoted state, then the snapshot schedule
+    takeSnapshot();
+    if (systemRunning && !config.snapshotPath.empty() && config.snapshotInterval.count() > 0 && 
+        !snapshotThread.joinable()) {
+        snapshotThreadStop = false;
+        snapshotThread = std::thread(&Bank::snapshotLoop, this);
+    }
+    
+    if (config.enableAuditLogging) {
+        transactionLogger->logMessage(TransactionLogger::LogLevel::WARNING, 
+                                    "Promoted to replication primary at LSN " + std::to_string(lastLsn));
+    }
+    return true;
+}
+
+std::string Bank::replicationSummary() const {
+    std::ostringstream oss;
+    switch (getReplicationRole()) {
+        case ReplicationRole::STANDALONE:
+            oss << "OFF";
+            break;
+        case ReplicationRole::PRIMARY: {
+            ReplicationServer::Statistics stats = replicationServer->getStatistics();
+            const ReplicationServer::Options& options = replicationServer->getOptions();
+            oss << "PRIMARY on port " << replicationServer->getPort() << " (" 
+                << replicationAckModeName(options.ackMode);
+            if (options.ackMode == ReplicationAckMode::QUORUM) {
+                oss << " of " << options.quorum << ", " << stats.quorumWaits << " waits, " 
+                    << stats.quorumTimeouts << " timeouts" << (stats.degraded ? ", DEGRADED" : "");
+            }
+            oss << "), shipped to LSN " << stats.shippedLsn << " in " << stats.batches << " batches (" 
+                << stats.records << " records, " << stats.bytes / 1024 << " KB), " << stats.bootstraps 
+                << " bootstraps, " << stats.droppedFollowers << " dropped; " << stats.followers.size() 
+                << " followers";
+            for (const ReplicationServer::FollowerStatus& follower : stats.followers) {
+                oss << "; " << follower.peer << " " << (follower.streaming ? "acked " + std::to_string(follower.ackedLsn) 
+                                                                           : std::string("bootstrapping")) 
+                    << ", lag " << follower.lagRecords << " records / " << follower.lag.count() << " ms";
+            }
+            break;
+        }
+        case ReplicationRole::FOLLOWER: {
+            ReplicationFollower::Statistics stats = replicationFollower->getStatistics();
+            const ReplicationFollower::Options& options = replicationFollower->getOptions();
+            oss << "FOLLOWER of " << options.primaryAddress << ":" << options.primaryPort << " (" 
+                << (stats.streaming ? "streaming" : stats.connected ? "bootstrapping" : "disconnected") 
+                << "), applied LSN " << stats.appliedLsn << " of " << stats.primaryLsn << ", lag " 
+                << stats.lagRecords << " records / " << stats.applyDelay.count() << " ms; " 
+                << stats.batches << " batches (" << stats.records << " records), " << stats.bootstraps 
+                << " bootstraps, " << stats.connections << " connections";
+            break;
+        }
+    }
+    return oss.str();
+}
+
+std::future<bool> Bank::processTransactionAsync(std::function<bool()> transactionTask, const std::string& accountNumber, 
+                                               const std::string& description, int priority) {
+    bool admitted = systemRunning && !isReplica() && (!admission || admission->tryAdmit(accountNumber).admitted());
+    if (admitted && admission) {
+        // The task holds its permit until it has run, and reports how long it sat queued
+        auto admittedAt = std::chrono::steady_clock::now();
+        transactionTask = [this, admittedAt, body = std::move(transactionTask)]() {
+            admission->recordQueueDelay(std::chrono::steady_clock::now() - admittedAt);
+            struct Permit {
+                AdmissionController& controller;
+                ~Permit() { controller.release(); }
+            } permit{*admission};
+            return body();
+        };
+    }
+    
+    // Process task in thread pool
+    if (admitted) {
+        std::packaged_task<bool()> task(std::move(transactionTask));
+        std::future<bool> result = task.get_future();
+        bool submitted = config.shardAffinity 
+            ? threadPool->submitToWorker(transactionPipeline->laneOwner(accounts.shardIndex(accountNumber)), 
+                                         UniqueFunction(std::move(task)), description)
+            : threadPool->submitTask(UniqueFunction(std::move(task)), description, priority);
+        if (submitted) {
+            return result;
+        }
+        if (admission) {
+            admission->release();   // Pool stopped underneath us: the task never runs
+        }
+    }
+    
+    // System stopped, or turned away by admission control: report the transaction as not processed
+    std::promise<bool> rejected;
+    rejected.set_value(false);
+    return rejected.get_future();
+}
+
 // ============================================================================
 // BANK UTILS IMPLEMENTATION
 // ============================================================================
@@ -503,10 +2352,6 @@ namespace BankUtils {
         return !name.empty() && name.length() >= 2 && name.length() <= 100;
     }
     
-    bool isValidInitialBalance(double balance) {
-        return balance >= 0.0 && balance < 1000000.0; // Reasonable limits
-    }
-    
     std::string formatAccountNumber(const std::string& number) {
         if (number.length() <= 8) {
             return number;
@@ -518,12 +2363,6 @@ namespace BankUtils {
         return code;
     }
     
-    std::string formatCurrency(double amount) {
-        std::ostringstream oss;
-        oss << "$" << std::fixed << std::setprecision(2) << amount;
-        return oss.str();
-    }
-    
     std::string generateBankCode() {
         static std::atomic<unsigned long long> counter(0);
         std::ostringstream oss;
@@ -531,50 +2370,31 @@ namespace BankUtils {
         return oss.str();
     }
     
-    std::string generateAccountNumber() {
-        static std::atomic<unsigned long long> counter(0);
-        std::ostringstream oss;
-        oss << "ACC" << std::setfill('0') << std::setw(8) << (++counter % 100000000);
-        return oss.str();
-    }
-    
     std::string generateTransactionId() {
-        static std::atomic<unsigned long long> counter(0);
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        
-        std::ostringstream oss;
-        oss << "TXN_" << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S")
-            << "_" << std::setfill('0') << std::setw(6) << (++counter % 1000000);
-        
-        return oss.str();
+        return "TXN_" + std::to_string(IdGenerator::next());
     }
     
-    double calculateInterest(double principal, double rate, int months) {
+    Money calculateInterest(Money principal, double rate, int months) {
         if (rate <= 0 || months <= 0) {
-            return 0.0;
+            return Money();
         }
-        double monthlyRate = rate / 12.0 / 100.0;
-        return principal * monthlyRate * months;
+        // Simple interest, rounded to the nearest cent
+        long double interest = static_cast<long double>(principal.toCents()) * rate * months / 1200.0L;
+        return Money::fromCents(static_cast<int64_t>(std::llround(interest)));
     }
     
-    double calculateTransactionFee(double amount, const std::string& type) {
-        if (type == TransactionType::TRANSFER) {
-            return std::min(amount * 0.01, 10.0); // 1% fee, max $10
-        } else if (type == TransactionType::WITHDRAW) {
-            return 2.0; // Fixed $2 fee
-        }
-        return 0.0; // No fee for deposits
+    Money calculateTransactionFee(Money amount, TransactionType type) {
+        return TransactionUtils::calculateTransactionFee(amount, type);
     }
     
-    double calculateMinimumBalance(const std::string& accountType) {
+    Money calculateMinimumBalance(const std::string& accountType) {
         if (accountType == "SAVINGS") {
-            return 100.0;
+            return Money::fromDollars(100);
         } else if (accountType == "CHECKING") {
-            return 0.0;
+            return Money();
         } else if (accountType == "PREMIUM") {
-            return 1000.0;
+            return Money::fromDollars(1000);
         }
-        return 0.0;
+        return Money();
     }
 }
@@ -0,0 +1,1859 @@
+#include "../include/bank_server.h"
+#include "../include/bank.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+constexpr char BankServer::kBinaryMagic[4];
+
+namespace {
+    constexpr uint64_t kListenerKey = 0;
+    constexpr uint64_t kWakeKey = 1;
+    constexpr size_t kMaxPipelinedReplies = 1024;      // Per connection; parsing pauses beyond it
+    constexpr size_t kMaxBufferedOutput = 4 << 20;     // Reading pauses (event streams: dropped)
+    constexpr size_t kReadChunk = 64 * 1024;
+    constexpr size_t kReadBudget = 4;                  // Chunks per readiness event, for fairness
+    constexpr size_t kWriteSegments = 64;              // iovecs per sendmsg
+    constexpr size_t kJsonMaxDepth = 32;
+    constexpr std::chrono::seconds kHeartbeatInterval{15};
+
+    // ------------------------------------------------------------------------
+    // JSON
+    // ------------------------------------------------------------------------
+
+    struct JsonValue {
+        enum class Kind : uint8_t { NONE, NULL_VALUE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+        Kind kind = Kind::NONE;
+        bool boolean = false;
+        std::string text;           // STRING contents, or the NUMBER literal
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string, JsonValue>> members;
+
+        const JsonValue* find(const char* key) const {
+            for (const auto& member : members) {
+                if (member.first == key) {
+                    return &member.second;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    class JsonParser {
+    public:
+        JsonParser(const char* begin, const char* end) : position(begin), end(end) {}
+
+        bool parseDocument(JsonValue& value) {
+            if (!parseValue(value, 0)) {
+                return false;
+            }
+            skipSpace();
+            return position == end;
+        }
+
+    private:
+        const char* position;
+        const char* end;
+
+        void skipSpace() {
+            while (position != end && (*position == ' ' || *position == '\t' || *position == '\n' || *position == '\r')) {
+                ++position;
+            }
+        }
+
+        bool literal(const char* word) {
+            size_t length = std::strlen(word);
+            if (static_cast<size_t>(end - position) < length || std::memcmp(position, word, length) != 0) {
+                return false;
+            }
+            position += length;
+            return true;
+        }
+
+        bool parseValue(JsonValue& value, size_t depth) {
+            skipSpace();
+            if (position == end || depth > kJsonMaxDepth) {
+                return false;
+            }
+            switch (*position) {
+                case '{': return parseObject(value, depth);
+                case '[': return parseArray(value, depth);
+                case '"': value.kind = JsonValue::Kind::STRING; return parseString(value.text);
+                case 't': value.kind = JsonValue::Kind::BOOLEAN; value.boolean = true; return literal("true");
+                case 'f': value.kind = JsonValue::Kind::BOOLEAN; value.boolean = false; return literal("false");
+                case 'n': value.kind = JsonValue::Kind::NULL_VALUE; return literal("null");
+                default: return parseNumber(value);
+            }
+        }
+
+        bool parseObject(JsonValue& value, size_t depth) {
+            value.kind = JsonValue::Kind::OBJECT;
+            ++position;
+            skipSpace();
+            if (position != end && *position == '}') {
+                ++position;
+                return true;
+            }
+            while (true) {
+                skipSpace();
+                std::string key;
+                if (position == end || *position != '"' || !parseString(key)) {
+                    return false;
+                }
+                skipSpace();
+                if (position == end || *position++ != ':') {
+                    return false;
+                }
+                value.members.emplace_back(std::move(key), JsonValue());
+                if (!parseValue(value.members.back().second, depth + 1)) {
+                    return false;
+                }
+                skipSpace();
+                if (position == end) {
+                    return false;
+                }
+                char next = *position++;
+                if (next == '}') {
+                    return true;
+                }
+                if (next != ',') {
+                    return false;
+                }
+            }
+        }
+
+        bool parseArray(JsonValue& value, size_t depth) {
+            value.kind = JsonValue::Kind::ARRAY;
+            ++position;
+            skipSpace();
+            if (position != end && *position == ']') {
+                ++position;
+                return true;
+            }
+            while (true) {
+                value.items.emplace_back();
+                if (!parseValue(value.items.back(), depth + 1)) {
+                    return false;
+                }
+                skipSpace();
+                if (position == end) {
+                    return false;
+                }
+                char next = *position++;
+                if (next == ']') {
+                    return true;
+                }
+                if (next != ',') {
+                    return false;
+                }
+            }
+        }
+
+        bool parseHex(uint32_t& code) {
+            if (end - position < 4) {
+                return false;
+            }
+            code = 0;
+            for (int i = 0; i < 4; ++i) {
+                char c = *position++;
+                code <<= 4;
+                if (c >= '0' && c <= '9') code |= static_cast<uint32_t>(c - '0');
+                else if (c >= 'a' && c <= 'f') code |= static_cast<uint32_t>(c - 'a' + 10);
+                else if (c >= 'A' && c <= 'F') code |= static_cast<uint32_t>(c - 'A' + 10);
+                else return false;
+            }
+            return true;
+        }
+
+        static void appendUtf8(std::string& out, uint32_t code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        bool parseString(std::string& out) {
+            ++position;     // Opening quote
+            while (position != end) {
+                char c = *position++;
+                if (c == '"') {
+                    return true;
+                }
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    return false;
+                }
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+                if (position == end) {
+                    return false;
+                }
+                switch (*position++) {
+                    case '"': out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/': out += '/'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u': {
+                        uint32_t code;
+                        if (!parseHex(code)) {
+                            return false;
+                        }
+                        if (code >= 0xD800 && code < 0xDC00) {
+                            uint32_t low;
+                            if (end - position < 6 || position[0] != '\\' || position[1] != 'u') {
+                                return false;
+                            }
+                            position += 2;
+                            if (!parseHex(low) || low < 0xDC00 || low >= 0xE000) {
+                                return false;
+                            }
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        appendUtf8(out, code);
+                        break;
+                    }
+                    default: return false;
+                }
+            }
+            return false;
+        }
+
+        bool parseNumber(JsonValue& value) {
+            const char* start = position;
+            while (position != end && (std::isdigit(static_cast<unsigned char>(*position)) || *position == '-' ||
+                                       *position == '+' || *position == '.' || *position == 'e' || *position == 'E')) {
+                ++position;
+            }
+            if (position == start) {
+                return false;
+            }
+            value.kind = JsonValue::Kind::NUMBER;
+            value.text.assign(start, position);
+            return true;
+        }
+    };
+
+    // Strings and numbers (forms post both) as text; empty when absent
+    std::string stringField(const JsonValue& object, const char* key) {
+        const JsonValue* value = object.find(key);
+        if (!value || (value->kind != JsonValue::Kind::STRING && value->kind != JsonValue::Kind::NUMBER)) {
+            return std::string();
+        }
+        return value->text;
+    }
+
+    // Dollars, as a JSON number or a numeric string
+    bool moneyField(const JsonValue& object, const char* key, Money& amount) {
+        std::string text = stringField(object, key);
+        if (text.empty()) {
+            return false;
+        }
+        char* parsedEnd = nullptr;
+        double dollars = std::strtod(text.c_str(), &parsedEnd);
+        if (parsedEnd != text.c_str() + text.size()) {
+            return false;
+        }
+        try {
+            amount = Money::fromDouble(dollars);
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+
+    void appendJsonString(std::string& out, const std::string& value) {
+        static const char hex[] = "0123456789abcdef";
+        out += '"';
+        for (char c : value) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out += "\\u00";
+                        out += hex[(c >> 4) & 0xF];
+                        out += hex[c & 0xF];
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    // Dollars with two decimals, as a JSON number
+    void appendMoney(std::string& out, Money amount) {
+        int64_t cents = amount.toCents();
+        uint64_t magnitude = cents < 0 ? (0 - static_cast<uint64_t>(cents)) : static_cast<uint64_t>(cents);
+        if (cents < 0) {
+            out += '-';
+        }
+        out += std::to_string(magnitude / 100);
+        out += '.';
+        out += static_cast<char>('0' + (magnitude % 100) / 10);
+        out += static_cast<char>('0' + magnitude % 10);
+    }
+
+    void appendMillis(std::string& out, std::chrono::system_clock::time_point time) {
+        out += std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+            time.time_since_epoch()).count());
+    }
+
+    void appendAccount(std::string& out, const Account& account, Money balance) {
+        out += "{\"accountNumber\":";
+        appendJsonString(out, account.getAccountNumber());
+        out += ",\"holderName\":";
+        appendJsonString(out, account.getAccountHolderName());
+        out += ",\"balance\":";
+        appendMoney(out, balance);
+        out += ",\"status\":";
+        appendJsonString(out, account.getStatus());
+        out += ",\"createdAt\":";
+        appendMillis(out, account.getCreatedAt());
+        out += ",\"transactionCount\":";
+        out += std::to_string(account.getHistory().totalAppended());
+        out += '}';
+    }
+
+    void appendTransaction(std::string& out, const Transaction& transaction) {
+        out += "{\"id\":";
+        appendJsonString(out, transaction.getTransactionId());
+        out += ",\"type\":\"";
+        out += transactionTypeName(transaction.type);
+        out += "\",\"amount\":";
+        appendMoney(out, transaction.amount);
+        out += ",\"description\":";
+        appendJsonString(out, transaction.getDescription());
+        out += ",\"status\":\"";
+        out += transactionStatusName(transaction.status);
+        out += "\",\"timestamp\":";
+        appendMillis(out, transaction.timestamp);
+        out += ",\"fromAccount\":";
+        appendJsonString(out, transaction.getFromAccount());
+        out += ",\"toAccount\":";
+        appendJsonString(out, transaction.getToAccount());
+        out += '}';
+    }
+
+    std::string errorBody(const std::string& message) {
+        std::string body = "{\"error\":";
+        appendJsonString(body, message);
+        body += '}';
+        return body;
+    }
+
+    // Newest first: O(accounts) scan, meant for dashboards rather than very large banks
+    std::vector<Transaction> newestTransactions(const Account& account, size_t limit) {
+        const TransactionHistory& history = account.getHistory();
+        size_t size = history.size();
+        std::vector<Transaction> page = history.page(size > limit ? size - limit : 0, limit);
+        std::reverse(page.begin(), page.end());
+        return page;
+    }
+
+    const char* statusText(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 204: return "No Content";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 409: return "Conflict";
+            case 413: return "Payload Too Large";
+            case 429: return "Too Many Requests";
+            case 501: return "Not Implemented";
+            case 503: return "Service Unavailable";
+            default: return "Internal Server Error";
+        }
+    }
+
+    const char* contentTypeFor(const std::string& name) {
+        auto endsWith = [&name](const char* suffix) {
+            size_t length = std::strlen(suffix);
+            return name.size() >= length && name.compare(name.size() - length, length, suffix) == 0;
+        };
+        if (endsWith(".html")) return "text/html; charset=utf-8";
+        if (endsWith(".css")) return "text/css; charset=utf-8";
+        if (endsWith(".js")) return "application/javascript; charset=utf-8";
+        if (endsWith(".json")) return "application/json";
+        if (endsWith(".svg")) return "image/svg+xml";
+        if (endsWith(".png")) return "image/png";
+        if (endsWith(".ico")) return "image/x-icon";
+        return "application/octet-stream";
+    }
+
+    // Value of name=N in a query string, or fallback if absent
+    size_t queryNumber(const std::string& query, const char* name, size_t fallback) {
+        size_t length = std::strlen(name);
+        size_t at = 0;
+        while (at < query.size()) {
+            size_t next = query.find('&', at);
+            if (next == std::string::npos) {
+                next = query.size();
+            }
+            if (query.compare(at, length, name) == 0 && at + length < query.size() && query[at + length] == '=') {
+                return std::strtoul(query.c_str() + at + length + 1, nullptr, 10);
+            }
+            at = next + 1;
+        }
+        return fallback;
+    }
+
+    size_t queryLimit(const std::string& query, size_t fallback) {
+        size_t value = queryNumber(query, "limit", fallback);
+        return value > 0 ? std::min<size_t>(value, 10000) : fallback;
+    }
+
+    bool equalsIgnoreCase(const char* data, size_t size, const char* word) {
+        size_t length = std::strlen(word);
+        if (size != length) {
+            return false;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            if (std::tolower(static_cast<unsigned char>(data[i])) != word[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool containsToken(const std::string& value, const char* token) {
+        std::string lower(value);
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lower.find(token) != std::string::npos;
+    }
+
+    void putLittle(std::string& out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    uint64_t getLittle(const char* data, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+        }
+        return value;
+    }
+}
+
+// ============================================================================
+// BANK SERVER IMPLEMENTATION
+// ============================================================================
+
+struct BankServer::HttpRequest {
+    std::string method;
+    std::string path;
+    std::string query;
+    std::string body;
+    bool keepAlive = true;
+};
+
+// Operations of one request, submitted together; the last completion renders the reply
+struct BankServer::OperationBatch {
+    enum class Format : uint8_t { JSON_OBJECT, JSON_ARRAY, BINARY };
+
+    struct Operation {
+        TransactionType type = TransactionType::DEPOSIT;
+        std::string account;
+        std::string target;
+        Money amount;
+        std::string description;
+        std::string error;          // Set: rejected before submission
+    };
+
+    struct Outcome {
+        bool success = false;
+        std::string message;
+        uint64_t transactionId = 0;
+        Money balance;
+        std::chrono::milliseconds retryAfter{0};    // Turned away by admission control
+    };
+
+    uint64_t connection = 0;
+    std::shared_ptr<Reply> reply;
+    Format format = Format::JSON_OBJECT;
+    bool keepAlive = true;
+    uint32_t tag = 0;
+    std::vector<Operation> operations;
+    std::vector<Outcome> outcomes;
+    std::atomic<size_t> remaining{0};
+};
+
+namespace {
+    using Buffer = std::shared_ptr<const std::string>;
+
+    void setHttpReply(std::vector<Buffer>& parts, int status, const char* contentType, Buffer body, bool keepAlive,
+                      const std::string& extraHeaders = std::string()) {
+        std::string head = "HTTP/1.1 " + std::to_string(status) + " " + statusText(status) + "\r\n";
+        head += extraHeaders;
+        if (body) {
+            head += "Content-Type: ";
+            head += contentType;
+            head += "\r\nContent-Length: " + std::to_string(body->size()) + "\r\n";
+        } else {
+            head += "Content-Length: 0\r\n";
+        }
+        head += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+        head += "Access-Control-Allow-Origin: *\r\n\r\n";
+        parts.clear();
+        parts.push_back(std::make_shared<const std::string>(std::move(head)));
+        if (body && !body->empty()) {
+            parts.push_back(std::move(body));
+        }
+    }
+
+    void setJsonReply(std::vector<Buffer>& parts, int status, std::string body, bool keepAlive,
+                      const std::string& extraHeaders = std::string()) {
+        setHttpReply(parts, status, "application/json", std::make_shared<const std::string>(std::move(body)), keepAlive,
+                     extraHeaders);
+    }
+
+    void appendOutcome(std::string& out, const BankServer::BinaryResponse& outcome, std::chrono::milliseconds retryAfter) {
+        out += "{\"success\":";
+        out += outcome.success ? "true" : "false";
+        out += ",\"message\":";
+        appendJsonString(out, outcome.message);
+        out += ",\"transactionId\":";
+        appendJsonString(out, outcome.transactionId != 0 ? "TXN_" + std::to_string(outcome.transactionId) : std::string());
+        out += ",\"newBalance\":";
+        appendMoney(out, outcome.balance);
+        if (retryAfter.count() > 0) {
+            out += ",\"retryAfterMs\":" + std::to_string(retryAfter.count());
+        }
+        out += '}';
+    }
+
+    std::string binaryFrame(uint32_t tag, bool success, Money balance, uint64_t transactionId, const std::string& message) {
+        size_t messageLength = std::min<size_t>(message.size(), 0xFFFF);
+        std::string frame;
+        frame.reserve(BankServer::kBinaryResponseHeader + messageLength);
+        putLittle(frame, BankServer::kBinaryResponseHeader - 4 + messageLength, 4);
+        putLittle(frame, tag, 4);
+        putLittle(frame, success ? 1 : 0, 1);
+        putLittle(frame, 0, 1);
+        putLittle(frame, messageLength, 2);
+        putLittle(frame, static_cast<uint64_t>(balance.toCents()), 8);
+        putLittle(frame, transactionId, 8);
+        frame.append(message, 0, messageLength);
+        return frame;
+    }
+}
+
+// Binary protocol helpers
+
+void BankServer::appendBinaryRequest(std::string& out, BinaryOp op, uint32_t tag, const std::string& account,
+                                     const std::string& target, Money amount) {
+    if (account.size() > 0xFF || target.size() > 0xFF) {
+        throw std::invalid_argument("Account numbers in binary frames are at most 255 bytes");
+    }
+    putLittle(out, kBinaryRequestHeader - 4 + account.size() + target.size(), 4);
+    putLittle(out, tag, 4);
+    putLittle(out, static_cast<uint8_t>(op), 1);
+    putLittle(out, account.size(), 1);
+    putLittle(out, target.size(), 1);
+    putLittle(out, 0, 1);
+    putLittle(out, static_cast<uint64_t>(amount.toCents()), 8);
+    out += account;
+    out += target;
+}
+
+size_t BankServer::parseBinaryResponse(const char* data, size_t size, BinaryResponse& response) {
+    if (size < kBinaryResponseHeader) {
+        return 0;
+    }
+    size_t length = static_cast<size_t>(getLittle(data, 4)) + 4;
+    if (size < length) {
+        return 0;
+    }
+    size_t messageLength = static_cast<size_t>(getLittle(data + 10, 2));
+    response.tag = static_cast<uint32_t>(getLittle(data + 4, 4));
+    response.success = data[8] != 0;
+    response.balance = Money::fromCents(static_cast<int64_t>(getLittle(data + 12, 8)));
+    response.transactionId = getLittle(data + 20, 8);
+    response.message.assign(data + kBinaryResponseHeader, std::min(messageLength, length - kBinaryResponseHeader));
+    return length;
+}
+
+BankServer::BankServer(Bank& bank) : BankServer(bank, Options()) {
+}
+
+BankServer::BankServer(Bank& bank, const Options& options)
+    : bank(bank), options(options), clientBuckets(options.clientRate, options.clientBurst), listenFd(-1), epollFd(-1), wakeFd(-1), boundPort(0),
+      running(false), stopping(false), nextConnectionId(2), pushPass(0), trackedValid(false),
+      inFlight(0), connectionsAccepted(0), openConnections(0), eventSubscribers(0),
+      httpRequests(0), binaryFrames(0), pushEvents(0), bytesWritten(0), rateLimited(0) {
+}
+
+BankServer::~BankServer() {
+    stop();
+}
+
+bool BankServer::isRunning() const {
+    return running.load();
+}
+
+uint16_t BankServer::getPort() const {
+    return boundPort;
+}
+
+BankServer::Statistics BankServer::getStatistics() const {
+    Statistics stats;
+    stats.connectionsAccepted = connectionsAccepted.load(std::memory_order_relaxed);
+    stats.openConnections = openConnections.load(std::memory_order_relaxed);
+    stats.eventSubscribers = eventSubscribers.load(std::memory_order_relaxed);
+    stats.httpRequests = httpRequests.load(std::memory_order_relaxed);
+    stats.binaryFrames = binaryFrames.load(std::memory_order_relaxed);
+    stats.pushEvents = pushEvents.load(std::memory_order_relaxed);
+    stats.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+    stats.rateLimited = rateLimited.load(std::memory_order_relaxed);
+    return stats;
+}
+
+#if defined(__linux__)
+
+namespace {
+    // Rate-limit key of a peer: its address without the port, so a client's connections share a bucket
+    uint64_t clientKey(const sockaddr_storage& peer) {
+        if (peer.ss_family == AF_INET) {
+            const auto& address = reinterpret_cast<const sockaddr_in&>(peer).sin_addr;
+            return TokenBuckets::keyOf(std::string_view(reinterpret_cast<const char*>(&address), sizeof(address)));
+        }
+        if (peer.ss_family == AF_INET6) {
+            const auto& address = reinterpret_cast<const sockaddr_in6&>(peer).sin6_addr;
+            return TokenBuckets::keyOf(std::string_view(reinterpret_cast<const char*>(&address), sizeof(address)));
+        }
+        return 0;
+    }
+}
+
+void BankServer::start() {
+    if (running) {
+        return;
+    }
+
+    auto fail = [this](const std::string& what) {
+        std::string message = "BankServer: " + what + ": " + std::strerror(errno);
+        for (int* fd : {&listenFd, &epollFd, &wakeFd}) {
+            if (*fd >= 0) {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, message);
+    };
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.bindAddress.c_str(), &address.sin_addr) != 1) {
+        errno = EINVAL;
+        fail("invalid bind address " + options.bindAddress);
+    }
+
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        fail("socket");
+    }
+    int enable = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        fail("bind " + options.bindAddress + ":" + std::to_string(options.port));
+    }
+    if (::listen(listenFd, SOMAXCONN) != 0) {
+        fail("listen");
+    }
+    socklen_t addressLength = sizeof(address);
+    ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &addressLength);
+    boundPort = ntohs(address.sin_port);
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        fail("epoll_create1");
+    }
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        fail("eventfd");
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = kListenerKey;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.u64 = kWakeKey;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    stopping = false;
+    running = true;
+    loopThread = std::thread(&BankServer::eventLoop, this);
+}
+
+void BankServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    stopping = true;
+    wake();
+    if (loopThread.joinable()) {
+        loopThread.join();
+    }
+
+    // Pool workers still hold batches and wake the (now idle) loop through wakeFd
+    {
+        std::unique_lock<std::mutex> lock(completionMutex);
+        drained.wait(lock, [this]() { return inFlight == 0; });
+        completions.clear();
+    }
+    for (int* fd : {&listenFd, &epollFd, &wakeFd}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void BankServer::wake() {
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeFd, &one, sizeof(one));
+    (void)written;  // A full counter already means a pending wake-up
+}
+
+// ----------------------------------------------------------------------------
+// Event loop
+// ----------------------------------------------------------------------------
+
+void BankServer::eventLoop() {
+    epoll_event events[64];
+    Clock::time_point nextPush = Clock::now() + options.pushInterval;
+    lastPushWrite = Clock::now();
+
+    while (!stopping) {
+        auto untilPush = std::chrono::duration_cast<std::chrono::milliseconds>(nextPush - Clock::now()).count();
+        int count = ::epoll_wait(epollFd, events, 64, untilPush > 0 ? static_cast<int>(untilPush) : 0);
+        for (int i = 0; i < count; ++i) {
+            uint64_t key = events[i].data.u64;
+            if (key == kListenerKey) {
+                acceptConnections();
+            } else if (key == kWakeKey) {
+                uint64_t ignored;
+                while (::read(wakeFd, &ignored, sizeof(ignored)) > 0) {
+                }
+                drainCompletions();
+            } else {
+                auto found = connections.find(key);
+                if (found == connections.end()) {
+                    continue;   // Closed earlier in this batch of events
+                }
+                Connection& connection = *found->second;
+                if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                    onReadable(connection);
+                } else if (events[i].events & EPOLLOUT) {
+                    onWritable(connection);
+                }
+            }
+        }
+
+        if (Clock::now() >= nextPush) {
+            pushBalances();
+            closeIdleConnections();
+            nextPush = Clock::now() + options.pushInterval;
+        }
+    }
+
+    while (!connections.empty()) {
+        closeConnection(*connections.begin()->second);
+    }
+}
+
+void BankServer::acceptConnections() {
+    while (true) {
+        sockaddr_storage peer{};
+        socklen_t peerLength = sizeof(peer);
+        int fd = ::accept4(listenFd, reinterpret_cast<sockaddr*>(&peer), &peerLength, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;     // EAGAIN, or an error the next readiness event will repeat
+        }
+        if (connections.size() >= options.maxConnections) {
+            ::close(fd);
+            continue;
+        }
+        int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->id = nextConnectionId++;
+        connection->client = clientKey(peer);
+        connection->lastActive = Clock::now();
+        connection->interest = EPOLLIN;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = connection->id;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections.emplace(connection->id, std::move(connection));
+        connectionsAccepted.fetch_add(1, std::memory_order_relaxed);
+        openConnections.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void BankServer::onReadable(Connection& connection) {
+    char chunk[kReadChunk];
+    for (size_t reads = 0; reads < kReadBudget && !readPaused(connection); ++reads) {
+        ssize_t received = ::recv(connection.fd, chunk, sizeof(chunk), 0);
+        if (received > 0) {
+            connection.input.append(chunk, static_cast<size_t>(received));
+            connection.lastActive = Clock::now();
+            if (static_cast<size_t>(received) < sizeof(chunk)) {
+                break;
+            }
+        } else if (received == 0) {
+            connection.peerClosed = true;   // Answer what was sent before the half-close
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            closeConnection(connection);
+            return;
+        }
+    }
+    progress(connection);
+}
+
+void BankServer::onWritable(Connection& connection) {
+    progress(connection);
+}
+
+void BankServer::closeConnection(Connection& connection) {
+    ::epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    ::close(connection.fd);
+    if (connection.mode == Connection::Mode::EVENTS) {
+        eventSubscribers.fetch_sub(1, std::memory_order_relaxed);
+    }
+    openConnections.fetch_sub(1, std::memory_order_relaxed);
+    connections.erase(connection.id);   // Destroys connection
+}
+
+void BankServer::closeIdleConnections() {
+    Clock::time_point now = Clock::now();
+    std::vector<uint64_t> idle;
+    for (const auto& entry : connections) {
+        const Connection& connection = *entry.second;
+        if (connection.mode != Connection::Mode::EVENTS && connection.replies.empty() &&
+            connection.output.empty() && now - connection.lastActive > options.idleTimeout) {
+            idle.push_back(entry.first);
+        }
+    }
+    for (uint64_t id : idle) {
+        closeConnection(*connections[id]);
+    }
+}
+
+bool BankServer::readPaused(const Connection& connection) const {
+    if (connection.closing || connection.peerClosed) {
+        return true;
+    }
+    if (connection.mode == Connection::Mode::EVENTS) {
+        return false;   // Only read to notice the close; input is discarded
+    }
+    return connection.replies.size() >= kMaxPipelinedReplies || connection.outputBytes >= kMaxBufferedOutput;
+}
+
+void BankServer::updateInterest(Connection& connection) {
+    uint32_t wanted = (readPaused(connection) ? 0u : static_cast<uint32_t>(EPOLLIN)) |
+                      (connection.output.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+    if (wanted != connection.interest) {
+        epoll_event event{};
+        event.events = wanted;
+        event.data.u64 = connection.id;
+        ::epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.interest = wanted;
+    }
+}
+
+void BankServer::progress(Connection& connection) {
+    // Parse, move finished replies (in order) to the output, and parse again once the pipeline has room
+    bool moved;
+    do {
+        parseInput(connection);
+        moved = false;
+        while (!connection.replies.empty() && connection.replies.front()->ready) {
+            std::shared_ptr<Reply> reply = std::move(connection.replies.front());
+            connection.replies.pop_front();
+            for (const Buffer& part : reply->parts) {
+                queueOutput(connection, part);
+            }
+            if (reply->close) {
+                connection.closing = true;
+            }
+            if (reply->startsStream) {
+                connection.streaming = true;
+            }
+            moved = true;
+        }
+    } while (moved && !connection.closing && connection.consumed < connection.input.size());
+
+    if (!writeOutput(connection)) {
+        closeConnection(connection);
+        return;
+    }
+    bool finished = connection.replies.empty() && connection.output.empty();
+    if ((connection.closing || connection.peerClosed) && finished) {
+        closeConnection(connection);
+        return;
+    }
+    if (connection.mode == Connection::Mode::EVENTS && connection.outputBytes > kMaxBufferedOutput) {
+        closeConnection(connection);    // A subscriber that stopped reading
+        return;
+    }
+    updateInterest(connection);
+}
+
+void BankServer::queueOutput(Connection& connection, const Buffer& data) {
+    if (data && !data->empty()) {
+        connection.output.push_back(Segment{data, 0});
+        connection.outputBytes += data->size();
+    }
+}
+
+bool BankServer::writeOutput(Connection& connection) {
+    while (!connection.output.empty()) {
+        iovec vectors[kWriteSegments];
+        size_t count = 0;
+        size_t offered = 0;
+        for (auto segment = connection.output.begin();
+             segment != connection.output.end() && count < kWriteSegments; ++segment, ++count) {
+            vectors[count].iov_base = const_cast<char*>(segment->data->data() + segment->offset);
+            vectors[count].iov_len = segment->data->size() - segment->offset;
+            offered += vectors[count].iov_len;
+        }
+        msghdr message{};
+        message.msg_iov = vectors;
+        message.msg_iovlen = count;
+        ssize_t sent = ::sendmsg(connection.fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        size_t remaining = static_cast<size_t>(sent);
+        bytesWritten.fetch_add(remaining, std::memory_order_relaxed);
+        connection.outputBytes -= remaining;
+        while (remaining > 0) {
+            Segment& front = connection.output.front();
+            size_t left = front.data->size() - front.offset;
+            if (remaining < left) {
+                front.offset += remaining;
+                break;
+            }
+            remaining -= left;
+            connection.output.pop_front();
+        }
+        if (static_cast<size_t>(sent) < offered) {
+            break;  // Socket buffer full
+        }
+    }
+    return true;
+}
+
+void BankServer::drainCompletions() {
+    std::vector<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        ready.swap(completions);
+    }
+    std::unordered_set<uint64_t> touched;
+    for (const Completion& completion : ready) {
+        completion.reply->ready = true;
+        auto found = connections.find(completion.connection);
+        if (found != connections.end()) {   // Gone: the client left before its reply
+            --found->second->pendingOperations;
+            touched.insert(completion.connection);
+        }
+    }
+    for (uint64_t id : touched) {
+        auto found = connections.find(id);
+        if (found != connections.end()) {
+            progress(*found->second);
+        }
+    }
+}
+
+#else
+
+void BankServer::start() {
+    throw BankException(BankException::ErrorType::SYSTEM_ERROR,
+                        "BankServer: the network front-end needs Linux (epoll)");
+}
+
+void BankServer::stop() {
+}
+
+void BankServer::wake() {
+}
+
+void BankServer::eventLoop() {
+}
+
+void BankServer::acceptConnections() {
+}
+
+void BankServer::onReadable(Connection&) {
+}
+
+void BankServer::onWritable(Connection&) {
+}
+
+void BankServer::closeConnection(Connection&) {
+}
+
+void BankServer::closeIdleConnections() {
+}
+
+bool BankServer::readPaused(const Connection&) const {
+    return true;
+}
+
+void BankServer::updateInterest(Connection&) {
+}
+
+void BankServer::progress(Connection&) {
+}
+
+void BankServer::queueOutput(Connection&, const Buffer&) {
+}
+
+bool BankServer::writeOutput(Connection&) {
+    return false;
+}
+
+void BankServer::drainCompletions() {
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Requests
+// ----------------------------------------------------------------------------
+
+void BankServer::parseInput(Connection& connection) {
+    while (!connection.closing && connection.consumed < connection.input.size() &&
+           connection.replies.size() < kMaxPipelinedReplies) {
+        const char* data = connection.input.data() + connection.consumed;
+        size_t size = connection.input.size() - connection.consumed;
+
+        if (connection.mode == Connection::Mode::UNKNOWN) {
+            size_t prefix = std::min(size, sizeof(kBinaryMagic));
+            if (std::memcmp(data, kBinaryMagic, prefix) != 0) {
+                connection.mode = Connection::Mode::HTTP;
+            } else if (prefix == sizeof(kBinaryMagic)) {
+                connection.mode = Connection::Mode::BINARY;
+                connection.consumed += sizeof(kBinaryMagic);
+                continue;
+            } else {
+                break;  // Part of the magic so far
+            }
+        }
+
+        size_t used = 0;
+        switch (connection.mode) {
+            case Connection::Mode::HTTP: used = parseHttp(connection, data, size); break;
+            case Connection::Mode::BINARY: used = parseBinary(connection, data, size); break;
+            default: used = size; break;     // Event streams ignore input
+        }
+        if (used == 0) {
+            break;
+        }
+        connection.consumed += used;
+    }
+
+    if (connection.consumed == connection.input.size()) {
+        connection.input.clear();
+        connection.consumed = 0;
+    } else if (connection.consumed > kReadChunk && connection.consumed * 2 > connection.input.size()) {
+        connection.input.erase(0, connection.consumed);
+        connection.consumed = 0;
+    }
+}
+
+size_t BankServer::parseHttp(Connection& connection, const char* data, size_t size) {
+    auto reject = [&](int status, const std::string& message) {
+        auto reply = std::make_shared<Reply>();
+        setJsonReply(reply->parts, status, errorBody(message), false);
+        reply->close = true;
+        reply->ready = true;
+        connection.replies.push_back(std::move(reply));
+        connection.closing = true;
+        return size;
+    };
+
+    const char* headerEnd = nullptr;
+    for (size_t i = 3; i < size; ++i) {
+        if (data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n' && data[i - 3] == '\r') {
+            headerEnd = data + i + 1;
+            break;
+        }
+    }
+    if (!headerEnd) {
+        return size > options.maxRequestBytes ? reject(413, "Request headers too large") : 0;
+    }
+
+    // Request line
+    HttpRequest request;
+    const char* lineEnd = static_cast<const char*>(std::memchr(data, '\r', static_cast<size_t>(headerEnd - data)));
+    std::string line(data, lineEnd);
+    size_t firstSpace = line.find(' ');
+    size_t secondSpace = firstSpace == std::string::npos ? std::string::npos : line.find(' ', firstSpace + 1);
+    if (secondSpace == std::string::npos || line.compare(secondSpace + 1, 7, "HTTP/1.") != 0) {
+        return reject(400, "Malformed request line");
+    }
+    request.method = line.substr(0, firstSpace);
+    std::string target = line.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+    size_t question = target.find('?');
+    request.path = target.substr(0, question);
+    if (question != std::string::npos) {
+        request.query = target.substr(question + 1);
+    }
+    bool http10 = line.compare(secondSpace + 1, 8, "HTTP/1.0") == 0;
+    request.keepAlive = !http10;
+
+    // Headers
+    size_t contentLength = 0;
+    const char* cursor = lineEnd + 2;
+    while (cursor < headerEnd - 2) {
+        const char* end = static_cast<const char*>(std::memchr(cursor, '\r', static_cast<size_t>(headerEnd - cursor)));
+        const char* colon = static_cast<const char*>(std::memchr(cursor, ':', static_cast<size_t>(end - cursor)));
+        if (colon) {
+            const char* value = colon + 1;
+            while (value < end && (*value == ' ' || *value == '\t')) {
+                ++value;
+            }
+            size_t nameLength = static_cast<size_t>(colon - cursor);
+            if (equalsIgnoreCase(cursor, nameLength, "content-length")) {
+                contentLength = std::strtoul(std::string(value, end).c_str(), nullptr, 10);
+            } else if (equalsIgnoreCase(cursor, nameLength, "transfer-encoding")) {
+                return reject(501, "Chunked request bodies are not supported");
+            } else if (equalsIgnoreCase(cursor, nameLength, "connection")) {
+                std::string tokens(value, end);
+                if (containsToken(tokens, "close")) {
+                    request.keepAlive = false;
+                } else if (containsToken(tokens, "keep-alive")) {
+                    request.keepAlive = true;
+                }
+            }
+        }
+        cursor = end + 2;
+    }
+
+    size_t headerLength = static_cast<size_t>(headerEnd - data);
+    if (contentLength > options.maxRequestBytes || headerLength + contentLength > options.maxRequestBytes) {
+        return reject(413, "Request body too large");
+    }
+    if (size < headerLength + contentLength) {
+        return 0;
+    }
+    request.body.assign(headerEnd, contentLength);
+
+    // Anything but another operation sees the effects of the operations before it
+    bool operation = request.method == "POST" && (request.path == "/api/deposit" || request.path == "/api/withdraw" ||
+                                                  request.path == "/api/transfer" || request.path == "/api/batch");
+    if (!operation && connection.pendingOperations > 0) {
+        return 0;
+    }
+
+    httpRequests.fetch_add(1, std::memory_order_relaxed);
+    auto reply = std::make_shared<Reply>();
+    connection.replies.push_back(reply);
+    if (!request.keepAlive) {
+        connection.closing = true;  // Nothing after this request is read
+    }
+    handleHttp(connection, request, reply);
+    return headerLength + contentLength;
+}
+
+size_t BankServer::parseBinary(Connection& connection, const char* data, size_t size) {
+    if (size < 4) {
+        return 0;
+    }
+    size_t length = static_cast<size_t>(getLittle(data, 4)) + 4;
+    if (length < kBinaryRequestHeader || length > kBinaryRequestHeader + 2 * 0xFF) {
+        connection.closing = true;  // Framing is lost; nothing sensible can be answered
+        return size;
+    }
+    if (size < length) {
+        return 0;
+    }
+
+    uint32_t tag = static_cast<uint32_t>(getLittle(data + 4, 4));
+    uint8_t op = static_cast<uint8_t>(data[8]);
+    if (op == static_cast<uint8_t>(BinaryOp::BALANCE) && connection.pendingOperations > 0) {
+        return 0;   // Reads wait for the operations before them, as in HTTP
+    }
+    binaryFrames.fetch_add(1, std::memory_order_relaxed);
+    size_t accountLength = static_cast<unsigned char>(data[9]);
+    size_t targetLength = static_cast<unsigned char>(data[10]);
+    Money amount = Money::fromCents(static_cast<int64_t>(getLittle(data + 12, 8)));
+    auto reply = std::make_shared<Reply>();
+    connection.replies.push_back(reply);
+
+    if (kBinaryRequestHeader + accountLength + targetLength != length) {
+        reply->parts.push_back(std::make_shared<const std::string>(
+            binaryFrame(tag, false, Money(), 0, "Malformed frame")));
+        reply->ready = true;
+        return length;
+    }
+    std::string account(data + kBinaryRequestHeader, accountLength);
+    std::string target(data + kBinaryRequestHeader + accountLength, targetLength);
+
+    if (op == static_cast<uint8_t>(BinaryOp::BALANCE)) {
+        Money balance = bank.getAccountBalance(account);
+        bool found = !balance.isNegative();
+        reply->parts.push_back(std::make_shared<const std::string>(
+            binaryFrame(tag, found, found ? balance : Money(), 0, found ? "" : "Account not found")));
+        reply->ready = true;
+        return length;
+    }
+
+    auto batch = std::make_shared<OperationBatch>();
+    batch->connection = connection.id;
+    batch->reply = reply;
+    batch->format = OperationBatch::Format::BINARY;
+    batch->tag = tag;
+    OperationBatch::Operation operation;
+    operation.account = std::move(account);
+    operation.target = std::move(target);
+    operation.amount = amount;
+    switch (static_cast<BinaryOp>(op)) {
+        case BinaryOp::DEPOSIT: operation.type = TransactionType::DEPOSIT; break;
+        case BinaryOp::WITHDRAW: operation.type = TransactionType::WITHDRAW; break;
+        case BinaryOp::TRANSFER: operation.type = TransactionType::TRANSFER; break;
+        default: operation.error = "Unknown operation"; break;
+    }
+    batch->operations.push_back(std::move(operation));
+    submitBatch(connection, batch);
+    return length;
+}
+
+void BankServer::handleHttp(Connection& connection, const HttpRequest& request, const std::shared_ptr<Reply>& reply) {
+    try {
+        if (request.method == "OPTIONS") {
+            // CORS preflight, for the UI opened from a file or another origin
+            std::string head = "HTTP/1.1 204 No Content\r\n"
+                               "Access-Control-Allow-Origin: *\r\n"
+                               "Access-Control-Allow-Methods: GET, POST, DELETE, OPTIONS\r\n"
+                               "Access-Control-Allow-Headers: Content-Type\r\n"
+                               "Access-Control-Max-Age: 600\r\n";
+            head += request.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+            reply->parts.push_back(std::make_shared<const std::string>(std::move(head)));
+            reply->close = !request.keepAlive;
+            reply->ready = true;
+        } else if (request.path.compare(0, 5, "/api/") == 0) {
+            handleApi(connection, request, reply);
+        } else if (request.method == "GET") {
+            handleStatic(request, *reply);
+        } else {
+            setJsonReply(reply->parts, 405, errorBody("Method not allowed"), request.keepAlive);
+            reply->close = !request.keepAlive;
+            reply->ready = true;
+        }
+    } catch (const BankException& e) {
+        setJsonReply(reply->parts, 400, errorBody(e.getErrorMessage()), request.keepAlive);
+        reply->close = !request.keepAlive;
+        reply->ready = true;
+    } catch (const std::exception& e) {
+        setJsonReply(reply->parts, 500, errorBody(e.what()), request.keepAlive);
+        reply->close = !request.keepAlive;
+        reply->ready = true;
+    }
+}
+
+void BankServer::handleApi(Connection& connection, const HttpRequest& request, const std::shared_ptr<Reply>& reply) {
+    const std::string& method = request.method;
+    std::string route = request.path.substr(5);
+    auto answer = [&](int status, std::string body) {
+        setJsonReply(reply->parts, status, std::move(body), request.keepAlive);
+        reply->close = !request.keepAlive;
+        reply->ready = true;
+    };
+    auto parseBody = [&](JsonValue& body) {
+        JsonParser parser(request.body.data(), request.body.data() + request.body.size());
+        if (request.body.empty() || !parser.parseDocument(body)) {
+            answer(400, errorBody("Request body must be JSON"));
+            return false;
+        }
+        return true;
+    };
+
+    // Event stream
+    if (route == "events" && method == "GET") {
+        reply->parts.push_back(std::make_shared<const std::string>(
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/event-stream\r\n"
+            "Cache-Control: no-cache\r\n"
+            "Connection: keep-alive\r\n"
+            "Access-Control-Allow-Origin: *\r\n\r\n"
+            "retry: 2000\n\n"));
+        reply->startsStream = true;
+        reply->ready = true;
+        connection.mode = Connection::Mode::EVENTS;
+        connection.needsSnapshot = true;
+        connection.closing = false;
+        eventSubscribers.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (route == "status" && method == "GET") {
+        answer(200, bank.getPerformanceSnapshot());
+        return;
+    }
+
+    // Pipelined operations
+    if (method == "POST" && (route == "deposit" || route == "withdraw" || route == "transfer" || route == "batch")) {
+        JsonValue body;
+        if (!parseBody(body)) {
+            return;
+        }
+        auto batch = std::make_shared<OperationBatch>();
+        batch->connection = connection.id;
+        batch->reply = reply;
+        batch->keepAlive = request.keepAlive;
+
+        std::vector<std::pair<std::string, const JsonValue*>> requested;
+        if (route == "batch") {
+            const JsonValue* list = body.kind == JsonValue::Kind::ARRAY ? &body : body.find("operations");
+            if (!list || list->kind != JsonValue::Kind::ARRAY) {
+                answer(400, errorBody("Expected an array of operations"));
+                return;
+            }
+            if (list->items.size() > options.maxBatchOperations) {
+                answer(413, errorBody("At most " + std::to_string(options.maxBatchOperations) +
+                                      " operations per batch"));
+                return;
+            }
+            batch->format = OperationBatch::Format::JSON_ARRAY;
+            for (const JsonValue& item : list->items) {
+                requested.emplace_back(stringField(item, "type"), &item);
+            }
+        } else {
+            requested.emplace_back(route, &body);
+        }
+
+        for (const auto& entry : requested) {
+            const JsonValue& fields = *entry.second;
+            OperationBatch::Operation operation;
+            if (entry.first == "deposit") {
+                operation.type = TransactionType::DEPOSIT;
+                operation.account = stringField(fields, "accountNumber");
+            } else if (entry.first == "withdraw") {
+                operation.type = TransactionType::WITHDRAW;
+                operation.account = stringField(fields, "accountNumber");
+            } else if (entry.first == "transfer") {
+                operation.type = TransactionType::TRANSFER;
+                operation.account = stringField(fields, "fromAccount");
+                operation.target = stringField(fields, "toAccount");
+            } else {
+                operation.error = "Unknown operation type '" + entry.first + "'";
+            }
+            operation.description = stringField(fields, "description");
+            if (operation.error.empty() && !moneyField(fields, "amount", operation.amount)) {
+                operation.error = "Invalid amount";
+            }
+            batch->operations.push_back(std::move(operation));
+        }
+        submitBatch(connection, batch);
+        return;
+    }
+
+    // Accounts
+    if (route == "accounts") {
+        if (method == "GET") {
+            size_t offset = queryNumber(request.query, "offset", 0);
+            size_t limit = queryLimit(request.query, kAccountPage);
+            submitBackground(connection, reply, request.keepAlive, [this, offset, limit]() {
+                Bank::AccountsView view = bank.viewAccounts();
+                const auto& entries = view.entries();
+                std::string body = "[";
+                for (size_t i = offset; i < entries.size() && i - offset < limit; ++i) {
+                    if (body.size() > 1) {
+                        body += ',';
+                    }
+                    appendAccount(body, *entries[i].account, entries[i].balance);
+                }
+                body += ']';
+                return BackgroundReply{200, std::move(body)};
+            });
+        } else if (method == "POST") {
+            JsonValue body;
+            if (!parseBody(body)) {
+                return;
+            }
+            Money initialBalance;
+            if (body.find("initialBalance") && !moneyField(body, "initialBalance", initialBalance)) {
+                answer(400, errorBody("Invalid initial balance"));
+                return;
+            }
+            std::string holderName = stringField(body, "holderName");
+            submitBackground(connection, reply, request.keepAlive, [this, holderName, initialBalance]() {
+                std::string number = bank.createAccount(holderName, initialBalance);
+                std::string created;
+                if (auto account = bank.getAccount(number)) {
+                    appendAccount(created, *account, account->getBalance());
+                }
+                return BackgroundReply{201, std::move(created)};
+            });
+        } else {
+            answer(405, errorBody("Method not allowed"));
+        }
+        return;
+    }
+
+    if (route.compare(0, 9, "accounts/") == 0) {
+        std::string number = route.substr(9);
+        bool transactions = false;
+        size_t slash = number.find('/');
+        if (slash != std::string::npos) {
+            transactions = number.compare(slash, std::string::npos, "/transactions") == 0;
+            if (!transactions) {
+                answer(404, errorBody("Unknown endpoint"));
+                return;
+            }
+            number.erase(slash);
+        }
+
+        if (method == "DELETE" && !transactions) {
+            submitBackground(connection, reply, request.keepAlive, [this, number]() {
+                if (bank.closeAccount(number)) {
+                    return BackgroundReply{200, "{\"closed\":true}"};
+                } else if (bank.getAccount(number)) {
+                    return BackgroundReply{409, errorBody("Only an account with a zero balance can be closed")};
+                }
+                return BackgroundReply{404, errorBody("Account not found")};
+            });
+            return;
+        }
+        if (method != "GET") {
+            answer(405, errorBody("Method not allowed"));
+            return;
+        }
+        std::shared_ptr<Account> account = bank.getAccount(number);
+        if (!account) {
+            answer(404, errorBody("Account not found"));
+            return;
+        }
+        std::string body;
+        if (transactions) {
+            body = "[";
+            for (const Transaction& transaction : newestTransactions(*account, queryLimit(request.query, 50))) {
+                if (body.size() > 1) {
+                    body += ',';
+                }
+                appendTransaction(body, transaction);
+            }
+            body += ']';
+        } else {
+            appendAccount(body, *account, account->getBalance());
+        }
+        answer(200, std::move(body));
+        return;
+    }
+
+    if (route == "transactions" && method == "GET") {
+        size_t limit = std::min(queryLimit(request.query, 20), kTransactionPage);
+        size_t offset = queryNumber(request.query, "offset", 0);
+        size_t accountCount = std::min(queryNumber(request.query, "accounts", kAccountPage), kAccountPage);
+        submitBackground(connection, reply, request.keepAlive, [this, limit, offset, accountCount]() {
+            std::vector<Transaction> newest;
+            Bank::AccountsView view = bank.viewAccounts();
+            const auto& entries = view.entries();
+            for (size_t i = offset; i < entries.size() && i - offset < accountCount; ++i) {
+                std::vector<Transaction> page = newestTransactions(*entries[i].account, limit);
+                newest.insert(newest.end(), page.begin(), page.end());
+            }
+            // A transfer is recorded on both of its accounts
+            std::sort(newest.begin(), newest.end(), [](const Transaction& a, const Transaction& b) {
+                if (a.timestamp != b.timestamp) return a.timestamp > b.timestamp;
+                if (a.id != b.id) return a.id > b.id;
+                if (a.fromAccount != b.fromAccount) return a.fromAccount < b.fromAccount;
+                return a.toAccount < b.toAccount;
+            });
+            newest.erase(std::unique(newest.begin(), newest.end(), [](const Transaction& a, const Transaction& b) {
+                return a.id == b.id && a.type == b.type && a.fromAccount == b.fromAccount && a.toAccount == b.toAccount;
+            }), newest.end());
+            std::string body = "[";
+            for (size_t i = 0; i < newest.size() && i < limit; ++i) {
+                if (i > 0) {
+                    body += ',';
+                }
+                appendTransaction(body, newest[i]);
+            }
+            body += ']';
+            return BackgroundReply{200, std::move(body)};
+        });
+        return;
+    }
+
+    if (route == "sample-data" && method == "POST") {
+        JsonValue body;
+        size_t count = 5;
+        if (!request.body.empty()) {
+            if (!parseBody(body)) {
+                return;
+            }
+            std::string text = stringField(body, "count");
+            if (!text.empty()) {
+                count = std::min<size_t>(std::strtoul(text.c_str(), nullptr, 10), 100000);
+            }
+        }
+        submitBackground(connection, reply, request.keepAlive, [this, count]() {
+            size_t before = bank.getTotalAccounts();
+            bank.generateSampleData(count);
+            return BackgroundReply{200, "{\"created\":" + std::to_string(bank.getTotalAccounts() - before) + "}"};
+        });
+        return;
+    }
+
+    if (route == "clear" && method == "POST") {
+        submitBackground(connection, reply, request.keepAlive, [this]() {
+            bank.clearAllData();
+            return BackgroundReply{200, "{\"cleared\":true}"};
+        });
+        return;
+    }
+
+    answer(404, errorBody("Unknown endpoint"));
+}
+
+void BankServer::handleStatic(const HttpRequest& request, Reply& reply) {
+    std::string name = request.path == "/" ? "index.html" : request.path.substr(1);
+    bool valid = !options.staticRoot.empty() && !name.empty() && name[0] != '.' &&
+        std::all_of(name.begin(), name.end(), [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '_' || c == '-';
+        });
+
+    auto cached = valid ? staticFiles.find(name) : staticFiles.end();
+    if (valid && cached == staticFiles.end()) {
+        std::ifstream file(options.staticRoot + "/" + name, std::ios::binary);
+        if (file) {
+            std::ostringstream contents;
+            contents << file.rdbuf();
+            cached = staticFiles.emplace(name, std::make_pair(
+                std::make_shared<const std::string>(contents.str()), contentTypeFor(name))).first;
+        }
+    }
+
+    if (cached == staticFiles.end()) {
+        setJsonReply(reply.parts, 404, errorBody("Not found"), request.keepAlive);
+    } else {
+        setHttpReply(reply.parts, 200, cached->second.second, cached->second.first, request.keepAlive);
+    }
+    reply.close = !request.keepAlive;
+    reply.ready = true;
+}
+
+// ----------------------------------------------------------------------------
+// Pipeline hand-off
+// ----------------------------------------------------------------------------
+
+void BankServer::submitBatch(Connection& connection, const std::shared_ptr<OperationBatch>& batch) {
+    ++connection.pendingOperations;
+    size_t count = batch->operations.size();
+    batch->outcomes.resize(count);
+    batch->remaining.store(count + 1, std::memory_order_relaxed);   // +1 held until every operation is submitted
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        ++inFlight;
+    }
+
+    // Runs once per operation, on a pool worker (or here, for a rejected one); the last renders the reply
+    auto finishOne = [this, batch]() {
+        if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        std::vector<Buffer>& parts = batch->reply->parts;
+        if (batch->format == OperationBatch::Format::BINARY) {
+            const OperationBatch::Outcome& outcome = batch->outcomes.front();
+            parts.push_back(std::make_shared<const std::string>(binaryFrame(
+                batch->tag, outcome.success, outcome.balance, outcome.transactionId, outcome.message)));
+        } else {
+            std::string body;
+            bool array = batch->format == OperationBatch::Format::JSON_ARRAY;
+            if (array) {
+                body += '[';
+            }
+            for (size_t i = 0; i < batch->outcomes.size(); ++i) {
+                const OperationBatch::Outcome& outcome = batch->outcomes[i];
+                BinaryResponse rendered;
+                rendered.success = outcome.success;
+                rendered.message = outcome.message;
+                rendered.transactionId = outcome.transactionId;
+                rendered.balance = outcome.balance;
+                if (i > 0) {
+                    body += ',';
+                }
+                appendOutcome(body, rendered, outcome.retryAfter);
+            }
+            if (array) {
+                body += ']';
+            }
+            // A single operation that failed is still a well-formed request: 200 with success false,
+            // unless it was turned away and should simply be retried later
+            std::chrono::milliseconds retryAfter = array ? std::chrono::milliseconds(0) 
+                                                         : batch->outcomes.front().retryAfter;
+            if (retryAfter.count() > 0) {
+                setJsonReply(parts, 429, std::move(body), batch->keepAlive,
+                             "Retry-After: " + std::to_string((retryAfter.count() + 999) / 1000) + "\r\n");
+            } else {
+                setJsonReply(parts, 200, std::move(body), batch->keepAlive);
+            }
+            batch->reply->close = !batch->keepAlive;
+        }
+        complete(batch->connection, batch->reply);
+    };
+
+    for (size_t i = 0; i < count; ++i) {
+        OperationBatch::Operation& operation = batch->operations[i];
+        if (!operation.error.empty()) {
+            batch->outcomes[i].message = operation.error;
+            finishOne();
+            continue;
+        }
+        if (clientBuckets.isEnabled()) {
+            std::chrono::microseconds wait = clientBuckets.tryTake(connection.client);
+            if (wait.count() > 0) {
+                OperationBatch::Outcome& outcome = batch->outcomes[i];
+                outcome.retryAfter = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    wait + std::chrono::microseconds(999));
+                outcome.message = "Client rate limit exceeded, retry in " + 
+                                  std::to_string(outcome.retryAfter.count()) + " ms";
+                rateLimited.fetch_add(1, std::memory_order_relaxed);
+                finishOne();
+                continue;
+            }
+        }
+        auto done = [batch, i, finishOne](const Bank::TransactionResult& result) {
+            OperationBatch::Outcome& outcome = batch->outcomes[i];
+            outcome.success = result.success;
+            outcome.message = result.message;
+            outcome.transactionId = result.transactionId;
+            outcome.balance = result.newBalance;
+            outcome.retryAfter = result.retryAfter;
+            finishOne();
+        };
+        try {
+            switch (operation.type) {
+                case TransactionType::DEPOSIT:
+                    bank.submitDeposit(operation.account, operation.amount, operation.description, done);
+                    break;
+                case TransactionType::WITHDRAW:
+                    bank.submitWithdraw(operation.account, operation.amount, operation.description, done);
+                    break;
+                default:
+                    bank.submitTransfer(operation.account, operation.target, operation.amount,
+                                        operation.description, done);
+                    break;
+            }
+        } catch (const std::exception& e) {
+            batch->outcomes[i].message = e.what();
+            finishOne();
+        }
+    }
+    finishOne();
+}
+
+// Requests that wait for the journal or walk every account run on a pool worker, like pipeline
+// batches, and come back through the completion queue; the loop thread never waits for them
+void BankServer::submitBackground(Connection& connection, const std::shared_ptr<Reply>& reply, bool keepAlive,
+                                  std::function<BackgroundReply()> work) {
+    ++connection.pendingOperations;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        ++inFlight;
+    }
+    uint64_t id = connection.id;
+    bool submitted = bank.submitBackground([this, id, reply, keepAlive, work = std::move(work)]() {
+        try {
+            BackgroundReply answer = work();
+            setJsonReply(reply->parts, answer.status, std::move(answer.body), keepAlive);
+        } catch (const BankException& e) {
+            setJsonReply(reply->parts, 400, errorBody(e.getErrorMessage()), keepAlive);
+        } catch (const std::exception& e) {
+            setJsonReply(reply->parts, 500, errorBody(e.what()), keepAlive);
+        }
+        reply->close = !keepAlive;
+        complete(id, reply);
+    });
+    if (!submitted) {
+        setJsonReply(reply->parts, 503, errorBody("Banking system is not running"), keepAlive);
+        reply->close = !keepAlive;
+        complete(id, reply);
+    }
+}
+
+void BankServer::complete(uint64_t connection, const std::shared_ptr<Reply>& reply) {
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        completions.push_back(Completion{connection, reply});
+        --inFlight;
+    }
+    drained.notify_all();
+    wake();
+}
+
+// ----------------------------------------------------------------------------
+// Balance push
+// ----------------------------------------------------------------------------
+
+std::string BankServer::renderStats(Money totalBalance) const {
+    Bank::TransactionStatistics stats = bank.getTransactionStatistics();
+    std::string out = "{\"accounts\":" + std::to_string(bank.getTotalAccounts()) +
+                      ",\"transactions\":" + std::to_string(stats.total) +
+                      ",\"successful\":" + std::to_string(stats.successful) +
+                      ",\"failed\":" + std::to_string(stats.failed) +
+                      ",\"totalBalance\":";
+    appendMoney(out, totalBalance);
+    out += '}';
+    return out;
+}
+
+void BankServer::pushBalances() {
+    std::vector<uint64_t> subscribers;
+    bool snapshotWanted = false;
+    for (const auto& entry : connections) {
+        if (entry.second->streaming) {
+            subscribers.push_back(entry.first);
+            snapshotWanted |= entry.second->needsSnapshot;
+        }
+    }
+    if (subscribers.empty()) {
+        // Nobody to diff for: start over from a full snapshot when someone subscribes
+        tracked.clear();
+        trackedValid = false;
+        return;
+    }
+
+    Bank::AccountsView view = bank.viewAccounts();
+    uint64_t pass = ++pushPass;
+    std::string opened, changed, closed, snapshot;
+    for (const auto& entry : view.entries()) {
+        const Account& account = *entry.account;
+        uint32_t index = account.getAccountIndex();
+        if (index >= tracked.size()) {
+            tracked.resize(static_cast<size_t>(index) + 1);
+        }
+        Tracked& last = tracked[index];
+        if (trackedValid) {
+            if (last.seenPass == 0) {
+                opened += opened.empty() ? "" : ",";
+                appendAccount(opened, account, entry.balance);
+            } else if (last.balance != entry.balance.toCents()) {
+                changed += changed.empty() ? "{\"accountNumber\":" : ",{\"accountNumber\":";
+                appendJsonString(changed, account.getAccountNumber());
+                changed += ",\"balance\":";
+                appendMoney(changed, entry.balance);
+                changed += '}';
+            }
+        }
+        if (snapshotWanted) {
+            snapshot += snapshot.empty() ? "" : ",";
+            appendAccount(snapshot, account, entry.balance);
+        }
+        last.balance = entry.balance.toCents();
+        last.seenPass = pass;
+    }
+    for (uint32_t index = 0; index < tracked.size(); ++index) {
+        Tracked& last = tracked[index];
+        if (last.seenPass != 0 && last.seenPass != pass) {
+            if (trackedValid) {
+                closed += closed.empty() ? "" : ",";
+                appendJsonString(closed, StringTable::accountNumbers().lookup(index));
+            }
+            last.seenPass = 0;
+        }
+    }
+    trackedValid = true;
+
+    std::string stats = renderStats(view.totalBalance());
+    Buffer deltas;
+    Clock::time_point now = Clock::now();
+    if (!opened.empty() || !changed.empty() || !closed.empty() || stats != lastStats) {
+        std::string event = "event: balances\ndata: {\"sequence\":" + std::to_string(pass) +
+                            ",\"stats\":" + stats + ",\"opened\":[" + opened + "],\"changed\":[" + changed +
+                            "],\"closed\":[" + closed + "]}\n\n";
+        deltas = std::make_shared<const std::string>(std::move(event));
+        lastPushWrite = now;
+    } else if (now - lastPushWrite >= kHeartbeatInterval) {
+        deltas = std::make_shared<const std::string>(": heartbeat\n\n");
+        lastPushWrite = now;
+    }
+    lastStats = std::move(stats);
+
+    Buffer snapshotEvent;
+    if (snapshotWanted) {
+        snapshotEvent = std::make_shared<const std::string>(
+            "event: snapshot\ndata: {\"sequence\":" + std::to_string(pass) + ",\"stats\":" + lastStats +
+            ",\"accounts\":[" + snapshot + "]}\n\n");
+    }
+
+    // One rendering per pass, shared by every subscriber
+    for (uint64_t id : subscribers) {
+        auto found = connections.find(id);
+        if (found == connections.end()) {
+            continue;
+        }
+        Connection& connection = *found->second;
+        if (connection.needsSnapshot) {
+            queueOutput(connection, snapshotEvent);
+            connection.needsSnapshot = false;
+        } else if (deltas) {
+            queueOutput(connection, deltas);
+        } else {
+            continue;
+        }
+        pushEvents.fetch_add(1, std::memory_order_relaxed);
+        progress(connection);
+    }
+}
@@ -1,29 +1,19 @@
 #include "../include/bank_utils.h"
+#include "../include/account_number_allocator.h"
 #include <random>
 #include <algorithm>
 #include <cctype>
-#include <regex>
 
 namespace BankUtils {
 
 std::string generateAccountNumber() {
-    static std::atomic<unsigned long long> counter(0);
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(1000, 9999);
-    
-    // Generate format: MTBS-XXXX-XXXX
-    std::ostringstream oss;
-    oss << "MTBS-" << std::setw(4) << std::setfill('0') << dis(gen) 
-        << "-" << std::setw(4) << std::setfill('0') << dis(gen);
-    
-    return oss.str();
+    // Format: MTBS-XXXXXXX-C (see AccountNumberAllocator); unique within the process
+    static AccountNumberAllocator allocator;
+    return allocator.allocate();
 }
 
-std::string formatCurrency(double amount) {
-    std::ostringstream oss;
-    oss << "$" << std::fixed << std::setprecision(2) << amount;
-    return oss.str();
+std::string formatCurrency(Money amount) {
+    return "$" + amount.toString();
 }
 
 std::string formatTimestamp(const std::chrono::system_clock::time_point& timestamp) {
@@ -49,16 +39,6 @@ std::string generateRandomString(size_t length) {
     return result;
 }
 
-bool isValidEmail(const std::string& email) {
-    if (email.empty() || email.length() > 254) {
-        return false;
-    }
-    
-    // Basic email validation regex
-    std::regex emailPattern(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
-    return std::regex_match(email, emailPattern);
-}
-
 std::string sanitizeInput(const std::string& input) {
     if (input.empty()) {
         return input;
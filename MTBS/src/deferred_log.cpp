@@ -0,0 +1,213 @@
+#include "../include/deferred_log.h"
+#include "../include/async_file_writer.h"
+#include "../include/thread_manager.h"
+#include <algorithm>
+
+namespace {
+    std::atomic<uint64_t> nextLogId(1);
+}
+
+// ============================================================================
+// DEFERRED LOG IMPLEMENTATION
+// ============================================================================
+
+DeferredLog::DeferredLog(AsyncFileWriter& output, Renderer renderer)
+    : output(output), renderer(std::move(renderer)),
+      logId(nextLogId.fetch_add(1, std::memory_order_relaxed)),
+      rendererIdle(false), renderedRecords(0), fullRingWaits(0),
+      wakeRequested(false), flushRequested(0), flushCompleted(0), stopping(false) {
+    renderThread = std::thread(&DeferredLog::renderLoop, this);
+}
+
+DeferredLog::~DeferredLog() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeRenderer.notify_one();
+    if (renderThread.joinable()) {
+        renderThread.join();
+    }
+
+    // Threads still holding one of these rings free it when they next register a ring, or exit
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& ring : rings) {
+        ring->orphaned.store(true, std::memory_order_relaxed);
+    }
+}
+
+DeferredLog::LocalRings::~LocalRings() {
+    // Released after the thread's last push, so the render thread sees every record before the flag
+    for (const Lease& lease : leases) {
+        lease.ring->retired.store(true, std::memory_order_release);
+    }
+}
+
+void DeferredLog::push(LogRecord record) {
+    record.timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    Ring& ring = localRing();
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    if (tail - ring.cachedHead == kRingRecords) {
+        ring.cachedHead = ring.head.load(std::memory_order_acquire);
+        if (tail - ring.cachedHead == kRingRecords) {
+            // Full: the record must not be lost, so hurry the render thread along
+            fullRingWaits.fetch_add(1, std::memory_order_relaxed);
+            do {
+                wake();
+                std::this_thread::yield();
+                ring.cachedHead = ring.head.load(std::memory_order_acquire);
+            } while (tail - ring.cachedHead == kRingRecords);
+        }
+    }
+    ring.records[tail & (kRingRecords - 1)] = record;
+
+    // Publish, then look at the flag; a render thread going idle checks the rings after setting it
+    ring.tail.store(tail + 1, std::memory_order_seq_cst);
+    if (rendererIdle.load(std::memory_order_seq_cst)) {
+        wake();
+    }
+}
+
+void DeferredLog::flush() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    uint64_t ticket = ++flushRequested;
+    wakeRenderer.notify_one();
+    rendered.wait(lock, [this, ticket]() { return flushCompleted >= ticket; });
+}
+
+uint64_t DeferredLog::getRenderedRecords() const {
+    return renderedRecords.load(std::memory_order_relaxed);
+}
+
+uint64_t DeferredLog::getFullRingWaits() const {
+    return fullRingWaits.load(std::memory_order_relaxed);
+}
+
+DeferredLog::Ring& DeferredLog::localRing() {
+    static thread_local LocalRings local;
+    for (auto lease = local.leases.rbegin(); lease != local.leases.rend(); ++lease) {
+        if (lease->logId == logId) {
+            return *lease->ring;
+        }
+    }
+
+    // First record from this thread: drop rings of logs since destroyed, then register one
+    local.leases.erase(std::remove_if(local.leases.begin(), local.leases.end(), [](const LocalRings::Lease& lease) {
+        return lease.ring->orphaned.load(std::memory_order_relaxed);
+    }), local.leases.end());
+
+    std::shared_ptr<Ring> ring;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (!spareRings.empty()) {
+            ring = std::move(spareRings.back());
+            spareRings.pop_back();
+        } else {
+            ring = std::make_shared<Ring>();
+        }
+        rings.push_back(ring);
+    }
+    local.leases.push_back({logId, ring});
+    return *ring;
+}
+
+void DeferredLog::wake() {
+    ThreadMonitor::lockProfiled(stateMutex, ThreadMonitor::LockSite::LOGGER);
+    std::lock_guard<std::mutex> lock(stateMutex, std::adopt_lock);
+    rendererIdle.store(false, std::memory_order_relaxed);
+    wakeRequested = true;
+    wakeRenderer.notify_one();
+}
+
+// ----------------------------------------------------------------------------
+// Render thread
+// ----------------------------------------------------------------------------
+
+void DeferredLog::renderLoop() {
+    std::string batch;
+    bool busy = false;      // The last pass found records: more are probably on the way
+
+    while (true) {
+        uint64_t ticket;
+        bool exiting;
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            auto wanted = [this]() { return wakeRequested || stopping || flushRequested > flushCompleted; };
+            if (busy) {
+                wakeRenderer.wait_for(lock, kRenderWindow, wanted);
+            } else {
+                // Producers look at the flag after publishing, so either they see it or we see their record
+                rendererIdle.store(true, std::memory_order_seq_cst);
+                if (!anyQueued()) {
+                    wakeRenderer.wait(lock, wanted);
+                }
+                rendererIdle.store(false, std::memory_order_relaxed);
+            }
+            wakeRequested = false;
+            ticket = flushRequested;
+            exiting = stopping;
+        }
+
+        batch.clear();
+        size_t count = renderPass(batch);
+        if (!batch.empty()) {
+            output.append(batch.data(), batch.size());
+        }
+        renderedRecords.fetch_add(count, std::memory_order_relaxed);
+        busy = count > 0;
+
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            flushCompleted = ticket;
+        }
+        rendered.notify_all();
+
+        if (exiting && !anyQueued()) {
+            break;
+        }
+    }
+}
+
+bool DeferredLog::anyQueued() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& ring : rings) {
+        if (ring->tail.load(std::memory_order_seq_cst) != ring->head.load(std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t DeferredLog::renderPass(std::string& batch) {
+    size_t count = 0;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (size_t i = 0; i < rings.size();) {
+        Ring& ring = *rings[i];
+        bool retired = ring.retired.load(std::memory_order_acquire);   // Before tail: then tail is final
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        uint64_t tail = ring.tail.load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            LogRecord& record = ring.records[head & (kRingRecords - 1)];
+            renderer(record, batch);
+            delete record.text;
+            record.text = nullptr;
+            ++count;
+        }
+        ring.head.store(head, std::memory_order_release);
+
+        if (!retired) {
+            ++i;
+            continue;
+        }
+        // Drained for good: stop scanning it, and keep it for the next thread if spares are short
+        if (spareRings.size() < kSpareRings) {
+            ring.retired.store(false, std::memory_order_relaxed);
+            spareRings.push_back(std::move(rings[i]));
+        }
+        rings[i] = std::move(rings.back());
+        rings.pop_back();
+    }
+    return count;
+}
@@ -0,0 +1,180 @@
+#include "../include/epoch_reclaimer.h"
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// EPOCH RECLAIMER IMPLEMENTATION
+// ============================================================================
+
+namespace {
+    struct alignas(64) PinRecord {
+        std::atomic<uint64_t> epoch{0};     // 0 while free, else the epoch its Pin saw
+    };
+
+    struct Retired {
+        uint64_t epoch;                     // Freed once every Pin is past it
+        void* object;
+        void (*reclaim)(void*);
+    };
+
+    // Constant-initialised, so usable from any static constructor or destructor
+    std::atomic<uint64_t> globalEpoch{1};
+    std::atomic<size_t> activePins{0};
+    std::atomic<size_t> pendingRetired{0};
+    PinRecord pinRecords[EpochReclaimer::kPinRecords];
+
+    // Queues left behind by threads that exited while Pins held them up
+    std::mutex& orphanMutex() {
+        static std::mutex* mutex = new std::mutex();
+        return *mutex;
+    }
+    std::vector<Retired>& orphans() {
+        static std::vector<Retired>* list = new std::vector<Retired>();
+        return *list;
+    }
+
+    uint64_t oldestPin() {
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (const PinRecord& record : pinRecords) {
+            uint64_t epoch = record.epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0 && epoch < oldest) {
+                oldest = epoch;
+            }
+        }
+        return oldest;
+    }
+
+    // Frees the entries no Pin can reach; returns how many are left
+    size_t reclaimFrom(std::vector<Retired>& list) {
+        if (list.empty()) {
+            return 0;
+        }
+        uint64_t oldest = activePins.load(std::memory_order_seq_cst) == 0 ?
+            std::numeric_limits<uint64_t>::max() : oldestPin();
+        auto kept = std::partition(list.begin(), list.end(),
+            [oldest](const Retired& entry) { return entry.epoch >= oldest; });
+        std::vector<Retired> ready(kept, list.end());
+        list.erase(kept, list.end());
+        pendingRetired.fetch_sub(ready.size(), std::memory_order_relaxed);
+        for (const Retired& entry : ready) {
+            entry.reclaim(entry.object);
+        }
+        return list.size();
+    }
+
+    struct ThreadQueue {
+        std::vector<Retired> retired;
+        size_t sinceCollect = 0;
+
+        ~ThreadQueue() {
+            if (reclaimFrom(retired) != 0) {
+                std::lock_guard<std::mutex> lock(orphanMutex());
+                orphans().insert(orphans().end(), retired.begin(), retired.end());
+            }
+        }
+    };
+
+    thread_local ThreadQueue threadQueue;
+    thread_local size_t pinHint = 0;
+
+    void collectOrphans() {
+        std::vector<Retired> taken;
+        {
+            std::lock_guard<std::mutex> lock(orphanMutex());
+            taken.swap(orphans());
+        }
+        if (reclaimFrom(taken) != 0) {
+            std::lock_guard<std::mutex> lock(orphanMutex());
+            orphans().insert(orphans().end(), taken.begin(), taken.end());
+        }
+    }
+}
+
+// Pin
+
+EpochReclaimer::Pin::Pin() : record(nullptr) {
+    // Counted before the record is claimed: a retire() that sees no Pins at all frees at once
+    activePins.fetch_add(1, std::memory_order_seq_cst);
+
+    uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+    for (size_t attempt = 0; !record; ++attempt) {
+        size_t index = (pinHint + attempt) % kPinRecords;
+        uint64_t expected = 0;
+        if (pinRecords[index].epoch.compare_exchange_strong(expected, epoch, std::memory_order_seq_cst)) {
+            record = &pinRecords[index].epoch;
+            pinHint = index;
+        } else if (attempt % kPinRecords == kPinRecords - 1) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Published only once the epoch is still current, so no object retired before it is kept
+    for (;;) {
+        uint64_t current = globalEpoch.load(std::memory_order_seq_cst);
+        if (current == epoch) {
+            break;
+        }
+        epoch = current;
+        record->store(epoch, std::memory_order_seq_cst);
+    }
+}
+
+EpochReclaimer::Pin::~Pin() {
+    release();
+}
+
+EpochReclaimer::Pin::Pin(Pin&& other) noexcept : record(other.record) {
+    other.record = nullptr;
+}
+
+EpochReclaimer::Pin& EpochReclaimer::Pin::operator=(Pin&& other) noexcept {
+    if (this != &other) {
+        release();
+        record = other.record;
+        other.record = nullptr;
+    }
+    return *this;
+}
+
+void EpochReclaimer::Pin::release() noexcept {
+    if (record) {
+        record->store(0, std::memory_order_release);
+        activePins.fetch_sub(1, std::memory_order_release);
+        record = nullptr;
+    }
+}
+
+// Retirement
+
+void EpochReclaimer::retire(void* object, void (*reclaim)(void*)) {
+    if (!object) {
+        return;
+    }
+
+    // The caller has unlinked the object; a Pin taken after this advance cannot reach it
+    uint64_t epoch = globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (activePins.load(std::memory_order_seq_cst) == 0) {
+        reclaim(object);
+    } else {
+        threadQueue.retired.push_back(Retired{epoch, object, reclaim});
+        pendingRetired.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!threadQueue.retired.empty() && ++threadQueue.sinceCollect >= kCollectEvery) {
+        threadQueue.sinceCollect = 0;
+        reclaimFrom(threadQueue.retired);
+    }
+}
+
+void EpochReclaimer::collect() {
+    threadQueue.sinceCollect = 0;
+    reclaimFrom(threadQueue.retired);
+    collectOrphans();
+}
+
+size_t EpochReclaimer::pendingCount() {
+    return pendingRetired.load(std::memory_order_relaxed);
+}
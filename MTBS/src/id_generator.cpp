@@ -0,0 +1,109 @@
+#include "../include/id_generator.h"
+#include <atomic>
+#include <algorithm>
+
+namespace {
+    constexpr int kSlotShift = IdGenerator::kSequenceBits;
+    constexpr int kNodeShift = kSlotShift + IdGenerator::kSlotBits;
+    constexpr int kTimeShift = kNodeShift + IdGenerator::kNodeBits;
+    constexpr uint64_t kTimeMask = (uint64_t(1) << IdGenerator::kTimeBits) - 1;
+    constexpr uint32_t kSharedSlot = IdGenerator::kSlotCount - 1;
+
+    // state = (milliseconds << kSequenceBits) | sequence of the slot's last ID
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> state{0};
+        std::atomic<bool> owned{false};
+    };
+
+    Slot slots[IdGenerator::kSlotCount];
+    std::atomic<uint32_t> slotHint{0};
+    std::atomic<uint64_t> floorMs{0};
+    std::atomic<uint32_t> nodeBits{0};
+
+    // Claims a slot for the lifetime of the calling thread
+    struct ThreadSlot {
+        uint32_t index;
+
+        ThreadSlot() : index(kSharedSlot) {
+            uint32_t start = slotHint.fetch_add(1, std::memory_order_relaxed);
+            for (uint32_t i = 0; i < kSharedSlot; ++i) {
+                uint32_t candidate = (start + i) % kSharedSlot;
+                if (!slots[candidate].owned.exchange(true, std::memory_order_acquire)) {
+                    index = candidate;
+                    break;
+                }
+            }
+        }
+
+        ~ThreadSlot() {
+            // The state stays behind, so the next owner continues after it
+            if (index != kSharedSlot) {
+                slots[index].owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    uint64_t currentMs() {
+        int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return now > static_cast<int64_t>(IdGenerator::kEpochMs) ? static_cast<uint64_t>(now) - IdGenerator::kEpochMs : 0;
+    }
+
+    uint64_t compose(uint64_t state, uint32_t slot, uint32_t node) {
+        uint64_t ms = (state >> IdGenerator::kSequenceBits) & kTimeMask;
+        uint64_t sequence = state & ((uint64_t(1) << IdGenerator::kSequenceBits) - 1);
+        return (ms << kTimeShift) | (uint64_t(node) << kNodeShift) | (uint64_t(slot) << kSlotShift) | sequence;
+    }
+}
+
+// ============================================================================
+// ID GENERATOR IMPLEMENTATION
+// ============================================================================
+
+uint64_t IdGenerator::next() {
+    thread_local ThreadSlot threadSlot;
+    Slot& slot = slots[threadSlot.index];
+
+    uint64_t ms = std::max(currentMs(), floorMs.load(std::memory_order_relaxed));
+    uint64_t last = slot.state.load(std::memory_order_relaxed);
+    uint64_t state;
+    do {
+        state = std::max(ms << kSequenceBits, last + 1);    // Sequence overflow carries into the next ms
+    } while (!slot.state.compare_exchange_weak(last, state, std::memory_order_relaxed));
+
+    return compose(state, threadSlot.index, nodeBits.load(std::memory_order_relaxed));
+}
+
+void IdGenerator::setNode(uint32_t node) {
+    nodeBits.store(node & kMaxNode, std::memory_order_relaxed);
+}
+
+uint32_t IdGenerator::getNode() {
+    return nodeBits.load(std::memory_order_relaxed);
+}
+
+void IdGenerator::observe(uint64_t id) {
+    uint64_t wanted = ((id >> kTimeShift) & kTimeMask) + 1;
+    uint64_t current = floorMs.load(std::memory_order_relaxed);
+    while (current < wanted && !floorMs.compare_exchange_weak(current, wanted, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t IdGenerator::highWatermark() {
+    uint32_t node = nodeBits.load(std::memory_order_relaxed);
+    uint64_t highest = compose(floorMs.load(std::memory_order_relaxed) << kSequenceBits, 0, node);
+    for (uint32_t i = 0; i < kSlotCount; ++i) {
+        highest = std::max(highest, compose(slots[i].state.load(std::memory_order_relaxed), i, node));
+    }
+    return highest;
+}
+
+std::chrono::system_clock::time_point IdGenerator::timeOf(uint64_t id) {
+    uint64_t ms = ((id >> kTimeShift) & kTimeMask) + kEpochMs;
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(ms)));
+}
+
+uint32_t IdGenerator::nodeOf(uint64_t id) {
+    return static_cast<uint32_t>((id >> kNodeShift) & kMaxNode);
+}
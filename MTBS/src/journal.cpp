@@ -0,0 +1,347 @@
+#include "../include/journal.h"
+#include "../include/replication.h"
+#include <fstream>
+#include <array>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <cstdio>
+
+namespace {
+    std::atomic<uint64_t> nextJournalId(1);
+
+    // Last writer ticket (and LSN) this thread appended, for commitCurrentThread()
+    struct LocalCommitSlot {
+        uint64_t journalId;
+        uint64_t ticket;
+        uint64_t lsn;
+    };
+    thread_local LocalCommitSlot localCommit = {0, 0, 0};
+
+    // Encoding scratch space, reused so append does not allocate
+    thread_local std::string localEncodeBuffer;
+
+    uint64_t nextSegmentNumber(const std::string& basePath) {
+        std::vector<Journal::Segment> segments = Journal::listSegments(basePath);
+        return segments.empty() ? 1 : segments.back().number + 1;
+    }
+
+    constexpr std::array<uint32_t, 256> makeCrcTable() {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+            }
+            table[i] = value;
+        }
+        return table;
+    }
+    constexpr std::array<uint32_t, 256> kCrcTable = makeCrcTable();
+
+    template <typename T>
+    void put(std::string& out, size_t offset, T value) {
+        std::memcpy(&out[offset], &value, sizeof(T));
+    }
+
+    template <typename T>
+    T get(const char* data, size_t offset) {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    int64_t toNanoseconds(std::chrono::system_clock::time_point timestamp) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+    }
+
+    std::chrono::system_clock::time_point fromNanoseconds(int64_t nanoseconds) {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+    }
+}
+
+// ============================================================================
+// JOURNAL IMPLEMENTATION
+// ============================================================================
+
+Journal::Journal(const std::string& basePath, const AsyncFileWriter::Options& options)
+    : basePath(basePath), currentSegment(nextSegmentNumber(basePath)),
+      writer(segmentPath(basePath, currentSegment.load()), options),
+      journalId(nextJournalId.fetch_add(1, std::memory_order_relaxed)), highestTransactionId(0), 
+      replicationLog(nullptr), nextLsn(0) {
+    
+    // Continue LSNs (and tell callers about transaction IDs) after the existing segments
+    for (const Segment& segment : listSegments(basePath)) {
+        if (segment.number == currentSegment.load()) {
+            continue;
+        }
+        JournalReader reader(segment.path);
+        JournalRecord record;
+        while (reader.next(record)) {
+            advanceLsn(record.lsn);
+            highestTransactionId = std::max(highestTransactionId, record.transactionId);
+        }
+    }
+}
+
+uint64_t Journal::append(JournalRecord& record) {
+    record.lsn = nextLsn.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    std::string& buffer = localEncodeBuffer;
+    encode(record, buffer);
+    uint64_t ticket = writer.append(buffer.data(), buffer.size());
+    if (ReplicationLog* log = replicationLog.load(std::memory_order_acquire)) {
+        log->publish(record.lsn, buffer.data(), buffer.size());
+    }
+
+    localCommit.journalId = journalId;
+    localCommit.ticket = ticket;
+    localCommit.lsn = record.lsn;
+    return record.lsn;
+}
+
+bool Journal::commitCurrentThread() {
+    return localCommit.journalId != journalId || writer.commit(localCommit.ticket);
+}
+
+uint64_t Journal::getCurrentThreadLsn() const {
+    return localCommit.journalId == journalId ? localCommit.lsn : 0;
+}
+
+bool Journal::flush() {
+    return writer.flush();
+}
+
+void Journal::advanceLsn(uint64_t lsn) {
+    uint64_t current = nextLsn.load(std::memory_order_relaxed);
+    while (current < lsn && !nextLsn.compare_exchange_weak(current, lsn, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Journal::getLastLsn() const {
+    return nextLsn.load();
+}
+
+uint64_t Journal::getHighestTransactionId() const {
+    return highestTransactionId;
+}
+
+uint64_t Journal::rotate() {
+    std::lock_guard<std::mutex> lock(rotateMutex);
+    uint64_t next = currentSegment.load() + 1;
+    
+    // reopen() flushes the old segment before switching, so every record in
+    // it was appended (and got its LSN) before rotate() returns
+    if (!writer.reopen(segmentPath(basePath, next))) {
+        return 0;
+    }
+    currentSegment.store(next);
+    return next;
+}
+
+uint64_t Journal::getCurrentSegment() const {
+    return currentSegment.load();
+}
+
+std::vector<Journal::Segment> Journal::listSegments() const {
+    return listSegments(basePath);
+}
+
+size_t Journal::removeSegmentsBefore(uint64_t segmentNumber) {
+    size_t removed = 0;
+    for (const Segment& segment : listSegments(basePath)) {
+        if (segment.number < segmentNumber && segment.number != currentSegment.load()) {
+            std::error_code error;
+            if (std::filesystem::remove(segment.path, error)) {
+                ++removed;
+            }
+        }
+    }
+    return removed;
+}
+
+std::vector<Journal::Segment> Journal::listSegments(const std::string& basePath) {
+    std::vector<Segment> segments;
+    std::filesystem::path base(basePath);
+    std::filesystem::path directory = base.has_parent_path() ? base.parent_path() : std::filesystem::path(".");
+    std::string prefix = base.filename().string() + ".";
+
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        std::string name = it->path().filename().string();
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        std::string digits = name.substr(prefix.size());
+        if (!std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            continue;
+        }
+        segments.push_back({std::stoull(digits), it->path().string()});
+    }
+
+    std::sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) {
+        return a.number < b.number;
+    });
+    return segments;
+}
+
+std::string Journal::segmentPath(const std::string& basePath, uint64_t segmentNumber) {
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), ".%06llu", static_cast<unsigned long long>(segmentNumber));
+    return basePath + suffix;
+}
+
+void Journal::setReplicationLog(ReplicationLog* log) {
+    replicationLog.store(log, std::memory_order_release);
+}
+
+std::string Journal::getBasePath() const {
+    return basePath;
+}
+
+std::string Journal::getPath() const {
+    return writer.getPath();
+}
+
+const AsyncFileWriter& Journal::getWriter() const {
+    return writer;
+}
+
+// ----------------------------------------------------------------------------
+// Serialization
+// ----------------------------------------------------------------------------
+
+void Journal::encode(const JournalRecord& record, std::string& out) {
+    // Oversized strings are cut so a record always fits kMaxRecordSize
+    size_t accountLength = std::min(record.account.size(), kMaxStringLength);
+    size_t counterpartyLength = std::min(record.counterparty.size(), kMaxStringLength);
+    size_t textLength = std::min(record.text.size(), kMaxStringLength);
+    size_t size = kHeaderSize + accountLength + counterpartyLength + textLength;
+    out.resize(size);
+
+    put<uint32_t>(out, 0, static_cast<uint32_t>(size));
+    put<uint64_t>(out, 8, record.lsn);
+    put<uint64_t>(out, 16, record.transactionId);
+    put<int64_t>(out, 24, toNanoseconds(record.timestamp));
+    put<int64_t>(out, 32, record.amount.toCents());
+    put<int64_t>(out, 40, record.balanceAfter.toCents());
+    put<int64_t>(out, 48, record.counterpartyBalanceAfter.toCents());
+    put<uint8_t>(out, 56, static_cast<uint8_t>(record.kind));
+    put<uint8_t>(out, 57, static_cast<uint8_t>(record.type));
+    put<uint8_t>(out, 58, static_cast<uint8_t>(record.status));
+    put<uint8_t>(out, 59, record.flags);
+    put<uint16_t>(out, 60, static_cast<uint16_t>(accountLength));
+    put<uint16_t>(out, 62, static_cast<uint16_t>(counterpartyLength));
+    put<uint16_t>(out, 64, static_cast<uint16_t>(textLength));
+    put<uint16_t>(out, 66, 0);
+
+    char* strings = &out[kHeaderSize];
+    std::memcpy(strings, record.account.data(), accountLength);
+    std::memcpy(strings + accountLength, record.counterparty.data(), counterpartyLength);
+    std::memcpy(strings + accountLength + counterpartyLength, record.text.data(), textLength);
+
+    put<uint32_t>(out, 4, crc32(out.data() + 8, size - 8));
+}
+
+bool Journal::decode(const char* data, size_t size, JournalRecord& record, size_t& consumed) {
+    if (size < kHeaderSize) {
+        return false;
+    }
+
+    uint32_t recordSize = get<uint32_t>(data, 0);
+    if (recordSize < kHeaderSize || recordSize > kMaxRecordSize || recordSize > size) {
+        return false;
+    }
+    if (get<uint32_t>(data, 4) != crc32(data + 8, recordSize - 8)) {
+        return false;
+    }
+
+    size_t accountLength = get<uint16_t>(data, 60);
+    size_t counterpartyLength = get<uint16_t>(data, 62);
+    size_t textLength = get<uint16_t>(data, 64);
+    if (kHeaderSize + accountLength + counterpartyLength + textLength != recordSize) {
+        return false;
+    }
+
+    uint8_t kind = get<uint8_t>(data, 56);
+    if (kind < static_cast<uint8_t>(JournalRecordKind::ACCOUNT_OPENED) ||
+        kind > static_cast<uint8_t>(JournalRecordKind::TRANSACTION)) {
+        return false;
+    }
+
+    record.kind = static_cast<JournalRecordKind>(kind);
+    record.lsn = get<uint64_t>(data, 8);
+    record.transactionId = get<uint64_t>(data, 16);
+    record.timestamp = fromNanoseconds(get<int64_t>(data, 24));
+    record.amount = Money::fromCents(get<int64_t>(data, 32));
+    record.balanceAfter = Money::fromCents(get<int64_t>(data, 40));
+    record.counterpartyBalanceAfter = Money::fromCents(get<int64_t>(data, 48));
+    record.type = static_cast<TransactionType>(get<uint8_t>(data, 57));
+    record.status = static_cast<TransactionStatus>(get<uint8_t>(data, 58));
+    record.flags = get<uint8_t>(data, 59);
+
+    const char* strings = data + kHeaderSize;
+    record.account.assign(strings, accountLength);
+    record.counterparty.assign(strings + accountLength, counterpartyLength);
+    record.text.assign(strings + accountLength + counterpartyLength, textLength);
+
+    consumed = recordSize;
+    return true;
+}
+
+uint32_t Journal::crc32(const char* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = kCrcTable[(crc ^ static_cast<uint8_t>(data[i])) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// ============================================================================
+// JOURNAL READER IMPLEMENTATION
+// ============================================================================
+
+JournalReader::JournalReader(const std::string& path)
+    : position(0), recordsRead(0), opened(false), corrupt(false) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return;
+    }
+
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    data.resize(static_cast<size_t>(size > 0 ? size : 0));
+    if (size > 0 && !file.read(data.data(), size)) {
+        data.clear();
+        return;
+    }
+    opened = true;
+}
+
+bool JournalReader::isOpen() const {
+    return opened;
+}
+
+bool JournalReader::next(JournalRecord& record) {
+    if (corrupt || position >= data.size()) {
+        return false;
+    }
+
+    size_t consumed = 0;
+    if (!Journal::decode(data.data() + position, data.size() - position, record, consumed)) {
+        corrupt = true;
+        return false;
+    }
+    position += consumed;
+    ++recordsRead;
+    return true;
+}
+
+bool JournalReader::hitCorruption() const {
+    return corrupt;
+}
+
+size_t JournalReader::getRecordsRead() const {
+    return recordsRead;
+}
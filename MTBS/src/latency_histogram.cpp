@@ -0,0 +1,288 @@
+#include "../include/latency_histogram.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace {
+    std::atomic<size_t> nextShard(0);
+    std::atomic<bool> statsEnabled(true);
+
+    int highestBit(uint64_t value) {
+        int bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+    }
+
+    constexpr size_t kStageCount = static_cast<size_t>(LatencyStage::COUNT);
+
+    // Function-local, like the StringTable instances, so any static initialiser can record
+    LatencyHistogram* stageHistograms() {
+        static LatencyHistogram histograms[kStageCount];
+        return histograms;
+    }
+
+    const char* const stageNames[] = {
+        "deposit", "withdraw", "transfer", "batch_transfer",
+        "account_lock_wait", "directory_lock_wait",
+        "work_queue_dwell", "transaction_queue_dwell",
+        "journal_commit", "log_write", "replication_ack"
+    };
+    static_assert(sizeof(stageNames) / sizeof(stageNames[0]) == kStageCount,
+                  "every LatencyStage needs a name");
+
+    // Nanoseconds as the shortest readable unit: "850ns", "12.4us", "3.10ms", "1.25s"
+    std::string formatNanos(double nanos) {
+        std::ostringstream oss;
+        oss << std::fixed;
+        if (nanos < 1000.0) {
+            oss << std::setprecision(0) << nanos << "ns";
+        } else if (nanos < 1000000.0) {
+            oss << std::setprecision(nanos < 10000.0 ? 2 : 1) << nanos / 1000.0 << "us";
+        } else if (nanos < 1000000000.0) {
+            oss << std::setprecision(nanos < 10000000.0 ? 2 : 1) << nanos / 1000000.0 << "ms";
+        } else {
+            oss << std::setprecision(2) << nanos / 1000000000.0 << "s";
+        }
+        return oss.str();
+    }
+}
+
+// ============================================================================
+// LATENCY HISTOGRAM IMPLEMENTATION
+// ============================================================================
+
+LatencyHistogram::Shard::Shard() : sum(0), max(0) {
+    for (std::atomic<uint64_t>& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::LatencyHistogram() {
+    for (std::atomic<Shard*>& shard : shards) {
+        shard.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::~LatencyHistogram() {
+    for (std::atomic<Shard*>& shard : shards) {
+        delete shard.load(std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t nanos) {
+    if (nanos < kSubBuckets) {
+        return static_cast<size_t>(nanos);
+    }
+    int magnitude = highestBit(nanos);
+    if (magnitude > kMaxMagnitude) {
+        return kBucketCount - 1;
+    }
+    size_t subBucket = static_cast<size_t>(nanos >> (magnitude - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<size_t>(magnitude - kSubBucketBits + 1) * kSubBuckets + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    int magnitude = static_cast<int>(bucket / kSubBuckets) + kSubBucketBits - 1;
+    uint64_t subBucket = bucket % kSubBuckets;
+    uint64_t width = uint64_t(1) << (magnitude - kSubBucketBits);
+    return ((kSubBuckets + subBucket) << (magnitude - kSubBucketBits)) + width - 1;
+}
+
+LatencyHistogram::Shard& LatencyHistogram::localShard() {
+    thread_local size_t index = nextShard.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+    Shard* shard = shards[index].load(std::memory_order_acquire);
+    if (!shard) {
+        Shard* created = new Shard();
+        if (shards[index].compare_exchange_strong(shard, created, std::memory_order_acq_rel)) {
+            shard = created;
+        } else {
+            delete created; // Another thread of this shard got there first
+        }
+    }
+    return *shard;
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+    Shard& shard = localShard();
+    shard.counts[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+    if (nanos == 0) {
+        return;
+    }
+    shard.sum.fetch_add(nanos, std::memory_order_relaxed);
+    uint64_t max = shard.max.load(std::memory_order_relaxed);
+    while (nanos > max && !shard.max.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot result;
+    result.counts.assign(kBucketCount, 0);
+    for (const std::atomic<Shard*>& slot : shards) {
+        const Shard* shard = slot.load(std::memory_order_acquire);
+        if (!shard) {
+            continue;
+        }
+        for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+            uint64_t count = shard->counts[bucket].load(std::memory_order_relaxed);
+            result.counts[bucket] += count;
+            result.count += count;
+        }
+        result.sumNanos += shard->sum.load(std::memory_order_relaxed);
+        result.maxNanos = std::max(result.maxNanos, shard->max.load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+void LatencyHistogram::reset() {
+    for (std::atomic<Shard*>& slot : shards) {
+        Shard* shard = slot.load(std::memory_order_acquire);
+        if (!shard) {
+            continue;
+        }
+        for (std::atomic<uint64_t>& count : shard->counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        shard->sum.store(0, std::memory_order_relaxed);
+        shard->max.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double percent) const {
+    if (count == 0) {
+        return 0;
+    }
+    // Rank of the sample at this percentile, 1-based; never beyond the last sample
+    double clamped = std::min(std::max(percent, 0.0), 100.0);
+    uint64_t rank = static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(count) + 0.5);
+    rank = std::min(std::max<uint64_t>(rank, 1), count);
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < counts.size(); ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(bucket), maxNanos);
+        }
+    }
+    return maxNanos;
+}
+
+double LatencyHistogram::Snapshot::meanNanos() const {
+    return count ? static_cast<double>(sumNanos) / static_cast<double>(count) : 0.0;
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    if (counts.size() < other.counts.size()) {
+        counts.resize(other.counts.size(), 0);
+    }
+    for (size_t bucket = 0; bucket < other.counts.size(); ++bucket) {
+        counts[bucket] += other.counts[bucket];
+    }
+    count += other.count;
+    sumNanos += other.sumNanos;
+    maxNanos = std::max(maxNanos, other.maxNanos);
+}
+
+// ============================================================================
+// LATENCY STATS IMPLEMENTATION
+// ============================================================================
+
+namespace LatencyStats {
+    LatencyHistogram& histogram(LatencyStage stage) {
+        return stageHistograms()[static_cast<size_t>(stage)];
+    }
+
+    const char* stageName(LatencyStage stage) {
+        size_t index = static_cast<size_t>(stage);
+        return index < kStageCount ? stageNames[index] : "unknown";
+    }
+
+    void record(LatencyStage stage, uint64_t nanos) {
+        if (statsEnabled.load(std::memory_order_relaxed)) {
+            histogram(stage).record(nanos);
+        }
+    }
+
+    void record(LatencyStage stage, std::chrono::steady_clock::duration elapsed) {
+        int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        record(stage, static_cast<uint64_t>(std::max<int64_t>(nanos, 0)));
+    }
+
+    void recordSince(LatencyStage stage, std::chrono::system_clock::time_point start) {
+        if (statsEnabled.load(std::memory_order_relaxed)) {
+            // The wall clock can step back; that counts as no wait
+            int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now() - start).count();
+            histogram(stage).record(static_cast<uint64_t>(std::max<int64_t>(nanos, 0)));
+        }
+    }
+
+    bool isEnabled() {
+        return statsEnabled.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool enabled) {
+        statsEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        for (size_t i = 0; i < kStageCount; ++i) {
+            stageHistograms()[i].reset();
+        }
+    }
+
+    std::string report() {
+        std::ostringstream oss;
+        oss << std::left << std::setw(24) << "stage" << std::right
+            << std::setw(12) << "count" << std::setw(10) << "mean"
+            << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+            << std::setw(10) << "p99.9" << std::setw(10) << "max";
+        size_t stages = 0;
+        for (size_t i = 0; i < kStageCount; ++i) {
+            LatencyHistogram::Snapshot snapshot = stageHistograms()[i].snapshot();
+            if (snapshot.count == 0) {
+                continue;
+            }
+            oss << "\n" << std::left << std::setw(24) << stageNames[i] << std::right
+                << std::setw(12) << snapshot.count
+                << std::setw(10) << formatNanos(snapshot.meanNanos())
+                << std::setw(10) << formatNanos(static_cast<double>(snapshot.percentile(50.0)))
+                << std::setw(10) << formatNanos(static_cast<double>(snapshot.percentile(90.0)))
+                << std::setw(10) << formatNanos(static_cast<double>(snapshot.percentile(99.0)))
+                << std::setw(10) << formatNanos(static_cast<double>(snapshot.percentile(99.9)))
+                << std::setw(10) << formatNanos(static_cast<double>(snapshot.maxNanos));
+            ++stages;
+        }
+        if (stages == 0) {
+            oss << "\n(no samples)";
+        }
+        return oss.str();
+    }
+
+    std::string toJson() {
+        std::ostringstream oss;
+        oss << "{";
+        bool first = true;
+        for (size_t i = 0; i < kStageCount; ++i) {
+            LatencyHistogram::Snapshot snapshot = stageHistograms()[i].snapshot();
+            if (snapshot.count == 0) {
+                continue;
+            }
+            oss << (first ? "" : ",") << "\"" << stageNames[i] << "\":{"
+                << "\"count\":" << snapshot.count
+                << ",\"mean_ns\":" << static_cast<uint64_t>(snapshot.meanNanos() + 0.5)
+                << ",\"p50_ns\":" << snapshot.percentile(50.0)
+                << ",\"p90_ns\":" << snapshot.percentile(90.0)
+                << ",\"p99_ns\":" << snapshot.percentile(99.0)
+                << ",\"p999_ns\":" << snapshot.percentile(99.9)
+                << ",\"max_ns\":" << snapshot.maxNanos << "}";
+            first = false;
+        }
+        oss << "}";
+        return oss.str();
+    }
+}
@@ -0,0 +1,652 @@
+#include "../include/log_reader.h"
+#include "../include/journal.h"
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MTBS_HAVE_SSE2 1
+#endif
+
+namespace {
+    constexpr char kIndexMagic[8] = {'M', 'T', 'B', 'S', 'L', 'I', 'X', '1'};
+    constexpr uint32_t kIndexVersion = 1;
+    constexpr size_t kFingerprintBytes = 4096;
+
+    bool isTokenChar(char c) {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+    }
+
+    // Start of the line containing position (lines never start before floor)
+    const char* lineStart(const char* floor, const char* position) {
+        while (position > floor && position[-1] != '\n') {
+            --position;
+        }
+        return position;
+    }
+
+    const char* lineEnd(const char* position, const char* end) {
+        const char* newline = static_cast<const char*>(std::memchr(position, '\n', static_cast<size_t>(end - position)));
+        return newline ? newline : end;
+    }
+
+    int countTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    template <typename T>
+    void put(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool take(const std::vector<char>& data, size_t& offset, T& value) {
+        if (offset + sizeof(T) > data.size()) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    // Merges sorted, possibly touching ranges
+    void appendRange(std::vector<std::pair<uint64_t, uint64_t>>& ranges, uint64_t begin, uint64_t end) {
+        if (begin >= end) {
+            return;
+        }
+        if (!ranges.empty() && ranges.back().second >= begin) {
+            ranges.back().second = std::max(ranges.back().second, end);
+        } else {
+            ranges.emplace_back(begin, end);
+        }
+    }
+}
+
+// ============================================================================
+// MAPPED FILE IMPLEMENTATION
+// ============================================================================
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        CloseHandle(handle);
+        return;
+    }
+    fileHandle = handle;
+    length = static_cast<size_t>(fileSize.QuadPart);
+    opened = true;
+    if (length == 0) {
+        return;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        length = 0;
+        return;
+    }
+    mappingHandle = mapping;
+    bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes) {
+        length = 0;
+    }
+#else
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return;
+    }
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0) {
+        ::close(descriptor);
+        return;
+    }
+    length = static_cast<size_t>(status.st_size);
+    opened = true;
+    if (length > 0) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping == MAP_FAILED) {
+            length = 0;
+        } else {
+            bytes = static_cast<const char*>(mapping);
+        }
+    }
+    ::close(descriptor); // The mapping keeps the file referenced
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (bytes) {
+        UnmapViewOfFile(bytes);
+    }
+    if (mappingHandle) {
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+    }
+    if (fileHandle) {
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+    }
+#else
+    if (bytes) {
+        ::munmap(const_cast<char*>(bytes), length);
+    }
+#endif
+}
+
+// ============================================================================
+// LOG INDEX IMPLEMENTATION
+// ============================================================================
+
+void LogIndex::open(const std::string& indexPath, const char* log, size_t size) {
+    updated = false;
+    if (!load(indexPath, log, size)) {
+        blockList.clear();
+        accountBlocks.clear();
+        covered = 0;
+        updated = true; // Rebuilt: worth saving even if nothing new was indexed
+    }
+    extend(log, size);
+}
+
+void LogIndex::extend(const char* log, size_t size) {
+    uint64_t start = covered;
+
+    // Complete blocks only: the block ends at the first newline past kBlockSize
+    while (size - start >= kBlockSize) {
+        const char* from = log + start + kBlockSize - 1;
+        const char* newline = static_cast<const char*>(std::memchr(from, '\n', size - (start + kBlockSize - 1)));
+        if (!newline) {
+            break;
+        }
+
+        Block block = {start, static_cast<uint64_t>(newline - log) + 1, 0, 0, UINT64_MAX, 0};
+        uint32_t blockNumber = static_cast<uint32_t>(blockList.size());
+        const char* line = log + block.begin;
+        const char* blockEnd = log + block.end;
+        while (line < blockEnd) {
+            const char* end = lineEnd(line, blockEnd);
+            indexLine(line, static_cast<size_t>(end - line), block, blockNumber);
+            line = end + 1;
+        }
+
+        blockList.push_back(block);
+        start = block.end;
+        updated = true;
+    }
+
+    covered = start;
+    if (fingerprint == 0 && covered > 0) {
+        fingerprint = fingerprintOf(log, static_cast<size_t>(covered));
+    }
+}
+
+void LogIndex::indexLine(const char* line, size_t length, Block& block, uint32_t blockNumber) {
+    uint64_t time = parseLineTime(line, length);
+    if (time != 0) {
+        block.minTime = block.minTime == 0 ? time : std::min(block.minTime, time);
+        block.maxTime = std::max(block.maxTime, time);
+    }
+
+    const char* end = line + length;
+    const char* position = line;
+    while (position < end) {
+        while (position < end && !isTokenChar(*position)) {
+            ++position;
+        }
+        const char* token = position;
+        while (position < end && isTokenChar(*position)) {
+            ++position;
+        }
+        size_t tokenLength = static_cast<size_t>(position - token);
+        if (tokenLength == 0) {
+            continue;
+        }
+
+        uint64_t number = 0;
+        if (isAccountToken(token, tokenLength)) {
+            std::vector<uint32_t>& postings = accountBlocks[std::string(token, tokenLength)];
+            if (postings.empty() || postings.back() != blockNumber) {
+                postings.push_back(blockNumber);
+            }
+        } else if (parseTransactionToken(token, tokenLength, number)) {
+            block.minTransaction = std::min(block.minTransaction, number);
+            block.maxTransaction = std::max(block.maxTransaction, number);
+        }
+    }
+}
+
+const std::vector<uint32_t>* LogIndex::blocksForAccount(const std::string& accountNumber) const {
+    auto found = accountBlocks.find(accountNumber);
+    return found == accountBlocks.end() ? nullptr : &found->second;
+}
+
+std::vector<uint32_t> LogIndex::blocksForTransaction(uint64_t transactionNumber) const {
+    std::vector<uint32_t> result;
+    for (size_t i = 0; i < blockList.size(); ++i) {
+        if (blockList[i].minTransaction <= transactionNumber && transactionNumber <= blockList[i].maxTransaction) {
+            result.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    return result;
+}
+
+std::vector<uint32_t> LogIndex::blocksForTime(uint64_t fromTime, uint64_t toTime) const {
+    std::vector<uint32_t> result;
+    for (size_t i = 0; i < blockList.size(); ++i) {
+        const Block& block = blockList[i];
+        if (block.minTime != 0 && block.minTime <= toTime && fromTime <= block.maxTime) {
+            result.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    return result;
+}
+
+// Account numbers look like "MTBS-1234-5678": letters, digits and at least one '-'
+bool LogIndex::isAccountToken(const char* token, size_t length) {
+    if (length < 8) {
+        return false;
+    }
+    bool hasLetter = false, hasDigit = false, hasDash = false;
+    for (size_t i = 0; i < length; ++i) {
+        char c = token[i];
+        hasLetter = hasLetter || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+        hasDigit = hasDigit || (c >= '0' && c <= '9');
+        hasDash = hasDash || c == '-';
+        if (c == '_') {
+            return false;
+        }
+    }
+    return hasLetter && hasDigit && hasDash;
+}
+
+// Transaction IDs look like "DEP_42": upper-case prefix, '_', decimal number
+bool LogIndex::parseTransactionToken(const char* token, size_t length, uint64_t& number) {
+    size_t i = 0;
+    while (i < length && token[i] >= 'A' && token[i] <= 'Z') {
+        ++i;
+    }
+    if (i == 0 || i + 1 >= length || token[i] != '_' || length - i - 1 > 19) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (size_t j = i + 1; j < length; ++j) {
+        if (token[j] < '0' || token[j] > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(token[j] - '0');
+    }
+    number = value;
+    return true;
+}
+
+// "[YYYY-MM-DD hh:mm:ss] ..." -> YYYYMMDDhhmmss, or 0
+uint64_t LogIndex::parseLineTime(const char* line, size_t length) {
+    static const int kDigitPositions[] = {1, 2, 3, 4, 6, 7, 9, 10, 12, 13, 15, 16, 18, 19};
+    if (length < 21 || line[0] != '[' || line[20] != ']') {
+        return 0;
+    }
+    uint64_t value = 0;
+    for (int position : kDigitPositions) {
+        char c = line[position];
+        if (c < '0' || c > '9') {
+            return 0;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return value;
+}
+
+uint64_t LogIndex::fingerprintOf(const char* log, size_t size) {
+    // FNV-1a over the first bytes, which never change while a log only grows
+    uint64_t hash = 1469598103934665603ull;
+    size_t length = std::min(size, kFingerprintBytes);
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(log[i])) * 1099511628211ull;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+// ----------------------------------------------------------------------------
+// Index file: magic, version, block size, covered bytes, fingerprint,
+// blocks, account postings, CRC-32 trailer
+// ----------------------------------------------------------------------------
+
+bool LogIndex::save(const std::string& indexPath) const {
+    std::string image;
+    image.append(kIndexMagic, sizeof(kIndexMagic));
+    put<uint32_t>(image, kIndexVersion);
+    put<uint32_t>(image, static_cast<uint32_t>(kBlockSize));
+    put<uint64_t>(image, covered);
+    put<uint64_t>(image, fingerprint);
+
+    put<uint64_t>(image, blockList.size());
+    for (const Block& block : blockList) {
+        put<uint64_t>(image, block.begin);
+        put<uint64_t>(image, block.end);
+        put<uint64_t>(image, block.minTime);
+        put<uint64_t>(image, block.maxTime);
+        put<uint64_t>(image, block.minTransaction);
+        put<uint64_t>(image, block.maxTransaction);
+    }
+
+    put<uint64_t>(image, accountBlocks.size());
+    for (const auto& item : accountBlocks) {
+        put<uint16_t>(image, static_cast<uint16_t>(item.first.size()));
+        image.append(item.first);
+        put<uint32_t>(image, static_cast<uint32_t>(item.second.size()));
+        image.append(reinterpret_cast<const char*>(item.second.data()), item.second.size() * sizeof(uint32_t));
+    }
+    put<uint32_t>(image, Journal::crc32(image.data(), image.size()));
+
+    // The index can always be rebuilt, so a plain write-and-rename is enough
+    std::string temporaryPath = indexPath + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(image.data(), static_cast<std::streamsize>(image.size()))) {
+            return false;
+        }
+    }
+#ifdef _WIN32
+    std::remove(indexPath.c_str());
+#endif
+    return std::rename(temporaryPath.c_str(), indexPath.c_str()) == 0;
+}
+
+bool LogIndex::load(const std::string& indexPath, const char* log, size_t size) {
+    std::ifstream in(indexPath, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::streamsize fileSize = in.tellg();
+    if (fileSize < static_cast<std::streamsize>(sizeof(kIndexMagic) + 4)) {
+        return false;
+    }
+    std::vector<char> data(static_cast<size_t>(fileSize));
+    in.seekg(0);
+    if (!in.read(data.data(), fileSize)) {
+        return false;
+    }
+
+    size_t bodySize = data.size() - 4;
+    uint32_t storedCrc;
+    std::memcpy(&storedCrc, data.data() + bodySize, sizeof(storedCrc));
+    if (std::memcmp(data.data(), kIndexMagic, sizeof(kIndexMagic)) != 0 ||
+        storedCrc != Journal::crc32(data.data(), bodySize)) {
+        return false;
+    }
+    data.resize(bodySize);
+
+    size_t offset = sizeof(kIndexMagic);
+    uint32_t version = 0, blockSize = 0;
+    uint64_t storedCovered = 0, storedFingerprint = 0, blockCount = 0, accountCount = 0;
+    if (!take(data, offset, version) || version != kIndexVersion || !take(data, offset, blockSize) ||
+        blockSize != kBlockSize || !take(data, offset, storedCovered) || !take(data, offset, storedFingerprint)) {
+        return false;
+    }
+
+    // The log must still start with the bytes that were indexed
+    if (storedCovered > size || (storedCovered > 0 && fingerprintOf(log, static_cast<size_t>(storedCovered)) != storedFingerprint)) {
+        return false;
+    }
+
+    std::vector<Block> loadedBlocks;
+    if (!take(data, offset, blockCount)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < blockCount; ++i) {
+        Block block;
+        if (!take(data, offset, block.begin) || !take(data, offset, block.end) ||
+            !take(data, offset, block.minTime) || !take(data, offset, block.maxTime) ||
+            !take(data, offset, block.minTransaction) || !take(data, offset, block.maxTransaction)) {
+            return false;
+        }
+        loadedBlocks.push_back(block);
+    }
+
+    std::unordered_map<std::string, std::vector<uint32_t>> loadedAccounts;
+    if (!take(data, offset, accountCount)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < accountCount; ++i) {
+        uint16_t keyLength = 0;
+        uint32_t postingCount = 0;
+        if (!take(data, offset, keyLength) || offset + keyLength > data.size()) {
+            return false;
+        }
+        std::string key(data.data() + offset, keyLength);
+        offset += keyLength;
+        if (!take(data, offset, postingCount) || offset + postingCount * sizeof(uint32_t) > data.size()) {
+            return false;
+        }
+        std::vector<uint32_t> postings(postingCount);
+        std::memcpy(postings.data(), data.data() + offset, postingCount * sizeof(uint32_t));
+        offset += postingCount * sizeof(uint32_t);
+        loadedAccounts.emplace(std::move(key), std::move(postings));
+    }
+
+    blockList = std::move(loadedBlocks);
+    accountBlocks = std::move(loadedAccounts);
+    covered = storedCovered;
+    fingerprint = storedFingerprint;
+    return true;
+}
+
+// ============================================================================
+// LOG READER IMPLEMENTATION
+// ============================================================================
+
+LogReader::LogReader(const std::string& logPath)
+    : path(logPath), file(logPath), indexed(false) {
+}
+
+bool LogReader::isOpen() const {
+    return file.isOpen();
+}
+
+size_t LogReader::size() const {
+    return file.size();
+}
+
+void LogReader::useIndex() {
+    if (!file.isOpen()) {
+        return;
+    }
+    std::string indexPath = path + ".idx";
+    index.open(indexPath, file.data(), file.size());
+    if (index.wasUpdated()) {
+        index.save(indexPath);
+    }
+    indexed = true;
+}
+
+std::vector<std::string> LogReader::readLast(size_t count, const LineFilter& filter) const {
+    std::vector<std::string> lines;
+    const char* begin = file.data();
+    const char* position = begin + file.size();
+
+    // Walk backwards one line at a time; only the pages at the end are touched
+    while (position > begin && lines.size() < count) {
+        const char* end = position;
+        if (end[-1] == '\n') {
+            --end;
+        }
+        const char* start = lineStart(begin, end);
+        size_t length = static_cast<size_t>(end - start);
+        if (length > 0 && (!filter || filter(start, length))) {
+            lines.emplace_back(start, length);
+        }
+        position = start;
+    }
+
+    std::reverse(lines.begin(), lines.end());
+    return lines;
+}
+
+std::vector<std::string> LogReader::search(const std::string& term, size_t limit, const LineFilter& filter) const {
+    std::vector<std::string> lines;
+    if (term.empty() || !file.isOpen() || file.size() == 0) {
+        return lines;
+    }
+    for (const auto& range : rangesFor(term)) {
+        scanRange(range.first, range.second, term, limit, filter, lines);
+        if (lines.size() >= limit) {
+            break;
+        }
+    }
+    return lines;
+}
+
+std::vector<std::string> LogReader::findBetween(uint64_t fromTime, uint64_t toTime, const LineFilter& filter) const {
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    if (indexed) {
+        for (uint32_t block : index.blocksForTime(fromTime, toTime)) {
+            appendRange(ranges, index.blocks()[block].begin, index.blocks()[block].end);
+        }
+        appendRange(ranges, index.indexedBytes(), file.size());
+    } else {
+        appendRange(ranges, 0, file.size());
+    }
+
+    std::vector<std::string> lines;
+    for (const auto& range : ranges) {
+        const char* line = file.data() + range.first;
+        const char* rangeEnd = file.data() + range.second;
+        while (line < rangeEnd) {
+            const char* end = lineEnd(line, rangeEnd);
+            size_t length = static_cast<size_t>(end - line);
+            uint64_t time = LogIndex::parseLineTime(line, length);
+            if (time >= fromTime && time <= toTime && (!filter || filter(line, length))) {
+                lines.emplace_back(line, length);
+            }
+            line = end + 1;
+        }
+    }
+    return lines;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> LogReader::rangesFor(const std::string& term) const {
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    uint64_t number = 0;
+
+    if (indexed && LogIndex::isAccountToken(term.data(), term.size())) {
+        if (const std::vector<uint32_t>* blocks = index.blocksForAccount(term)) {
+            for (uint32_t block : *blocks) {
+                appendRange(ranges, index.blocks()[block].begin, index.blocks()[block].end);
+            }
+        }
+    } else if (indexed && LogIndex::parseTransactionToken(term.data(), term.size(), number)) {
+        for (uint32_t block : index.blocksForTransaction(number)) {
+            appendRange(ranges, index.blocks()[block].begin, index.blocks()[block].end);
+        }
+    } else {
+        appendRange(ranges, 0, file.size()); // Not an indexed key: full scan
+        return ranges;
+    }
+
+    appendRange(ranges, index.indexedBytes(), file.size());
+    return ranges;
+}
+
+void LogReader::scanRange(uint64_t begin, uint64_t end, const std::string& term, size_t limit,
+                          const LineFilter& filter, std::vector<std::string>& out) const {
+    // Indexed keys match whole tokens only ("DEP_42" must not match "DEP_420")
+    uint64_t unused = 0;
+    bool wholeToken = LogIndex::isAccountToken(term.data(), term.size()) ||
+                      LogIndex::parseTransactionToken(term.data(), term.size(), unused);
+
+    const char* floor = file.data() + begin;
+    const char* stop = file.data() + end;
+    const char* position = floor;
+    while (position < stop && out.size() < limit) {
+        const char* hit = findSubstring(position, stop, term.data(), term.size());
+        if (!hit) {
+            break;
+        }
+        const char* hitEnd = hit + term.size();
+        if (wholeToken && ((hit > floor && isTokenChar(hit[-1])) || (hitEnd < stop && isTokenChar(*hitEnd)))) {
+            position = hit + 1;
+            continue;
+        }
+
+        const char* start = lineStart(floor, hit);
+        const char* finish = lineEnd(hitEnd, stop);
+        size_t length = static_cast<size_t>(finish - start);
+        if (!filter || filter(start, length)) {
+            out.emplace_back(start, length);
+        }
+        position = finish + 1;
+    }
+}
+
+const char* LogReader::findSubstring(const char* begin, const char* end, const char* needle, size_t length) {
+    if (length == 0 || static_cast<size_t>(end - begin) < length) {
+        return nullptr;
+    }
+    if (length == 1) {
+        return static_cast<const char*>(std::memchr(begin, needle[0], static_cast<size_t>(end - begin)));
+    }
+
+    const char* position = begin;
+    const char* last = end - length; // Last valid start
+
+#ifdef MTBS_HAVE_SSE2
+    // Compare the first and last needle bytes for 16 candidate starts at once;
+    // only candidates where both match are checked with memcmp
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i final = _mm_set1_epi8(needle[length - 1]);
+    while (position + 16 <= last + 1) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position + length - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, final))));
+        while (mask != 0) {
+            int bit = countTrailingZeros(mask);
+            if (std::memcmp(position + bit + 1, needle + 1, length - 2) == 0) {
+                return position + bit;
+            }
+            mask &= mask - 1;
+        }
+        position += 16;
+    }
+#endif
+
+    // Remainder (or no SSE2): memchr for the first byte, then compare
+    while (position <= last) {
+        const void* candidate = std::memchr(position, needle[0], static_cast<size_t>(last - position) + 1);
+        if (!candidate) {
+            return nullptr;
+        }
+        position = static_cast<const char*>(candidate);
+        if (std::memcmp(position + 1, needle + 1, length - 1) == 0) {
+            return position;
+        }
+        ++position;
+    }
+    return nullptr;
+}
@@ -1,9 +1,14 @@
 #include "../include/bank.h"
+#include "../include/bank_server.h"
 #include <iostream>
 #include <thread>
+#include <future>
 #include <chrono>
 #include <vector>
 #include <random>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 
 /**
  * @brief Main demonstration program for the Multithreaded Bank Transaction System
@@ -19,16 +24,16 @@ void demonstrateBasicOperations(Bank& bank) {
     std::cout << "\n=== BASIC BANKING OPERATIONS ===" << std::endl;
     
     // Create accounts
-    std::string account1 = bank.createAccount("John Doe", 1000.0);
-    std::string account2 = bank.createAccount("Jane Smith", 2500.0);
-    std::string account3 = bank.createAccount("Bob Johnson", 500.0);
+    std::string account1 = bank.createAccount("John Doe", Money::fromDollars(1000));
+    std::string account2 = bank.createAccount("Jane Smith", Money::fromDollars(2500));
+    std::string account3 = bank.createAccount("Bob Johnson", Money::fromDollars(500));
     
     std::cout << "Created accounts: " << account1 << ", " << account2 << ", " << account3 << std::endl;
     
     // Perform basic transactions
-    bank.processDeposit(account1, 500.0, "Salary deposit");
-    bank.processWithdraw(account2, 200.0, "ATM withdrawal");
-    bank.processTransfer(account1, account3, 150.0, "Loan repayment");
+    bank.processDeposit(account1, Money::fromDollars(500), "Salary deposit");
+    bank.processWithdraw(account2, Money::fromDollars(200), "ATM withdrawal");
+    bank.processTransfer(account1, account3, Money::fromDollars(150), "Loan repayment");
     
     // Wait for transactions to complete
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -60,7 +65,7 @@ void demonstrateConcurrentTransactions(Bank& bank) {
     
     for (int i = 0; i < 10; ++i) {
         threads.emplace_back([&bank, account1, account2, i]() {
-            double amount = 10.0 + (i * 5.0); // Different amounts for each thread
+            Money amount = Money::fromDollars(10 + (i * 5)); // Different amounts for each thread
             std::string desc = "Concurrent transfer " + std::to_string(i + 1);
             
             if (i % 2 == 0) {
@@ -106,8 +111,8 @@ void demonstrateRaceConditionPrevention(Bank& bank) {
     for (int i = 0; i < 5; ++i) {
         balanceThreads.emplace_back([&bank, account1, account2, i]() {
             for (int j = 0; j < 20; ++j) {
-                double balance1 = bank.getAccountBalance(account1);
-                double balance2 = bank.getAccountBalance(account2);
+                Money balance1 = bank.getAccountBalance(account1);
+                Money balance2 = bank.getAccountBalance(account2);
                 
                 if (j % 10 == 0) {
                     std::cout << "Thread " << i << " - Balance check " << j << ": "
@@ -124,7 +129,7 @@ void demonstrateRaceConditionPrevention(Bank& bank) {
     for (int i = 0; i < 3; ++i) {
         operationThreads.emplace_back([&bank, account1, account2, i]() {
             for (int j = 0; j < 10; ++j) {
-                double amount = 5.0 + (j * 2.0);
+                Money amount = Money::fromDollars(5 + (j * 2));
                 std::string desc = "Race test " + std::to_string(i) + "-" + std::to_string(j);
                 
                 if (i % 2 == 0) {
@@ -149,6 +154,38 @@ void demonstrateRaceConditionPrevention(Bank& bank) {
     std::cout << "Race condition prevention test completed!" << std::endl;
 }
 
+void demonstratePipelinedTransactions(Bank& bank) {
+    std::cout << "\n=== PIPELINED TRANSACTIONS DEMONSTRATION ===" << std::endl;
+    
+    auto accounts = bank.getAllAccounts();
+    if (accounts.empty()) {
+        return;
+    }
+    
+    // Submit many small deposits asynchronously; the pipeline batches them per account shard
+    const int depositsPerAccount = 200;
+    std::vector<std::future<Bank::TransactionResult>> results;
+    results.reserve(accounts.size() * depositsPerAccount);
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < depositsPerAccount; ++i) {
+        for (const auto& account : accounts) {
+            results.push_back(bank.submitDeposit(account->getAccountNumber(), Money::fromDollars(1), "Pipelined deposit"));
+        }
+    }
+    
+    size_t succeeded = 0;
+    for (auto& result : results) {
+        if (result.get().success) {
+            ++succeeded;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    
+    std::cout << succeeded << " of " << results.size() << " pipelined deposits succeeded in " 
+              << elapsed.count() << " us" << std::endl;
+}
+
 void demonstrateSystemMonitoring(Bank& bank) {
     std::cout << "\n=== SYSTEM MONITORING ===" << std::endl;
     
@@ -165,22 +202,71 @@ void demonstrateErrorHandling(Bank& bank) {
     auto accounts = bank.getAllAccounts();
     if (!accounts.empty()) {
         std::string testAccount = accounts[0]->getAccountNumber();
-        double currentBalance = bank.getAccountBalance(testAccount);
+        Money currentBalance = bank.getAccountBalance(testAccount);
+        Money overdraftAmount = currentBalance + Money::fromDollars(1000);
         
-        std::cout << "Attempting to withdraw $" << (currentBalance + 1000.0) 
+        std::cout << "Attempting to withdraw $" << overdraftAmount 
                   << " from account with balance $" << currentBalance << std::endl;
         
-        bool result = bank.processWithdraw(testAccount, currentBalance + 1000.0, "Overdraft test");
+        bool result = bank.processWithdraw(testAccount, overdraftAmount, "Overdraft test");
         std::cout << "Withdrawal result: " << (result ? "SUCCESS" : "FAILED (expected)") << std::endl;
     }
     
     // Try to access non-existent account
     std::cout << "Attempting to access non-existent account..." << std::endl;
-    double balance = bank.getAccountBalance("NONEXISTENT");
+    Money balance = bank.getAccountBalance("NONEXISTENT");
     std::cout << "Balance of non-existent account: " << balance << std::endl;
 }
 
-int main() {
+namespace {
+    volatile std::sig_atomic_t stopRequested = 0;
+    
+    void requestStop(int) {
+        stopRequested = 1;
+    }
+}
+
+/**
+ * @brief Serves the web UI and the bank's API (see BankServer) until Ctrl+C
+ * 
+ * Unlike the demonstration, state persists: the journal and snapshot in the
+ * working directory are recovered on start and the final snapshot is written on stop.
+ */
+int runServer(uint16_t port) {
+    Bank::Config config("MTBS Bank", "MTBS001", 100000, 16, true);
+    Bank bank(config);
+    bank.startBankingSystem();
+    
+    BankServer::Options options;
+    options.port = port;
+    BankServer server(bank, options);
+    server.start();
+    
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::cout << "Serving the MTBS web UI at http://" << options.bindAddress << ":" << server.getPort() 
+              << "/ (Ctrl+C to stop)" << std::endl;
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    
+    std::cout << "\nStopping..." << std::endl;
+    server.stop();
+    bank.stopBankingSystem();
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // --serve [port]: run the network front-end instead of the demonstration
+    if (argc > 1 && std::strcmp(argv[1], "--serve") == 0) {
+        try {
+            return runServer(static_cast<uint16_t>(argc > 2 ? std::atoi(argv[2]) : 8080));
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
     std::cout << "🏦 MULTITHREADED BANK TRANSACTION SYSTEM 🏦" << std::endl;
     std::cout << "=============================================" << std::endl;
     std::cout << "Demonstrating Operating System Concepts:" << std::endl;
@@ -194,6 +280,7 @@ int main() {
     try {
         // Create and configure the banking system
         Bank::Config config("MTBS Bank", "MTBS001", 100, 50, true);
+        config.recoverOnStart = false; // Each demo run starts from empty accounts
         Bank bank(config);
         
         // Start the banking system
@@ -206,6 +293,7 @@ int main() {
         demonstrateBasicOperations(bank);
         demonstrateConcurrentTransactions(bank);
         demonstrateRaceConditionPrevention(bank);
+        demonstratePipelinedTransactions(bank);
         demonstrateSystemMonitoring(bank);
         demonstrateErrorHandling(bank);
         
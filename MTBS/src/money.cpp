@@ -0,0 +1,241 @@
+#include "../include/money.h"
+#include <cmath>
+#include <stdexcept>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+// ============================================================================
+// OVERFLOW HELPERS
+// ============================================================================
+
+namespace {
+    bool addOverflows(int64_t a, int64_t b, int64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_add_overflow(a, b, &result);
+#else
+        if ((b > 0 && a > std::numeric_limits<int64_t>::max() - b) ||
+            (b < 0 && a < std::numeric_limits<int64_t>::min() - b)) {
+            return true;
+        }
+        result = a + b;
+        return false;
+#endif
+    }
+
+    bool subtractOverflows(int64_t a, int64_t b, int64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_sub_overflow(a, b, &result);
+#else
+        if ((b < 0 && a > std::numeric_limits<int64_t>::max() + b) ||
+            (b > 0 && a < std::numeric_limits<int64_t>::min() + b)) {
+            return true;
+        }
+        result = a - b;
+        return false;
+#endif
+    }
+
+    bool multiplyOverflows(int64_t a, int64_t b, int64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_mul_overflow(a, b, &result);
+#else
+        if (a == 0 || b == 0) {
+            result = 0;
+            return false;
+        }
+        int64_t product = static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+        if ((a == -1 && b == std::numeric_limits<int64_t>::min()) ||
+            (b == -1 && a == std::numeric_limits<int64_t>::min()) ||
+            product / b != a) {
+            return true;
+        }
+        result = product;
+        return false;
+#endif
+    }
+
+    [[noreturn]] void throwOverflow(const char* operation) {
+        throw std::overflow_error(std::string("Money overflow in ") + operation);
+    }
+
+    // Values with magnitude below 2^51 can be summed 4096 at a time without
+    // the partial sum exceeding 2^63, so such blocks need no per-add checks.
+    constexpr size_t kSumBlockSize = 4096;
+    constexpr int64_t kSafeMagnitude = int64_t(1) << 51;
+
+    // 128-bit running total (high * 2^64 + low) for Money::sumCents, so only
+    // the final result has to fit in 64 bits, not every partial sum
+    struct WideTotal {
+        uint64_t low = 0;
+        int64_t high = 0;
+
+        void add(int64_t value) {
+            uint64_t before = low;
+            low += static_cast<uint64_t>(value);
+            high += (value < 0 ? -1 : 0) + (low < before ? 1 : 0);
+        }
+
+        bool fits(int64_t& result) const {
+            bool negative = (low >> 63) != 0;
+            if (high != (negative ? -1 : 0)) {
+                return false;
+            }
+            result = static_cast<int64_t>(low);
+            return true;
+        }
+    };
+}
+
+// ============================================================================
+// MONEY IMPLEMENTATION
+// ============================================================================
+
+Money Money::fromDollars(int64_t dollars, int64_t extraCents) {
+    int64_t result;
+    if (multiplyOverflows(dollars, 100, result) || addOverflows(result, extraCents, result)) {
+        throwOverflow("fromDollars");
+    }
+    return Money(result);
+}
+
+Money Money::fromDouble(double amount) {
+    if (!std::isfinite(amount)) {
+        throw std::invalid_argument("Money amount must be a finite number");
+    }
+
+    double scaled = std::round(amount * 100.0);
+    // 2^63 is exactly representable; anything at or beyond it does not fit
+    if (scaled >= 9223372036854775808.0 || scaled < -9223372036854775808.0) {
+        throwOverflow("fromDouble");
+    }
+    return Money(static_cast<int64_t>(scaled));
+}
+
+std::string Money::toString() const {
+    std::ostringstream oss;
+    oss << *this;
+    return oss.str();
+}
+
+Money Money::operator+(Money other) const {
+    Money result;
+    if (!tryAdd(*this, other, result)) {
+        throwOverflow("addition");
+    }
+    return result;
+}
+
+Money Money::operator-(Money other) const {
+    Money result;
+    if (!trySubtract(*this, other, result)) {
+        throwOverflow("subtraction");
+    }
+    return result;
+}
+
+Money Money::operator-() const {
+    if (cents == std::numeric_limits<int64_t>::min()) {
+        throwOverflow("negation");
+    }
+    return Money(-cents);
+}
+
+Money& Money::operator+=(Money other) {
+    *this = *this + other;
+    return *this;
+}
+
+Money& Money::operator-=(Money other) {
+    *this = *this - other;
+    return *this;
+}
+
+Money Money::multipliedBy(int64_t factor) const {
+    int64_t result;
+    if (multiplyOverflows(cents, factor, result)) {
+        throwOverflow("multiplication");
+    }
+    return Money(result);
+}
+
+bool Money::tryAdd(Money a, Money b, Money& result) noexcept {
+    int64_t value;
+    if (addOverflows(a.cents, b.cents, value)) {
+        return false;
+    }
+    result = Money(value);
+    return true;
+}
+
+bool Money::trySubtract(Money a, Money b, Money& result) noexcept {
+    int64_t value;
+    if (subtractOverflows(a.cents, b.cents, value)) {
+        return false;
+    }
+    result = Money(value);
+    return true;
+}
+
+Money Money::sum(const Money* values, size_t count) {
+    // Money is layout-compatible with int64_t (see static_assert in money.h)
+    return sumCents(reinterpret_cast<const int64_t*>(values), count);
+}
+
+Money Money::sumCents(const int64_t* values, size_t count) {
+    WideTotal total;
+
+    for (size_t blockStart = 0; blockStart < count; blockStart += kSumBlockSize) {
+        size_t blockEnd = std::min(count, blockStart + kSumBlockSize);
+
+        // Branch-free pass: four independent lanes plus min/max tracking.
+        // Written so the compiler can turn it into packed 64-bit adds.
+        int64_t lane[4] = {0, 0, 0, 0};
+        int64_t minValue = 0;
+        int64_t maxValue = 0;
+        size_t i = blockStart;
+        for (; i + 4 <= blockEnd; i += 4) {
+            for (size_t l = 0; l < 4; ++l) {
+                int64_t v = values[i + l];
+                lane[l] = static_cast<int64_t>(static_cast<uint64_t>(lane[l]) + static_cast<uint64_t>(v));
+                minValue = v < minValue ? v : minValue;
+                maxValue = v > maxValue ? v : maxValue;
+            }
+        }
+        for (; i < blockEnd; ++i) {
+            int64_t v = values[i];
+            lane[0] = static_cast<int64_t>(static_cast<uint64_t>(lane[0]) + static_cast<uint64_t>(v));
+            minValue = v < minValue ? v : minValue;
+            maxValue = v > maxValue ? v : maxValue;
+        }
+
+        if (minValue > -kSafeMagnitude && maxValue < kSafeMagnitude) {
+            // No partial sum can have left the int64 range; the lanes are exact
+            total.add(lane[0] + lane[1] + lane[2] + lane[3]);
+        } else {
+            // Rare: huge values in this block, redo it into the wide total
+            for (size_t j = blockStart; j < blockEnd; ++j) {
+                total.add(values[j]);
+            }
+        }
+    }
+
+    int64_t result;
+    if (!total.fits(result)) {
+        throwOverflow("sum");
+    }
+    return Money(result);
+}
+
+std::ostream& operator<<(std::ostream& os, Money amount) {
+    int64_t cents = amount.toCents();
+    // Work in unsigned space so INT64_MIN prints correctly
+    uint64_t magnitude = cents < 0 ? (0 - static_cast<uint64_t>(cents)) : static_cast<uint64_t>(cents);
+
+    std::ostringstream oss;
+    if (cents < 0) {
+        oss << '-';
+    }
+    oss << (magnitude / 100) << '.' << std::setw(2) << std::setfill('0') << (magnitude % 100);
+    return os << oss.str();
+}
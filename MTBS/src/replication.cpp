@@ -0,0 +1,1054 @@
+#include "../include/replication.h"
+#include "../include/bank.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr char kHelloMagic[4] = {'M', 'T', 'B', 'R'};
+    constexpr size_t kFrameHeader = 5;                 // u32 payload length, u8 type
+    constexpr size_t kRecordsHeader = 36;              // First, last and primary LSN, shipped at, count
+    constexpr size_t kMaxFrameBytes = 256 << 20;
+    constexpr size_t kSnapshotChunkBytes = 256 * 1024;
+    constexpr size_t kFramesPerSend = 64;
+    constexpr std::chrono::seconds kSendTimeout{10};   // A follower that stops reading is dropped
+    constexpr std::chrono::seconds kHelloTimeout{5};
+    constexpr std::chrono::milliseconds kAcceptPoll{200};
+
+    // Where drain() finds a record's kind, flags and transaction ID (see Journal's record layout)
+    constexpr size_t kTransactionIdOffset = 16;
+    constexpr size_t kKindOffset = 56;
+    constexpr size_t kFlagsOffset = 59;
+
+    enum FrameType : uint8_t {
+        CONNECTION_CLOSED = 0,      // Follower-internal, never sent
+        HELLO = 1,
+        SNAPSHOT_BEGIN = 2,
+        SNAPSHOT_CHUNK = 3,
+        SNAPSHOT_END = 4,
+        RECORDS = 5,
+        ACK = 6
+    };
+
+    size_t roundUpToPowerOfTwo(size_t value) {
+        size_t power = 1;
+        while (power < value) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    template <typename T>
+    void put(std::string& out, size_t offset, T value) {
+        std::memcpy(&out[offset], &value, sizeof(T));
+    }
+
+    template <typename T>
+    T get(const char* data, size_t offset) {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void beginFrame(std::string& out, FrameType type) {
+        out.assign(kFrameHeader, '\0');
+        out[4] = static_cast<char>(type);
+    }
+
+    void finishFrame(std::string& out) {
+        put<uint32_t>(out, 0, static_cast<uint32_t>(out.size() - kFrameHeader));
+    }
+
+    std::string u64Frame(FrameType type, uint64_t value) {
+        std::string frame;
+        beginFrame(frame, type);
+        frame.resize(kFrameHeader + sizeof(uint64_t));
+        put<uint64_t>(frame, kFrameHeader, value);
+        finishFrame(frame);
+        return frame;
+    }
+
+    // RECORDS frame with room for records after the header (filled in by finishRecords)
+    void beginRecords(std::string& out) {
+        beginFrame(out, RECORDS);
+        out.resize(kFrameHeader + kRecordsHeader);
+    }
+
+    void finishRecords(std::string& out, uint64_t firstLsn, uint64_t lastLsn, uint64_t primaryLsn, uint32_t count) {
+        put<uint64_t>(out, kFrameHeader, firstLsn);
+        put<uint64_t>(out, kFrameHeader + 8, lastLsn);
+        put<uint64_t>(out, kFrameHeader + 16, primaryLsn);
+        put<int64_t>(out, kFrameHeader + 24, nowNs());
+        put<uint32_t>(out, kFrameHeader + 32, count);
+        finishFrame(out);
+    }
+
+    bool decodeAll(const char* data, size_t size, std::vector<JournalRecord>& records) {
+        size_t position = 0;
+        while (position < size) {
+            JournalRecord record;
+            size_t consumed = 0;
+            if (!Journal::decode(data + position, size - position, record, consumed)) {
+                return false;
+            }
+            records.push_back(std::move(record));
+            position += consumed;
+        }
+        return true;
+    }
+
+    void raiseTo(std::atomic<uint64_t>& value, uint64_t candidate) {
+        uint64_t current = value.load(std::memory_order_relaxed);
+        while (current < candidate && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Sockets (blocking; timeouts bound how long a dead peer can hold a thread)
+    // ------------------------------------------------------------------------
+
+#if defined(__linux__)
+    bool sendAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    bool receiveAll(int fd, char* data, size_t size) {
+        while (size > 0) {
+            ssize_t received = ::recv(fd, data, size, 0);
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                return false;
+            }
+            data += received;
+            size -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    void setTimeout(int fd, int option, std::chrono::milliseconds timeout) {
+        timeval value{};
+        value.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+        value.tv_usec = static_cast<suseconds_t>(timeout.count() % 1000 * 1000);
+        ::setsockopt(fd, SOL_SOCKET, option, &value, sizeof(value));
+    }
+
+    void setNoDelay(int fd) {
+        int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+
+    void shutdownSocket(int fd) {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+
+    void closeSocket(int fd) {
+        ::close(fd);
+    }
+
+    bool waitReadable(int fd, std::chrono::milliseconds timeout) {
+        pollfd entry{};
+        entry.fd = fd;
+        entry.events = POLLIN;
+        return ::poll(&entry, 1, static_cast<int>(timeout.count())) > 0;
+    }
+
+    int connectTo(const std::string& address, uint16_t port) {
+        sockaddr_in target{};
+        target.sin_family = AF_INET;
+        target.sin_port = htons(port);
+        if (inet_pton(AF_INET, address.c_str(), &target.sin_addr) != 1) {
+            return -1;
+        }
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&target), sizeof(target)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    std::string peerName(const sockaddr_in& address) {
+        char text[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &address.sin_addr, text, sizeof(text));
+        return std::string(text) + ":" + std::to_string(ntohs(address.sin_port));
+    }
+#else
+    bool sendAll(int, const char*, size_t) { return false; }
+    bool receiveAll(int, char*, size_t) { return false; }
+    void setNoDelay(int) {}
+    void shutdownSocket(int) {}
+    void closeSocket(int) {}
+    int connectTo(const std::string&, uint16_t) { return -1; }
+#endif
+
+    bool sendFrame(int fd, const std::string& frame) {
+        return sendAll(fd, frame.data(), frame.size());
+    }
+
+    bool readFrame(int fd, uint8_t& type, std::string& payload) {
+        char header[kFrameHeader];
+        if (!receiveAll(fd, header, sizeof(header))) {
+            return false;
+        }
+        uint32_t length = get<uint32_t>(header, 0);
+        if (length > kMaxFrameBytes) {
+            return false;
+        }
+        type = static_cast<uint8_t>(header[4]);
+        payload.resize(length);
+        return length == 0 || receiveAll(fd, &payload[0], length);
+    }
+}
+
+const char* replicationRoleName(ReplicationRole role) {
+    switch (role) {
+        case ReplicationRole::STANDALONE: return "STANDALONE";
+        case ReplicationRole::PRIMARY: return "PRIMARY";
+        case ReplicationRole::FOLLOWER: return "FOLLOWER";
+    }
+    return "UNKNOWN";
+}
+
+const char* replicationAckModeName(ReplicationAckMode mode) {
+    switch (mode) {
+        case ReplicationAckMode::ASYNC: return "ASYNC";
+        case ReplicationAckMode::QUORUM: return "QUORUM";
+    }
+    return "UNKNOWN";
+}
+
+// ============================================================================
+// REPLICATION LOG IMPLEMENTATION
+// ============================================================================
+
+ReplicationLog::ReplicationLog(size_t requested)
+    : capacity(roundUpToPowerOfTwo(std::max<size_t>(requested, 2))), mask(capacity - 1),
+      baseLsn(0), drainPosition(0) {
+    slots = std::make_unique<Slot[]>(capacity);
+    reset(0);
+}
+
+void ReplicationLog::reset(uint64_t lastLsn) {
+    baseLsn = lastLsn;
+    for (size_t i = 0; i < capacity; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    drainPosition.store(0, std::memory_order_release);
+}
+
+void ReplicationLog::publish(uint64_t lsn, const char* data, size_t size) {
+    if (lsn <= baseLsn) {
+        return;
+    }
+    uint64_t position = lsn - baseLsn - 1;
+    Slot& slot = slots[position & mask];
+    while (slot.sequence.load(std::memory_order_acquire) != position) {
+        std::this_thread::yield();      // A whole ring ahead of the shipper
+    }
+    slot.bytes.assign(data, size);
+    slot.sequence.store(position + 1, std::memory_order_release);
+}
+
+size_t ReplicationLog::drain(std::string& out, uint64_t& firstLsn, uint64_t& lastLsn, size_t maxRecords) {
+    uint64_t start = drainPosition.load(std::memory_order_relaxed);
+
+    // Find the longest published prefix that closes every batch transfer it opens
+    openBatches.clear();
+    size_t ready = 0;
+    size_t safe = 0;
+    while (ready < capacity && (ready < maxRecords || !openBatches.empty())) {
+        const Slot& slot = slots[(start + ready) & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != start + ready + 1) {
+            break;
+        }
+        const std::string& bytes = slot.bytes;
+        if (bytes.size() >= Journal::kHeaderSize &&
+            static_cast<uint8_t>(bytes[kKindOffset]) == static_cast<uint8_t>(JournalRecordKind::TRANSACTION)) {
+            uint8_t flags = static_cast<uint8_t>(bytes[kFlagsOffset]);
+            if (flags & Transaction::FLAG_BATCH) {
+                uint64_t id = get<uint64_t>(bytes.data(), kTransactionIdOffset);
+                auto open = std::find(openBatches.begin(), openBatches.end(), id);
+                if (flags & Transaction::FLAG_BATCH_LAST) {
+                    if (open != openBatches.end()) {
+                        openBatches.erase(open);
+                    }
+                } else if (open == openBatches.end()) {
+                    openBatches.push_back(id);
+                }
+            }
+        }
+        ++ready;
+        if (openBatches.empty()) {
+            safe = ready;
+        }
+    }
+    if (safe == 0 && ready == capacity) {
+        safe = ready;   // A batch larger than the ring: publishers wait on it, so it goes out in parts
+    }
+    if (safe == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < safe; ++i) {
+        Slot& slot = slots[(start + i) & mask];
+        out.append(slot.bytes);
+        slot.sequence.store(start + i + capacity, std::memory_order_release);
+    }
+    firstLsn = baseLsn + start + 1;
+    lastLsn = baseLsn + start + safe;
+    drainPosition.store(start + safe, std::memory_order_release);
+    return safe;
+}
+
+uint64_t ReplicationLog::getDrainedLsn() const {
+    return baseLsn + drainPosition.load(std::memory_order_acquire);
+}
+
+// ============================================================================
+// REPLICATION SERVER IMPLEMENTATION
+// ============================================================================
+
+ReplicationServer::ReplicationServer(Journal& journal, const Options& options, SnapshotSource source)
+    : journal(journal), options(options), source(std::move(source)), log(options.ringCapacity),
+      listenFd(-1), boundPort(0), running(false), windowBytes(0), quorumLsn(0), streamingFollowers(0),
+      degraded(false), degradedAt(0), shipperStop(false), shipperNudged(false),
+      batchesShipped(0), recordsShipped(0), bytesShipped(0), bootstraps(0), droppedFollowers(0),
+      quorumWaits(0), quorumTimeouts(0) {
+    this->options.quorum = std::max<size_t>(this->options.quorum, 1);
+    this->options.maxBatchRecords = std::max<size_t>(this->options.maxBatchRecords, 1);
+
+    log.reset(journal.getLastLsn());
+    journal.setReplicationLog(&log);
+    shipper = std::thread(&ReplicationServer::shipLoop, this);
+}
+
+ReplicationServer::~ReplicationServer() {
+    stop();
+    journal.setReplicationLog(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(shipperMutex);
+        shipperStop = true;
+    }
+    shipperWake.notify_all();
+    shipper.join();
+}
+
+#if defined(__linux__)
+
+void ReplicationServer::start() {
+    if (running) {
+        return;
+    }
+
+    auto fail = [this](const std::string& what) {
+        std::string message = "ReplicationServer: " + what + ": " + std::strerror(errno);
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            listenFd = -1;
+        }
+        throw BankException(BankException::ErrorType::SYSTEM_ERROR, message);
+    };
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.bindAddress.c_str(), &address.sin_addr) != 1) {
+        errno = EINVAL;
+        fail("invalid bind address " + options.bindAddress);
+    }
+
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        fail("socket");
+    }
+    int enable = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        fail("bind " + options.bindAddress + ":" + std::to_string(options.port));
+    }
+    if (::listen(listenFd, 16) != 0) {
+        fail("listen");
+    }
+    socklen_t addressLength = sizeof(address);
+    ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &addressLength);
+    boundPort = ntohs(address.sin_port);
+
+    running = true;
+    listener = std::thread(&ReplicationServer::acceptLoop, this);
+}
+
+void ReplicationServer::acceptLoop() {
+    while (running) {
+        if (!waitReadable(listenFd, kAcceptPoll)) {
+            reapSessions(false);
+            continue;
+        }
+        sockaddr_in peer{};
+        socklen_t peerLength = sizeof(peer);
+        int fd = ::accept4(listenFd, reinterpret_cast<sockaddr*>(&peer), &peerLength, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        setNoDelay(fd);
+        setTimeout(fd, SO_SNDTIMEO, kSendTimeout);
+        setTimeout(fd, SO_RCVTIMEO, kHelloTimeout);
+
+        auto session = std::make_shared<Session>();
+        session->fd = fd;
+        session->peer = peerName(peer);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sessions.push_back(session);
+        }
+        session->sender = std::thread(&ReplicationServer::sendLoop, this, session);
+        reapSessions(false);
+    }
+}
+
+#else
+
+void ReplicationServer::start() {
+    throw BankException(BankException::ErrorType::SYSTEM_ERROR,
+                        "ReplicationServer: replication needs Linux (sockets)");
+}
+
+void ReplicationServer::acceptLoop() {
+}
+
+#endif
+
+void ReplicationServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (listener.joinable()) {
+        listener.join();
+    }
+    if (listenFd >= 0) {
+        closeSocket(listenFd);
+        listenFd = -1;
+    }
+    reapSessions(true);
+}
+
+bool ReplicationServer::isRunning() const {
+    return running;
+}
+
+uint16_t ReplicationServer::getPort() const {
+    return boundPort;
+}
+
+const ReplicationServer::Options& ReplicationServer::getOptions() const {
+    return options;
+}
+
+bool ReplicationServer::waitForQuorum(uint64_t lsn) {
+    if (options.ackMode != ReplicationAckMode::QUORUM || lsn == 0 ||
+        quorumLsn.load(std::memory_order_acquire) >= lsn) {
+        return true;
+    }
+    if (degraded.load(std::memory_order_relaxed) ||
+        streamingFollowers.load(std::memory_order_relaxed) < options.quorum) {
+        return false;
+    }
+    quorumWaits.fetch_add(1, std::memory_order_relaxed);
+
+    // Ship now rather than at the end of the batch window
+    {
+        std::lock_guard<std::mutex> lock(shipperMutex);
+        shipperNudged = true;
+    }
+    shipperWake.notify_one();
+
+    auto deadline = Clock::now() + options.ackTimeout;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (quorumLsn.load(std::memory_order_acquire) < lsn) {
+        if (degraded.load(std::memory_order_relaxed) ||
+            streamingFollowers.load(std::memory_order_relaxed) < options.quorum) {
+            return false;
+        }
+        if (acksChanged.wait_until(lock, deadline) == std::cv_status::timeout &&
+            quorumLsn.load(std::memory_order_acquire) < lsn) {
+            // Stop waiting until the quorum has caught up with everything journalled so far
+            quorumTimeouts.fetch_add(1, std::memory_order_relaxed);
+            degradedAt = journal.getLastLsn();
+            degraded.store(true, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    return true;
+}
+
+ReplicationServer::Statistics ReplicationServer::getStatistics() const {
+    Statistics stats;
+    stats.shippedLsn = log.getDrainedLsn();
+    stats.batches = batchesShipped.load(std::memory_order_relaxed);
+    stats.records = recordsShipped.load(std::memory_order_relaxed);
+    stats.bytes = bytesShipped.load(std::memory_order_relaxed);
+    stats.bootstraps = bootstraps.load(std::memory_order_relaxed);
+    stats.droppedFollowers = droppedFollowers.load(std::memory_order_relaxed);
+    stats.quorumWaits = quorumWaits.load(std::memory_order_relaxed);
+    stats.quorumTimeouts = quorumTimeouts.load(std::memory_order_relaxed);
+    stats.degraded = degraded.load(std::memory_order_relaxed);
+
+    uint64_t lastLsn = journal.getLastLsn();
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::shared_ptr<Session>& session : sessions) {
+        if (session->closed) {
+            continue;
+        }
+        FollowerStatus follower;
+        follower.peer = session->peer;
+        follower.streaming = session->streaming;
+        follower.sentLsn = session->sentLsn.load(std::memory_order_relaxed);
+        follower.ackedLsn = session->ackedLsn.load(std::memory_order_relaxed);
+        follower.lagRecords = session->streaming && lastLsn > follower.ackedLsn ? lastLsn - follower.ackedLsn : 0;
+        if (!session->unacked.empty()) {
+            follower.lag = std::chrono::duration_cast<std::chrono::milliseconds>(now - session->unacked.front().second);
+        }
+        stats.followers.push_back(std::move(follower));
+    }
+    return stats;
+}
+
+void ReplicationServer::shipLoop() {
+    std::unique_lock<std::mutex> wake(shipperMutex);
+    while (!shipperStop) {
+        shipperWake.wait_for(wake, options.batchWindow, [this]() { return shipperStop || shipperNudged; });
+        shipperNudged = false;
+        wake.unlock();
+
+        for (;;) {
+            std::string frame;
+            beginRecords(frame);
+            uint64_t firstLsn = 0;
+            uint64_t lastLsn = 0;
+            size_t count = log.drain(frame, firstLsn, lastLsn, options.maxBatchRecords);
+            if (count == 0) {
+                break;
+            }
+            finishRecords(frame, firstLsn, lastLsn, lastLsn, static_cast<uint32_t>(count));
+            batchesShipped.fetch_add(1, std::memory_order_relaxed);
+            recordsShipped.fetch_add(count, std::memory_order_relaxed);
+            bytesShipped.fetch_add(frame.size(), std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            bool wanted = std::any_of(sessions.begin(), sessions.end(), [](const std::shared_ptr<Session>& session) {
+                return session->registered && !session->closed;
+            });
+            if (wanted) {
+                windowBytes += frame.size();
+                window.push_back({firstLsn, lastLsn, std::make_shared<const std::string>(std::move(frame)), Clock::now()});
+                trimWindowLocked();
+                windowChanged.notify_all();
+            }
+        }
+        wake.lock();
+    }
+}
+
+void ReplicationServer::trimWindowLocked() {
+    while (!window.empty()) {
+        const Batch& front = window.front();
+        bool needed = false;
+        for (const std::shared_ptr<Session>& session : sessions) {
+            needed = needed || (session->registered && !session->closed && session->nextLsn <= front.lastLsn);
+        }
+        if (needed && windowBytes <= options.maxWindowBytes) {
+            return;
+        }
+        if (needed) {
+            // Too far behind to catch up from the window: it bootstraps again on reconnecting
+            for (const std::shared_ptr<Session>& session : sessions) {
+                if (session->registered && !session->closed && session->nextLsn <= front.lastLsn) {
+                    closeSession(*session);
+                    droppedFollowers.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            updateQuorumLocked();
+        }
+        windowBytes -= front.frame->size();
+        window.pop_front();
+    }
+}
+
+void ReplicationServer::sendLoop(const std::shared_ptr<Session>& session) {
+    Session& s = *session;
+    uint8_t type = 0;
+    std::string payload;
+    bool ok = readFrame(s.fd, type, payload) && type == HELLO && payload.size() >= sizeof(kHelloMagic) &&
+              std::memcmp(payload.data(), kHelloMagic, sizeof(kHelloMagic)) == 0;
+#if defined(__linux__)
+    if (ok) {
+        setTimeout(s.fd, SO_RCVTIMEO, std::chrono::milliseconds(0));
+    }
+#endif
+    ok = ok && bootstrap(s);
+    if (ok) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            s.streaming = !s.closed;
+            updateQuorumLocked();
+        }
+        s.reader = std::thread(&ReplicationServer::ackLoop, this, session);
+    }
+
+    // Stream the window; acks come back on the reader, so several batches are in flight at once
+    std::vector<std::shared_ptr<const std::string>> frames;
+    while (ok) {
+        frames.clear();
+        uint64_t sent = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            bool ready = windowChanged.wait_for(lock, options.heartbeatInterval, [this, &s]() {
+                return s.closed || (!window.empty() && window.back().lastLsn >= s.nextLsn);
+            });
+            if (s.closed) {
+                break;
+            }
+            if (ready) {
+                auto next = std::lower_bound(window.begin(), window.end(), s.nextLsn,
+                                             [](const Batch& batch, uint64_t lsn) { return batch.lastLsn < lsn; });
+                for (; next != window.end() && frames.size() < kFramesPerSend; ++next) {
+                    frames.push_back(next->frame);
+                    s.unacked.emplace_back(next->lastLsn, next->shippedAt);
+                    s.nextLsn = next->lastLsn + 1;
+                }
+                sent = s.nextLsn - 1;
+                trimWindowLocked();
+            }
+        }
+
+        if (frames.empty()) {
+            std::string heartbeat;
+            beginRecords(heartbeat);
+            finishRecords(heartbeat, 0, 0, log.getDrainedLsn(), 0);
+            ok = sendFrame(s.fd, heartbeat);
+            continue;
+        }
+        for (const std::shared_ptr<const std::string>& frame : frames) {
+            ok = ok && sendFrame(s.fd, *frame);
+        }
+        s.sentLsn.store(sent, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closeSession(s);
+    }
+    if (s.reader.joinable()) {
+        s.reader.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        s.streaming = false;
+        updateQuorumLocked();
+    }
+    s.finished = true;
+}
+
+bool ReplicationServer::bootstrap(Session& session) {
+    bool ok = true;
+    bool begun = false;
+    uint64_t cutLsn = 0;
+    uint64_t accountsSent = 0;
+    std::string chunk;
+    std::string encoded;
+    beginFrame(chunk, SNAPSHOT_CHUNK);
+
+    auto flush = [&]() {
+        if (!begun) {
+            ok = ok && sendFrame(session.fd, u64Frame(SNAPSHOT_BEGIN, cutLsn));
+            begun = true;
+        }
+        if (chunk.size() > kFrameHeader) {
+            finishFrame(chunk);
+            ok = ok && sendFrame(session.fd, chunk);
+            beginFrame(chunk, SNAPSHOT_CHUNK);
+        }
+    };
+    auto cut = [&]() {
+        // Records drained before this point are all at or below the cut; later ones are kept for us
+        std::lock_guard<std::mutex> lock(mutex);
+        cutLsn = journal.getLastLsn();
+        session.nextLsn = cutLsn + 1;
+        session.registered = true;
+        return cutLsn;
+    };
+    auto emit = [&](const JournalRecord& record) {
+        if (!ok || session.closed) {
+            ok = false;
+            return;
+        }
+        // Chunks end between accounts, so an account and its history arrive in one frame
+        if (record.kind == JournalRecordKind::ACCOUNT_OPENED) {
+            if (chunk.size() >= kSnapshotChunkBytes) {
+                flush();
+            }
+            ++accountsSent;
+        }
+        Journal::encode(record, encoded);
+        chunk += encoded;
+    };
+
+    try {
+        source(cut, emit);
+    } catch (const std::exception&) {
+        return false;
+    }
+    flush();
+    ok = ok && sendFrame(session.fd, u64Frame(SNAPSHOT_END, accountsSent));
+    if (ok) {
+        bootstraps.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ok;
+}
+
+void ReplicationServer::ackLoop(const std::shared_ptr<Session>& session) {
+    Session& s = *session;
+    uint8_t type = 0;
+    std::string payload;
+    while (!s.closed && readFrame(s.fd, type, payload)) {
+        if (type != ACK || payload.size() < sizeof(uint64_t)) {
+            break;
+        }
+        uint64_t applied = get<uint64_t>(payload.data(), 0);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (applied > s.ackedLsn.load(std::memory_order_relaxed)) {
+            s.ackedLsn.store(applied, std::memory_order_relaxed);
+        }
+        while (!s.unacked.empty() && s.unacked.front().first <= applied) {
+            s.unacked.pop_front();
+        }
+        updateQuorumLocked();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    closeSession(s);
+}
+
+void ReplicationServer::closeSession(Session& session) {
+    if (!session.closed.exchange(true)) {
+        shutdownSocket(session.fd);     // Wakes its sender and reader; the fd is closed when reaped
+    }
+    windowChanged.notify_all();
+    acksChanged.notify_all();
+}
+
+void ReplicationServer::reapSessions(bool all) {
+    std::vector<std::shared_ptr<Session>> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = sessions.begin(); it != sessions.end();) {
+            if (all) {
+                closeSession(**it);
+            }
+            if (all || (*it)->finished) {
+                done.push_back(std::move(*it));
+                it = sessions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        updateQuorumLocked();
+        trimWindowLocked();
+    }
+    for (const std::shared_ptr<Session>& session : done) {
+        session->sender.join();
+        closeSocket(session->fd);
+    }
+}
+
+void ReplicationServer::updateQuorumLocked() {
+    std::vector<uint64_t> acked;
+    for (const std::shared_ptr<Session>& session : sessions) {
+        if (session->streaming && !session->closed) {
+            acked.push_back(session->ackedLsn.load(std::memory_order_relaxed));
+        }
+    }
+    streamingFollowers.store(acked.size(), std::memory_order_relaxed);
+    if (acked.size() >= options.quorum) {
+        // The quorum-th highest ack: that many followers have applied everything up to it
+        std::nth_element(acked.begin(), acked.begin() + (options.quorum - 1), acked.end(), std::greater<uint64_t>());
+        uint64_t applied = acked[options.quorum - 1];
+        if (applied > quorumLsn.load(std::memory_order_relaxed)) {
+            quorumLsn.store(applied, std::memory_order_release);
+        }
+        if (degraded.load(std::memory_order_relaxed) && applied >= degradedAt) {
+            degraded.store(false, std::memory_order_relaxed);
+        }
+    }
+    acksChanged.notify_all();
+}
+
+// ============================================================================
+// REPLICATION FOLLOWER IMPLEMENTATION
+// ============================================================================
+
+ReplicationFollower::ReplicationFollower(const Options& options, ResetHook reset, ApplyHook apply)
+    : options(options), reset(std::move(reset)), apply(std::move(apply)), running(false), stopping(false),
+      socketFd(-1), receiverDone(false), connected(false), streaming(false), appliedLsn(0), primaryLsn(0),
+      highestLsn(0), bootstrapCut(0), applyDelayNs(0), batchesApplied(0), recordsApplied(0),
+      bootstrapsApplied(0), connections(0) {
+    this->options.maxQueuedFrames = std::max<size_t>(this->options.maxQueuedFrames, 1);
+}
+
+ReplicationFollower::~ReplicationFollower() {
+    stop();
+}
+
+void ReplicationFollower::start() {
+#if !defined(__linux__)
+    throw BankException(BankException::ErrorType::SYSTEM_ERROR,
+                        "ReplicationFollower: replication needs Linux (sockets)");
+#endif
+    if (running) {
+        return;
+    }
+    stopping = false;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        receiverDone = false;
+    }
+    running = true;
+    receiver = std::thread(&ReplicationFollower::receiveLoop, this);
+    applier = std::thread(&ReplicationFollower::applyLoop, this);
+}
+
+void ReplicationFollower::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(socketMutex);
+        if (socketFd >= 0) {
+            shutdownSocket(socketFd);
+        }
+    }
+    queueChanged.notify_all();
+    receiver.join();
+    applier.join();
+}
+
+bool ReplicationFollower::isRunning() const {
+    return running;
+}
+
+uint64_t ReplicationFollower::getHighestLsn() const {
+    return highestLsn.load(std::memory_order_acquire);
+}
+
+const ReplicationFollower::Options& ReplicationFollower::getOptions() const {
+    return options;
+}
+
+ReplicationFollower::Statistics ReplicationFollower::getStatistics() const {
+    Statistics stats;
+    stats.connected = connected.load(std::memory_order_relaxed);
+    stats.streaming = streaming.load(std::memory_order_relaxed);
+    stats.appliedLsn = appliedLsn.load(std::memory_order_relaxed);
+    stats.primaryLsn = std::max(primaryLsn.load(std::memory_order_relaxed), stats.appliedLsn);
+    stats.lagRecords = stats.primaryLsn - stats.appliedLsn;
+    stats.applyDelay = std::chrono::milliseconds(applyDelayNs.load(std::memory_order_relaxed) / 1000000);
+    stats.batches = batchesApplied.load(std::memory_order_relaxed);
+    stats.records = recordsApplied.load(std::memory_order_relaxed);
+    stats.bootstraps = bootstrapsApplied.load(std::memory_order_relaxed);
+    stats.connections = connections.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ReplicationFollower::receiveLoop() {
+    auto pause = [this]() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueChanged.wait_for(lock, options.reconnectDelay, [this]() { return stopping.load(); });
+    };
+
+    while (!stopping) {
+        int fd = connectTo(options.primaryAddress, options.primaryPort);
+        if (fd < 0) {
+            pause();
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(socketMutex);
+            if (stopping) {
+                closeSocket(fd);
+                break;
+            }
+            socketFd = fd;
+        }
+        setNoDelay(fd);
+        connections.fetch_add(1, std::memory_order_relaxed);
+        connected = true;
+
+        std::string hello;
+        beginFrame(hello, HELLO);
+        hello.append(kHelloMagic, sizeof(kHelloMagic));
+        finishFrame(hello);
+        bool ok = sendFrame(fd, hello);
+
+        Frame frame;
+        frame.fd = fd;
+        while (ok && !stopping && readFrame(fd, frame.type, frame.payload)) {
+            if (frame.type == RECORDS && frame.payload.size() >= kRecordsHeader) {
+                raiseTo(primaryLsn, get<uint64_t>(frame.payload.data(), 16));
+                if (get<uint32_t>(frame.payload.data(), 32) == 0) {
+                    continue;   // Heartbeat
+                }
+            }
+            ok = enqueue(std::move(frame));
+            frame = Frame();
+            frame.fd = fd;
+        }
+
+        connected = false;
+        streaming = false;
+        {
+            std::lock_guard<std::mutex> lock(socketMutex);
+            shutdownSocket(fd);
+            socketFd = -1;
+        }
+        enqueue(Frame{CONNECTION_CLOSED, std::string(), fd});
+        if (!stopping) {
+            pause();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    receiverDone = true;
+    queueChanged.notify_all();
+}
+
+bool ReplicationFollower::enqueue(Frame frame) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    if (frame.type != CONNECTION_CLOSED) {
+        queueChanged.wait(lock, [this]() { return stopping || queue.size() < options.maxQueuedFrames; });
+        if (stopping) {
+            return false;
+        }
+    }
+    queue.push_back(std::move(frame));
+    queueChanged.notify_all();
+    return true;
+}
+
+void ReplicationFollower::applyLoop() {
+    for (;;) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueChanged.wait(lock, [this]() { return !queue.empty() || receiverDone; });
+            if (queue.empty()) {
+                return;
+            }
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        queueChanged.notify_all();
+
+        if (frame.type == CONNECTION_CLOSED) {
+            closeSocket(frame.fd);      // Every frame it carried has been applied
+        } else if (!stopping) {
+            applyFrame(frame);
+        }
+    }
+}
+
+void ReplicationFollower::applyFrame(Frame& frame) {
+    const std::string& payload = frame.payload;
+    std::vector<JournalRecord> records;
+    bool ok = true;
+    try {
+        switch (frame.type) {
+            case SNAPSHOT_BEGIN:
+                ok = payload.size() >= sizeof(uint64_t);
+                if (ok) {
+                    bootstrapCut = get<uint64_t>(payload.data(), 0);
+                    streaming = false;
+                    appliedLsn.store(0, std::memory_order_relaxed);
+                    highestLsn.store(bootstrapCut, std::memory_order_release);
+                    reset(bootstrapCut);
+                }
+                break;
+            case SNAPSHOT_CHUNK:
+                ok = decodeAll(payload.data(), payload.size(), records);
+                if (ok) {
+                    for (const JournalRecord& record : records) {
+                        raiseTo(highestLsn, record.lsn);
+                    }
+                    apply(records, true);
+                }
+                break;
+            case SNAPSHOT_END:
+                appliedLsn.store(bootstrapCut, std::memory_order_relaxed);
+                streaming = true;
+                bootstrapsApplied.fetch_add(1, std::memory_order_relaxed);
+                ok = sendFrame(frame.fd, u64Frame(ACK, bootstrapCut));
+                break;
+            case RECORDS: {
+                ok = payload.size() >= kRecordsHeader &&
+                     decodeAll(payload.data() + kRecordsHeader, payload.size() - kRecordsHeader, records);
+                if (!ok) {
+                    break;
+                }
+                uint64_t lastLsn = get<uint64_t>(payload.data(), 8);
+                int64_t shippedAt = get<int64_t>(payload.data(), 24);
+                raiseTo(highestLsn, lastLsn);
+                apply(records, false);
+                appliedLsn.store(lastLsn, std::memory_order_relaxed);
+                applyDelayNs.store(std::max<int64_t>(nowNs() - shippedAt, 0), std::memory_order_relaxed);
+                batchesApplied.fetch_add(1, std::memory_order_relaxed);
+                recordsApplied.fetch_add(records.size(), std::memory_order_relaxed);
+                sendFrame(frame.fd, u64Frame(ACK, lastLsn));    // A lost ack only delays the primary
+                break;
+            }
+            default:
+                ok = false;
+                break;
+        }
+    } catch (const std::exception&) {
+        ok = false;
+    }
+
+    if (!ok) {
+        // Undecodable or unappliable: drop the connection and bootstrap again
+        shutdownSocket(frame.fd);
+    }
+}
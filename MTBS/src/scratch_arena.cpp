@@ -0,0 +1,58 @@
+#include "../include/scratch_arena.h"
+#include <algorithm>
+#include <cstdint>
+
+// ============================================================================
+// SCRATCH ARENA IMPLEMENTATION
+// ============================================================================
+
+ScratchArena& ScratchArena::local() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+void ScratchArena::rewind(Mark position) noexcept {
+    current = position.block;
+    offset = position.offset;
+}
+
+size_t ScratchArena::reservedBytes() const noexcept {
+    size_t total = 0;
+    for (const Block& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+    // Blocks past the current one are free again after a rewind: move on to them
+    for (; current < blocks.size(); ++current, offset = 0) {
+        if (void* carved = carve(blocks[current], bytes, alignment)) {
+            return carved;
+        }
+        if (offset == 0) {
+            break;  // Too small even when empty: replaced below
+        }
+    }
+
+    // Oversized requests get a block of their own, sized to fit
+    size_t size = std::max(kBlockSize, bytes + alignment);
+    Block block{std::unique_ptr<unsigned char[]>(new unsigned char[size]), size};
+    if (current < blocks.size()) {
+        blocks[current] = std::move(block);
+    } else {
+        blocks.push_back(std::move(block));
+    }
+    offset = 0;
+    return carve(blocks[current], bytes, alignment);
+}
+
+void* ScratchArena::carve(Block& block, size_t bytes, size_t alignment) noexcept {
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+    uintptr_t start = (base + offset + alignment - 1) / alignment * alignment;
+    if (start + bytes > base + block.size) {
+        return nullptr;
+    }
+    offset = static_cast<size_t>(start + bytes - base);
+    return reinterpret_cast<void*>(start);
+}
@@ -0,0 +1,12 @@
+#include "../include/sharded_counter.h"
+
+namespace {
+    std::atomic<size_t> nextSlot(0);
+}
+
+namespace ShardedCounterSlots {
+    size_t threadSlot() {
+        thread_local size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % kSlotCount;
+        return slot;
+    }
+}
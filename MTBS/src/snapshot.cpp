@@ -0,0 +1,188 @@
+#include "../include/snapshot.h"
+#include "../include/journal.h"
+#include "../include/async_file_writer.h"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+    constexpr char kMagic[8] = {'M', 'T', 'B', 'S', 'S', 'N', 'P', '1'};
+    constexpr uint32_t kVersion = 3;
+    constexpr size_t kVersion1HeaderSize = 48;
+    constexpr size_t kHeaderSize = 56;
+    constexpr size_t kVersion2EntryHeaderSize = 20;
+    constexpr size_t kEntryHeaderSize = 24;
+    constexpr size_t kMaxStringLength = 4096;
+
+    template <typename T>
+    void put(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T get(const char* data, size_t offset) {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    bool readFile(const std::string& path, std::vector<char>& data) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::streamsize size = file.tellg();
+        file.seekg(0);
+        data.resize(static_cast<size_t>(size > 0 ? size : 0));
+        return size <= 0 || static_cast<bool>(file.read(data.data(), size));
+    }
+
+    // Returns the header size of the file's version, or 0 if it is not a snapshot
+    size_t parseHeader(const char* data, size_t size, SnapshotData& snapshot, uint64_t& entryCount, 
+                       uint32_t& version) {
+        if (size < kVersion1HeaderSize || std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+            return 0;
+        }
+        version = get<uint32_t>(data, 8);
+        size_t headerSize = version == 1 ? kVersion1HeaderSize : kHeaderSize;
+        if (version < 1 || version > kVersion || size < headerSize) {
+            return 0;
+        }
+        snapshot.snapshotLsn = get<uint64_t>(data, 16);
+        snapshot.lastTransactionId = get<uint64_t>(data, 24);
+        entryCount = get<uint64_t>(data, 32);
+        snapshot.createdAt = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(get<int64_t>(data, 40))));
+        snapshot.nextAccountOrdinal = version == 1 ? 0 : get<uint64_t>(data, 48);
+        return headerSize;
+    }
+}
+
+// ============================================================================
+// SNAPSHOT IMPLEMENTATION
+// ============================================================================
+
+namespace Snapshot {
+    bool write(const std::string& path, const SnapshotData& snapshot) {
+        std::string image;
+        image.reserve(kHeaderSize + snapshot.entries.size() * (kEntryHeaderSize + 32) + 4);
+
+        image.append(kMagic, sizeof(kMagic));
+        put<uint32_t>(image, kVersion);
+        put<uint32_t>(image, 0);
+        put<uint64_t>(image, snapshot.snapshotLsn);
+        put<uint64_t>(image, snapshot.lastTransactionId);
+        put<uint64_t>(image, snapshot.entries.size());
+        put<int64_t>(image, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                snapshot.createdAt.time_since_epoch()).count());
+        put<uint64_t>(image, snapshot.nextAccountOrdinal);
+
+        std::string encoded;
+        for (const SnapshotEntry& entry : snapshot.entries) {
+            size_t accountLength = std::min(entry.accountNumber.size(), kMaxStringLength);
+            size_t holderLength = std::min(entry.holderName.size(), kMaxStringLength);
+            put<uint64_t>(image, entry.lastLsn);
+            put<int64_t>(image, entry.balance.toCents());
+            put<uint16_t>(image, static_cast<uint16_t>(accountLength));
+            put<uint16_t>(image, static_cast<uint16_t>(holderLength));
+            put<uint32_t>(image, static_cast<uint32_t>(entry.history.size()));
+            image.append(entry.accountNumber.data(), accountLength);
+            image.append(entry.holderName.data(), holderLength);
+            for (const JournalRecord& record : entry.history) {
+                Journal::encode(record, encoded);
+                image.append(encoded);
+            }
+        }
+        put<uint32_t>(image, Journal::crc32(image.data(), image.size()));
+
+        // Write and sync the new image next to the old one, then swap it in
+        std::string temporaryPath = path + ".tmp";
+        std::remove(temporaryPath.c_str());
+        {
+            AsyncFileWriter::Options options;
+            options.durability = AsyncFileWriter::Durability::ASYNC;
+            AsyncFileWriter out(temporaryPath, options);
+            if (!out.isOpen()) {
+                return false;
+            }
+            out.append(image);
+            out.flush();
+        }
+
+#ifdef _WIN32
+        std::remove(path.c_str()); // rename does not replace on Windows
+#endif
+        return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+    }
+
+    bool read(const std::string& path, SnapshotData& snapshot) {
+        std::vector<char> data;
+        if (!readFile(path, data) || data.size() < kVersion1HeaderSize + 4) {
+            return false;
+        }
+
+        size_t bodySize = data.size() - 4;
+        if (get<uint32_t>(data.data(), bodySize) != Journal::crc32(data.data(), bodySize)) {
+            return false;
+        }
+
+        uint64_t entryCount = 0;
+        uint32_t version = 0;
+        size_t headerSize = parseHeader(data.data(), bodySize, snapshot, entryCount, version);
+        if (headerSize == 0) {
+            return false;
+        }
+
+        size_t entryHeaderSize = version < 3 ? kVersion2EntryHeaderSize : kEntryHeaderSize;
+        snapshot.entries.clear();
+        snapshot.entries.reserve(static_cast<size_t>(std::min<uint64_t>(entryCount, bodySize / entryHeaderSize)));
+        size_t offset = headerSize;
+        for (uint64_t i = 0; i < entryCount; ++i) {
+            if (offset + entryHeaderSize > bodySize) {
+                return false;
+            }
+            size_t accountLength = get<uint16_t>(data.data(), offset + 16);
+            size_t holderLength = get<uint16_t>(data.data(), offset + 18);
+            uint32_t historyCount = version < 3 ? 0 : get<uint32_t>(data.data(), offset + 20);
+            if (offset + entryHeaderSize + accountLength + holderLength > bodySize) {
+                return false;
+            }
+
+            SnapshotEntry entry;
+            entry.lastLsn = get<uint64_t>(data.data(), offset);
+            entry.balance = Money::fromCents(get<int64_t>(data.data(), offset + 8));
+            const char* strings = data.data() + offset + entryHeaderSize;
+            entry.accountNumber.assign(strings, accountLength);
+            entry.holderName.assign(strings + accountLength, holderLength);
+            offset += entryHeaderSize + accountLength + holderLength;
+
+            entry.history.resize(std::min<size_t>(historyCount, (bodySize - offset) / Journal::kHeaderSize));
+            if (entry.history.size() != historyCount) {
+                return false;
+            }
+            for (JournalRecord& record : entry.history) {
+                size_t consumed = 0;
+                if (!Journal::decode(data.data() + offset, bodySize - offset, record, consumed)) {
+                    return false;
+                }
+                offset += consumed;
+            }
+            snapshot.entries.push_back(std::move(entry));
+        }
+        return offset == bodySize;
+    }
+
+    bool readHeader(const std::string& path, SnapshotData& snapshot) {
+        std::ifstream file(path, std::ios::binary);
+        char header[kHeaderSize];
+        if (!file.is_open()) {
+            return false;
+        }
+        file.read(header, sizeof(header));  // A version 1 file may be shorter than this
+        uint64_t entryCount = 0;
+        uint32_t version = 0;
+        return parseHeader(header, static_cast<size_t>(file.gcount()), snapshot, entryCount, version) != 0;
+    }
+}
@@ -0,0 +1,95 @@
+#include "../include/string_table.h"
+#include <mutex>
+#include <stdexcept>
+
+// ============================================================================
+// STRING TABLE IMPLEMENTATION
+// ============================================================================
+
+StringTable::StringTable()
+    : chunks(new std::atomic<std::string*>[kMaxChunks]), count(0) {
+    for (size_t i = 0; i < kMaxChunks; ++i) {
+        chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+StringTable::~StringTable() {
+    for (size_t i = 0; i < kMaxChunks; ++i) {
+        delete[] chunks[i].load(std::memory_order_relaxed);
+    }
+}
+
+uint32_t StringTable::intern(const std::string& value) {
+    return internUpTo(value, kNoString);
+}
+
+uint32_t StringTable::internBounded(const std::string& value, size_t limit) {
+    return internUpTo(value, limit);
+}
+
+uint32_t StringTable::internUpTo(const std::string& value, size_t limit) {
+    if (value.empty()) {
+        return kNoString;
+    }
+
+    // Fast path: already interned
+    {
+        std::shared_lock<std::shared_mutex> lock(indexMutex);
+        auto it = index.find(std::string_view(value));
+        if (it != index.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    auto it = index.find(std::string_view(value));
+    if (it != index.end()) {
+        return it->second;
+    }
+
+    uint32_t id = count.load(std::memory_order_relaxed);
+    if (id >= limit) {
+        return kNoString;
+    }
+    if (id >= kNoString) {
+        throw std::length_error("StringTable is full");
+    }
+
+    size_t chunkIndex = id >> kChunkBits;
+    std::string* chunk = chunks[chunkIndex].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new std::string[kChunkSize];
+        chunks[chunkIndex].store(chunk, std::memory_order_release);
+    }
+
+    std::string& slot = chunk[id & (kChunkSize - 1)];
+    slot = value;
+    index.emplace(std::string_view(slot), id);
+
+    // Publishes the new entry to lock-free lookups
+    count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+const std::string& StringTable::lookup(uint32_t id) const {
+    static const std::string empty;
+    if (id == kNoString || id >= count.load(std::memory_order_acquire)) {
+        return empty;
+    }
+    std::string* chunk = chunks[id >> kChunkBits].load(std::memory_order_acquire);
+    return chunk[id & (kChunkSize - 1)];
+}
+
+size_t StringTable::size() const {
+    return count.load(std::memory_order_acquire);
+}
+
+StringTable& StringTable::accountNumbers() {
+    static StringTable table;
+    return table;
+}
+
+StringTable& StringTable::descriptions() {
+    static StringTable table;
+    return table;
+}
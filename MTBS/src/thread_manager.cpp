@@ -1,121 +1,394 @@
 #include "../include/thread_manager.h"
+#include "../include/latency_histogram.h"
+#include "../include/slab_allocator.h"
 #include <iostream>
 #include <algorithm>
 #include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <cstdlib>
+#endif
 
 // ============================================================================
 // THREAD POOL IMPLEMENTATION
 // ============================================================================
 
-ThreadPool::Task::Task(const std::function<void()>& func, const std::string& desc, int prio)
-    : function(func), description(desc), priority(prio) {
+namespace {
+    // Identifies the pool and worker slot of the calling thread, if any
+    thread_local ThreadPool* currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+
+    using TaskSlots = SlabPool<sizeof(ThreadPool::Task), alignof(ThreadPool::Task)>;
+    
+    uint64_t nextRandom(uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+    
+#if defined(__linux__)
+    // NUMA node of a CPU, from its node<N> entry in sysfs (-1 if the kernel does not say)
+    int cpuNode(int cpu) {
+        std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        DIR* directory = ::opendir(path.c_str());
+        if (!directory) {
+            return -1;
+        }
+        int node = -1;
+        while (dirent* entry = ::readdir(directory)) {
+            if (std::strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+                node = std::atoi(entry->d_name + 4);
+                break;
+            }
+        }
+        ::closedir(directory);
+        return node;
+    }
+#endif
+}
+
+ThreadPool::Task::Task(UniqueFunction func, const std::string& desc, int prio)
+    : function(std::move(func)), description(desc), priority(prio) {
 }
 
-ThreadPool::ThreadPool(size_t threadCount) 
-    : running(false), activeThreads(0) {
+ThreadPool::ThreadPool(size_t threadCount, size_t injectionCapacity, bool pinWorkers) 
+    : threadCount(threadCount == 0 ? 1 : threadCount), pinned(pinWorkers), monitor(nullptr),
+      pendingTasks(0), sleepingWorkers(0), running(false), activeThreads(0) {
     
-    // Create worker threads
-    for (size_t i = 0; i < threadCount; ++i) {
-        createWorker();
+    for (size_t band = 0; band < kPriorityBands; ++band) {
+        injection[band] = std::make_unique<MpmcRing<Task*>>(injectionCapacity);
+    }
+    inboxes.reset(new Inbox[this->threadCount]);
+    for (size_t i = 0; i < this->threadCount; ++i) {
+        inboxes[i].tasks = std::make_unique<MpmcRing<Task*>>(injectionCapacity);
+    }
+    if (pinned) {
+        placeWorkers();
     }
 }
 
 ThreadPool::~ThreadPool() {
     stop();
+    drainRemainingTasks(); // Anything submitted while stop() was in progress
 }
 
 void ThreadPool::start() {
     std::lock_guard<std::mutex> lock(poolMutex);
     if (!running) {
         running = true;
-        condition.notify_all();
+        
+        // Workers are (re)created on every start, so stop() followed by
+        // start() gives a fully working pool again
+        for (size_t i = 0; i < threadCount; ++i) {
+            createWorker();
+        }
     }
 }
 
 void ThreadPool::stop() {
     {
         std::lock_guard<std::mutex> lock(poolMutex);
+        if (!running) {
+            return;
+        }
         running = false;
     }
     condition.notify_all();
     
     // Wait for all worker threads to finish
     for (auto& worker : workers) {
-        if (worker && worker->joinable()) {
-            worker->join();
+        if (worker->thread.joinable()) {
+            worker->thread.join();
         }
     }
+    
+    // Tasks that raced with stop() are still owed a run (their futures may be waited on)
+    drainRemainingTasks();
     workers.clear();
 }
 
 bool ThreadPool::submitTask(const std::function<void()>& task, const std::string& description) {
-    std::lock_guard<std::mutex> lock(poolMutex);
+    return submitTask(UniqueFunction(task), description, 0);
+}
+
+bool ThreadPool::submitTask(UniqueFunction task, const std::string& description, int priority) {
+    if (!running) {
+        return false;
+    }
+    
+    size_t band = static_cast<size_t>(bandForPriority(priority));
+    Task* node = makeTask(std::move(task), description, priority);
+    
+    // Count before publishing so a parked worker never misses it
+    pendingTasks.fetch_add(1, std::memory_order_seq_cst);
+    
+    if (currentPool == this) {
+        workers[currentWorker]->deques[band].push(node);
+    } else {
+        while (!injection[band]->tryPush(node)) {
+            std::this_thread::yield(); // Ring full: workers are draining it
+        }
+    }
     
+    wakeWorker();
+    return true;
+}
+
+bool ThreadPool::submitToWorker(size_t worker, UniqueFunction task, const std::string& description) {
     if (!running) {
         return false;
     }
     
-    // Create task with default priority
-    Task newTask(task, description, 0);
-    taskQueue.push(newTask);
+    Inbox& inbox = inboxes[worker % threadCount];
+    Task* node = makeTask(std::move(task), description, 0);
     
-    // Notify a waiting worker thread
-    condition.notify_one();
+    // Count before publishing, then look at the flag the worker sets before it parks
+    inbox.pending.fetch_add(1, std::memory_order_seq_cst);
+    while (!inbox.tasks->tryPush(node)) {
+        std::this_thread::yield(); // Inbox full: its worker is draining it
+    }
+    if (inbox.sleeping.load(std::memory_order_seq_cst)) {
+        // Parked workers share one condition; the others see nothing for them and park again
+        ThreadMonitor::lockProfiled(poolMutex, ThreadMonitor::LockSite::POOL);
+        std::lock_guard<std::mutex> lock(poolMutex, std::adopt_lock);
+        condition.notify_all();
+    }
     return true;
 }
 
+void ThreadPool::setMonitor(ThreadMonitor* threadMonitor) {
+    monitor = threadMonitor;
+}
+
 size_t ThreadPool::getActiveThreadCount() const {
     return activeThreads.load();
 }
 
 size_t ThreadPool::getQueueSize() const {
-    std::lock_guard<std::mutex> lock(poolMutex);
-    return taskQueue.size();
+    size_t queued = pendingTasks.load();
+    for (size_t i = 0; i < threadCount; ++i) {
+        queued += inboxes[i].pending.load(std::memory_order_relaxed);
+    }
+    return queued;
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return threadCount;
 }
 
 bool ThreadPool::isRunning() const {
     return running.load();
 }
 
+bool ThreadPool::isPinned() const {
+    return pinned && !workerCpus.empty();
+}
+
+int ThreadPool::getWorkerCpu(size_t worker) const {
+    return worker < workerCpus.size() ? workerCpus[worker] : -1;
+}
+
+int ThreadPool::getWorkerNode(size_t worker) const {
+    return worker < workerNodes.size() ? workerNodes[worker] : -1;
+}
+
+size_t ThreadPool::currentWorkerIndex() {
+    return currentPool ? currentWorker : SIZE_MAX;
+}
+
+ThreadPool::PriorityBand ThreadPool::bandForPriority(int priority) {
+    if (priority > 0) return PriorityBand::HIGH;
+    if (priority < 0) return PriorityBand::LOW;
+    return PriorityBand::NORMAL;
+}
+
 void ThreadPool::createWorker() {
-    auto worker = std::make_unique<std::thread>([this]() {
-        workerFunction();
-    });
+    size_t index = workers.size();
+    auto worker = std::make_unique<Worker>();
+    worker->stealSeed = 0x9E3779B97F4A7C15ull * (index + 1);
     workers.push_back(std::move(worker));
+    
+    // Start the thread only once the slot is in place
+    workers.back()->thread = std::thread([this, index]() {
+        workerFunction(index);
+    });
+    
+#if defined(__linux__)
+    if (index < workerCpus.size()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(workerCpus[index], &cpus);
+        ::pthread_setaffinity_np(workers.back()->thread.native_handle(), sizeof(cpus), &cpus);
+    }
+#endif
 }
 
-void ThreadPool::workerFunction() {
-    while (running) {
-        Task task;
-        {
-            std::unique_lock<std::mutex> lock(poolMutex);
-            
-            // Wait for a task or stop signal
-            condition.wait(lock, [this]() {
-                return !running || !taskQueue.empty();
-            });
-            
-            if (!running && taskQueue.empty()) {
-                break;
-            }
-            
-            if (!taskQueue.empty()) {
-                task = taskQueue.top();
-                taskQueue.pop();
-                activeThreads++;
-            }
+// One CPU per worker slot from the process's affinity mask, node by node; more
+// workers than CPUs wrap around
+void ThreadPool::placeWorkers() {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (::sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return;
+    }
+    std::vector<std::pair<int, int>> cpus;  // Node, CPU
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpus.emplace_back(cpuNode(cpu), cpu);
+        }
+    }
+    if (cpus.empty()) {
+        return;
+    }
+    std::stable_sort(cpus.begin(), cpus.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.first < b.first;
+    });
+    for (size_t i = 0; i < threadCount; ++i) {
+        workerNodes.push_back(cpus[i % cpus.size()].first);
+        workerCpus.push_back(cpus[i % cpus.size()].second);
+    }
+#endif
+}
+
+ThreadPool::Task* ThreadPool::makeTask(UniqueFunction task, const std::string& description, int priority) {
+    void* slot = TaskSlots::instance().allocate();
+    try {
+        return new (slot) Task(std::move(task), description, priority);
+    } catch (...) {
+        TaskSlots::instance().deallocate(slot);
+        throw;
+    }
+}
+
+void ThreadPool::workerFunction(size_t index) {
+    {
+        // Wait until start() has finished populating the worker list
+        std::lock_guard<std::mutex> lock(poolMutex);
+    }
+    currentPool = this;
+    currentWorker = index;
+    if (monitor) {
+        monitor->registerThread(std::this_thread::get_id(), "Worker " + std::to_string(index));
+    }
+    
+    while (true) {
+        Task* task = nullptr;
+        if (findTask(index, task)) {
+            runTask(task);
+            continue;
         }
         
-        // Execute the task
-        if (task.function) {
-            try {
-                task.function();
-            } catch (const std::exception& e) {
-                std::cerr << "Error in worker thread: " << e.what() << std::endl;
-            }
+        Inbox& inbox = inboxes[index];
+        std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+        ThreadMonitor::lockProfiled(lock, ThreadMonitor::LockSite::POOL);
+        inbox.sleeping.store(true, std::memory_order_seq_cst);
+        sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        ThreadMonitor::setState(ThreadMonitor::ThreadState::PARKED);
+        condition.wait(lock, [this, &inbox]() {
+            return !running || pendingTasks.load(std::memory_order_seq_cst) > 0 || 
+                   inbox.pending.load(std::memory_order_seq_cst) > 0;
+        });
+        ThreadMonitor::setState(ThreadMonitor::ThreadState::IDLE);
+        sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+        inbox.sleeping.store(false, std::memory_order_relaxed);
+        
+        if (!running && pendingTasks.load() == 0 && inbox.pending.load() == 0) {
+            break;
+        }
+    }
+    
+    if (monitor) {
+        monitor->unregisterThread(std::this_thread::get_id());
+    }
+    currentPool = nullptr;
+}
+
+bool ThreadPool::findTask(size_t index, Task*& task) {
+    Worker& self = *workers[index];
+    
+    // Work addressed to this worker comes first, and nobody else can take it
+    Inbox& inbox = inboxes[index];
+    if (inbox.tasks->tryPop(task)) {
+        inbox.pending.fetch_sub(1, std::memory_order_seq_cst);
+        return true;
+    }
+    
+    for (size_t band = 0; band < kPriorityBands; ++band) {
+        // Own deque first (no contention), then the shared ring, then steal
+        if (self.deques[band].pop(task) || injection[band]->tryPop(task)) {
+            pendingTasks.fetch_sub(1, std::memory_order_seq_cst);
+            return true;
         }
         
-        activeThreads--;
+        size_t victimCount = workers.size();
+        size_t first = static_cast<size_t>(nextRandom(self.stealSeed) % victimCount);
+        for (size_t i = 0; i < victimCount; ++i) {
+            size_t victim = (first + i) % victimCount;
+            if (victim != index && workers[victim]->deques[band].steal(task)) {
+                pendingTasks.fetch_sub(1, std::memory_order_seq_cst);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runTask(Task* task) {
+    activeThreads++;
+    ThreadMonitor::beginTask(task->description);
+    
+    // Execute the task
+    if (task->function) {
+        try {
+            task->function();
+        } catch (const std::exception& e) {
+            std::cerr << "Error in worker thread: " << e.what() << std::endl;
+        }
+    }
+    task->~Task();
+    TaskSlots::instance().deallocate(task);
+    
+    ThreadMonitor::endTask();
+    activeThreads--;
+}
+
+void ThreadPool::wakeWorker() {
+    if (sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+        ThreadMonitor::lockProfiled(poolMutex, ThreadMonitor::LockSite::POOL);
+        std::lock_guard<std::mutex> lock(poolMutex, std::adopt_lock);
+        condition.notify_one();
+    }
+}
+
+void ThreadPool::drainRemainingTasks() {
+    Task* task = nullptr;
+    for (size_t i = 0; i < threadCount; ++i) {
+        while (inboxes[i].tasks->tryPop(task)) {
+            inboxes[i].pending.fetch_sub(1, std::memory_order_seq_cst);
+            runTask(task);
+        }
+    }
+    for (size_t band = 0; band < kPriorityBands; ++band) {
+        while (injection[band]->tryPop(task)) {
+            pendingTasks.fetch_sub(1, std::memory_order_seq_cst);
+            runTask(task);
+        }
+        for (auto& worker : workers) {
+            while (worker->deques[band].steal(task)) {
+                pendingTasks.fetch_sub(1, std::memory_order_seq_cst);
+                runTask(task);
+            }
+        }
     }
 }
 
@@ -123,85 +396,408 @@ void ThreadPool::workerFunction() {
 // WORK QUEUE IMPLEMENTATION
 // ============================================================================
 
-WorkQueue::WorkItem::WorkItem(const std::function<void()>& w, const std::string& desc)
-    : work(w), description(desc), timestamp(std::chrono::system_clock::now()) {
+WorkQueue::WorkItem::WorkItem(UniqueFunction w, const std::string& desc)
+    : work(std::move(w)), description(desc), timestamp(std::chrono::system_clock::now()) {
 }
 
-WorkQueue::WorkQueue(size_t maxSize) : maxSize(maxSize) {
+WorkQueue::WorkQueue(size_t maxSize, BackpressurePolicy policy) 
+    : queue(maxSize), policy(policy) {
 }
 
-bool WorkQueue::enqueue(const WorkItem& item) {
-    std::unique_lock<std::mutex> lock(queueMutex);
-    
-    // Wait if queue is full
-    notFull.wait(lock, [this]() { return queue.size() < maxSize; });
-    
-    queue.push(item);
-    
-    // Notify waiting consumers
-    notEmpty.notify_one();
-    return true;
+bool WorkQueue::enqueue(WorkItem&& item) {
+    // Wait (or reject) according to the policy if queue is full
+    return queue.push(std::move(item), policy);
 }
 
 bool WorkQueue::dequeue(WorkItem& item) {
-    std::unique_lock<std::mutex> lock(queueMutex);
-    
-    // Wait if queue is empty
-    notEmpty.wait(lock, [this]() { return !queue.empty(); });
-    
-    item = queue.front();
-    queue.pop();
-    
-    // Notify waiting producers
-    notFull.notify_one();
+    // Wait if queue is empty; spin first only if producers asked for it
+    BackpressurePolicy consumerPolicy = policy == BackpressurePolicy::SPIN_THEN_PARK 
+        ? BackpressurePolicy::SPIN_THEN_PARK : BackpressurePolicy::BLOCK;
+    if (!queue.pop(item, consumerPolicy)) {
+        return false;
+    }
+    LatencyStats::recordSince(LatencyStage::WORK_QUEUE_DWELL, item.timestamp);
     return true;
 }
 
+void WorkQueue::close() {
+    queue.close();
+}
+
 size_t WorkQueue::size() const {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    return queue.size();
+    return queue.sizeApprox();
 }
 
 bool WorkQueue::empty() const {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    return queue.empty();
+    return queue.sizeApprox() == 0;
 }
 
 // ============================================================================
 // THREAD MONITOR IMPLEMENTATION
 // ============================================================================
 
+namespace {
+    // Acquisitions left before this thread's next contention sample, per site: one shared
+    // countdown would keep sampling the same site of an operation that takes several locks
+    thread_local uint32_t lockSampleCountdown[static_cast<size_t>(ThreadMonitor::LockSite::COUNT)] = {};
+}
+
+thread_local ThreadMonitor::ThreadSlot* ThreadMonitor::currentSlot = nullptr;
+std::atomic<uint32_t> ThreadMonitor::samplePeriod(0);
+ThreadMonitor::SiteSlot ThreadMonitor::sites[static_cast<size_t>(ThreadMonitor::LockSite::COUNT)];
+
+ThreadMonitor::ThreadMonitor() : threadSlots(new ThreadSlot[kMaxThreads]), threadCount(0) {
+    for (size_t i = 0; i < kMaxThreads; ++i) {
+        for (std::atomic<uint64_t>& word : threadSlots[i].task) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+ThreadMonitor::~ThreadMonitor() {
+    std::less<const ThreadSlot*> before;
+    if (currentSlot && !before(currentSlot, &threadSlots[0]) && before(currentSlot, &threadSlots[0] + kMaxThreads)) {
+        currentSlot = nullptr;
+    }
+}
+
 void ThreadMonitor::registerThread(const std::thread::id& id, const std::string& name) {
     std::lock_guard<std::mutex> lock(monitorMutex);
-    
-    ThreadInfo info;
-    info.id = id;
-    info.name = name;
-    info.status = "RUNNING";
-    info.startTime = std::chrono::system_clock::now();
-    
-    threads[id] = info;
+
+    size_t count = threadCount.load(std::memory_order_relaxed);
+    ThreadSlot* slot = findSlot(id);
+    for (size_t i = 0; !slot && i < count; ++i) {
+        ThreadSlot& candidate = threadSlots[i];
+        if (candidate.state.load(std::memory_order_relaxed) == static_cast<uint8_t>(ThreadState::EXITED) &&
+            candidate.name == name) {
+            slot = &candidate;
+        }
+    }
+    bool fresh = !slot;
+    if (fresh) {
+        if (count == kMaxThreads) {
+            return; // Untracked
+        }
+        slot = &threadSlots[count];
+        slot->name = name;
+    }
+
+    slot->id.store(id, std::memory_order_relaxed);
+    slot->startTimeNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+    slot->tasksRun.store(0, std::memory_order_relaxed);
+    slot->busyNs.store(0, std::memory_order_relaxed);
+    slot->idleNs.store(0, std::memory_order_relaxed);
+    slot->sinceNs.store(steadyNs(), std::memory_order_relaxed);
+    slot->inTask.store(false, std::memory_order_relaxed);
+    slot->lock.store(static_cast<uint8_t>(LockSite::NONE), std::memory_order_relaxed);
+    slot->state.store(static_cast<uint8_t>(ThreadState::IDLE), std::memory_order_release);
+    if (fresh) {
+        threadCount.store(count + 1, std::memory_order_release);
+    }
+    if (id == std::this_thread::get_id()) {
+        currentSlot = slot;
+    }
 }
 
-void ThreadMonitor::updateThreadStatus(const std::thread::id& id, const std::string& status) {
+void ThreadMonitor::unregisterThread(const std::thread::id& id) {
     std::lock_guard<std::mutex> lock(monitorMutex);
-    
-    auto it = threads.find(id);
-    if (it != threads.end()) {
-        it->second.status = status;
+
+    ThreadSlot* slot = findSlot(id);
+    if (!slot) {
+        return;
+    }
+    slot->inTask.store(false, std::memory_order_relaxed);
+    slot->lock.store(static_cast<uint8_t>(LockSite::NONE), std::memory_order_relaxed);
+    slot->state.store(static_cast<uint8_t>(ThreadState::EXITED), std::memory_order_release);
+    if (currentSlot == slot) {
+        currentSlot = nullptr;
+    }
+}
+
+void ThreadMonitor::updateThreadStatus(const std::thread::id& id, ThreadState state) {
+    if (ThreadSlot* slot = findSlot(id)) {
+        slot->state.store(static_cast<uint8_t>(state), std::memory_order_relaxed);
     }
 }
 
 std::vector<ThreadMonitor::ThreadInfo> ThreadMonitor::getAllThreads() const {
-    std::lock_guard<std::mutex> lock(monitorMutex);
-    
+    size_t count = threadCount.load(std::memory_order_acquire);
+    int64_t now = steadyNs();
+
     std::vector<ThreadInfo> result;
-    result.reserve(threads.size());
-    
-    for (const auto& pair : threads) {
-        result.push_back(pair.second);
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const ThreadSlot& slot = threadSlots[i];
+        ThreadState state = static_cast<ThreadState>(slot.state.load(std::memory_order_acquire));
+        if (state == ThreadState::EXITED) {
+            continue;
+        }
+
+        ThreadInfo info;
+        info.id = slot.id.load(std::memory_order_relaxed);
+        info.name = slot.name;
+        info.startTime = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(slot.startTimeNs.load(std::memory_order_relaxed))));
+        info.state = state;
+        info.lock = state == ThreadState::WAITING_LOCK
+            ? static_cast<LockSite>(slot.lock.load(std::memory_order_relaxed)) : LockSite::NONE;
+        info.tasksRun = slot.tasksRun.load(std::memory_order_relaxed);
+
+        // The current spell counts towards busy or idle time as it goes
+        bool inTask = slot.inTask.load(std::memory_order_relaxed);
+        int64_t spell = std::max<int64_t>(0, now - slot.sinceNs.load(std::memory_order_relaxed));
+        info.busy = std::chrono::nanoseconds(slot.busyNs.load(std::memory_order_relaxed) + (inTask ? spell : 0));
+        info.idle = std::chrono::nanoseconds(slot.idleNs.load(std::memory_order_relaxed) + (inTask ? 0 : spell));
+        if (inTask) {
+            info.task = readTask(slot);
+        }
+
+        info.status = stateName(state);
+        if (state == ThreadState::WAITING_LOCK) {
+            info.status += std::string(" on ") + lockSiteName(info.lock);
+        }
+        if (!info.task.empty()) {
+            info.status += (state == ThreadState::RUNNING ? " " : " in ") + info.task;
+        }
+        result.push_back(std::move(info));
+    }
+
+    return result;
+}
+
+void ThreadMonitor::setState(ThreadState state) {
+    if (ThreadSlot* slot = currentSlot) {
+        slot->state.store(static_cast<uint8_t>(state), std::memory_order_relaxed);
+    }
+}
+
+void ThreadMonitor::beginTask(const std::string& description) {
+    ThreadSlot* slot = currentSlot;
+    if (!slot) {
+        return;
+    }
+
+    int64_t now = steadyNs();
+    slot->idleNs.store(slot->idleNs.load(std::memory_order_relaxed) + (now - slot->sinceNs.load(std::memory_order_relaxed)),
+                       std::memory_order_relaxed);
+    slot->sinceNs.store(now, std::memory_order_relaxed);
+
+    // Only the words up to the terminator are written; readers stop there
+    uint64_t words[kTaskWords] = {};
+    size_t length = std::min(description.size(), kTaskNameBytes);
+    std::memcpy(words, description.data(), length);
+    size_t used = std::min(length / sizeof(uint64_t) + 1, kTaskWords);
+    uint32_t version = slot->taskVersion.load(std::memory_order_relaxed);
+    slot->taskVersion.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < used; ++i) {
+        slot->task[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot->taskVersion.store(version + 2, std::memory_order_release);
+
+    slot->inTask.store(true, std::memory_order_relaxed);
+    slot->state.store(static_cast<uint8_t>(ThreadState::RUNNING), std::memory_order_relaxed);
+}
+
+void ThreadMonitor::endTask() {
+    ThreadSlot* slot = currentSlot;
+    if (!slot) {
+        return;
+    }
+
+    int64_t now = steadyNs();
+    slot->busyNs.store(slot->busyNs.load(std::memory_order_relaxed) + (now - slot->sinceNs.load(std::memory_order_relaxed)),
+                       std::memory_order_relaxed);
+    slot->sinceNs.store(now, std::memory_order_relaxed);
+    slot->tasksRun.store(slot->tasksRun.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slot->inTask.store(false, std::memory_order_relaxed);
+    slot->state.store(static_cast<uint8_t>(ThreadState::IDLE), std::memory_order_relaxed);
+}
+
+const char* ThreadMonitor::stateName(ThreadState state) {
+    switch (state) {
+        case ThreadState::IDLE: return "idle";
+        case ThreadState::RUNNING: return "running";
+        case ThreadState::WAITING_LOCK: return "waiting";
+        case ThreadState::PARKED: return "parked";
+        case ThreadState::EXITED: return "exited";
+    }
+    return "unknown";
+}
+
+const char* ThreadMonitor::lockSiteName(LockSite site) {
+    switch (site) {
+        case LockSite::NONE: return "none";
+        case LockSite::ACCOUNTS: return "accountsMutex";
+        case LockSite::ACCOUNT: return "accountMutex";
+        case LockSite::POOL: return "poolMutex";
+        case LockSite::LOGGER: return "loggerMutex";
+        case LockSite::COUNT: break;
+    }
+    return "unknown";
+}
+
+void ThreadMonitor::setContentionSampling(uint32_t period) {
+    samplePeriod.store(period, std::memory_order_relaxed);
+}
+
+uint32_t ThreadMonitor::getContentionSampling() {
+    return samplePeriod.load(std::memory_order_relaxed);
+}
+
+std::vector<ThreadMonitor::LockContention> ThreadMonitor::getLockContention() {
+    std::vector<LockContention> result;
+    for (size_t i = 1; i < static_cast<size_t>(LockSite::COUNT); ++i) {
+        const SiteSlot& slot = sites[i];
+        LockContention contention;
+        contention.site = static_cast<LockSite>(i);
+        contention.sampled = slot.sampled.load(std::memory_order_relaxed);
+        contention.contended = slot.contended.load(std::memory_order_relaxed);
+        contention.wait = std::chrono::nanoseconds(slot.waitNs.load(std::memory_order_relaxed));
+        contention.maxWait = std::chrono::nanoseconds(slot.maxWaitNs.load(std::memory_order_relaxed));
+        contention.peakWaiters = slot.peakWaiters.load(std::memory_order_relaxed);
+        result.push_back(contention);
     }
-    
     return result;
 }
 
+void ThreadMonitor::resetLockContention() {
+    for (SiteSlot& slot : sites) {
+        slot.sampled.store(0, std::memory_order_relaxed);
+        slot.contended.store(0, std::memory_order_relaxed);
+        slot.waitNs.store(0, std::memory_order_relaxed);
+        slot.maxWaitNs.store(0, std::memory_order_relaxed);
+        slot.peakWaiters.store(slot.waiters.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void ThreadMonitor::noteAcquired(LockSite site) {
+    if (sampleAcquisition(site)) {
+        sites[static_cast<size_t>(site)].sampled.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+ThreadMonitor::LockWait::LockWait(LockSite site)
+    : site(site), previousState(0), counted(false), sampled(false), startNs(0) {
+    if (ThreadSlot* slot = currentSlot) {
+        previousState = slot->state.load(std::memory_order_relaxed);
+        slot->lock.store(static_cast<uint8_t>(site), std::memory_order_relaxed);
+        slot->state.store(static_cast<uint8_t>(ThreadState::WAITING_LOCK), std::memory_order_relaxed);
+    }
+    if (samplePeriod.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    // Every waiter is counted while sampling is on, so the peak does not depend on the period
+    SiteSlot& stats = sites[static_cast<size_t>(site)];
+    size_t waiting = stats.waiters.fetch_add(1, std::memory_order_relaxed) + 1;
+    counted = true;
+    size_t peak = stats.peakWaiters.load(std::memory_order_relaxed);
+    while (waiting > peak && !stats.peakWaiters.compare_exchange_weak(peak, waiting, std::memory_order_relaxed)) {
+    }
+    sampled = sampleAcquisition(site);
+    if (sampled) {
+        startNs = steadyNs();
+    }
+}
+
+ThreadMonitor::LockWait::~LockWait() {
+    if (counted) {
+        SiteSlot& stats = sites[static_cast<size_t>(site)];
+        stats.waiters.fetch_sub(1, std::memory_order_relaxed);
+        if (sampled) {
+            int64_t waited = steadyNs() - startNs;
+            stats.sampled.fetch_add(1, std::memory_order_relaxed);
+            stats.contended.fetch_add(1, std::memory_order_relaxed);
+            stats.waitNs.fetch_add(waited, std::memory_order_relaxed);
+            int64_t longest = stats.maxWaitNs.load(std::memory_order_relaxed);
+            while (waited > longest && !stats.maxWaitNs.compare_exchange_weak(longest, waited, std::memory_order_relaxed)) {
+            }
+        }
+    }
+    if (ThreadSlot* slot = currentSlot) {
+        slot->state.store(previousState, std::memory_order_relaxed);
+        slot->lock.store(static_cast<uint8_t>(LockSite::NONE), std::memory_order_relaxed);
+    }
+}
+
+ThreadMonitor::ThreadSlot* ThreadMonitor::findSlot(const std::thread::id& id) const {
+    size_t count = threadCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        ThreadSlot& slot = threadSlots[i];
+        if (slot.state.load(std::memory_order_relaxed) != static_cast<uint8_t>(ThreadState::EXITED) &&
+            slot.id.load(std::memory_order_relaxed) == id) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+bool ThreadMonitor::sampleAcquisition(LockSite site) {
+    uint32_t period = samplePeriod.load(std::memory_order_relaxed);
+    if (period == 0) {
+        return false;
+    }
+    uint32_t& countdown = lockSampleCountdown[static_cast<size_t>(site)];
+    if (countdown == 0 || countdown > period) {
+        countdown = period;
+    }
+    return --countdown == 0;
+}
+
+std::string ThreadMonitor::readTask(const ThreadSlot& slot) {
+    uint64_t words[kTaskWords];
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        uint32_t version = slot.taskVersion.load(std::memory_order_acquire);
+        if (version & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < kTaskWords; ++i) {
+            words[i] = slot.task[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.taskVersion.load(std::memory_order_relaxed) == version) {
+            const char* text = reinterpret_cast<const char*>(words);
+            return std::string(text, std::find(text, text + kTaskNameBytes, '\0'));
+        }
+    }
+    return std::string(); // Changing too fast to catch; the next read will do
+}
+
+int64_t ThreadMonitor::steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ThreadMonitor::trackShards(size_t count) {
+    shardSlots.reset(count ? new ShardSlot[count] : nullptr);
+    shardCount = count;
+}
+
+void ThreadMonitor::recordShardBatch(size_t shard, size_t worker, size_t operations, std::chrono::nanoseconds busy) {
+    if (shard >= shardCount) {
+        return;
+    }
+    ShardSlot& slot = shardSlots[shard];
+    slot.operations.fetch_add(operations, std::memory_order_relaxed);
+    slot.batches.fetch_add(1, std::memory_order_relaxed);
+    slot.busyNs.fetch_add(busy.count(), std::memory_order_relaxed);
+    if (slot.worker.load(std::memory_order_relaxed) != worker) {
+        slot.worker.store(worker, std::memory_order_relaxed);
+    }
+}
+
+std::vector<ThreadMonitor::ShardLoad> ThreadMonitor::getShardLoads() const {
+    std::vector<ShardLoad> loads(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        const ShardSlot& slot = shardSlots[i];
+        loads[i].shard = i;
+        loads[i].worker = slot.worker.load(std::memory_order_relaxed);
+        loads[i].operations = slot.operations.load(std::memory_order_relaxed);
+        loads[i].batches = slot.batches.load(std::memory_order_relaxed);
+        loads[i].busy = std::chrono::nanoseconds(slot.busyNs.load(std::memory_order_relaxed));
+    }
+    return loads;
+}
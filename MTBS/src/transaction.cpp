@@ -1,4 +1,8 @@
 #include "../include/transaction.h"
+#include "../include/log_reader.h"
+#include "../include/id_generator.h"
+#include "../include/latency_histogram.h"
+#include "../include/thread_manager.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -6,118 +10,184 @@
 #include <queue>
 #include <condition_variable>
 #include <fstream>
+#include <algorithm>
+#include <ctime>
+#include <cstring>
+
+namespace {
+    // "YYYY-MM-DD HH:MM:SS" in local time; localtime runs once per second per thread
+    const std::string& localTimestamp(std::time_t now) {
+        thread_local std::time_t cachedSecond = -1;
+        thread_local std::string cachedText;
+        
+        if (now != cachedSecond) {
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &now);
+#else
+            localtime_r(&now, &local);
+#endif
+            char buffer[32];
+            size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+            cachedText.assign(buffer, length);
+            cachedSecond = now;
+        }
+        return cachedText;
+    }
 
-// ============================================================================
-// STATIC MEMBER INITIALIZATION
-// ============================================================================
+    // Log time as YYYYMMDDhhmmss, the key LogIndex uses for timestamps
+    uint64_t localTimeKey(std::chrono::system_clock::time_point point) {
+        std::time_t time = std::chrono::system_clock::to_time_t(point);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        return static_cast<uint64_t>(local.tm_year + 1900) * 10000000000ull +
+               static_cast<uint64_t>(local.tm_mon + 1) * 100000000ull +
+               static_cast<uint64_t>(local.tm_mday) * 1000000ull +
+               static_cast<uint64_t>(local.tm_hour) * 10000ull +
+               static_cast<uint64_t>(local.tm_min) * 100ull +
+               static_cast<uint64_t>(local.tm_sec);
+    }
 
-std::atomic<unsigned long long> TransactionProcessor::transactionCounter(0);
+    // Lines written by logTransaction or the account audit trail
+    bool isTransactionEntry(const char* line, size_t length) {
+        static const char* const kPrefixes[] = {"Transaction: ", "Deposit: ", "Withdrawal: ", "Transfer: "};
+        const char* end = line + length;
+        const char* message = line;
+        for (int field = 0; field < 2 && message < end; ++field) { // Skip "[time] [LEVEL] "
+            const char* close = static_cast<const char*>(std::memchr(message, ']', static_cast<size_t>(end - message)));
+            if (!close) {
+                return false;
+            }
+            message = close + 2;
+        }
+        if (message >= end) {
+            return false;
+        }
+        size_t remaining = static_cast<size_t>(end - message);
+        for (const char* prefix : kPrefixes) {
+            size_t prefixLength = std::strlen(prefix);
+            if (remaining >= prefixLength && std::memcmp(message, prefix, prefixLength) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
 
 // ============================================================================
 // TRANSACTION RESULT IMPLEMENTATION
 // ============================================================================
 
 TransactionProcessor::TransactionResult::TransactionResult(bool s, const std::string& msg, 
-                                                         const std::string& id, double balance, 
+                                                         uint64_t id, Money balance, 
                                                          std::chrono::system_clock::time_point time)
     : success(s), message(msg), transactionId(id), newBalance(balance), timestamp(time) {
 }
 
+std::string TransactionProcessor::TransactionResult::getTransactionId() const {
+    return transactionId != 0 ? "TXN_" + std::to_string(transactionId) : std::string();
+}
+
 // ============================================================================
 // TRANSACTION PROCESSOR IMPLEMENTATION
 // ============================================================================
 
-TransactionProcessor::TransactionProcessor() {
-    // Initialize transaction counter if needed
-}
+TransactionProcessor::TransactionProcessor() = default;
 
 TransactionProcessor::~TransactionProcessor() = default;
 
 TransactionProcessor::TransactionResult TransactionProcessor::processDeposit(Account& account, 
-                                                                          double amount, 
+                                                                          Money amount, 
                                                                           const std::string& description) {
     // Validate transaction
-    if (!validateTransaction(account, amount, "DEPOSIT")) {
+    if (!validateTransaction(account, amount, TransactionType::DEPOSIT)) {
         return TransactionResult(false, "Invalid deposit transaction", 
-                               generateTransactionId(), account.getBalance(), 
+                               0, account.getBalance(), 
                                std::chrono::system_clock::now());
     }
     
     // Process deposit
-    bool success = account.deposit(amount, description);
-    double newBalance = account.getBalance();
+    Transaction recorded;
+    bool success = account.deposit(amount, description, &recorded);
+    Money newBalance = account.getBalance();
     
     if (success) {
         return TransactionResult(true, "Deposit successful", 
-                               generateTransactionId(), newBalance, 
+                               recorded.id, newBalance, 
                                std::chrono::system_clock::now());
     } else {
         return TransactionResult(false, "Deposit failed", 
-                               generateTransactionId(), newBalance, 
+                               0, newBalance, 
                                std::chrono::system_clock::now());
     }
 }
 
 TransactionProcessor::TransactionResult TransactionProcessor::processWithdraw(Account& account, 
-                                                                           double amount, 
+                                                                           Money amount, 
                                                                            const std::string& description) {
     // Validate transaction
-    if (!validateTransaction(account, amount, "WITHDRAW")) {
+    if (!validateTransaction(account, amount, TransactionType::WITHDRAW)) {
         return TransactionResult(false, "Invalid withdrawal transaction", 
-                               generateTransactionId(), account.getBalance(), 
+                               0, account.getBalance(), 
                                std::chrono::system_clock::now());
     }
     
     // Process withdrawal
-    bool success = account.withdraw(amount, description);
-    double newBalance = account.getBalance();
+    Transaction recorded;
+    bool success = account.withdraw(amount, description, &recorded);
+    Money newBalance = account.getBalance();
     
     if (success) {
         return TransactionResult(true, "Withdrawal successful", 
-                               generateTransactionId(), newBalance, 
+                               recorded.id, newBalance, 
                                std::chrono::system_clock::now());
     } else {
         return TransactionResult(false, "Insufficient funds for withdrawal", 
-                               generateTransactionId(), newBalance, 
+                               0, newBalance, 
                                std::chrono::system_clock::now());
     }
 }
 
 TransactionProcessor::TransactionResult TransactionProcessor::processTransfer(Account& fromAccount, 
                                                                             Account& toAccount, 
-                                                                            double amount, 
+                                                                            Money amount, 
                                                                             const std::string& description) {
     // Validate transaction
-    if (!validateTransaction(fromAccount, amount, "TRANSFER")) {
+    if (!validateTransaction(fromAccount, amount, TransactionType::TRANSFER)) {
         return TransactionResult(false, "Invalid transfer transaction", 
-                               generateTransactionId(), fromAccount.getBalance(), 
+                               0, fromAccount.getBalance(), 
                                std::chrono::system_clock::now());
     }
     
     // Process transfer
-    bool success = fromAccount.transfer(toAccount, amount, description);
-    double newBalance = fromAccount.getBalance();
+    Transaction recorded;
+    bool success = fromAccount.transfer(toAccount, amount, description, &recorded);
+    Money newBalance = fromAccount.getBalance();
     
     if (success) {
         return TransactionResult(true, "Transfer successful", 
-                               generateTransactionId(), newBalance, 
+                               recorded.id, newBalance, 
                                std::chrono::system_clock::now());
     } else {
         return TransactionResult(false, "Transfer failed - insufficient funds", 
-                               generateTransactionId(), newBalance, 
+                               0, newBalance, 
                                std::chrono::system_clock::now());
     }
 }
 
 TransactionProcessor::TransactionResult TransactionProcessor::processBalanceCheck(const Account& account) {
-    double balance = account.getBalance();
+    Money balance = account.getBalance();
     return TransactionResult(true, "Balance check successful", 
                            generateTransactionId(), balance, 
                            std::chrono::system_clock::now());
 }
 
-bool TransactionProcessor::validateTransaction(const Account& account, double amount, 
-                                             const std::string& type) {
+bool TransactionProcessor::validateTransaction(const Account& account, Money amount, 
+                                             TransactionType type) {
     // Check if account is active
     if (!isAccountActive(account)) {
         return false;
@@ -129,25 +199,16 @@ bool TransactionProcessor::validateTransaction(const Account& account, double am
     }
     
     // Check sufficient funds for withdrawals and transfers
-    if ((type == "WITHDRAW" || type == "TRANSFER") && !hasSufficientFunds(account, amount)) {
+    if ((type == TransactionType::WITHDRAW || type == TransactionType::TRANSFER) &&
+        !hasSufficientFunds(account, amount)) {
         return false;
     }
     
     return true;
 }
 
-std::string TransactionProcessor::generateTransactionId() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::ostringstream oss;
-    oss << "TXN_" << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S")
-        << "_" << std::setfill('0') << std::setw(3) << ms.count()
-        << "_" << ++transactionCounter;
-    
-    return oss.str();
+uint64_t TransactionProcessor::generateTransactionId() {
+    return IdGenerator::next(); // No allocation, no shared counter
 }
 
 std::string TransactionProcessor::getCurrentTimestamp() {
@@ -161,17 +222,17 @@ std::string TransactionProcessor::getCurrentTimestamp() {
 
 void TransactionProcessor::logTransaction(const Transaction& transaction) {
     std::cout << "[" << getCurrentTimestamp() << "] " 
-              << "Transaction: " << transaction.transactionId 
-              << " - " << transaction.type 
-              << " $" << std::fixed << std::setprecision(2) << transaction.amount
-              << " - Status: " << transaction.status << std::endl;
+              << "Transaction: " << transaction.getTransactionId() 
+              << " - " << transactionTypeName(transaction.type) 
+              << " $" << transaction.amount
+              << " - Status: " << transactionStatusName(transaction.status) << std::endl;
 }
 
-bool TransactionProcessor::isValidAmount(double amount) {
-    return amount > 0 && amount < 1000000000; // Reasonable banking limits
+bool TransactionProcessor::isValidAmount(Money amount) {
+    return amount.isPositive() && amount < Money::fromDollars(1000000000); // Reasonable banking limits
 }
 
-bool TransactionProcessor::hasSufficientFunds(const Account& account, double amount) {
+bool TransactionProcessor::hasSufficientFunds(const Account& account, Money amount) {
     return account.getBalance() >= amount;
 }
 
@@ -189,66 +250,55 @@ TransactionQueue::TransactionTask::TransactionTask(
     : task(t), description(desc), queuedAt(std::chrono::system_clock::now()) {
 }
 
-TransactionQueue::TransactionQueue(size_t maxQueueSize) 
-    : maxSize(maxQueueSize), totalProcessed(0), totalFailed(0) {
+TransactionQueue::TransactionQueue(size_t maxQueueSize, BackpressurePolicy policy) 
+    : taskQueue(maxQueueSize), policy(policy), maxSize(taskQueue.capacity()), 
+      totalProcessed(0), totalFailed(0) {
 }
 
 TransactionQueue::~TransactionQueue() = default;
 
 bool TransactionQueue::enqueueTransaction(const TransactionTask& task) {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    
-    if (isFull()) {
-        return false; // Queue is full
-    }
-    
-    taskQueue.push_back(task);
-    queueCondition.notify_one();
-    return true;
+    return taskQueue.push(task, policy);
+}
+
+bool TransactionQueue::enqueueTransaction(TransactionTask&& task) {
+    return taskQueue.push(std::move(task), policy);
 }
 
 bool TransactionQueue::dequeueTransaction(TransactionTask& task) {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    
-    if (isEmpty()) {
-        return false; // Queue is empty
+    if (!taskQueue.tryPop(task)) {
+        return false;
     }
-    
-    task = taskQueue.front();
-    taskQueue.erase(taskQueue.begin());
+    LatencyStats::recordSince(LatencyStage::TRANSACTION_QUEUE_DWELL, task.queuedAt);
     return true;
 }
 
 size_t TransactionQueue::getQueueSize() const {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    return taskQueue.size();
+    return taskQueue.sizeApprox();
 }
 
 bool TransactionQueue::isEmpty() const {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    return taskQueue.empty();
+    return taskQueue.sizeApprox() == 0;
 }
 
 bool TransactionQueue::isFull() const {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    return taskQueue.size() >= maxSize;
+    return taskQueue.sizeApprox() >= maxSize;
 }
 
 void TransactionQueue::clearQueue() {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    while (!taskQueue.empty()) {
-        taskQueue.erase(taskQueue.begin());
+    TransactionTask discarded;
+    while (taskQueue.tryPop(discarded)) {
     }
 }
 
 std::vector<std::string> TransactionQueue::getQueueStatus() const {
-    std::lock_guard<std::mutex> lock(queueMutex);
+    size_t size = taskQueue.sizeApprox();
     
     std::vector<std::string> status;
-    status.push_back("Queue Size: " + std::to_string(taskQueue.size()));
+    status.push_back("Queue Size: " + std::to_string(size));
     status.push_back("Max Size: " + std::to_string(maxSize));
-    status.push_back("Is Empty: " + std::string(isEmpty() ? "Yes" : "No"));
-    status.push_back("Is Full: " + std::string(isFull() ? "Yes" : "No"));
+    status.push_back("Is Empty: " + std::string(size == 0 ? "Yes" : "No"));
+    status.push_back("Is Full: " + std::string(size >= maxSize ? "Yes" : "No"));
     
     return status;
 }
@@ -258,41 +308,72 @@ std::vector<std::string> TransactionQueue::getQueueStatus() const {
 // ============================================================================
 
 TransactionLogger::TransactionLogger(const std::string& logFilePath)
-    : logFile(logFilePath), currentLevel(LogLevel::INFO), 
-      totalLogged(0), successfulLogged(0), failedLogged(0) {
-    logStream.open(logFile, std::ios::app);
+    : logFile(logFilePath), currentLevel(LogLevel::INFO) {
+    // The text log is for people: no fsync per line, only on flush and rotation
+    AsyncFileWriter::Options options;
+    options.durability = AsyncFileWriter::Durability::ASYNC;
+    logWriter = std::make_unique<AsyncFileWriter>(logFile, options);
+    deferredLog = std::make_unique<DeferredLog>(*logWriter, &TransactionLogger::renderRecord);
 }
 
-TransactionLogger::~TransactionLogger() {
-    if (logStream.is_open()) {
-        logStream.close();
-    }
-}
+TransactionLogger::~TransactionLogger() = default; // Renders what is queued; the writer then drains and syncs
 
 void TransactionLogger::logTransaction(const Transaction& transaction) {
-    std::string message = "Transaction: " + transaction.transactionId + 
-                          " - " + transaction.type + 
-                          " $" + std::to_string(transaction.amount) + 
-                          " - Status: " + transaction.status;
-    
-    logMessage(LogLevel::INFO, message);
+    if (isEnabled(LogLevel::INFO)) {
+        LogRecord record;
+        record.flags = transaction.flags;
+        record.ids[0] = static_cast<uint32_t>(transaction.type);
+        record.ids[1] = static_cast<uint32_t>(transaction.status);
+        record.values[0] = static_cast<int64_t>(transaction.id);
+        record.values[1] = transaction.amount.toCents();
+        queueRecord(LogLevel::INFO, FORMAT_TRANSACTION, record);
+    }
     
     // Update statistics
-    totalLogged++;
-    if (transaction.status == TransactionStatus::SUCCESS) {
-        successfulLogged++;
-    } else {
-        failedLogged++;
-    }
+    logged.add(transaction.status == TransactionStatus::SUCCESS ? LOGGED_SUCCESSFUL : LOGGED_FAILED);
 }
 
-void TransactionLogger::logMessage(LogLevel level, const std::string& message) {
-    if (level < currentLevel) {
+void TransactionLogger::logMessage(LogLevel level, std::string_view message) {
+    if (!isEnabled(level)) {
         return; // Skip logging if level is too low
     }
     
-    std::string entry = formatLogEntry(level, message);
-    writeToFile(entry);
+    ScopedLatency timer(LatencyStage::LOG_WRITE);
+    LogRecord record;
+    record.text = new std::string(message);     // Owned by the record from here on
+    queueRecord(level, FORMAT_TEXT, record);
+}
+
+void TransactionLogger::logDeposit(uint32_t account, Money amount) {
+    if (isEnabled(LogLevel::INFO)) {
+        LogRecord record;
+        record.ids[0] = account;
+        record.values[0] = amount.toCents();
+        queueRecord(LogLevel::INFO, FORMAT_DEPOSIT, record);
+    }
+}
+
+void TransactionLogger::logWithdrawal(uint32_t account, Money amount) {
+    if (isEnabled(LogLevel::INFO)) {
+        LogRecord record;
+        record.ids[0] = account;
+        record.values[0] = amount.toCents();
+        queueRecord(LogLevel::INFO, FORMAT_WITHDRAWAL, record);
+    }
+}
+
+void TransactionLogger::logTransfer(uint32_t fromAccount, uint32_t toAccount, Money amount) {
+    if (isEnabled(LogLevel::INFO)) {
+        LogRecord record;
+        record.ids[0] = fromAccount;
+        record.ids[1] = toAccount;
+        record.values[0] = amount.toCents();
+        queueRecord(LogLevel::INFO, FORMAT_TRANSFER, record);
+    }
+}
+
+bool TransactionLogger::isEnabled(LogLevel level) const {
+    return level >= currentLevel.load(std::memory_order_relaxed);
 }
 
 void TransactionLogger::logError(const std::string& error, const std::string& context) {
@@ -304,23 +385,17 @@ void TransactionLogger::logError(const std::string& error, const std::string& co
 }
 
 void TransactionLogger::setLogLevel(LogLevel level) {
-    std::lock_guard<std::mutex> lock(loggerMutex);
-    currentLevel = level;
+    currentLevel.store(level, std::memory_order_relaxed);
 }
 
 void TransactionLogger::flushLogs() {
-    std::lock_guard<std::mutex> lock(loggerMutex);
-    if (logStream.is_open()) {
-        logStream.flush();
-    }
+    deferredLog->flush();
+    logWriter->flush();
 }
 
 void TransactionLogger::rotateLogFile() {
-    std::lock_guard<std::mutex> lock(loggerMutex);
-    
-    if (logStream.is_open()) {
-        logStream.close();
-    }
+    ThreadMonitor::lockProfiled(loggerMutex, ThreadMonitor::LockSite::LOGGER);
+    std::lock_guard<std::mutex> lock(loggerMutex, std::adopt_lock);
     
     // Create new log file with timestamp
     auto now = std::chrono::system_clock::now();
@@ -328,39 +403,52 @@ void TransactionLogger::rotateLogFile() {
     std::ostringstream oss;
     oss << logFile << "." << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S");
     
-    logFile = oss.str();
-    logStream.open(logFile, std::ios::app);
+    // Everything logged so far lands in the old file first
+    deferredLog->flush();
+    if (logWriter->reopen(oss.str())) {
+        logFile = oss.str();
+    }
 }
 
 std::vector<std::string> TransactionLogger::getRecentTransactions(size_t count) {
-    // This is a simplified implementation
-    // In a real system, you'd read from the log file
-    std::vector<std::string> recent;
-    recent.push_back("Recent transactions would be loaded from log file");
-    return recent;
+    // Scans backwards from the end of the mapping; cost depends on count, not log size
+    LogReader reader(currentLogFile());
+    return reader.readLast(count, isTransactionEntry);
 }
 
 std::vector<std::string> TransactionLogger::searchTransactions(const std::string& searchTerm) {
-    // This is a simplified implementation
-    // In a real system, you'd search through the log file
-    std::vector<std::string> results;
-    results.push_back("Search results for: " + searchTerm);
-    return results;
+    LogReader reader(currentLogFile());
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        reader.useIndex();
+    }
+    return reader.search(searchTerm, SIZE_MAX, isTransactionEntry);
+}
+
+std::vector<std::string> TransactionLogger::getTransactionsBetween(std::chrono::system_clock::time_point from,
+                                                                   std::chrono::system_clock::time_point to) {
+    LogReader reader(currentLogFile());
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        reader.useIndex();
+    }
+    return reader.findBetween(localTimeKey(from), localTimeKey(to), isTransactionEntry);
 }
 
 size_t TransactionLogger::getTotalTransactions() const {
-    return totalLogged;
+    std::array<uint64_t, LOGGED_COUNT> counts = logged.snapshot();
+    return counts[LOGGED_SUCCESSFUL] + counts[LOGGED_FAILED];
 }
 
 size_t TransactionLogger::getSuccessfulTransactions() const {
-    return successfulLogged;
+    return logged.get(LOGGED_SUCCESSFUL);
 }
 
 size_t TransactionLogger::getFailedTransactions() const {
-    return failedLogged;
+    return logged.get(LOGGED_FAILED);
 }
 
-std::string TransactionLogger::levelToString(LogLevel level) {
+const char* TransactionLogger::levelToString(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG: return "DEBUG";
         case LogLevel::INFO: return "INFO";
@@ -371,24 +459,68 @@ std::string TransactionLogger::levelToString(LogLevel level) {
     }
 }
 
-std::string TransactionLogger::formatLogEntry(LogLevel level, const std::string& message) {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    
-    std::ostringstream oss;
-    oss << "[" << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S") << "] "
-        << "[" << levelToString(level) << "] "
-        << message;
-    
-    return oss.str();
+void TransactionLogger::queueRecord(LogLevel level, LogFormat format, LogRecord& record) {
+    record.level = static_cast<uint8_t>(level);
+    record.format = format;
+    deferredLog->push(record);  // Copies into this thread's ring; formatting happens on the render thread
 }
 
-void TransactionLogger::writeToFile(const std::string& entry) {
-    std::lock_guard<std::mutex> lock(loggerMutex);
-    if (logStream.is_open()) {
-        logStream << entry << std::endl;
-        logStream.flush();
+void TransactionLogger::renderRecord(const LogRecord& record, std::string& line) {
+    const StringTable& numbers = StringTable::accountNumbers();
+    line += '[';
+    line += localTimestamp(static_cast<std::time_t>(record.timeNs / 1000000000));
+    line += "] [";
+    line += levelToString(static_cast<LogLevel>(record.level));
+    line += "] ";
+    
+    switch (record.format) {
+        case FORMAT_TEXT:
+            line += *record.text;
+            break;
+        case FORMAT_TRANSACTION: {
+            Transaction transaction{};
+            transaction.id = static_cast<uint64_t>(record.values[0]);
+            transaction.type = static_cast<TransactionType>(record.ids[0]);
+            transaction.flags = record.flags;
+            line += "Transaction: ";
+            line += transaction.getTransactionId();
+            line += " - ";
+            line += transactionTypeName(transaction.type);
+            line += " $";
+            line += Money::fromCents(record.values[1]).toString();
+            line += " - Status: ";
+            line += transactionStatusName(static_cast<TransactionStatus>(record.ids[1]));
+            break;
+        }
+        case FORMAT_DEPOSIT:
+            line += "Deposit: $";
+            line += Money::fromCents(record.values[0]).toString();
+            line += " to account ";
+            line += numbers.lookup(record.ids[0]);
+            break;
+        case FORMAT_WITHDRAWAL:
+            line += "Withdrawal: $";
+            line += Money::fromCents(record.values[0]).toString();
+            line += " from account ";
+            line += numbers.lookup(record.ids[0]);
+            break;
+        case FORMAT_TRANSFER:
+            line += "Transfer: $";
+            line += Money::fromCents(record.values[0]).toString();
+            line += " from ";
+            line += numbers.lookup(record.ids[0]);
+            line += " to ";
+            line += numbers.lookup(record.ids[1]);
+            break;
     }
+    line += '\n';
+}
+
+std::string TransactionLogger::currentLogFile() {
+    flushLogs();
+    ThreadMonitor::lockProfiled(loggerMutex, ThreadMonitor::LockSite::LOGGER);
+    std::lock_guard<std::mutex> lock(loggerMutex, std::adopt_lock);
+    return logFile;
 }
 
 // ============================================================================
@@ -397,34 +529,25 @@ void TransactionLogger::writeToFile(const std::string& entry) {
 
 namespace TransactionUtils {
     std::string generateUniqueId() {
-        static std::atomic<unsigned long long> counter(0);
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        
-        std::ostringstream oss;
-        oss << "UTIL_" << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S")
-            << "_" << ++counter;
-        
-        return oss.str();
+        return "UTIL_" + std::to_string(IdGenerator::next());
     }
     
-    std::string formatCurrency(double amount) {
-        std::ostringstream oss;
-        oss << "$" << std::fixed << std::setprecision(2) << amount;
-        return oss.str();
+    std::string formatCurrency(Money amount) {
+        return "$" + amount.toString();
     }
     
     bool isValidAccountNumber(const std::string& accountNumber) {
         return !accountNumber.empty() && accountNumber.length() >= 8;
     }
     
-    double calculateTransactionFee(double amount, const std::string& type) {
+    Money calculateTransactionFee(Money amount, TransactionType type) {
         if (type == TransactionType::TRANSFER) {
-            return std::min(amount * 0.01, 10.0); // 1% fee, max $10
+            // 1% fee, max $10
+            return std::min(Money::fromCents(amount.toCents() / 100), Money::fromDollars(10));
         } else if (type == TransactionType::WITHDRAW) {
-            return 2.0; // Fixed $2 fee
+            return Money::fromDollars(2); // Fixed $2 fee
         }
-        return 0.0; // No fee for deposits
+        return Money(); // No fee for deposits
     }
     
     std::string generateTransactionSummary(const std::vector<Transaction>& transactions) {
@@ -432,19 +555,21 @@ namespace TransactionUtils {
             return "No transactions to summarize";
         }
         
-        double totalAmount = 0.0;
-        size_t successfulCount = 0;
+        std::vector<Money> successfulAmounts;
+        successfulAmounts.reserve(transactions.size());
         size_t failedCount = 0;
         
         for (const auto& txn : transactions) {
             if (txn.isSuccessful()) {
-                totalAmount += txn.amount;
-                successfulCount++;
+                successfulAmounts.push_back(txn.amount);
             } else {
                 failedCount++;
             }
         }
         
+        size_t successfulCount = successfulAmounts.size();
+        Money totalAmount = Money::sum(successfulAmounts.data(), successfulAmounts.size());
+        
         std::ostringstream oss;
         oss << "Transaction Summary:\n"
             << "Total Transactions: " << transactions.size() << "\n"
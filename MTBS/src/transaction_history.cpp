@@ -0,0 +1,325 @@
+#include "../include/transaction_history.h"
+#include "../include/account.h"
+#include <new>
+#include <thread>
+#include <algorithm>
+
+// ============================================================================
+// CHUNK LAYOUT
+// ============================================================================
+
+// Chunk sizes double from kFirstChunkSize up to kMaxChunkSize and then stay
+// constant: 8, 16, 32, 64, 128, 256, 256, ...
+namespace {
+    constexpr uint64_t kGrowingChunks = 5;
+    constexpr uint64_t kGrowingSlots = TransactionHistory::kFirstChunkSize * ((1u << kGrowingChunks) - 1);
+
+    size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+struct TransactionHistory::Chunk {
+    uint64_t chunkNumber;
+    uint64_t startSlot;
+    size_t capacity;
+    Transaction* records;
+    std::atomic<uint8_t>* ready;
+
+    // Header, records and ready flags live in a single allocation
+    static Chunk* create(uint64_t number) {
+        size_t capacity = TransactionHistory::chunkCapacity(number);
+        size_t bytes = sizeof(Chunk) + capacity * sizeof(Transaction) + capacity * sizeof(std::atomic<uint8_t>);
+        char* memory = static_cast<char*>(::operator new(bytes));
+
+        Chunk* chunk = new (memory) Chunk();
+        chunk->chunkNumber = number;
+        chunk->startSlot = TransactionHistory::chunkStartSlot(number);
+        chunk->capacity = capacity;
+        chunk->records = reinterpret_cast<Transaction*>(memory + sizeof(Chunk));
+        chunk->ready = reinterpret_cast<std::atomic<uint8_t>*>(memory + sizeof(Chunk) + capacity * sizeof(Transaction));
+        for (size_t i = 0; i < capacity; ++i) {
+            new (&chunk->ready[i]) std::atomic<uint8_t>(0);
+        }
+        return chunk;
+    }
+
+    static void destroy(Chunk* chunk) {
+        if (chunk) {
+            chunk->~Chunk();
+            ::operator delete(static_cast<void*>(chunk));
+        }
+    }
+};
+
+static_assert(sizeof(Transaction) % alignof(Transaction) == 0, "Transaction array must stay aligned");
+
+uint64_t TransactionHistory::chunkNumberForSlot(uint64_t slot) {
+    if (slot >= kGrowingSlots) {
+        return kGrowingChunks + (slot - kGrowingSlots) / kMaxChunkSize;
+    }
+    uint64_t number = 0;
+    while (chunkStartSlot(number + 1) <= slot) {
+        ++number;
+    }
+    return number;
+}
+
+uint64_t TransactionHistory::chunkStartSlot(uint64_t chunkNumber) {
+    if (chunkNumber >= kGrowingChunks) {
+        return kGrowingSlots + (chunkNumber - kGrowingChunks) * kMaxChunkSize;
+    }
+    return kFirstChunkSize * ((uint64_t(1) << chunkNumber) - 1);
+}
+
+size_t TransactionHistory::chunkCapacity(uint64_t chunkNumber) {
+    if (chunkNumber >= kGrowingChunks) {
+        return kMaxChunkSize;
+    }
+    return kFirstChunkSize << chunkNumber;
+}
+
+// ============================================================================
+// TRANSACTION HISTORY IMPLEMENTATION
+// ============================================================================
+
+TransactionHistory::TransactionHistory(size_t maxResidentChunks)
+    : reserved(0), residentStart(0), clearedUpTo(0), activeReaders(0) {
+    size_t ringSize = roundUpToPowerOfTwo(std::max<size_t>(maxResidentChunks, 2));
+    ring.reset(new std::atomic<Chunk*>[ringSize]);
+    for (size_t i = 0; i < ringSize; ++i) {
+        ring[i].store(nullptr, std::memory_order_relaxed);
+    }
+    ringMask = ringSize - 1;
+}
+
+TransactionHistory::~TransactionHistory() {
+    for (size_t i = 0; i <= ringMask; ++i) {
+        Chunk::destroy(ring[i].load(std::memory_order_relaxed));
+    }
+    for (Chunk* chunk : retired) {
+        Chunk::destroy(chunk);
+    }
+}
+
+void TransactionHistory::append(const Transaction& transaction) {
+    // Writers look at chunks other writers may evict, so they register too
+    activeReaders.fetch_add(1, std::memory_order_seq_cst);
+
+    uint64_t slot = reserved.fetch_add(1, std::memory_order_acq_rel);
+    Chunk* chunk = chunkForAppend(chunkNumberForSlot(slot));
+    if (chunk) {
+        size_t offset = static_cast<size_t>(slot - chunk->startSlot);
+        new (&chunk->records[offset]) Transaction(transaction);
+        chunk->ready[offset].store(1, std::memory_order_release);
+    }
+    // else: writer stalled past the resident window and its chunk is already gone
+
+    activeReaders.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void TransactionHistory::clear() {
+    uint64_t end = reserved.load(std::memory_order_acquire);
+    uint64_t current = clearedUpTo.load(std::memory_order_relaxed);
+    while (current < end && !clearedUpTo.compare_exchange_weak(current, end, std::memory_order_acq_rel)) {
+    }
+}
+
+void TransactionHistory::setSpillHandler(SpillHandler handler) {
+    spillHandler = std::move(handler);
+}
+
+size_t TransactionHistory::size() const {
+    uint64_t end = reserved.load(std::memory_order_acquire);
+    uint64_t start = firstReadableSlot();
+    return end > start ? static_cast<size_t>(end - start) : 0;
+}
+
+uint64_t TransactionHistory::totalAppended() const {
+    return reserved.load(std::memory_order_acquire);
+}
+
+TransactionHistory::Chunk* TransactionHistory::chunkForAppend(uint64_t chunkNumber) {
+    std::atomic<Chunk*>& cell = ring[chunkNumber & ringMask];
+    Chunk* current = cell.load(std::memory_order_seq_cst);
+
+    while (true) {
+        if (current && current->chunkNumber == chunkNumber) {
+            return current;
+        }
+        if (current && current->chunkNumber > chunkNumber) {
+            return nullptr;
+        }
+
+        // The chunk being displaced must be complete before it leaves the
+        // ring; its slots were reserved long ago, so this wait is only hit
+        // when a writer was descheduled mid-append.
+        if (current) {
+            for (size_t i = 0; i < current->capacity; ++i) {
+                while (!current->ready[i].load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        Chunk* fresh = Chunk::create(chunkNumber);
+        if (cell.compare_exchange_strong(current, fresh, std::memory_order_seq_cst)) {
+            if (current) {
+                evict(current);
+            }
+            return fresh;
+        }
+        Chunk::destroy(fresh); // Another writer installed it; re-check what it installed
+    }
+}
+
+void TransactionHistory::evict(Chunk* chunk) {
+    if (spillHandler) {
+        spillHandler(chunk->records, chunk->capacity);
+    }
+
+    uint64_t newStart = chunk->startSlot + chunk->capacity;
+    uint64_t current = residentStart.load(std::memory_order_relaxed);
+    while (current < newStart && !residentStart.compare_exchange_weak(current, newStart, std::memory_order_acq_rel)) {
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        retired.push_back(chunk);
+    }
+    reclaimRetired();
+}
+
+void TransactionHistory::reclaimRetired() {
+    std::vector<Chunk*> reclaimable;
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        // Only called from append, so the calling writer accounts for one
+        // registration. A reader that registers after this check can no
+        // longer reach any retired chunk, since they were all unlinked from
+        // the ring before.
+        if (activeReaders.load(std::memory_order_seq_cst) > 1) {
+            return;
+        }
+        reclaimable.swap(retired);
+    }
+    for (Chunk* chunk : reclaimable) {
+        Chunk::destroy(chunk);
+    }
+}
+
+uint64_t TransactionHistory::firstReadableSlot() const {
+    return std::max(residentStart.load(std::memory_order_acquire),
+                    clearedUpTo.load(std::memory_order_acquire));
+}
+
+bool TransactionHistory::readSlot(uint64_t& slot, Transaction& out) const {
+    while (true) {
+        if (slot >= reserved.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        uint64_t chunkNumber = chunkNumberForSlot(slot);
+        Chunk* chunk = ring[chunkNumber & ringMask].load(std::memory_order_seq_cst);
+        if (!chunk || chunk->chunkNumber < chunkNumber) {
+            return false; // Not installed yet
+        }
+        if (chunk->chunkNumber > chunkNumber) {
+            // Evicted while we were reading; skip ahead to what is still resident
+            slot = std::max(slot + 1, residentStart.load(std::memory_order_acquire));
+            continue;
+        }
+
+        size_t offset = static_cast<size_t>(slot - chunk->startSlot);
+        if (!chunk->ready[offset].load(std::memory_order_acquire)) {
+            return false; // Still being written; stop at a consistent prefix
+        }
+        out = chunk->records[offset];
+        ++slot;
+        return true;
+    }
+}
+
+template <typename Predicate>
+std::vector<Transaction> TransactionHistory::collect(uint64_t startSlot, size_t limit, Predicate predicate) const {
+    std::vector<Transaction> result;
+    Cursor reader(*this, startSlot);
+    Transaction record;
+    while (result.size() < limit && reader.next(record)) {
+        if (predicate(record)) {
+            result.push_back(record);
+        }
+    }
+    return result;
+}
+
+std::vector<Transaction> TransactionHistory::snapshot() const {
+    std::vector<Transaction> result;
+    result.reserve(size());
+    Cursor reader(*this, firstReadableSlot());
+    Transaction record;
+    while (reader.next(record)) {
+        result.push_back(record);
+    }
+    return result;
+}
+
+std::vector<Transaction> TransactionHistory::page(size_t offset, size_t limit) const {
+    std::vector<Transaction> result;
+    result.reserve(limit < size() ? limit : size());
+    Cursor reader(*this, firstReadableSlot() + offset);
+    Transaction record;
+    while (result.size() < limit && reader.next(record)) {
+        result.push_back(record);
+    }
+    return result;
+}
+
+std::vector<Transaction> TransactionHistory::findByIdRange(uint64_t firstId, uint64_t lastId) const {
+    return collect(firstReadableSlot(), static_cast<size_t>(-1), [firstId, lastId](const Transaction& record) {
+        return record.id >= firstId && record.id <= lastId;
+    });
+}
+
+std::vector<Transaction> TransactionHistory::findByTimeRange(TimePoint from, TimePoint to) const {
+    return collect(firstReadableSlot(), static_cast<size_t>(-1), [from, to](const Transaction& record) {
+        return record.timestamp >= from && record.timestamp <= to;
+    });
+}
+
+TransactionHistory::Cursor TransactionHistory::cursor(size_t offset) const {
+    return Cursor(*this, firstReadableSlot() + offset);
+}
+
+// ============================================================================
+// CURSOR IMPLEMENTATION
+// ============================================================================
+
+TransactionHistory::Cursor::Cursor(const TransactionHistory& owner, uint64_t startSlot)
+    : history(&owner), slot(startSlot) {
+    history->activeReaders.fetch_add(1, std::memory_order_seq_cst);
+}
+
+TransactionHistory::Cursor::Cursor(Cursor&& other) noexcept
+    : history(other.history), slot(other.slot) {
+    other.history = nullptr;
+}
+
+TransactionHistory::Cursor::~Cursor() {
+    if (history) {
+        history->activeReaders.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+bool TransactionHistory::Cursor::next(Transaction& out) {
+    if (!history) {
+        return false;
+    }
+    // A slot may have been cleared or evicted since the cursor was created
+    slot = std::max(slot, history->firstReadableSlot());
+    return history->readSlot(slot, out);
+}
@@ -0,0 +1,420 @@
+#include "../include/transaction_pipeline.h"
+#include "../include/account_directory.h"
+#include "../include/admission_controller.h"
+#include "../include/thread_manager.h"
+#include "../include/scratch_arena.h"
+#include <thread>
+#include <algorithm>
+
+namespace {
+    // Deposits and withdrawals for one account collected from a batch
+    struct PostingGroup {
+        const std::string* accountNumber;
+        std::shared_ptr<Account> account;
+        std::pmr::vector<size_t> operations;  // Indices into the batch, in submission order
+    };
+
+    const char* successMessage(TransactionType type) {
+        return type == TransactionType::DEPOSIT ? "Deposit successful" : "Withdrawal successful";
+    }
+
+    const char* failureMessage(TransactionType type, TransactionStatus status) {
+        if (status == TransactionStatus::INSUFFICIENT_FUNDS) {
+            return "Insufficient funds for withdrawal";
+        }
+        return type == TransactionType::DEPOSIT ? "Invalid deposit transaction" : "Invalid withdrawal transaction";
+    }
+}
+
+// ============================================================================
+// TRANSACTION PIPELINE IMPLEMENTATION
+// ============================================================================
+
+TransactionPipeline::TransactionPipeline(AccountDirectory& directory, ThreadPool& pool,
+                                         size_t batchSize, size_t laneCapacity)
+    : directory(directory), pool(pool), batchSize(batchSize == 0 ? 1 : batchSize),
+      laneCount(directory.shardCount()), admission(nullptr), laneAffinity(false), inFlight(0), batchesExecuted(0) {
+
+    // One lane per directory shard, so a lane's accounts share a shard
+    lanes.reset(new Lane[laneCount]);
+    for (size_t i = 0; i < laneCount; ++i) {
+        lanes[i].queue = std::make_unique<MpmcRing<Operation*>>(laneCapacity);
+    }
+}
+
+TransactionPipeline::~TransactionPipeline() {
+    flush();
+}
+
+void TransactionPipeline::setJournalHook(JournalHook hook) {
+    journalHook = std::move(hook);
+}
+
+void TransactionPipeline::setCommitHook(CommitHook hook) {
+    commitHook = std::move(hook);
+}
+
+void TransactionPipeline::setAdmissionController(AdmissionController* controller) {
+    admission = controller;
+}
+
+void TransactionPipeline::setBatchHook(BatchHook hook) {
+    batchHook = std::move(hook);
+}
+
+void TransactionPipeline::setLaneAffinity(bool enabled) {
+    laneAffinity = enabled;
+}
+
+std::future<TransactionPipeline::Result> TransactionPipeline::submitDeposit(const std::string& accountNumber,
+                                                                          Money amount,
+                                                                          const std::string& description) {
+    auto operation = makeOperation(TransactionType::DEPOSIT, accountNumber, "", amount, description);
+    std::future<Result> future = operation->promise.get_future();
+    admit(std::move(operation));
+    return future;
+}
+
+std::future<TransactionPipeline::Result> TransactionPipeline::submitWithdraw(const std::string& accountNumber,
+                                                                           Money amount,
+                                                                           const std::string& description) {
+    auto operation = makeOperation(TransactionType::WITHDRAW, accountNumber, "", amount, description);
+    std::future<Result> future = operation->promise.get_future();
+    admit(std::move(operation));
+    return future;
+}
+
+std::future<TransactionPipeline::Result> TransactionPipeline::submitTransfer(const std::string& fromAccount,
+                                                                           const std::string& toAccount,
+                                                                           Money amount,
+                                                                           const std::string& description) {
+    auto operation = makeOperation(TransactionType::TRANSFER, fromAccount, toAccount, amount, description);
+    std::future<Result> future = operation->promise.get_future();
+    admit(std::move(operation));
+    return future;
+}
+
+void TransactionPipeline::submitDeposit(const std::string& accountNumber, Money amount,
+                                        const std::string& description, Callback callback) {
+    auto operation = makeOperation(TransactionType::DEPOSIT, accountNumber, "", amount, description);
+    operation->callback = std::move(callback);
+    admit(std::move(operation));
+}
+
+void TransactionPipeline::submitWithdraw(const std::string& accountNumber, Money amount,
+                                         const std::string& description, Callback callback) {
+    auto operation = makeOperation(TransactionType::WITHDRAW, accountNumber, "", amount, description);
+    operation->callback = std::move(callback);
+    admit(std::move(operation));
+}
+
+void TransactionPipeline::submitTransfer(const std::string& fromAccount, const std::string& toAccount,
+                                         Money amount, const std::string& description, Callback callback) {
+    auto operation = makeOperation(TransactionType::TRANSFER, fromAccount, toAccount, amount, description);
+    operation->callback = std::move(callback);
+    admit(std::move(operation));
+}
+
+void TransactionPipeline::flush() {
+    while (inFlight.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+size_t TransactionPipeline::getLaneCount() const {
+    return laneCount;
+}
+
+size_t TransactionPipeline::laneOwner(size_t lane) const {
+    return lane % pool.getThreadCount();
+}
+
+bool TransactionPipeline::hasLaneAffinity() const {
+    return laneAffinity;
+}
+
+size_t TransactionPipeline::getBatchSize() const {
+    return batchSize;
+}
+
+size_t TransactionPipeline::getInFlight() const {
+    return inFlight.load();
+}
+
+size_t TransactionPipeline::getBatchesExecuted() const {
+    return batchesExecuted.load();
+}
+
+// ----------------------------------------------------------------------------
+// Admission
+// ----------------------------------------------------------------------------
+
+void TransactionPipeline::admit(std::unique_ptr<Operation> operation) {
+    if (!pool.isRunning()) {
+        complete(*operation, makeResult(false, "Transaction pipeline is not running", 0, Money()));
+        return;
+    }
+    if (admission) {
+        AdmissionController::Decision decision = admission->tryAdmit(operation->accountNumber);
+        if (!decision.admitted()) {
+            Result rejected = makeResult(false, decision.message(), 0, Money());
+            rejected.retryAfter = decision.retryAfter;
+            complete(*operation, rejected);
+            return;
+        }
+        operation->admittedAt = std::chrono::steady_clock::now();
+    }
+
+    size_t laneIndex = directory.shardIndex(operation->accountNumber);
+    Lane& lane = lanes[laneIndex];
+
+    // Count before publishing so the drainer's re-check cannot miss it
+    inFlight.fetch_add(1, std::memory_order_acq_rel);
+    lane.pending.fetch_add(1, std::memory_order_seq_cst);
+
+    Operation* raw = operation.get();
+    if (!lane.queue->tryPush(raw)) {
+        lane.pending.fetch_sub(1, std::memory_order_seq_cst);
+        inFlight.fetch_sub(1, std::memory_order_acq_rel);
+        if (admission) {
+            admission->release();
+        }
+        complete(*operation, makeResult(false, "Transaction queue full", 0, Money()));
+        return;
+    }
+    operation.release(); // Owned by the lane until completion
+
+    if (!lane.scheduled.exchange(true, std::memory_order_seq_cst)) {
+        scheduleLane(laneIndex);
+    }
+}
+
+void TransactionPipeline::scheduleLane(size_t laneIndex) {
+    UniqueFunction drain([this, laneIndex]() {
+        drainLane(laneIndex);
+    });
+    bool submitted = laneAffinity 
+        ? pool.submitToWorker(laneOwner(laneIndex), std::move(drain), "Pipeline lane " + std::to_string(laneIndex))
+        : pool.submitTask(std::move(drain), "Pipeline lane " + std::to_string(laneIndex), 0);
+
+    if (!submitted) {
+        drainLane(laneIndex); // Pool stopped underneath us: finish on the caller
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Per-shard execution
+// ----------------------------------------------------------------------------
+
+void TransactionPipeline::drainLane(size_t laneIndex) {
+    Lane& lane = lanes[laneIndex];
+    std::vector<Operation*> batch;
+    batch.reserve(batchSize);
+
+    Operation* operation = nullptr;
+    while (batch.size() < batchSize && lane.queue->tryPop(operation)) {
+        batch.push_back(operation);
+    }
+
+    if (!batch.empty()) {
+        lane.pending.fetch_sub(batch.size(), std::memory_order_seq_cst);
+        size_t operations = batch.size();
+        auto started = batchHook ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        try {
+            executeBatch(batch);
+            batchesExecuted.fetch_add(1, std::memory_order_relaxed);
+            if (batchHook) {
+                batchHook(laneIndex, operations, std::chrono::steady_clock::now() - started);
+            }
+        } catch (...) {
+            // The batch was settled on the way out; the lane must still be released below
+        }
+    }
+
+    // Release the lane, then re-check for work that arrived meanwhile
+    lane.scheduled.store(false, std::memory_order_seq_cst);
+    if (lane.pending.load(std::memory_order_seq_cst) > 0 &&
+        !lane.scheduled.exchange(true, std::memory_order_seq_cst)) {
+        scheduleLane(laneIndex);
+    }
+}
+
+void TransactionPipeline::executeBatch(std::vector<Operation*>& batch) {
+    BatchGuard guard{*this, batch};
+
+    // Scratch-arena locals rather than thread_local buffers: completion
+    // callbacks may re-enter the pipeline on this thread, and a nested
+    // batch simply allocates after this one
+    ArenaScope scratch;
+    std::pmr::vector<PostingGroup> groups(scratch.resource());
+    std::pmr::vector<Account::Posting> postings(scratch.resource());
+    std::pmr::vector<Account::PostingResult> results(scratch.resource());
+    std::pmr::vector<Completion> finished(scratch.resource());
+    finished.reserve(batch.size());
+    if (admission) {
+        // Lanes are FIFO: the first operation waited longest
+        admission->recordQueueDelay(std::chrono::steady_clock::now() - batch.front()->admittedAt);
+    }
+
+    // Apply the collected postings, one applyPostings call per account
+    auto flushGroups = [&]() {
+        for (PostingGroup& group : groups) {
+            postings.clear();
+            for (size_t index : group.operations) {
+                const Operation& op = *batch[index];
+                uint32_t description = op.amount.isPositive() ? Transaction::internDescription(op.description)
+                                                              : StringTable::kNoString; // Rejected anyway
+                postings.push_back({op.type, op.amount, description});
+            }
+            results.resize(postings.size());
+            group.account->applyPostings(postings.data(), postings.size(), results.data());
+
+            for (size_t i = 0; i < group.operations.size(); ++i) {
+                Operation& op = *batch[group.operations[i]];
+                const Account::PostingResult& outcome = results[i];
+                bool success = outcome.record.isSuccessful();
+                finished.push_back({&op, makeResult(success,
+                                                    success ? successMessage(op.type)
+                                                            : failureMessage(op.type, outcome.record.status),
+                                                    success ? outcome.record.id : 0, outcome.balanceAfter),
+                                    outcome.record.status});
+            }
+        }
+        groups.clear();
+    };
+
+    for (size_t index = 0; index < batch.size(); ++index) {
+        Operation& op = *batch[index];
+
+        if (op.type == TransactionType::TRANSFER) {
+            // Keep submission order: everything queued before the transfer goes first
+            flushGroups();
+            executeTransfer(op, finished);
+            continue;
+        }
+
+        // Validation: resolve the account once per group
+        auto group = std::find_if(groups.begin(), groups.end(), [&op](const PostingGroup& candidate) {
+            return *candidate.accountNumber == op.accountNumber;
+        });
+        if (group == groups.end()) {
+            std::shared_ptr<Account> account = directory.find(op.accountNumber);
+            if (!account) {
+                finished.push_back({&op, makeResult(false, "Account not found", 0, Money::fromDollars(-1)),
+                                    TransactionStatus::INVALID_ACCOUNT});
+                continue;
+            }
+            groups.push_back({&op.accountNumber, std::move(account), std::pmr::vector<size_t>(scratch.resource())});
+            group = groups.end() - 1;
+        }
+        group->operations.push_back(index);
+    }
+    flushGroups();
+
+    // One durability wait covers the whole batch; outcomes are recorded once it is known
+    if (commitHook && !commitHook()) {
+        for (Completion& completion : finished) {
+            if (completion.result.success) {
+                completion.result.success = false;
+                completion.result.message = "Journal write failed";
+                completion.status = TransactionStatus::FAILED;
+            }
+        }
+    }
+    for (Completion& completion : finished) {
+        if (journalHook) {
+            const Operation& op = *completion.operation;
+            journalHook(op.type, op.accountNumber, 
+                        op.type == TransactionType::TRANSFER ? op.targetAccount : std::string(), 
+                        op.amount, completion.status);
+        }
+        complete(*completion.operation, completion.result);
+    }
+}
+
+void TransactionPipeline::settleBatch(std::vector<Operation*>& batch) noexcept {
+    for (Operation* op : batch) {
+        if (!op->completed) {
+            // Only reached when executeBatch threw before this operation's outcome was delivered
+            try {
+                complete(*op, makeResult(false, "Transaction pipeline error", 0, Money()));
+            } catch (...) {
+            }
+        }
+        delete op;
+    }
+    if (admission) {
+        admission->release(batch.size());
+    }
+    inFlight.fetch_sub(batch.size(), std::memory_order_acq_rel);
+}
+
+void TransactionPipeline::executeTransfer(Operation& op, std::pmr::vector<Completion>& finished) {
+    std::shared_ptr<Account> from = directory.find(op.accountNumber);
+    std::shared_ptr<Account> to = directory.find(op.targetAccount);
+
+    bool success = false;
+    Transaction record;
+    record.id = 0;
+    record.status = TransactionStatus::INSUFFICIENT_FUNDS;
+    TransactionStatus status = TransactionStatus::INSUFFICIENT_FUNDS;
+    const char* message = "Transfer failed - insufficient funds";
+    if (!from || !to) {
+        status = TransactionStatus::INVALID_ACCOUNT;
+        message = "Account not found";
+    } else if (from == to) {
+        status = TransactionStatus::INVALID_ACCOUNT;
+        message = "Cannot transfer to the same account";
+    } else if (!op.amount.isPositive()) {
+        status = TransactionStatus::FAILED;
+        message = "Invalid transfer transaction";
+    } else {
+        success = from->transfer(*to, op.amount, op.description, &record);
+        if (success) {
+            status = TransactionStatus::SUCCESS;
+            message = "Transfer successful";
+        } else if (record.status == TransactionStatus::FAILED) {
+            status = TransactionStatus::FAILED;
+            message = "Transfer failed - balance overflow";
+        }
+    }
+
+    Money balance = from ? from->getBalance() : Money::fromDollars(-1);
+    finished.push_back({&op, makeResult(success, message, record.id, balance), status});
+}
+
+// ----------------------------------------------------------------------------
+// Completion
+// ----------------------------------------------------------------------------
+
+void TransactionPipeline::complete(Operation& operation, const Result& result) {
+    operation.completed = true;
+    if (operation.callback) {
+        try {
+            operation.callback(result);
+        } catch (const std::exception&) {
+            // A failing callback must not take down the lane
+        }
+    } else {
+        operation.promise.set_value(result);
+    }
+}
+
+std::unique_ptr<TransactionPipeline::Operation> TransactionPipeline::makeOperation(TransactionType type,
+                                                                                 const std::string& accountNumber,
+                                                                                 const std::string& targetAccount,
+                                                                                 Money amount,
+                                                                                 const std::string& description) {
+    auto operation = std::make_unique<Operation>();
+    operation->type = type;
+    operation->accountNumber = accountNumber;
+    operation->targetAccount = targetAccount;
+    operation->amount = amount;
+    operation->description = description;
+    return operation;
+}
+
+TransactionPipeline::Result TransactionPipeline::makeResult(bool success, const std::string& message,
+                                                            uint64_t id, Money balance) {
+    return Result(success, message, id, balance, std::chrono::system_clock::now());
+}
@@ -0,0 +1,140 @@
+/**
+ * @brief AccountNumberAllocator: number format, parsing and check characters
+ *
+ * Round-trips ordinals through format() and parse(), checks that the
+ * MOD 37,36 check character rejects every single mistyped character, and
+ * that allocation stays unique across threads and resumes past observed
+ * numbers.
+ */
+
+#include "../include/account_number_allocator.h"
+#include "test_support.h"
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr char kDigits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    void testRoundTrip() {
+        const uint64_t ordinals[] = {0, 1, 2, 35, 36, 4095, 4096, 123456789,
+                                     AccountNumberAllocator::kSerialSpace - 1};
+        std::set<std::string> numbers;
+        for (uint64_t ordinal : ordinals) {
+            std::string number = AccountNumberAllocator::format(ordinal);
+            CHECK(number.size() == AccountNumberAllocator::kNumberLength);
+            CHECK(number.compare(0, 5, "MTBS-") == 0 && number[12] == '-');
+
+            uint64_t parsed = 0;
+            CHECK(AccountNumberAllocator::parse(number, parsed) && parsed == ordinal);
+            numbers.insert(number);
+        }
+        CHECK(numbers.size() == sizeof(ordinals) / sizeof(ordinals[0]));
+
+        // Consecutive ordinals do not give consecutive-looking serials
+        CHECK(AccountNumberAllocator::format(0).substr(5, 6) != AccountNumberAllocator::format(1).substr(5, 6));
+    }
+
+    void testRejects() {
+        std::string number = AccountNumberAllocator::format(987654);
+        uint64_t ordinal = 0;
+
+        CHECK(!AccountNumberAllocator::parse("", ordinal));
+        CHECK(!AccountNumberAllocator::parse(number.substr(0, 13), ordinal));
+        CHECK(!AccountNumberAllocator::parse(number + "0", ordinal));
+        CHECK(!AccountNumberAllocator::parse("ACC-" + number.substr(4), ordinal));
+
+        // Serials are upper case only (the check character would not notice)
+        for (size_t position = 5; position < 12; ++position) {
+            if (number[position] >= 'A' && number[position] <= 'Z') {
+                std::string lowered = number;
+                lowered[position] = static_cast<char>(lowered[position] - 'A' + 'a');
+                CHECK(!AccountNumberAllocator::parse(lowered, ordinal));
+            }
+        }
+
+        std::string noDashes = number;
+        noDashes[4] = '_';
+        CHECK(!AccountNumberAllocator::parse(noDashes, ordinal));
+    }
+
+    void testCheckCharacter() {
+        // Every single substitution in the serial or the check character is caught
+        for (uint64_t base : {uint64_t(0), uint64_t(77), uint64_t(31415926)}) {
+            std::string number = AccountNumberAllocator::format(base);
+            for (size_t position = 5; position < AccountNumberAllocator::kNumberLength; ++position) {
+                if (position == 12) {
+                    continue;   // The dash
+                }
+                for (const char* digit = kDigits; *digit; ++digit) {
+                    if (*digit == number[position]) {
+                        continue;
+                    }
+                    std::string mistyped = number;
+                    mistyped[position] = *digit;
+                    uint64_t ordinal = 0;
+                    CHECK(!AccountNumberAllocator::parse(mistyped, ordinal));
+                }
+            }
+        }
+
+        // Dashes are skipped, letters and digits are not; the result is always one of ours
+        CHECK(AccountNumberAllocator::checkCharacter("MTBS-0000000") == AccountNumberAllocator::checkCharacter("MTBS0000000"));
+        char check = AccountNumberAllocator::checkCharacter("MTBS-ABCDEFG");
+        CHECK(std::string(kDigits).find(check) != std::string::npos);
+    }
+
+    void testAllocation() {
+        AccountNumberAllocator allocator(16);
+        constexpr size_t kThreads = 4;
+        constexpr size_t kPerThread = 1000;
+        std::vector<std::vector<std::string>> issued(kThreads);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&allocator, &issued, t]() {
+                for (size_t i = 0; i < kPerThread; ++i) {
+                    issued[t].push_back(allocator.allocate());
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        std::set<std::string> unique;
+        for (const auto& numbers : issued) {
+            for (const std::string& number : numbers) {
+                uint64_t ordinal = 0;
+                CHECK(AccountNumberAllocator::parse(number, ordinal));
+                CHECK(ordinal < allocator.getNextOrdinal());
+                unique.insert(number);
+            }
+        }
+        CHECK(unique.size() == kThreads * kPerThread);
+
+        // Recovery: nothing at or below an observed number is handed out again
+        AccountNumberAllocator resumed(16);
+        resumed.observe(AccountNumberAllocator::format(5000));
+        resumed.observe("not-one-of-ours");
+        CHECK(resumed.getNextOrdinal() >= 5001);
+        for (int i = 0; i < 100; ++i) {
+            uint64_t ordinal = 0;
+            CHECK(AccountNumberAllocator::parse(resumed.allocate(), ordinal) && ordinal > 5000);
+        }
+
+        resumed.advanceTo(100000);
+        uint64_t ordinal = 0;
+        CHECK(AccountNumberAllocator::parse(resumed.allocate(), ordinal) && ordinal >= 100000);
+    }
+}
+
+int main() {
+    testRoundTrip();
+    testRejects();
+    testCheckCharacter();
+    testAllocation();
+    return test::testResult();
+}
@@ -0,0 +1,92 @@
+/**
+ * @brief IdGenerator: uniqueness across threads and the 64-bit layout
+ *
+ * Checks that concurrent threads never mint the same ID, that the node,
+ * time and sign bits land where id_generator.h documents them, and that
+ * observe() moves every later ID past one read back from disk.
+ */
+
+#include "../include/id_generator.h"
+#include "test_support.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr int kTimeShift = IdGenerator::kNodeBits + IdGenerator::kSlotBits + IdGenerator::kSequenceBits;
+
+    void testUniqueAcrossThreads() {
+        constexpr size_t kThreads = 8;
+        constexpr size_t kPerThread = 50000;   // Far more than one millisecond's sequence space
+        std::vector<std::vector<uint64_t>> minted(kThreads);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&minted, t]() {
+                minted[t].reserve(kPerThread);
+                for (size_t i = 0; i < kPerThread; ++i) {
+                    minted[t].push_back(IdGenerator::next());
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        std::vector<uint64_t> all;
+        for (const auto& ids : minted) {
+            // One thread's IDs come from one slot, so they strictly increase
+            CHECK(std::adjacent_find(ids.begin(), ids.end(), std::greater_equal<uint64_t>()) == ids.end());
+            all.insert(all.end(), ids.begin(), ids.end());
+        }
+        std::sort(all.begin(), all.end());
+        CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+        CHECK(IdGenerator::highWatermark() >= all.back());
+    }
+
+    void testLayout() {
+        uint32_t previousNode = IdGenerator::getNode();
+
+        IdGenerator::setNode(5);
+        uint64_t id = IdGenerator::next();
+        CHECK((id >> 63) == 0);
+        CHECK(IdGenerator::nodeOf(id) == 5);
+        CHECK(((id >> (IdGenerator::kSlotBits + IdGenerator::kSequenceBits)) & IdGenerator::kMaxNode) == 5);
+
+        // Milliseconds since kEpochMs sit above the node bits; timeOf decodes them
+        auto now = std::chrono::system_clock::now();
+        uint64_t millis = id >> kTimeShift;
+        uint64_t expected = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count()) - IdGenerator::kEpochMs;
+        CHECK(millis <= expected + 1000 && millis + 1000 >= expected);
+        auto drift = std::chrono::duration_cast<std::chrono::milliseconds>(now - IdGenerator::timeOf(id)).count();
+        CHECK(drift > -1000 && drift < 1000);
+
+        IdGenerator::setNode(IdGenerator::kMaxNode + 9);    // Masked to the node bits
+        CHECK(IdGenerator::getNode() == ((IdGenerator::kMaxNode + 9) & IdGenerator::kMaxNode));
+        CHECK(IdGenerator::nodeOf(IdGenerator::next()) == IdGenerator::getNode());
+
+        IdGenerator::setNode(previousNode);
+    }
+
+    void testObserve() {
+        // An ID from a minute ahead (another node's clock, or one persisted before a clock step)
+        uint64_t ahead = IdGenerator::next() + (uint64_t(60000) << kTimeShift);
+        IdGenerator::observe(ahead);
+        CHECK(IdGenerator::next() > ahead);
+        CHECK(IdGenerator::highWatermark() > ahead);
+
+        // Observing an older ID changes nothing
+        uint64_t before = IdGenerator::next();
+        IdGenerator::observe(before / 2);
+        CHECK(IdGenerator::next() > before);
+    }
+}
+
+int main() {
+    testUniqueAcrossThreads();
+    testLayout();
+    testObserve();
+    return test::testResult();
+}
@@ -0,0 +1,147 @@
+/**
+ * @brief Journal encoding and JournalReader: round trip, CRC and torn tails
+ *
+ * Records written back to back must read back field for field. A flipped
+ * bit anywhere after the CRC, or a file cut mid-record (a crash during an
+ * append), must stop the reader at the last intact record and report
+ * corruption rather than return garbage.
+ */
+
+#include "../include/journal.h"
+#include "test_support.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+    JournalRecord makeRecord(uint64_t lsn) {
+        JournalRecord record;
+        record.kind = JournalRecordKind::TRANSACTION;
+        record.lsn = lsn;
+        record.transactionId = 1000 + lsn;
+        record.timestamp = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds(1700000000 + lsn)));
+        record.type = lsn % 2 ? TransactionType::TRANSFER : TransactionType::WITHDRAW;
+        record.status = lsn % 3 ? TransactionStatus::SUCCESS : TransactionStatus::INSUFFICIENT_FUNDS;
+        record.flags = static_cast<uint8_t>(lsn);
+        record.amount = Money::fromCents(12345 * static_cast<int64_t>(lsn));
+        record.account = "MTBS-0000001-" + std::to_string(lsn);
+        record.balanceAfter = Money::fromCents(-7);
+        record.counterparty = lsn % 2 ? "MTBS-0000002-X" : "";
+        record.counterpartyBalanceAfter = Money::fromCents(99);
+        record.text = "Payment " + std::to_string(lsn);
+        return record;
+    }
+
+    bool sameRecord(const JournalRecord& a, const JournalRecord& b) {
+        return a.kind == b.kind && a.lsn == b.lsn && a.transactionId == b.transactionId &&
+               a.timestamp == b.timestamp && a.type == b.type && a.status == b.status && a.flags == b.flags &&
+               a.amount == b.amount && a.account == b.account && a.balanceAfter == b.balanceAfter &&
+               a.counterparty == b.counterparty && a.counterpartyBalanceAfter == b.counterpartyBalanceAfter &&
+               a.text == b.text;
+    }
+
+    std::string encodeAll(const std::vector<JournalRecord>& records, std::vector<size_t>& offsets) {
+        std::string file;
+        std::string encoded;
+        for (const JournalRecord& record : records) {
+            Journal::encode(record, encoded);
+            offsets.push_back(file.size());
+            file += encoded;
+        }
+        return file;
+    }
+
+    void writeFile(const std::string& path, const std::string& contents) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+
+    size_t readAll(const std::string& path, const std::vector<JournalRecord>& expected, bool& corrupt) {
+        JournalReader reader(path);
+        CHECK(reader.isOpen());
+        JournalRecord record;
+        size_t count = 0;
+        while (reader.next(record)) {
+            CHECK(count < expected.size() && sameRecord(record, expected[count]));
+            ++count;
+        }
+        CHECK(reader.getRecordsRead() == count);
+        corrupt = reader.hitCorruption();
+        return count;
+    }
+
+    void testEncodeDecode() {
+        JournalRecord original = makeRecord(3);
+        original.kind = JournalRecordKind::ACCOUNT_OPENED;
+        std::string encoded;
+        Journal::encode(original, encoded);
+        CHECK(encoded.size() == Journal::kHeaderSize + original.account.size() + original.counterparty.size() +
+                                original.text.size());
+
+        JournalRecord decoded;
+        size_t consumed = 0;
+        CHECK(Journal::decode(encoded.data(), encoded.size(), decoded, consumed));
+        CHECK(consumed == encoded.size() && sameRecord(decoded, original));
+
+        // Every byte after the CRC field is covered by it
+        for (size_t i = 8; i < encoded.size(); ++i) {
+            std::string damaged = encoded;
+            damaged[i] = static_cast<char>(damaged[i] ^ 0x10);
+            CHECK(!Journal::decode(damaged.data(), damaged.size(), decoded, consumed));
+        }
+        CHECK(!Journal::decode(encoded.data(), encoded.size() - 1, decoded, consumed));
+        CHECK(!Journal::decode(encoded.data(), Journal::kHeaderSize - 1, decoded, consumed));
+
+        // Oversized strings are cut so the record still fits
+        JournalRecord large = makeRecord(4);
+        large.text.assign(Journal::kMaxStringLength + 100, 'x');
+        Journal::encode(large, encoded);
+        CHECK(Journal::decode(encoded.data(), encoded.size(), decoded, consumed));
+        CHECK(decoded.text.size() == Journal::kMaxStringLength);
+    }
+
+    void testReader(const std::string& path) {
+        std::vector<JournalRecord> records;
+        for (uint64_t lsn = 1; lsn <= 50; ++lsn) {
+            records.push_back(makeRecord(lsn));
+        }
+        std::vector<size_t> offsets;
+        std::string file = encodeAll(records, offsets);
+        bool corrupt = true;
+
+        writeFile(path, file);
+        CHECK(readAll(path, records, corrupt) == records.size() && !corrupt);
+
+        // Torn tail: the last append was cut short, anywhere inside the record
+        size_t lastStart = offsets.back();
+        for (size_t cut : {lastStart + 1, lastStart + 4, lastStart + 8, lastStart + Journal::kHeaderSize, file.size() - 1}) {
+            writeFile(path, file.substr(0, cut));
+            CHECK(readAll(path, records, corrupt) == records.size() - 1 && corrupt);
+        }
+
+        // A damaged record in the middle stops the reader there
+        std::string damaged = file;
+        damaged[offsets[20] + Journal::kHeaderSize + 2] ^= 0x01;
+        writeFile(path, damaged);
+        CHECK(readAll(path, records, corrupt) == 20 && corrupt);
+
+        // Empty and missing files hold no records
+        writeFile(path, "");
+        CHECK(readAll(path, records, corrupt) == 0 && !corrupt);
+        std::remove(path.c_str());
+        JournalReader missing(path);
+        CHECK(!missing.isOpen());
+    }
+}
+
+int main() {
+    std::string path = (std::filesystem::temp_directory_path() / "mtbs_test_journal.wal").string();
+    testEncodeDecode();
+    testReader(path);
+    std::remove(path.c_str());
+    return test::testResult();
+}
@@ -0,0 +1,82 @@
+/**
+ * @brief Money: checked arithmetic and the overflow edges of sumCents
+ *
+ * sumCents keeps a 128-bit running total, so it must accept inputs whose
+ * partial sums leave the 64-bit range as long as the exact total fits, and
+ * throw only when the total itself does not.
+ */
+
+#include "../include/money.h"
+#include "test_support.h"
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+    constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+
+    int64_t sum(const std::vector<int64_t>& values) {
+        return Money::sumCents(values.data(), values.size()).toCents();
+    }
+
+    void testCheckedArithmetic() {
+        Money result = Money::fromCents(7);
+        CHECK(Money::tryAdd(Money::fromCents(2), Money::fromCents(3), result) && result.toCents() == 5);
+
+        result = Money::fromCents(7);
+        CHECK(!Money::tryAdd(Money::fromCents(kMax), Money::fromCents(1), result));
+        CHECK(result.toCents() == 7);   // Untouched on overflow
+        CHECK(!Money::trySubtract(Money::fromCents(kMin), Money::fromCents(1), result));
+        CHECK(result.toCents() == 7);
+
+        CHECK_THROWS(Money::fromCents(kMax) + Money::fromCents(1), std::overflow_error);
+        CHECK_THROWS(Money::fromCents(kMin) - Money::fromCents(1), std::overflow_error);
+        CHECK(Money::fromDollars(12, 34).toCents() == 1234);
+    }
+
+    void testSumEdges() {
+        CHECK(Money::sumCents(nullptr, 0).toCents() == 0);
+        CHECK(sum({kMax}) == kMax);
+        CHECK(sum({kMin}) == kMin);
+        CHECK(sum({kMax, kMin}) == -1);
+
+        // Partial sums leave the range, the total does not
+        CHECK(sum({kMax, 1, -1}) == kMax);
+        CHECK(sum({kMax, kMax, kMin, kMin, 5}) == 3);
+        CHECK(sum({kMin, -1, 1}) == kMin);
+
+        // Totals that do not fit
+        CHECK_THROWS(sum({kMax, 1}), std::overflow_error);
+        CHECK_THROWS(sum({kMin, -1}), std::overflow_error);
+        CHECK_THROWS(sum({kMax, kMax, kMin, 2}), std::overflow_error);   // kMax + 1
+    }
+
+    void testSumAcrossBlocks() {
+        // Long enough to span several internal blocks, with a ragged tail for the scalar loop
+        std::vector<int64_t> values;
+        for (size_t i = 0; i < 10003; ++i) {
+            values.push_back(i % 2 == 0 ? kMax / 2 : -(kMax / 2));
+        }
+        CHECK(sum(values) == kMax / 2);     // 5002 positive, 5001 negative
+
+        std::vector<int64_t> overflowing(20000, kMax / 4);
+        CHECK_THROWS(sum(overflowing), std::overflow_error);
+        overflowing.assign(20000, kMin / 4);
+        CHECK_THROWS(sum(overflowing), std::overflow_error);
+
+        std::vector<int64_t> cents(9999, 3);
+        CHECK(sum(cents) == 29997);
+
+        std::vector<Money> amounts(4097, Money::fromCents(-2));
+        CHECK(Money::sum(amounts.data(), amounts.size()).toCents() == -8194);
+    }
+}
+
+int main() {
+    testCheckedArithmetic();
+    testSumEdges();
+    testSumAcrossBlocks();
+    return test::testResult();
+}
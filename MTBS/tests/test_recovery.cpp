@@ -0,0 +1,157 @@
+/**
+ * @brief Restart recovery: snapshot load plus journal tail replay
+ *
+ * A bank runs with a journal and snapshots; after a snapshot it keeps
+ * working, and its files are copied mid-run, the state a crash would leave
+ * behind (with EVERY_RECORD durability each synchronous call is on disk
+ * when it returns). A second bank started on the copy must load the
+ * snapshot, replay the journal written after it, and end up with the same
+ * balances, histories and closed accounts, without reissuing account
+ * numbers or transaction IDs.
+ */
+
+#include "../include/bank.h"
+#include "../include/journal.h"
+#include "test_support.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    Bank::Config recoveryConfig(const fs::path& directory) {
+        Bank::Config config;
+        config.enableAuditLogging = false;
+        config.journalPath = (directory / "bank_journal.wal").string();
+        config.snapshotPath = (directory / "bank_snapshot.dat").string();
+        config.historyArchivePath = (directory / "bank_history.wal").string();
+        config.journalDurability = AsyncFileWriter::Durability::EVERY_RECORD;
+        config.snapshotInterval = std::chrono::seconds(0);
+        return config;
+    }
+
+    // What a crash at this instant would leave on disk
+    void copyCrashImage(const Bank::Config& config, const fs::path& target) {
+        fs::copy_file(config.snapshotPath, target / fs::path(config.snapshotPath).filename());
+        for (const Journal::Segment& segment : Journal::listSegments(config.journalPath)) {
+            fs::copy_file(segment.path, target / fs::path(segment.path).filename());
+        }
+        if (fs::exists(config.historyArchivePath)) {
+            fs::copy_file(config.historyArchivePath, target / fs::path(config.historyArchivePath).filename());
+        }
+    }
+
+    struct Expected {
+        Money balance;
+        size_t transactions;
+        std::vector<uint64_t> ids;
+    };
+
+    std::vector<uint64_t> transactionIds(Bank& bank, const std::string& account) {
+        std::vector<uint64_t> ids;
+        for (const Transaction& transaction : bank.getAccountTransactions(account)) {
+            ids.push_back(transaction.id);
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    void testSnapshotPlusReplay(const fs::path& root) {
+        fs::path live = root / "live";
+        fs::path crashed = root / "crashed";
+        fs::create_directories(live);
+        fs::create_directories(crashed);
+
+        std::map<std::string, Expected> expected;
+        std::string closed;
+        uint64_t highestId = 0;
+        {
+            Bank bank(recoveryConfig(live));
+            bank.startBankingSystem();
+            std::string alice = bank.createAccount("Alice Example", Money::fromDollars(500));
+            std::string bob = bank.createAccount("Bob Example", Money::fromDollars(100));
+            closed = bank.createAccount("Carol Example", Money::fromDollars(0));
+            for (int i = 0; i < 20; ++i) {
+                CHECK(bank.processDeposit(alice, Money::fromCents(101), "Before snapshot"));
+            }
+            CHECK(bank.processTransfer(alice, bob, Money::fromDollars(50), "Rent"));
+            CHECK(bank.takeSnapshot());
+
+            // The journal tail: only replay restores these
+            for (int i = 0; i < 15; ++i) {
+                CHECK(bank.processWithdraw(bob, Money::fromCents(250), "After snapshot"));
+            }
+            CHECK(!bank.processWithdraw(bob, Money::fromDollars(1000000), "Insufficient"));
+            CHECK(bank.processTransfer(bob, alice, Money::fromCents(333), "Refund"));
+            std::string dave = bank.createAccount("Dave Example", Money::fromDollars(42));
+            CHECK(bank.processDeposit(dave, Money::fromCents(1), "Opened after snapshot"));
+            CHECK(bank.closeAccount(closed));
+
+            for (const std::string& account : {alice, bob, dave}) {
+                expected[account] = {bank.getAccountBalance(account), bank.getAccountTransactions(account).size(),
+                                     transactionIds(bank, account)};
+                if (!expected[account].ids.empty()) {
+                    highestId = std::max(highestId, expected[account].ids.back());
+                }
+            }
+            copyCrashImage(recoveryConfig(live), crashed);
+            bank.stopBankingSystem();
+        }
+
+        Bank recovered(recoveryConfig(crashed));
+        recovered.startBankingSystem();
+        for (const auto& [account, state] : expected) {
+            CHECK(recovered.getAccount(account) != nullptr);
+            CHECK(recovered.getAccountBalance(account) == state.balance);
+            CHECK(recovered.getAccountTransactions(account).size() == state.transactions);
+            CHECK(transactionIds(recovered, account) == state.ids);
+        }
+        CHECK(recovered.getAccount(closed) == nullptr);
+
+        // Work after the restart neither reuses account numbers nor transaction IDs
+        std::string fresh = recovered.createAccount("Erin Example", Money::fromDollars(1));
+        CHECK(expected.count(fresh) == 0 && fresh != closed);
+        std::string alice = expected.begin()->first;
+        CHECK(recovered.processDeposit(alice, Money::fromCents(5), "After restart"));
+        std::vector<uint64_t> ids = transactionIds(recovered, alice);
+        CHECK(!ids.empty() && ids.back() > highestId);
+        recovered.stopBankingSystem();
+    }
+
+    void testCleanRestart(const fs::path& root) {
+        // A clean stop snapshots: the restart has nothing to replay but must match all the same
+        fs::path directory = root / "clean";
+        fs::create_directories(directory);
+        std::string account;
+        Money balance;
+        size_t transactions = 0;
+        {
+            Bank bank(recoveryConfig(directory));
+            bank.startBankingSystem();
+            account = bank.createAccount("Frank Example", Money::fromDollars(10));
+            CHECK(bank.processDeposit(account, Money::fromCents(99), "Deposit"));
+            balance = bank.getAccountBalance(account);
+            transactions = bank.getAccountTransactions(account).size();
+            bank.stopBankingSystem();
+        }
+        Bank bank(recoveryConfig(directory));
+        bank.startBankingSystem();
+        CHECK(bank.getAccountBalance(account) == balance);
+        CHECK(bank.getAccountTransactions(account).size() == transactions);
+        bank.stopBankingSystem();
+    }
+}
+
+int main() {
+    fs::path root = fs::temp_directory_path() /
+                    ("mtbs_test_recovery_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    testSnapshotPlusReplay(root);
+    testCleanRestart(root);
+    std::error_code error;
+    fs::remove_all(root, error);
+    return test::testResult();
+}
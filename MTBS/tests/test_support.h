@@ -0,0 +1,40 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <iostream>
+
+/**
+ * @brief Minimal checks for the test programs under tests/
+ *
+ * A failed CHECK prints the file, line and expression and carries on, so
+ * one run reports every failure; main returns testResult(), which ctest
+ * reads as pass (0) or fail.
+ */
+namespace test {
+    inline int failures = 0;
+
+    inline void fail(const char* file, int line, const char* what) {
+        ++failures;
+        std::cerr << file << ":" << line << ": check failed: " << what << "\n";
+    }
+
+    inline int testResult() {
+        if (failures > 0) {
+            std::cerr << failures << " check(s) failed\n";
+            return 1;
+        }
+        return 0;
+    }
+}
+
+#define CHECK(condition) \
+    do { if (!(condition)) { test::fail(__FILE__, __LINE__, #condition); } } while (0)
+
+#define CHECK_THROWS(expression, exceptionType) \
+    do { \
+        bool thrown = false; \
+        try { (void)(expression); } catch (const exceptionType&) { thrown = true; } \
+        if (!thrown) { test::fail(__FILE__, __LINE__, #expression " throws " #exceptionType); } \
+    } while (0)
+
+#endif // TEST_SUPPORT_H